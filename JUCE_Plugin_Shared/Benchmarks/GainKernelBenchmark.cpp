@@ -0,0 +1,253 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - DSP code shared by the plugin projects
+    GainKernelBenchmark - compares the plugindsp gain kernels at every
+    available SIMD level against juce::FloatVectorOperations
+
+    Usage: GainKernelBenchmark [--quick]
+
+  ==============================================================================
+*/
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "BenchmarkUtilities.h"
+#include "GainKernels.h"
+
+#include <cstdio>
+#include <functional>
+
+namespace
+{
+    //==============================================================================
+    struct Settings
+    {
+        int warmupBatches = 20;
+        int measuredBatches = 200;
+        int callsPerBatch = 20;
+    };
+
+    struct Buffers
+    {
+        Buffers (int numChannels, int numSamples)
+            : source (numChannels, numSamples),
+              dest (numChannels, numSamples),
+              interleavedSource ((size_t) (numChannels * numSamples)),
+              interleavedDest ((size_t) (numChannels * numSamples)),
+              channelGains ((size_t) numChannels)
+        {
+            juce::Random random (1234);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                    source.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+                channelGains[(size_t) channel] = 0.5f + 0.01f * (float) channel;
+            }
+
+            dest.makeCopyOf (source);
+
+            for (size_t i = 0; i < interleavedSource.size(); ++i)
+                interleavedSource[i] = random.nextFloat() * 2.0f - 1.0f;
+        }
+
+        juce::AudioBuffer<float> source, dest;
+        std::vector<float> interleavedSource, interleavedDest, channelGains;
+    };
+
+    double nanosecondsPerSample (const std::function<void()>& fn, int numChannels, int numSamples,
+                                 const Settings& settings)
+    {
+        const auto timings = plugindsp::bench::timeBatches (fn, settings.callsPerBatch,
+                                                            settings.warmupBatches, settings.measuredBatches);
+
+        return plugindsp::bench::summarise (timings).p50 / (double) (numChannels * numSamples);
+    }
+
+    void printRow (const char* operation, int numChannels, int numSamples, const char* implementation,
+                   double nsPerSample, double baselineNsPerSample)
+    {
+        std::printf ("%-22s %4d %6d  %-10s %10.4f", operation, numChannels, numSamples,
+                     implementation, nsPerSample);
+
+        if (baselineNsPerSample > 0.0)
+            std::printf ("  %6.2fx", baselineNsPerSample / nsPerSample);
+
+        std::printf ("\n");
+    }
+
+    //==============================================================================
+    // One operation, timed once with the JUCE equivalent (if there is one) and
+    // then once per available SIMD level.
+    struct Operation
+    {
+        const char* name;
+        std::function<void (Buffers&, int numChannels, int numSamples)> juceVersion;
+        std::function<void (Buffers&, int numChannels, int numSamples)> kernelVersion;
+    };
+
+    std::vector<Operation> createOperations()
+    {
+        std::vector<Operation> operations;
+
+        // In-place operations alternate between a gain and its reciprocal so the
+        // data stays in a sensible range however many times they run.
+        operations.push_back ({ "applyGain (planar)",
+            [] (Buffers& b, int numChannels, int numSamples)
+            {
+                static bool flip = false;
+                const auto gain = (flip = ! flip) ? 0.5f : 2.0f;
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    juce::FloatVectorOperations::multiply (b.dest.getWritePointer (channel), gain, numSamples);
+            },
+            [] (Buffers& b, int numChannels, int numSamples)
+            {
+                static bool flip = false;
+                const auto gain = (flip = ! flip) ? 0.5f : 2.0f;
+                plugindsp::applyGain (b.dest.getArrayOfWritePointers(), numChannels, numSamples, gain);
+            } });
+
+        operations.push_back ({ "copyWithGain (planar)",
+            [] (Buffers& b, int numChannels, int numSamples)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    juce::FloatVectorOperations::multiply (b.dest.getWritePointer (channel),
+                                                           b.source.getReadPointer (channel), 0.7f, numSamples);
+            },
+            [] (Buffers& b, int numChannels, int numSamples)
+            {
+                plugindsp::copyWithGain (b.dest.getArrayOfWritePointers(), b.source.getArrayOfReadPointers(),
+                                         numChannels, numSamples, 0.7f);
+            } });
+
+        operations.push_back ({ "addWithGain (planar)",
+            [] (Buffers& b, int numChannels, int numSamples)
+            {
+                static bool flip = false;
+                const auto gain = (flip = ! flip) ? 0.25f : -0.25f;
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    juce::FloatVectorOperations::addWithMultiply (b.dest.getWritePointer (channel),
+                                                                  b.source.getReadPointer (channel), gain, numSamples);
+            },
+            [] (Buffers& b, int numChannels, int numSamples)
+            {
+                static bool flip = false;
+                const auto gain = (flip = ! flip) ? 0.25f : -0.25f;
+                plugindsp::addWithGain (b.dest.getArrayOfWritePointers(), b.source.getArrayOfReadPointers(),
+                                        numChannels, numSamples, gain);
+            } });
+
+        // JUCE has no vectorised ramp, so AudioBuffer::applyGainRamp is the baseline
+        operations.push_back ({ "applyGainRamp (planar)",
+            [] (Buffers& b, int numChannels, int numSamples)
+            {
+                static bool flip = false;
+                flip = ! flip;
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    b.dest.applyGainRamp (channel, 0, numSamples, flip ? 0.5f : 2.0f, flip ? 2.0f : 0.5f);
+            },
+            [] (Buffers& b, int numChannels, int numSamples)
+            {
+                static bool flip = false;
+                flip = ! flip;
+
+                const auto start = flip ? 0.5f : 2.0f;
+                const auto end   = flip ? 2.0f : 0.5f;
+                plugindsp::applyGainRamp (b.dest.getArrayOfWritePointers(), numChannels, numSamples,
+                                          start, (end - start) / (float) numSamples);
+            } });
+
+        // No JUCE equivalent for per-channel gains on interleaved data
+        operations.push_back ({ "copyWithGain (interl.)",
+            nullptr,
+            [] (Buffers& b, int numChannels, int numSamples)
+            {
+                plugindsp::copyWithGainInterleaved (b.interleavedDest.data(), b.interleavedSource.data(),
+                                                    numChannels, numSamples, b.channelGains.data());
+            } });
+
+        // Meter input: JUCE needs one pass for min/max and another for RMS
+        operations.push_back ({ "measureLevels (planar)",
+            [] (Buffers& b, int numChannels, int numSamples)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    const auto range = juce::FloatVectorOperations::findMinAndMax (b.source.getReadPointer (channel), numSamples);
+                    plugindsp::bench::doNotOptimise (range.getEnd() + b.source.getRMSLevel (channel, 0, numSamples));
+                }
+            },
+            [] (Buffers& b, int numChannels, int numSamples)
+            {
+                plugindsp::LevelSummary levels[64];
+                plugindsp::measureLevels (b.source.getArrayOfReadPointers(), juce::jmin (numChannels, 64),
+                                          numSamples, levels);
+                plugindsp::bench::doNotOptimise (levels[0].sumOfSquares);
+            } });
+
+        return operations;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    Settings settings;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (juce::String (argv[i]) == "--quick")
+        {
+            settings.warmupBatches = 5;
+            settings.measuredBatches = 30;
+        }
+    }
+
+    std::printf ("Best available SIMD level: %s\n\n",
+                 plugindsp::getSimdLevelName (plugindsp::getBestAvailableSimdLevel()));
+
+    std::printf ("%-22s %4s %6s  %-10s %10s  %s\n", "operation", "ch", "block", "impl", "ns/sample", "vs JUCE");
+
+    const auto bestLevel = plugindsp::getBestAvailableSimdLevel();
+    const auto operations = createOperations();
+
+    for (const auto& operation : operations)
+    {
+        for (auto numChannels : { 2, 16, 64 })
+        {
+            for (auto numSamples : { 64, 256, 1024 })
+            {
+                Buffers buffers (numChannels, numSamples);
+                double baseline = 0.0;
+
+                if (operation.juceVersion != nullptr)
+                {
+                    baseline = nanosecondsPerSample ([&] { operation.juceVersion (buffers, numChannels, numSamples); },
+                                                     numChannels, numSamples, settings);
+                    printRow (operation.name, numChannels, numSamples, "JUCE", baseline, 0.0);
+                }
+
+                for (auto level : { plugindsp::SimdLevel::scalar, plugindsp::SimdLevel::sse2,
+                                    plugindsp::SimdLevel::avx2, plugindsp::SimdLevel::avx512 })
+                {
+                    if (! plugindsp::setActiveSimdLevel (level))
+                        continue;
+
+                    const auto ns = nanosecondsPerSample ([&] { operation.kernelVersion (buffers, numChannels, numSamples); },
+                                                          numChannels, numSamples, settings);
+                    printRow (operation.name, numChannels, numSamples, plugindsp::getSimdLevelName (level), ns, baseline);
+                }
+
+                plugindsp::setActiveSimdLevel (bestLevel);
+            }
+        }
+
+        std::printf ("\n");
+    }
+
+    return 0;
+}
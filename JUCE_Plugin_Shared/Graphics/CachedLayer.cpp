@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - editor graphics shared by the plugin projects
+    CachedLayer - static drawing rendered once into an Image and blitted
+
+  ==============================================================================
+*/
+
+#include "CachedLayer.h"
+
+namespace gfx
+{
+
+CachedLayer::CachedLayer (PaintFunction paintFunction)
+    : paint (std::move (paintFunction))
+{
+}
+
+void CachedLayer::draw (juce::Graphics& g, juce::Rectangle<int> area)
+{
+    if (area.isEmpty())
+        return;
+
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (! isValid || area.getWidth() != imageArea.getWidth() || area.getHeight() != imageArea.getHeight()
+          || scale != imageScale)
+    {
+        image = juce::Image (juce::Image::ARGB,
+                             juce::roundToInt ((float) area.getWidth() * scale),
+                             juce::roundToInt ((float) area.getHeight() * scale),
+                             true);
+
+        juce::Graphics imageGraphics (image);
+        imageGraphics.addTransform (juce::AffineTransform::scale (scale));
+        paint (imageGraphics, area.withZeroOrigin());
+
+        imageScale = scale;
+        isValid = true;
+        ++numRenders;
+    }
+
+    imageArea = area;
+    g.drawImageTransformed (image, juce::AffineTransform::scale (1.0f / imageScale)
+                                                         .translated ((float) area.getX(), (float) area.getY()));
+}
+
+} // namespace gfx
@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - editor graphics shared by the plugin projects
+    CachedLayer - static drawing rendered once into an Image and blitted
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+namespace gfx
+{
+
+//==============================================================================
+/**
+ * Caches the static parts of a component's drawing (backgrounds, borders,
+ * titles, grid lines) in an Image.
+ *
+ * The paint function runs once, and again only when the size or the display
+ * scale changes or invalidate() is called. Every other repaint is a single
+ * image blit, which is far cheaper than filling, stroking and laying out text
+ * again. The image is rendered at the display's physical pixel scale, so it
+ * stays sharp on high-DPI screens.
+ */
+class CachedLayer
+{
+public:
+    using PaintFunction = std::function<void (juce::Graphics&, juce::Rectangle<int> area)>;
+
+    explicit CachedLayer (PaintFunction paintFunction);
+
+    /** Draws the layer over area, re-rendering it first if needed. */
+    void draw (juce::Graphics& g, juce::Rectangle<int> area);
+
+    /** Makes the next draw() re-render, e.g. after a colour change. */
+    void invalidate() noexcept          { isValid = false; }
+
+    /** Times the layer has been rendered, for diagnostics. */
+    int getNumRenders() const noexcept  { return numRenders; }
+
+private:
+    PaintFunction paint;
+    juce::Image image;
+    juce::Rectangle<int> imageArea;
+    float imageScale = 0.0f;
+    bool isValid = false;
+    int numRenders = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CachedLayer)
+};
+
+} // namespace gfx
@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - editor graphics shared by the plugin projects
+    FrameClock - one display-rate timer shared by every editor in the process,
+    and RepaintThrottle, which coalesces a component's repaints onto it
+
+  ==============================================================================
+*/
+
+#include "FrameClock.h"
+
+namespace gfx
+{
+
+//==============================================================================
+FrameClock::~FrameClock()
+{
+    stopTimer();
+}
+
+void FrameClock::addClient (Client* client)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (clients.contains (client))
+        return;
+
+    clients.add (client);
+
+    if (numClients++ == 0)
+        startTimerHz (framesPerSecond);
+}
+
+void FrameClock::removeClient (Client* client)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (! clients.contains (client))
+        return;
+
+    clients.remove (client);
+
+    if (--numClients == 0)
+        stopTimer();
+}
+
+void FrameClock::timerCallback()
+{
+    ++numFrames;
+    const auto now = juce::Time::getMillisecondCounterHiRes() * 0.001;
+    clients.call ([now] (Client& client) { client.frameTick (now); });
+}
+
+//==============================================================================
+RepaintThrottle::RepaintThrottle (juce::Component& componentToRepaint, int maxFramesPerSecond)
+    : component (componentToRepaint),
+      frameInterval (1.0 / juce::jlimit (1, FrameClock::framesPerSecond, maxFramesPerSecond))
+{
+    clock->addClient (this);
+}
+
+RepaintThrottle::~RepaintThrottle()
+{
+    clock->removeClient (this);
+}
+
+void RepaintThrottle::markDirty (juce::Rectangle<int> area)
+{
+    dirtyArea.add (area.getIntersection (component.getLocalBounds()));
+}
+
+void RepaintThrottle::markAllDirty()
+{
+    dirtyArea.clear();
+    dirtyArea.add (component.getLocalBounds());
+}
+
+void RepaintThrottle::frameTick (double timeSeconds)
+{
+    // Half a frame of slack, so a 30 Hz client doesn't drift onto every third tick
+    if (timeSeconds - lastFrameTime < frameInterval - 0.5 / FrameClock::framesPerSecond)
+        return;
+
+    if (! component.isShowing())
+        return;
+
+    lastFrameTime = timeSeconds;
+
+    if (onFrame != nullptr)
+        onFrame();
+
+    for (const auto& area : dirtyArea)
+        component.repaint (area);
+
+    dirtyArea.clear();
+}
+
+} // namespace gfx
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - editor graphics shared by the plugin projects
+    FrameClock - one display-rate timer shared by every editor in the process,
+    and RepaintThrottle, which coalesces a component's repaints onto it
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+namespace gfx
+{
+
+//==============================================================================
+/**
+ * A single frame timer for every editor in the process.
+ *
+ * With dozens of editors open, each running its own timers for meters and
+ * readouts, the message thread wakes up for every one of them at a different
+ * moment. The FrameClock runs one timer at the display rate (like a vblank
+ * callback) and ticks every client from it, so all editors update together
+ * and the message thread gets long idle gaps in between.
+ *
+ * Hold it through juce::SharedResourcePointer<FrameClock>: the first holder
+ * creates it and the last one destroys it. The timer only runs while it has
+ * clients. Message thread only.
+ */
+class FrameClock  : private juce::Timer
+{
+public:
+    static constexpr int framesPerSecond = 60;
+
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        /** Called once per frame with the frame's time, in seconds. */
+        virtual void frameTick (double timeSeconds) = 0;
+    };
+
+    FrameClock() = default;
+    ~FrameClock() override;
+
+    void addClient (Client*);
+    void removeClient (Client*);
+
+    /** Frames ticked so far, for diagnostics. */
+    juce::int64 getNumFrames() const noexcept   { return numFrames; }
+
+private:
+    void timerCallback() override;
+
+    juce::ListenerList<Client> clients;
+    int numClients = 0;
+    juce::int64 numFrames = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FrameClock)
+};
+
+//==============================================================================
+/**
+ * Repaints a component from the shared FrameClock rather than immediately.
+ *
+ * markDirty() collects the areas that changed; on the next frame they are
+ * repainted together, so a meter updated from several places repaints once
+ * per frame, and only where it changed. onFrame runs at most
+ * maxFramesPerSecond times a second, only while the component is on screen,
+ * and is where visualisers pull new data and mark what moved.
+ */
+class RepaintThrottle  : private FrameClock::Client
+{
+public:
+    RepaintThrottle (juce::Component& componentToRepaint, int maxFramesPerSecond = FrameClock::framesPerSecond);
+    ~RepaintThrottle() override;
+
+    /** Queues an area (in the component's coordinates) for the next frame. */
+    void markDirty (juce::Rectangle<int> area);
+    void markAllDirty();
+
+    /** Called each throttled frame, before the dirty areas are repainted. */
+    std::function<void()> onFrame;
+
+private:
+    void frameTick (double timeSeconds) override;
+
+    juce::Component& component;
+    juce::SharedResourcePointer<FrameClock> clock;
+    const double frameInterval;
+    double lastFrameTime = 0.0;
+    juce::RectangleList<int> dirtyArea;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RepaintThrottle)
+};
+
+} // namespace gfx
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - editor graphics shared by the plugin projects
+    FrameTimeCounter - how long an editor takes to paint each frame
+
+  ==============================================================================
+*/
+
+#include "FrameTimeCounter.h"
+
+namespace gfx
+{
+
+void FrameTimeCounter::beginFrame() noexcept
+{
+    frameStartTicks = juce::Time::getHighResolutionTicks();
+}
+
+void FrameTimeCounter::endFrame() noexcept
+{
+    if (frameStartTicks == 0)
+        return;
+
+    const auto milliseconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks()
+                                                                            - frameStartTicks) * 1000.0;
+    frameStartTicks = 0;
+
+    recent[(size_t) (stats.numFrames % recentFrames)] = milliseconds;
+    ++stats.numFrames;
+
+    stats.lastMilliseconds = milliseconds;
+    stats.maxMilliseconds = juce::jmax (stats.maxMilliseconds, milliseconds);
+
+    if (milliseconds > budgetMilliseconds)
+        ++stats.numOverBudget;
+}
+
+void FrameTimeCounter::reset() noexcept
+{
+    frameStartTicks = 0;
+    stats = {};
+}
+
+FrameTimeCounter::Stats FrameTimeCounter::getStats() const noexcept
+{
+    auto result = stats;
+    const auto count = (int) juce::jmin (stats.numFrames, (juce::int64) recentFrames);
+
+    if (count > 0)
+    {
+        auto total = 0.0;
+
+        for (int i = 0; i < count; ++i)
+            total += recent[(size_t) i];
+
+        result.averageMilliseconds = total / count;
+    }
+
+    return result;
+}
+
+} // namespace gfx
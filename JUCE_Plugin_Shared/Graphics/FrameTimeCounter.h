@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - editor graphics shared by the plugin projects
+    FrameTimeCounter - how long an editor takes to paint each frame
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+
+namespace gfx
+{
+
+//==============================================================================
+/**
+ * Times an editor's paints, to check it stays inside its frame budget.
+ *
+ * Call beginFrame() at the top of the editor's paint() and endFrame() in its
+ * paintOverChildren(), so the time covers the editor and every child painted
+ * in the same pass. Message thread only.
+ */
+class FrameTimeCounter
+{
+public:
+    /** The per-frame target for an editor, in milliseconds. */
+    static constexpr double budgetMilliseconds = 1.0;
+
+    void beginFrame() noexcept;
+    void endFrame() noexcept;
+    void reset() noexcept;
+
+    struct Stats
+    {
+        juce::int64 numFrames = 0;
+        juce::int64 numOverBudget = 0;
+        double lastMilliseconds = 0.0;
+        double averageMilliseconds = 0.0;   // over the last recentFrames frames
+        double maxMilliseconds = 0.0;       // since the last reset()
+    };
+
+    Stats getStats() const noexcept;
+
+    static constexpr int recentFrames = 64;
+
+private:
+    juce::int64 frameStartTicks = 0;
+    std::array<double, recentFrames> recent {};
+    Stats stats;
+
+    JUCE_LEAK_DETECTOR (FrameTimeCounter)
+};
+
+} // namespace gfx
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - editor graphics shared by the plugin projects
+    LevelMeter - peak and RMS bars per channel, drawn from block summaries
+
+  ==============================================================================
+*/
+
+#include "LevelMeter.h"
+
+namespace gfx
+{
+
+LevelMeter::LevelMeter()
+{
+    setOpaque (true);
+}
+
+//==============================================================================
+void LevelMeter::addBlock (const plugindsp::BlockSummary& block) noexcept
+{
+    if (block.numChannels > 0 && block.numChannels != numChannels)
+    {
+        numChannels = block.numChannels;
+        scale.invalidate();
+        repaint();
+    }
+
+    for (int c = 0; c < block.numChannels; ++c)
+    {
+        const auto& levels = block.channels[c];
+        auto& channel = channels[(size_t) c];
+
+        channel.blockPeak = juce::jmax (channel.blockPeak, -levels.minimum, levels.maximum);
+        channel.sumOfSquares += levels.sumOfSquares;
+        channel.numSamples += block.numSamples;
+    }
+}
+
+void LevelMeter::update (double elapsedSeconds)
+{
+    for (int c = 0; c < numChannels; ++c)
+    {
+        auto& channel = channels[(size_t) c];
+
+        // Peaks jump up and fall back slowly; the held peak waits, then drops
+        const auto fallen = channel.peak - peakFallDecibelsPerSecond * (float) elapsedSeconds;
+        channel.peak = juce::jmax (minimumDecibels, fallen,
+                                   juce::Decibels::gainToDecibels (channel.blockPeak, minimumDecibels));
+
+        if (channel.numSamples > 0)
+            channel.rms = juce::Decibels::gainToDecibels ((float) std::sqrt (channel.sumOfSquares / channel.numSamples),
+                                                          minimumDecibels);
+
+        if (channel.peak >= channel.held)
+        {
+            channel.held = channel.peak;
+            channel.heldFor = 0.0;
+        }
+        else if ((channel.heldFor += elapsedSeconds) > peakHoldSeconds)
+        {
+            channel.held = channel.peak;
+        }
+
+        channel.blockPeak = 0.0f;
+        channel.sumOfSquares = 0.0;
+        channel.numSamples = 0;
+
+        // Repaint only the part of the bar between the old and new heights
+        const auto bar = getBarArea (c);
+        const auto peakTop = decibelsToY (channel.peak, bar);
+        const auto rmsTop = decibelsToY (channel.rms, bar);
+        const auto heldTop = decibelsToY (channel.held, bar);
+
+        if (peakTop == channel.peakTop && rmsTop == channel.rmsTop && heldTop == channel.heldTop)
+            continue;
+
+        const auto top = juce::jmin ({ peakTop, rmsTop, heldTop, channel.peakTop, channel.rmsTop, channel.heldTop });
+        const auto bottom = juce::jmax ({ peakTop, rmsTop, heldTop, channel.peakTop, channel.rmsTop, channel.heldTop });
+
+        channel.peakTop = peakTop;
+        channel.rmsTop = rmsTop;
+        channel.heldTop = heldTop;
+
+        repaint (bar.withTop (top - 1).withBottom (bottom + 2));
+    }
+}
+
+//==============================================================================
+juce::Rectangle<int> LevelMeter::getBarArea (int channel) const noexcept
+{
+    const auto area = getLocalBounds().reduced (2);
+    const auto width = area.getWidth() / juce::jmax (1, numChannels);
+    return { area.getX() + channel * width, area.getY(), juce::jmax (1, width - 1), area.getHeight() };
+}
+
+int LevelMeter::decibelsToY (float decibels, juce::Rectangle<int> bar) const noexcept
+{
+    const auto proportion = juce::jlimit (0.0f, 1.0f, 1.0f - decibels / minimumDecibels);
+    return bar.getBottom() - juce::roundToInt (proportion * (float) bar.getHeight());
+}
+
+void LevelMeter::paintScale (juce::Graphics& g, juce::Rectangle<int> area)
+{
+    g.fillAll (juce::Colours::black);
+
+    // A tick every 12 dB across every bar
+    g.setColour (juce::Colours::white.withAlpha (0.15f));
+
+    for (auto decibels = 0.0f; decibels > minimumDecibels; decibels -= 12.0f)
+        g.fillRect (area.getX(), decibelsToY (decibels, getBarArea (0)), area.getWidth(), 1);
+}
+
+void LevelMeter::paint (juce::Graphics& g)
+{
+    scale.draw (g, getLocalBounds());
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        const auto& channel = channels[(size_t) c];
+        const auto bar = getBarArea (c);
+
+        g.setColour (juce::Colours::limegreen.withAlpha (0.45f));
+        g.fillRect (bar.withTop (channel.peakTop));
+
+        g.setColour (juce::Colours::limegreen);
+        g.fillRect (bar.withTop (channel.rmsTop));
+
+        g.setColour (channel.held > -0.1f ? juce::Colours::red : juce::Colours::white);
+        g.fillRect (bar.withTop (channel.heldTop).withHeight (1));
+    }
+}
+
+void LevelMeter::resized()
+{
+    for (int c = 0; c < numChannels; ++c)
+    {
+        auto& channel = channels[(size_t) c];
+        const auto bar = getBarArea (c);
+        channel.peakTop = decibelsToY (channel.peak, bar);
+        channel.rmsTop = decibelsToY (channel.rms, bar);
+        channel.heldTop = decibelsToY (channel.held, bar);
+    }
+}
+
+} // namespace gfx
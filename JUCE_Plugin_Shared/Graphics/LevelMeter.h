@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - editor graphics shared by the plugin projects
+    LevelMeter - peak and RMS bars per channel, drawn from block summaries
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "CachedLayer.h"
+#include "MeterFeed.h"
+
+#include <array>
+
+namespace gfx
+{
+
+//==============================================================================
+/**
+ * A vertical peak/RMS meter with one bar per channel, from -60 to 0 dB.
+ *
+ * Feed it the summaries that arrived since the last frame with addBlock(),
+ * then call update() once per frame: the peaks fall back at a fixed rate
+ * with a short hold, the RMS is taken over the frame's blocks, and only the
+ * bars whose drawn height changed are repainted.
+ */
+class LevelMeter  : public juce::Component
+{
+public:
+    LevelMeter();
+
+    void addBlock (const plugindsp::BlockSummary& block) noexcept;
+    void update (double elapsedSeconds);
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+    static constexpr float minimumDecibels = -60.0f;
+    static constexpr float peakFallDecibelsPerSecond = 24.0f;
+    static constexpr double peakHoldSeconds = 1.5;
+
+private:
+    struct Channel
+    {
+        // Gathered from the blocks since the last update()
+        float blockPeak = 0.0f;
+        double sumOfSquares = 0.0;
+        int numSamples = 0;
+
+        // Displayed, in dB
+        float peak = minimumDecibels;
+        float rms = minimumDecibels;
+        float held = minimumDecibels;
+        double heldFor = 0.0;
+
+        // Drawn heights, in pixels, for working out what to repaint
+        int peakTop = 0, rmsTop = 0, heldTop = 0;
+    };
+
+    juce::Rectangle<int> getBarArea (int channel) const noexcept;
+    int decibelsToY (float decibels, juce::Rectangle<int> bar) const noexcept;
+    void paintScale (juce::Graphics&, juce::Rectangle<int> area);
+
+    std::array<Channel, plugindsp::BlockSummary::maxChannels> channels;
+    int numChannels = 2;
+    CachedLayer scale { [this] (juce::Graphics& g, juce::Rectangle<int> area) { paintScale (g, area); } };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeter)
+};
+
+} // namespace gfx
@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - editor graphics shared by the plugin projects
+    SignalMonitor - a level meter and scope reading a processor's MeterFeed
+
+  ==============================================================================
+*/
+
+#include "SignalMonitor.h"
+
+namespace gfx
+{
+
+SignalMonitor::SignalMonitor (plugindsp::MeterFeed& feed)
+    : reader (feed)
+{
+    addAndMakeVisible (meter);
+    addAndMakeVisible (scope);
+
+    frames.onFrame = [this] { drainFeed(); };
+}
+
+void SignalMonitor::drainFeed()
+{
+    const auto sampleRate = reader.getFeed().getSampleRate();
+    plugindsp::BlockSummary block;
+
+    while (reader.pop (block))
+    {
+        meter.addBlock (block);
+        scope.addBlock (block, sampleRate);
+    }
+
+    const auto now = juce::Time::getMillisecondCounterHiRes() * 0.001;
+    const auto elapsed = lastFrameSeconds > 0.0 ? juce::jmin (now - lastFrameSeconds, 0.25) : 0.0;
+    lastFrameSeconds = now;
+
+    meter.update (elapsed);
+    scope.update();
+}
+
+void SignalMonitor::resized()
+{
+    auto area = getLocalBounds();
+    meter.setBounds (area.removeFromLeft (juce::jmin (24, area.getWidth() / 4)));
+    area.removeFromLeft (4);
+    scope.setBounds (area);
+}
+
+} // namespace gfx
@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - editor graphics shared by the plugin projects
+    SignalMonitor - a level meter and scope reading a processor's MeterFeed
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FrameClock.h"
+#include "LevelMeter.h"
+#include "WaveformScope.h"
+
+namespace gfx
+{
+
+//==============================================================================
+/**
+ * A LevelMeter beside a WaveformScope, fed from a processor's MeterFeed.
+ *
+ * While this component exists the feed is active; once per frame (from the
+ * shared FrameClock, and only while it's on screen) it drains every waiting
+ * block summary into the meter and scope. Destroying it, e.g. by closing the
+ * editor, switches the feed off again, so the audio thread stops measuring.
+ */
+class SignalMonitor  : public juce::Component
+{
+public:
+    explicit SignalMonitor (plugindsp::MeterFeed& feed);
+
+    void resized() override;
+
+private:
+    void drainFeed();
+
+    plugindsp::MeterFeed::Reader reader;
+    LevelMeter meter;
+    WaveformScope scope;
+
+    double lastFrameSeconds = 0.0;
+    RepaintThrottle frames { *this };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SignalMonitor)
+};
+
+} // namespace gfx
@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - editor graphics shared by the plugin projects
+    WaveformScope - a scrolling min/max view of the output, drawn from block
+    summaries
+
+  ==============================================================================
+*/
+
+#include "WaveformScope.h"
+
+namespace gfx
+{
+
+WaveformScope::WaveformScope (double secondsToShow)
+    : visibleSeconds (secondsToShow)
+{
+    setOpaque (true);
+}
+
+//==============================================================================
+void WaveformScope::addBlock (const plugindsp::BlockSummary& block, double sampleRate) noexcept
+{
+    if (columns.empty() || block.numChannels <= 0)
+        return;
+
+    auto low = block.channels[0].minimum, high = block.channels[0].maximum;
+
+    for (int c = 1; c < block.numChannels; ++c)
+    {
+        low = juce::jmin (low, block.channels[c].minimum);
+        high = juce::jmax (high, block.channels[c].maximum);
+    }
+
+    const auto samplesPerColumn = visibleSeconds * sampleRate / (double) columns.size();
+    auto remaining = (double) block.numSamples;
+
+    if (samplesInCurrent == 0.0)
+        current = { low, high };
+
+    while (remaining > 0.0)
+    {
+        current.minimum = juce::jmin (current.minimum, low);
+        current.maximum = juce::jmax (current.maximum, high);
+
+        const auto used = juce::jmin (remaining, samplesPerColumn - samplesInCurrent);
+        samplesInCurrent += used;
+        remaining -= used;
+
+        if (samplesInCurrent >= samplesPerColumn)
+        {
+            columns[(size_t) nextColumn] = current;
+            nextColumn = (nextColumn + 1) % (int) columns.size();
+            current = { low, high };
+            samplesInCurrent = 0.0;
+            hasNewColumns = true;
+        }
+    }
+}
+
+void WaveformScope::update()
+{
+    // Scrolling moves every column, so the whole scope is dirty
+    if (hasNewColumns)
+        repaint();
+
+    hasNewColumns = false;
+}
+
+//==============================================================================
+void WaveformScope::paintBackground (juce::Graphics& g, juce::Rectangle<int> area)
+{
+    g.fillAll (juce::Colours::black);
+
+    g.setColour (juce::Colours::white.withAlpha (0.15f));
+    g.fillRect (area.getX(), area.getCentreY(), area.getWidth(), 1);
+}
+
+void WaveformScope::paint (juce::Graphics& g)
+{
+    background.draw (g, getLocalBounds());
+
+    const auto numColumns = (int) columns.size();
+    const auto halfHeight = (float) getHeight() * 0.5f;
+
+    g.setColour (juce::Colours::limegreen);
+
+    for (int x = 0; x < numColumns; ++x)
+    {
+        const auto& column = columns[(size_t) ((nextColumn + x) % numColumns)];
+        const auto top = halfHeight * (1.0f - juce::jlimit (-1.0f, 1.0f, column.maximum));
+        const auto bottom = halfHeight * (1.0f - juce::jlimit (-1.0f, 1.0f, column.minimum));
+
+        g.fillRect ((float) x, top, 1.0f, juce::jmax (1.0f, bottom - top));
+    }
+}
+
+void WaveformScope::resized()
+{
+    // One column per pixel; the history is cleared rather than resampled
+    columns.assign ((size_t) juce::jmax (1, getWidth()), Column {});
+    nextColumn = 0;
+    samplesInCurrent = 0.0;
+}
+
+} // namespace gfx
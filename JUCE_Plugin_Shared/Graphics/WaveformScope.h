@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - editor graphics shared by the plugin projects
+    WaveformScope - a scrolling min/max view of the output, drawn from block
+    summaries
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "CachedLayer.h"
+#include "MeterFeed.h"
+
+#include <vector>
+
+namespace gfx
+{
+
+//==============================================================================
+/**
+ * Scrolls the last few seconds of output from right to left, one pixel
+ * column at a time.
+ *
+ * Each column holds the minimum and maximum of every channel over its share
+ * of time, so the blocks are decimated to the display's width whatever the
+ * block size or sample rate. A block longer than a column fills several
+ * columns. The scope only repaints on frames where a new column completed.
+ */
+class WaveformScope  : public juce::Component
+{
+public:
+    explicit WaveformScope (double visibleSeconds = 4.0);
+
+    void addBlock (const plugindsp::BlockSummary& block, double sampleRate) noexcept;
+
+    /** Repaints if a column was completed since the last call. */
+    void update();
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+    struct Column
+    {
+        float minimum = 0.0f, maximum = 0.0f;
+    };
+
+    void paintBackground (juce::Graphics&, juce::Rectangle<int> area);
+
+    const double visibleSeconds;
+    std::vector<Column> columns;     // a ring; newest at nextColumn - 1
+    int nextColumn = 0;
+    Column current;
+    double samplesInCurrent = 0.0;
+    bool hasNewColumns = false;
+
+    CachedLayer background { [this] (juce::Graphics& g, juce::Rectangle<int> area) { paintBackground (g, area); } };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformScope)
+};
+
+} // namespace gfx
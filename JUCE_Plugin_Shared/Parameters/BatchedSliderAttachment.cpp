@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - parameter helpers shared by the plugin projects
+    BatchedSliderAttachment - connects a Slider to a parameter with proper
+    host gestures and a cap on how often the host is notified
+
+  ==============================================================================
+*/
+
+#include "BatchedSliderAttachment.h"
+
+namespace params
+{
+
+//==============================================================================
+BatchedSliderAttachment::BatchedSliderAttachment (juce::RangedAudioParameter& parameter, juce::Slider& s,
+                                                  int maxUpdatesPerSecond, juce::UndoManager* undoManager)
+    : slider (s),
+      attachment (parameter, [this] (float newValue) { setSliderValue (newValue); }, undoManager),
+      updateIntervalMilliseconds (1000 / juce::jlimit (1, 1000, maxUpdatesPerSecond))
+{
+    slider.addListener (this);
+    attachment.sendInitialUpdate();
+}
+
+BatchedSliderAttachment::~BatchedSliderAttachment()
+{
+    slider.removeListener (this);
+
+    // Don't leave the host with an open gesture if the editor closes mid-drag
+    if (isDragging)
+    {
+        sendPendingValue();
+        attachment.endGesture();
+    }
+}
+
+//==============================================================================
+void BatchedSliderAttachment::sliderValueChanged (juce::Slider*)
+{
+    if (ignoreCallbacks)
+        return;
+
+    const auto newValue = (float) slider.getValue();
+
+    if (! isDragging)
+    {
+        attachment.setValueAsCompleteGesture (newValue);
+        ++numHostUpdates;
+        return;
+    }
+
+    pendingValue = newValue;
+    hasPendingValue = true;
+
+    // Send the first change of a burst straight away, then at most once per interval
+    if (! isTimerRunning())
+    {
+        sendPendingValue();
+        startTimer (updateIntervalMilliseconds);
+    }
+}
+
+void BatchedSliderAttachment::sliderDragStarted (juce::Slider*)
+{
+    isDragging = true;
+    attachment.beginGesture();
+}
+
+void BatchedSliderAttachment::sliderDragEnded (juce::Slider*)
+{
+    stopTimer();
+    sendPendingValue();
+    attachment.endGesture();
+    isDragging = false;
+}
+
+void BatchedSliderAttachment::timerCallback()
+{
+    // Stop once the slider has been still for a whole interval
+    if (hasPendingValue)
+        sendPendingValue();
+    else
+        stopTimer();
+}
+
+//==============================================================================
+void BatchedSliderAttachment::setSliderValue (float newValue)
+{
+    const juce::ScopedValueSetter<bool> svs (ignoreCallbacks, true);
+    slider.setValue (newValue, juce::sendNotificationSync);
+}
+
+void BatchedSliderAttachment::sendPendingValue()
+{
+    if (! hasPendingValue)
+        return;
+
+    hasPendingValue = false;
+    attachment.setValueAsPartOfGesture (pendingValue);
+    ++numHostUpdates;
+}
+
+} // namespace params
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - parameter helpers shared by the plugin projects
+    BatchedSliderAttachment - connects a Slider to a parameter with proper
+    host gestures and a cap on how often the host is notified
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+namespace params
+{
+
+//==============================================================================
+/**
+ * Like AudioProcessorValueTreeState::SliderAttachment, but batches changes.
+ *
+ * Dragging the slider wraps the whole drag in one begin/end change gesture,
+ * so hosts record a single automation pass. Within the drag, the newest value
+ * is sent at most maxUpdatesPerSecond times (the first change goes at once,
+ * and the final value is always sent before the gesture ends), instead of
+ * once per mouse event. Changes that aren't drags - typing in the text box,
+ * double-click to reset, the keyboard - are sent at once as complete gestures.
+ *
+ * Host and automation changes move the slider without echoing back.
+ * The slider's range and interval are left as the editor set them.
+ */
+class BatchedSliderAttachment  : private juce::Slider::Listener,
+                                 private juce::Timer
+{
+public:
+    BatchedSliderAttachment (juce::RangedAudioParameter& parameter, juce::Slider& slider,
+                             int maxUpdatesPerSecond = 30, juce::UndoManager* undoManager = nullptr);
+    ~BatchedSliderAttachment() override;
+
+    /** Number of values sent to the host so far, for diagnostics. */
+    int getNumHostUpdates() const noexcept   { return numHostUpdates; }
+
+private:
+    //==============================================================================
+    void sliderValueChanged (juce::Slider*) override;
+    void sliderDragStarted (juce::Slider*) override;
+    void sliderDragEnded (juce::Slider*) override;
+    void timerCallback() override;
+
+    void setSliderValue (float newValue);
+    void sendPendingValue();
+
+    //==============================================================================
+    juce::Slider& slider;
+    juce::ParameterAttachment attachment;
+    const int updateIntervalMilliseconds;
+
+    float pendingValue = 0.0f;
+    bool hasPendingValue = false;
+    bool isDragging = false;
+    bool ignoreCallbacks = false;
+    int numHostUpdates = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BatchedSliderAttachment)
+};
+
+} // namespace params
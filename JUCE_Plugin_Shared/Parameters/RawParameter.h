@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - parameter helpers shared by the plugin projects
+    RawParameter - cached lock-free access to an AudioProcessorValueTreeState
+    parameter for the audio thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <atomic>
+
+namespace params
+{
+
+//==============================================================================
+/**
+ * Looks a parameter up in an AudioProcessorValueTreeState once, at
+ * construction, and keeps its raw value pointer.
+ *
+ * get() is a single relaxed atomic load of the denormalised value, with no
+ * virtual call or string lookup, so it is the way to read parameters in
+ * processBlock(). Use getParameter() on the message thread, e.g. to set a
+ * value and notify the host.
+ */
+class RawParameter
+{
+public:
+    RawParameter (juce::AudioProcessorValueTreeState& state, const juce::String& parameterID)
+        : parameter (state.getParameter (parameterID)),
+          value (state.getRawParameterValue (parameterID))
+    {
+        // The ID must match one in the parameter layout
+        jassert (parameter != nullptr && value != nullptr);
+    }
+
+    /** The current (denormalised) value. Safe to call on the audio thread. */
+    float get() const noexcept                               { return value->load (std::memory_order_relaxed); }
+
+    juce::RangedAudioParameter& getParameter() const noexcept { return *parameter; }
+
+    /** Sets a denormalised value and notifies the host. Message thread only. */
+    void setValueNotifyingHost (float newValue) const
+    {
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (newValue));
+    }
+
+private:
+    juce::RangedAudioParameter* parameter;
+    std::atomic<float>* value;
+
+    JUCE_DECLARE_NON_COPYABLE (RawParameter)
+};
+
+} // namespace params
@@ -0,0 +1,210 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - preset management shared by the plugin projects
+    PresetBrowser - search, filter, load and save a PresetLibrary's presets
+
+  ==============================================================================
+*/
+
+#include "PresetBrowser.h"
+
+namespace presets
+{
+
+namespace
+{
+    juce::String toString (std::string_view text)
+    {
+        return juce::String::fromUTF8 (text.data(), (int) text.size());
+    }
+}
+
+//==============================================================================
+PresetBrowser::PresetBrowser (PresetLibrary& l)
+    : library (l)
+{
+    searchBox.setTextToShowWhenEmpty ("Search presets", juce::Colours::grey);
+    searchBox.onTextChange = [this] { refreshMatches(); };
+    searchBox.onReturnKey = [this] { loadRow (list.getSelectedRow()); };
+    addAndMakeVisible (searchBox);
+
+    tagFilter.onChange = [this] { refreshMatches(); };
+    addAndMakeVisible (tagFilter);
+
+    list.setRowHeight (20);
+    list.setColour (juce::ListBox::backgroundColourId, juce::Colours::black.withAlpha (0.2f));
+    addAndMakeVisible (list);
+
+    saveButton.onClick = [this] { showSaveDialog(); };
+    addAndMakeVisible (saveButton);
+
+    library.addChangeListener (this);
+    changeListenerCallback (&library);
+}
+
+PresetBrowser::~PresetBrowser()
+{
+    library.removeChangeListener (this);
+}
+
+void PresetBrowser::resized()
+{
+    auto bounds = getLocalBounds();
+
+    searchBox.setBounds (bounds.removeFromTop (24));
+    bounds.removeFromTop (4);
+    tagFilter.setBounds (bounds.removeFromTop (24));
+    bounds.removeFromTop (4);
+    saveButton.setBounds (bounds.removeFromBottom (24));
+    bounds.removeFromBottom (4);
+    list.setBounds (bounds);
+}
+
+//==============================================================================
+int PresetBrowser::getNumRows()
+{
+    return (int) matches.size();
+}
+
+void PresetBrowser::paintListBoxItem (int row, juce::Graphics& g, int width, int height, bool selected)
+{
+    if (catalog == nullptr || row < 0 || row >= (int) matches.size())
+        return;
+
+    const auto index = matches[(size_t) row];
+
+    if (selected || index == library.getCurrentProgram())
+        g.fillAll (juce::Colours::white.withAlpha (selected ? 0.2f : 0.08f));
+
+    auto area = juce::Rectangle<int> (width, height).reduced (4, 0);
+    const auto tags = toString (catalog->getTags (index));
+
+    g.setFont (13.0f);
+
+    if (tags.isNotEmpty())
+    {
+        g.setColour (juce::Colours::grey);
+        g.drawText (tags, area.removeFromRight (width / 3), juce::Justification::centredRight, true);
+    }
+
+    g.setColour (juce::Colours::white);
+    g.drawText (toString (catalog->getName (index)), area, juce::Justification::centredLeft, true);
+}
+
+void PresetBrowser::listBoxItemClicked (int row, const juce::MouseEvent&)
+{
+    loadRow (row);
+}
+
+void PresetBrowser::returnKeyPressed (int row)
+{
+    loadRow (row);
+}
+
+void PresetBrowser::loadRow (int row)
+{
+    if (row >= 0 && row < (int) matches.size())
+        library.setCurrentProgram (matches[(size_t) row]);
+}
+
+//==============================================================================
+void PresetBrowser::changeListenerCallback (juce::ChangeBroadcaster*)
+{
+    // Either a new catalog or a program change; only the former needs a new search
+    auto latest = library.getCatalog();
+
+    if (latest != catalog)
+    {
+        catalog = std::move (latest);
+        refreshTags();
+        refreshMatches();
+    }
+    else
+    {
+        list.repaint();
+    }
+}
+
+void PresetBrowser::refreshTags()
+{
+    const auto selected = tagFilter.getSelectedId() > 1 ? tagFilter.getText() : juce::String();
+
+    tagFilter.clear (juce::dontSendNotification);
+    tagFilter.addItem ("All tags", 1);
+
+    if (catalog != nullptr)
+    {
+        int id = 2;
+
+        for (const auto tag : catalog->getAllTags())
+            tagFilter.addItem (toString (tag), id++);
+    }
+
+    tagFilter.setSelectedId (1, juce::dontSendNotification);
+
+    for (int i = 1; i < tagFilter.getNumItems(); ++i)
+        if (tagFilter.getItemText (i) == selected)
+            tagFilter.setSelectedItemIndex (i, juce::dontSendNotification);
+}
+
+void PresetBrowser::refreshMatches()
+{
+    matches.clear();
+
+    if (catalog != nullptr)
+    {
+        const auto query = searchBox.getText().toStdString();
+        const auto tag = tagFilter.getSelectedId() > 1 ? tagFilter.getText().toStdString() : std::string();
+        catalog->search (query, tag, matches);
+    }
+
+    list.updateContent();
+
+    // Keep the current program in view when it's among the matches
+    const auto it = std::find (matches.begin(), matches.end(), library.getCurrentProgram());
+
+    if (it != matches.end())
+    {
+        const auto row = (int) std::distance (matches.begin(), it);
+        list.selectRow (row, false, true);
+    }
+    else
+    {
+        list.deselectAllRows();
+    }
+
+    list.repaint();
+}
+
+//==============================================================================
+void PresetBrowser::showSaveDialog()
+{
+    saveDialog = std::make_unique<juce::AlertWindow> ("Save Preset", "Save the current settings as a preset.",
+                                                      juce::MessageBoxIconType::NoIcon, this);
+    saveDialog->addTextEditor ("name", {}, "Name:");
+    saveDialog->addTextEditor ("tags", {}, "Tags (comma-separated):");
+    saveDialog->addButton ("Save", 1, juce::KeyPress (juce::KeyPress::returnKey));
+    saveDialog->addButton ("Cancel", 0, juce::KeyPress (juce::KeyPress::escapeKey));
+
+    juce::Component::SafePointer<PresetBrowser> safeThis (this);
+
+    saveDialog->enterModalState (true, juce::ModalCallbackFunction::create ([safeThis] (int result)
+    {
+        if (safeThis == nullptr || safeThis->saveDialog == nullptr)
+            return;
+
+        const auto name = safeThis->saveDialog->getTextEditorContents ("name");
+        const auto tags = safeThis->saveDialog->getTextEditorContents ("tags");
+        safeThis->saveDialog.reset();
+
+        if (result != 1)
+            return;
+
+        if (const auto saved = safeThis->library.savePreset (name, tags); saved.failed())
+            juce::AlertWindow::showMessageBoxAsync (juce::MessageBoxIconType::WarningIcon,
+                                                    "Save Preset", saved.getErrorMessage());
+    }));
+}
+
+} // namespace presets
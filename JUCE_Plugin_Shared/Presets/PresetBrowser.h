@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - preset management shared by the plugin projects
+    PresetBrowser - search, filter, load and save a PresetLibrary's presets
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "PresetLibrary.h"
+
+namespace presets
+{
+
+//==============================================================================
+/**
+ * A search box, a tag filter and a list of a PresetLibrary's presets, with a
+ * button to save the current state as a new preset.
+ *
+ * The list is a view over the mapped catalog: searching walks the catalog's
+ * names and tags without copying them, and rows are drawn straight from it.
+ * Clicking a row (or pressing return) loads that preset through
+ * PresetLibrary::setCurrentProgram().
+ */
+class PresetBrowser  : public juce::Component,
+                       private juce::ChangeListener,
+                       private juce::ListBoxModel
+{
+public:
+    explicit PresetBrowser (PresetLibrary& library);
+    ~PresetBrowser() override;
+
+    void resized() override;
+
+private:
+    //==============================================================================
+    int getNumRows() override;
+    void paintListBoxItem (int row, juce::Graphics&, int width, int height, bool selected) override;
+    void listBoxItemClicked (int row, const juce::MouseEvent&) override;
+    void returnKeyPressed (int row) override;
+
+    void changeListenerCallback (juce::ChangeBroadcaster*) override;
+
+    void refreshTags();
+    void refreshMatches();
+    void loadRow (int row);
+    void showSaveDialog();
+
+    PresetLibrary& library;
+    std::shared_ptr<const plugindsp::PresetCatalog> catalog;
+    std::vector<int> matches;       // catalog indices shown, in order
+
+    juce::TextEditor searchBox;
+    juce::ComboBox tagFilter;
+    juce::ListBox list { {}, this };
+    juce::TextButton saveButton { "Save..." };
+
+    std::unique_ptr<juce::AlertWindow> saveDialog;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBrowser)
+};
+
+} // namespace presets
@@ -0,0 +1,243 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - preset management shared by the plugin projects
+    PresetLibrary - a processor's preset library behind the host program
+    API, with program changes prepared off the audio thread
+
+  ==============================================================================
+*/
+
+#include "PresetLibrary.h"
+
+namespace presets
+{
+
+namespace
+{
+    // How often the message thread looks for a program change; well under a host's UI latency
+    constexpr int programPollIntervalMs = 30;
+}
+
+//==============================================================================
+plugindsp::PresetScanner::Options PresetLibrary::makeDefaultOptions (const juce::String& pluginName,
+                                                                     std::uint32_t pluginMagic,
+                                                                     const juce::String& fileExtension)
+{
+   #if ! PLUGIN_SHARED_USER_PRESETS
+    // A console tool or test: no library, so nothing is scanned or written
+    juce::ignoreUnused (pluginName, pluginMagic, fileExtension);
+    return {};
+   #else
+    const auto presetDirectory = juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
+                                     .getChildFile (pluginName).getChildFile ("Presets");
+    const auto catalogDirectory = juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+                                      .getChildFile (pluginName);
+
+    plugindsp::PresetScanner::Options options;
+    options.presetDirectory = presetDirectory.getFullPathName().toStdString();
+    options.catalogDirectory = catalogDirectory.getFullPathName().toStdString();
+    options.extension = fileExtension.toStdString();
+    options.pluginMagic = pluginMagic;
+    return options;
+   #endif
+}
+
+PresetLibrary::PresetLibrary (juce::AudioProcessor& p, const plugindsp::PresetScanner::Options& libraryOptions)
+    : processor (p),
+      options (libraryOptions),
+      loadSlot (std::make_shared<LoadSlot>())
+{
+    loadSlot->owner = this;
+    startTimer (programPollIntervalMs);
+}
+
+PresetLibrary::~PresetLibrary()
+{
+    stopTimer();
+
+    {
+        const std::lock_guard<std::mutex> lock (scannerLock);
+
+        if (scanner != nullptr)
+            scanner->removeListener (this);
+    }
+
+    // A load still in flight finds no owner and is dropped
+    {
+        const std::lock_guard<std::mutex> lock (loadSlot->lock);
+        loadSlot->owner = nullptr;
+    }
+
+    cancelPendingUpdate();
+}
+
+//==============================================================================
+plugindsp::PresetScanner* PresetLibrary::getScanner()
+{
+    if (options.presetDirectory.empty())
+        return nullptr;
+
+    const std::lock_guard<std::mutex> lock (scannerLock);
+
+    if (scanner == nullptr)
+    {
+        scanner = plugindsp::PresetScanner::getShared (options);
+        scanner->addListener (this);
+    }
+
+    return scanner.get();
+}
+
+std::shared_ptr<const plugindsp::PresetCatalog> PresetLibrary::getCatalog()
+{
+    auto* activeScanner = getScanner();
+    return activeScanner != nullptr ? activeScanner->getCatalog() : nullptr;
+}
+
+void PresetLibrary::rescan()
+{
+    if (auto* activeScanner = getScanner())
+        activeScanner->rescan();
+}
+
+//==============================================================================
+int PresetLibrary::getNumPrograms()
+{
+    const auto catalog = getCatalog();
+    return catalog != nullptr ? juce::jmax (1, catalog->getNumPresets()) : 1;
+}
+
+void PresetLibrary::setCurrentProgram (int index) noexcept
+{
+    // Just a note for the message thread's timer: this may be the audio
+    // thread, so nothing is posted (that would lock the message queue)
+    currentProgram.store (index, std::memory_order_relaxed);
+    pendingProgram.store (index, std::memory_order_release);
+}
+
+juce::String PresetLibrary::getProgramName (int index)
+{
+    const auto catalog = getCatalog();
+
+    if (catalog == nullptr || index < 0 || index >= catalog->getNumPresets())
+        return {};
+
+    const auto name = catalog->getName (index);
+    return juce::String::fromUTF8 (name.data(), (int) name.size());
+}
+
+juce::File PresetLibrary::getPresetDirectory() const
+{
+    return juce::File (juce::String::fromUTF8 (options.presetDirectory.c_str()));
+}
+
+//==============================================================================
+juce::Result PresetLibrary::savePreset (const juce::String& name, const juce::String& tags)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    if (name.trim().isEmpty())
+        return juce::Result::fail ("A preset needs a name");
+
+    if (options.presetDirectory.empty())
+        return juce::Result::fail ("There's no preset directory to save to");
+
+    juce::MemoryBlock state;
+    processor.getStateInformation (state);
+
+    // Normalised values by ID hash, so a browser can describe the preset without the plugin
+    std::vector<plugindsp::ParameterStateEntry> summary;
+
+    for (auto* parameter : processor.getParameters())
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter))
+            summary.push_back ({ plugindsp::hashParameterID (withID->paramID.toRawUTF8()), withID->getValue() });
+
+    std::vector<std::uint8_t> bytes;
+    plugindsp::writePresetFile (bytes, options.pluginMagic, name.trim().toStdString(), tags.trim().toStdString(),
+                                summary.data(), summary.size(), state.getData(), state.getSize());
+
+    const auto directory = getPresetDirectory();
+    const auto file = directory.getChildFile (juce::File::createLegalFileName (name.trim()))
+                          .withFileExtension (juce::String (options.extension));
+
+    if (const auto created = directory.createDirectory(); created.failed())
+        return created;
+
+    if (! file.replaceWithData (bytes.data(), bytes.size()))
+        return juce::Result::fail ("Couldn't write " + file.getFullPathName());
+
+    rescan();
+    return juce::Result::ok();
+}
+
+//==============================================================================
+void PresetLibrary::presetCatalogChanged()
+{
+    // The scanner's thread: pass it on to the message thread
+    catalogChanged.store (true, std::memory_order_release);
+    triggerAsyncUpdate();
+}
+
+void PresetLibrary::timerCallback()
+{
+    // A program change: read the preset on the scanner's thread
+    const auto index = pendingProgram.exchange (-1, std::memory_order_acquire);
+
+    if (index < 0)
+        return;
+
+    auto* activeScanner = getScanner();
+
+    if (activeScanner == nullptr)
+        return;
+
+    std::weak_ptr<LoadSlot> slot (loadSlot);
+
+    activeScanner->requestLoad (index, [slot] (plugindsp::PresetScanner::LoadedPreset&& preset)
+    {
+        if (const auto target = slot.lock())
+        {
+            const std::lock_guard<std::mutex> lock (target->lock);
+
+            if (target->owner != nullptr)
+            {
+                target->preset = std::move (preset);
+                target->hasPreset = true;
+                target->owner->triggerAsyncUpdate();
+            }
+        }
+    });
+}
+
+void PresetLibrary::handleAsyncUpdate()
+{
+    // A preset has been read: swap the state in, here on the message thread
+    plugindsp::PresetScanner::LoadedPreset loaded;
+
+    {
+        const std::lock_guard<std::mutex> lock (loadSlot->lock);
+
+        if (loadSlot->hasPreset)
+        {
+            loaded = std::move (loadSlot->preset);
+            loadSlot->hasPreset = false;
+        }
+    }
+
+    // Only the newest request counts: a later one may already be on its way
+    if (loaded.loaded && loaded.index == currentProgram.load (std::memory_order_relaxed))
+    {
+        processor.setStateInformation (loaded.state.data(), (int) loaded.state.size());
+        processor.updateHostDisplay (juce::AudioProcessorListener::ChangeDetails().withProgramChanged (true));
+        sendChangeMessage();
+    }
+
+    if (catalogChanged.exchange (false, std::memory_order_acq_rel))
+    {
+        processor.updateHostDisplay (juce::AudioProcessorListener::ChangeDetails().withProgramChanged (true));
+        sendChangeMessage();
+    }
+}
+
+} // namespace presets
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - preset management shared by the plugin projects
+    PresetLibrary - a processor's preset library behind the host program
+    API, with program changes prepared off the audio thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "PresetScanner.h"
+
+#include <atomic>
+#include <mutex>
+
+/** Set to 0 in console tools and tests, so makeDefaultOptions() leaves the user's library alone. */
+#ifndef PLUGIN_SHARED_USER_PRESETS
+ #define PLUGIN_SHARED_USER_PRESETS 1
+#endif
+
+namespace presets
+{
+
+//==============================================================================
+/**
+ * Connects a processor to a shared PresetScanner and implements the host
+ * program API over its catalog: program N is preset N of the catalog, in
+ * name order. Forward getNumPrograms(), getCurrentProgram(),
+ * setCurrentProgram() and getProgramName() here.
+ *
+ * setCurrentProgram() may be called on any thread, including the audio
+ * thread: it stores the index in two atomics and returns, without posting
+ * anything. A timer on the message thread picks the index up, asks the
+ * scanner's thread to read the preset file, and when the state is ready it
+ * is handed to the processor's setStateInformation() on the message thread.
+ * The audio thread never waits for the disk, takes a lock or parses
+ * anything; it only sees the parameters change, which the processor smooths
+ * as it would any automation.
+ *
+ * The scanner (and its thread, which may write a catalog file) is only
+ * started on first use: a program query, opening a browser, a save or a
+ * program change. A processor that's only created and played, as in a
+ * render or a benchmark, never touches the disk. Options with no preset
+ * directory give an empty library that never starts one.
+ *
+ * When the scanner publishes a new catalog, the host is told the program
+ * list changed and change listeners (e.g. a PresetBrowser) are notified.
+ */
+class PresetLibrary  : public juce::ChangeBroadcaster,
+                       private plugindsp::PresetScanner::Listener,
+                       private juce::AsyncUpdater,
+                       private juce::Timer
+{
+public:
+    /**
+     * Presets live in the user's documents folder under pluginName/Presets;
+     * catalogs in the application data folder under pluginName. With
+     * PLUGIN_SHARED_USER_PRESETS=0 there is no preset directory instead.
+     */
+    static plugindsp::PresetScanner::Options makeDefaultOptions (const juce::String& pluginName,
+                                                                 std::uint32_t pluginMagic,
+                                                                 const juce::String& fileExtension);
+
+    PresetLibrary (juce::AudioProcessor& processor, const plugindsp::PresetScanner::Options& options);
+    ~PresetLibrary() override;
+
+    //==============================================================================
+    /** At least 1: some hosts don't cope with 0 programs. Starts the scanner. */
+    int getNumPrograms();
+    int getCurrentProgram() const noexcept              { return juce::jmax (0, currentProgram.load (std::memory_order_relaxed)); }
+
+    /** Any thread, including the audio thread. The switch happens shortly after, on the message thread. */
+    void setCurrentProgram (int index) noexcept;
+
+    juce::String getProgramName (int index);
+
+    //==============================================================================
+    /** The catalog for browsing; keep the pointer while using views into it. Starts the scanner. */
+    std::shared_ptr<const plugindsp::PresetCatalog> getCatalog();
+
+    /**
+     * Saves the processor's current state as a preset in the library
+     * directory, with a summary of its parameters, then rescans.
+     */
+    juce::Result savePreset (const juce::String& name, const juce::String& tags);
+
+    void rescan();
+
+    /** Starts the scanner if it hasn't been; nullptr if the options have no preset directory. */
+    plugindsp::PresetScanner* getScanner();
+
+    const plugindsp::PresetScanner::Options& getOptions() const noexcept    { return options; }
+    juce::File getPresetDirectory() const;
+
+private:
+    //==============================================================================
+    /** Where the scanner's thread leaves a loaded preset; outlives the library if a load is in flight. */
+    struct LoadSlot
+    {
+        std::mutex lock;
+        PresetLibrary* owner = nullptr;
+        plugindsp::PresetScanner::LoadedPreset preset;
+        bool hasPreset = false;
+    };
+
+    void presetCatalogChanged() override;
+    void handleAsyncUpdate() override;
+    void timerCallback() override;
+
+    juce::AudioProcessor& processor;
+    const plugindsp::PresetScanner::Options options;
+
+    std::mutex scannerLock;                             // guards starting the scanner
+    std::shared_ptr<plugindsp::PresetScanner> scanner;
+    std::shared_ptr<LoadSlot> loadSlot;
+
+    std::atomic<int> currentProgram { -1 };
+    std::atomic<int> pendingProgram { -1 };
+    std::atomic<bool> catalogChanged { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetLibrary)
+};
+
+} // namespace presets
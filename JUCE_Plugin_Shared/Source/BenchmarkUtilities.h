@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - DSP code shared by the plugin projects
+    BenchmarkUtilities - timing and statistics helpers for the benchmark apps
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace plugindsp
+{
+namespace bench
+{
+
+//==============================================================================
+using Clock = std::chrono::steady_clock;
+
+inline double nanosecondsBetween (Clock::time_point start, Clock::time_point end) noexcept
+{
+    return (double) std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count();
+}
+
+/** Stops the optimiser from discarding a result that is otherwise unused. */
+template <typename Type>
+inline void doNotOptimise (const Type& value) noexcept
+{
+   #if defined (_MSC_VER)
+    const volatile auto* sink = &value;
+    (void) sink;
+   #else
+    asm volatile ("" : : "r,m" (value) : "memory");
+   #endif
+}
+
+//==============================================================================
+/** Summary statistics for a set of timings, all in nanoseconds. */
+struct Summary
+{
+    int count = 0;
+    double mean = 0.0;
+    double min = 0.0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+/** Nearest-rank percentile of an already sorted list. */
+inline double percentileOfSorted (const std::vector<double>& sorted, double percentile) noexcept
+{
+    if (sorted.empty())
+        return 0.0;
+
+    const auto rank = (size_t) std::ceil (percentile / 100.0 * (double) sorted.size());
+    return sorted[std::min (sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+inline Summary summarise (std::vector<double> timings)
+{
+    Summary summary;
+
+    if (timings.empty())
+        return summary;
+
+    std::sort (timings.begin(), timings.end());
+
+    double total = 0.0;
+
+    for (auto t : timings)
+        total += t;
+
+    summary.count = (int) timings.size();
+    summary.mean  = total / (double) timings.size();
+    summary.min   = timings.front();
+    summary.p50   = percentileOfSorted (timings, 50.0);
+    summary.p99   = percentileOfSorted (timings, 99.0);
+    summary.max   = timings.back();
+    return summary;
+}
+
+//==============================================================================
+/**
+ * Calls fn() warmupRuns times untimed, then measuredRuns times, returning the
+ * duration of each measured call in nanoseconds.
+ */
+template <typename Function>
+std::vector<double> timeEachCall (Function&& fn, int warmupRuns, int measuredRuns)
+{
+    for (int i = 0; i < warmupRuns; ++i)
+        fn();
+
+    std::vector<double> timings;
+    timings.reserve ((size_t) std::max (0, measuredRuns));
+
+    for (int i = 0; i < measuredRuns; ++i)
+    {
+        const auto start = Clock::now();
+        fn();
+        timings.push_back (nanosecondsBetween (start, Clock::now()));
+    }
+
+    return timings;
+}
+
+/**
+ * For very short operations: times batches of callsPerBatch calls and returns
+ * the average duration of one call, per batch, in nanoseconds.
+ */
+template <typename Function>
+std::vector<double> timeBatches (Function&& fn, int callsPerBatch, int warmupBatches, int measuredBatches)
+{
+    auto timings = timeEachCall ([&]
+                                 {
+                                     for (int i = 0; i < callsPerBatch; ++i)
+                                         fn();
+                                 },
+                                 warmupBatches, measuredBatches);
+
+    for (auto& t : timings)
+        t /= (double) std::max (1, callsPerBatch);
+
+    return timings;
+}
+
+} // namespace bench
+} // namespace plugindsp
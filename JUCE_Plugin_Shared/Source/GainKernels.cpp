@@ -0,0 +1,341 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - DSP code shared by the plugin projects
+    GainKernels - CPU detection, dispatch and multichannel wrappers
+
+  ==============================================================================
+*/
+
+#include "GainKernels.h"
+#include "GainKernelsImpl.h"
+
+#include <atomic>
+
+#if PLUGINDSP_X86_KERNELS
+ #if defined (_MSC_VER)
+  #include <intrin.h>
+ #else
+  #include <cpuid.h>
+ #endif
+#endif
+
+namespace plugindsp
+{
+
+namespace
+{
+    //==============================================================================
+    struct CpuFeatures
+    {
+        bool sse2 = false;
+        bool avx2 = false;     // AVX2 + FMA, with OS support for YMM state
+        bool avx512 = false;   // AVX-512F, with OS support for ZMM state
+    };
+
+   #if PLUGINDSP_X86_KERNELS
+    void readCpuid (unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) noexcept
+    {
+       #if defined (_MSC_VER)
+        int r[4];
+        __cpuidex (r, (int) leaf, (int) subleaf);
+        for (int i = 0; i < 4; ++i)
+            regs[i] = (unsigned int) r[i];
+       #else
+        __cpuid_count (leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+       #endif
+    }
+
+    unsigned long long readXcr0() noexcept
+    {
+       #if defined (_MSC_VER)
+        return _xgetbv (0);
+       #else
+        unsigned int eax = 0, edx = 0;
+        __asm__ volatile ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+        return ((unsigned long long) edx << 32) | eax;
+       #endif
+    }
+
+    CpuFeatures detectCpuFeatures() noexcept
+    {
+        CpuFeatures features;
+        unsigned int regs[4] = {};
+
+        readCpuid (0, 0, regs);
+        const auto maxLeaf = regs[0];
+
+        if (maxLeaf < 1)
+            return features;
+
+        readCpuid (1, 0, regs);
+        const auto ecx1 = regs[2];
+        const auto edx1 = regs[3];
+
+        features.sse2 = (edx1 & (1u << 26)) != 0;
+
+        const auto hasOsxsave = (ecx1 & (1u << 27)) != 0;
+        const auto hasAvx     = (ecx1 & (1u << 28)) != 0;
+        const auto hasFma     = (ecx1 & (1u << 12)) != 0;
+
+        if (! (hasOsxsave && hasAvx) || maxLeaf < 7)
+            return features;
+
+        // The CPU advertising AVX isn't enough: the OS must also save the
+        // wider registers on a context switch.
+        const auto xcr0 = readXcr0();
+        const auto osSavesYmm = (xcr0 & 0x06) == 0x06;
+        const auto osSavesZmm = (xcr0 & 0xe6) == 0xe6;
+
+        readCpuid (7, 0, regs);
+        const auto ebx7 = regs[1];
+
+        features.avx2   = osSavesYmm && hasFma && (ebx7 & (1u << 5)) != 0;
+        features.avx512 = features.avx2 && osSavesZmm && (ebx7 & (1u << 16)) != 0;
+        return features;
+    }
+   #else
+    CpuFeatures detectCpuFeatures() noexcept
+    {
+        return {};
+    }
+   #endif
+
+    //==============================================================================
+    constexpr int numSimdLevels = 4;
+
+    struct KernelRegistry
+    {
+        KernelRegistry() noexcept
+        {
+            tables[(int) SimdLevel::scalar] = detail::makeScalarKernels();
+            available[(int) SimdLevel::scalar] = true;
+
+           #if PLUGINDSP_X86_KERNELS
+            const auto features = detectCpuFeatures();
+
+            if (features.sse2)
+            {
+                tables[(int) SimdLevel::sse2] = detail::makeSse2Kernels();
+                available[(int) SimdLevel::sse2] = true;
+            }
+
+            if (features.avx2)
+            {
+                tables[(int) SimdLevel::avx2] = detail::makeAvx2Kernels();
+                available[(int) SimdLevel::avx2] = true;
+            }
+
+            if (features.avx512)
+            {
+                tables[(int) SimdLevel::avx512] = detail::makeAvx512Kernels();
+                available[(int) SimdLevel::avx512] = true;
+            }
+           #endif
+
+            for (int level = numSimdLevels; --level >= 0;)
+            {
+                if (available[level])
+                {
+                    best = (SimdLevel) level;
+                    break;
+                }
+            }
+
+            active.store ((int) best);
+        }
+
+        GainKernelTable tables[numSimdLevels] {};
+        bool available[numSimdLevels] {};
+        SimdLevel best = SimdLevel::scalar;
+        std::atomic<int> active { 0 };
+    };
+
+    KernelRegistry& getRegistry() noexcept
+    {
+        static KernelRegistry registry;
+        return registry;
+    }
+}
+
+//==============================================================================
+SimdLevel getActiveSimdLevel() noexcept
+{
+    return (SimdLevel) getRegistry().active.load (std::memory_order_relaxed);
+}
+
+SimdLevel getBestAvailableSimdLevel() noexcept
+{
+    return getRegistry().best;
+}
+
+bool isSimdLevelAvailable (SimdLevel level) noexcept
+{
+    const auto index = (int) level;
+    return index >= 0 && index < numSimdLevels && getRegistry().available[index];
+}
+
+bool setActiveSimdLevel (SimdLevel level) noexcept
+{
+    if (! isSimdLevelAvailable (level))
+        return false;
+
+    getRegistry().active.store ((int) level, std::memory_order_relaxed);
+    return true;
+}
+
+const char* getSimdLevelName (SimdLevel level) noexcept
+{
+    switch (level)
+    {
+        case SimdLevel::scalar:  return "Scalar";
+        case SimdLevel::sse2:    return "SSE2";
+        case SimdLevel::avx2:    return "AVX2";
+        case SimdLevel::avx512:  return "AVX-512";
+    }
+
+    return "Unknown";
+}
+
+const GainKernelTable& getGainKernels() noexcept
+{
+    auto& registry = getRegistry();
+    return registry.tables[registry.active.load (std::memory_order_relaxed)];
+}
+
+//==============================================================================
+void applyGain (float* const* channels, int numChannels, int numSamples, float gain) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    const auto& kernels = getGainKernels();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        kernels.multiply (channels[channel], numSamples, gain);
+}
+
+void copyWithGain (float* const* dest, const float* const* source,
+                   int numChannels, int numSamples, float gain) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    const auto& kernels = getGainKernels();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        kernels.multiplyCopy (dest[channel], source[channel], numSamples, gain);
+}
+
+void addWithGain (float* const* dest, const float* const* source,
+                  int numChannels, int numSamples, float gain) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    const auto& kernels = getGainKernels();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        kernels.multiplyAdd (dest[channel], source[channel], numSamples, gain);
+}
+
+void applyGainRamp (float* const* channels, int numChannels, int numSamples,
+                    float firstGain, float gainStep) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    const auto& kernels = getGainKernels();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        kernels.multiplyRamp (channels[channel], numSamples, firstGain, gainStep);
+}
+
+void copyWithGainRamp (float* const* dest, const float* const* source,
+                       int numChannels, int numSamples,
+                       float firstGain, float gainStep) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    const auto& kernels = getGainKernels();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        kernels.multiplyRampCopy (dest[channel], source[channel], numSamples, firstGain, gainStep);
+}
+
+void applyGainCurve (float* const* channels, int numChannels, int numSamples,
+                     const float* gains) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    const auto& kernels = getGainKernels();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        kernels.multiplyCurve (channels[channel], gains, numSamples);
+}
+
+void applyChannelGains (float* const* channels, int numChannels, int numSamples,
+                        const float* channelGains) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    const auto& kernels = getGainKernels();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        if (channelGains[channel] != 1.0f)
+            kernels.multiply (channels[channel], numSamples, channelGains[channel]);
+}
+
+void applyChannelGainRamps (float* const* channels, int numChannels, int numSamples,
+                            const float* firstGains, const float* gainSteps) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    const auto& kernels = getGainKernels();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        if (gainSteps[channel] != 0.0f)
+            kernels.multiplyRamp (channels[channel], numSamples, firstGains[channel], gainSteps[channel]);
+        else if (firstGains[channel] != 1.0f)
+            kernels.multiply (channels[channel], numSamples, firstGains[channel]);
+    }
+}
+
+void generateTremoloGains (float* dest, int numSamples, float firstPhase, float phaseStep,
+                           float firstDepth, float depthStep) noexcept
+{
+    if (numSamples > 0)
+        getGainKernels().tremoloGains (dest, numSamples, firstPhase, phaseStep, firstDepth, depthStep);
+}
+
+void measureLevels (const float* const* channels, int numChannels, int numSamples,
+                    LevelSummary* levels) noexcept
+{
+    const auto& kernels = getGainKernels();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        float results[3];
+        kernels.measure (channels[channel], numSamples, results);
+        levels[channel] = { results[0], results[1], results[2] };
+    }
+}
+
+void applyGainInterleaved (float* data, int numChannels, int numFrames,
+                           const float* channelGains) noexcept
+{
+    getGainKernels().multiplyInterleaved (data, data, numChannels, numFrames, channelGains);
+}
+
+void copyWithGainInterleaved (float* dest, const float* source, int numChannels, int numFrames,
+                              const float* channelGains) noexcept
+{
+    getGainKernels().multiplyInterleaved (dest, source, numChannels, numFrames, channelGains);
+}
+
+} // namespace plugindsp
@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - DSP code shared by the plugin projects
+    GainKernels - vectorised gain/mix kernels with runtime CPU dispatch
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace plugindsp
+{
+
+//==============================================================================
+/**
+ * Instruction sets the gain kernels can be compiled for.
+ *
+ * The best level supported by both the build and the running CPU is chosen
+ * the first time a kernel is called. On non-x86 builds only the scalar level
+ * exists, and the compiler is left to auto-vectorise it.
+ */
+enum class SimdLevel
+{
+    scalar = 0,
+    sse2,
+    avx2,
+    avx512
+};
+
+/** Returns the level currently used by all kernels. */
+SimdLevel getActiveSimdLevel() noexcept;
+
+/** Returns the best level this CPU (and this build) can run. */
+SimdLevel getBestAvailableSimdLevel() noexcept;
+
+/** Returns true if kernels for the given level are compiled in and the CPU supports them. */
+bool isSimdLevelAvailable (SimdLevel level) noexcept;
+
+/**
+ * Forces a particular level, e.g. to compare them in a benchmark.
+ * Returns false (and changes nothing) if the level isn't available.
+ * Not intended to be called while audio is running.
+ */
+bool setActiveSimdLevel (SimdLevel level) noexcept;
+
+/** Returns a short readable name such as "AVX2". */
+const char* getSimdLevelName (SimdLevel level) noexcept;
+
+//==============================================================================
+/**
+ * Planar kernels operate on an array of channel pointers, processing the same
+ * range of samples in every channel. Ramps use the gain
+ * (firstGain + gainStep * i) for sample i, so a ramp can be continued across
+ * blocks by passing firstGain + gainStep * numSamples for the next block.
+ */
+
+/** channels[c][i] *= gain */
+void applyGain (float* const* channels, int numChannels, int numSamples, float gain) noexcept;
+
+/** dest[c][i] = source[c][i] * gain. dest and source may be the same buffers. */
+void copyWithGain (float* const* dest, const float* const* source,
+                   int numChannels, int numSamples, float gain) noexcept;
+
+/** dest[c][i] += source[c][i] * gain */
+void addWithGain (float* const* dest, const float* const* source,
+                  int numChannels, int numSamples, float gain) noexcept;
+
+/** channels[c][i] *= firstGain + gainStep * i */
+void applyGainRamp (float* const* channels, int numChannels, int numSamples,
+                    float firstGain, float gainStep) noexcept;
+
+/** dest[c][i] = source[c][i] * (firstGain + gainStep * i) */
+void copyWithGainRamp (float* const* dest, const float* const* source,
+                       int numChannels, int numSamples,
+                       float firstGain, float gainStep) noexcept;
+
+/** channels[c][i] *= gains[i], i.e. one gain curve shared by every channel */
+void applyGainCurve (float* const* channels, int numChannels, int numSamples,
+                     const float* gains) noexcept;
+
+/**
+ * channels[c][i] *= channelGains[c], i.e. a different gain per channel (trims)
+ * in one call over the whole channel set. Channels at unity gain are skipped.
+ */
+void applyChannelGains (float* const* channels, int numChannels, int numSamples,
+                        const float* channelGains) noexcept;
+
+/**
+ * channels[c][i] *= firstGains[c] + gainSteps[c] * i, i.e. every channel
+ * ramping at its own rate. Channels that aren't ramping (a step of 0) get a
+ * flat multiply, or are skipped at unity gain.
+ */
+void applyChannelGainRamps (float* const* channels, int numChannels, int numSamples,
+                            const float* firstGains, const float* gainSteps) noexcept;
+
+//==============================================================================
+/**
+ * Fills a tremolo gain curve for a sine LFO:
+ *
+ *     dest[i] = 1 - depth * (0.5 - 0.5 * cos (2 pi phase))
+ *
+ * with phase = firstPhase + phaseStep * i and depth = firstDepth + depthStep * i,
+ * so the gain is 1 at the start of each cycle and 1 - depth halfway through.
+ * Like the ramps, phase and depth are computed from the index rather than
+ * accumulated. The sine is a polynomial accurate to about 1e-6; phases can
+ * be any value below 2^20 cycles in size, but stay most precise near 0.
+ */
+void generateTremoloGains (float* dest, int numSamples, float firstPhase, float phaseStep,
+                           float firstDepth, float depthStep) noexcept;
+
+//==============================================================================
+/** One channel's levels over a block, for meters and scopes. */
+struct LevelSummary
+{
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+    float sumOfSquares = 0.0f;
+};
+
+/**
+ * levels[c] = the minimum, maximum and sum of squares of channels[c], in one
+ * vectorised pass per channel. Peak is max (-minimum, maximum) and RMS is
+ * sqrt (sumOfSquares / numSamples). An empty block gives all zeros.
+ */
+void measureLevels (const float* const* channels, int numChannels, int numSamples,
+                    LevelSummary* levels) noexcept;
+
+//==============================================================================
+/**
+ * Double-precision versions of the planar kernels, for processors running
+ * with AudioProcessor::doublePrecision. They're overloads, so DSP code
+ * templated on the sample type picks the right one at compile time.
+ *
+ * These are plain loops built at the baseline instruction set and left to
+ * the compiler to vectorise, rather than dispatched per CPU like the float
+ * kernels: double-precision hosts are rare and the loops are memory bound.
+ * Gain curves stay float, as they only carry control signals.
+ */
+void applyGain (double* const* channels, int numChannels, int numSamples, double gain) noexcept;
+void applyGainRamp (double* const* channels, int numChannels, int numSamples,
+                    double firstGain, double gainStep) noexcept;
+void applyGainCurve (double* const* channels, int numChannels, int numSamples,
+                     const float* gains) noexcept;
+void applyChannelGains (double* const* channels, int numChannels, int numSamples,
+                        const float* channelGains) noexcept;
+void applyChannelGainRamps (double* const* channels, int numChannels, int numSamples,
+                            const float* firstGains, const float* gainSteps) noexcept;
+void measureLevels (const double* const* channels, int numChannels, int numSamples,
+                    LevelSummary* levels) noexcept;
+
+//==============================================================================
+/**
+ * Interleaved kernels operate on frames of numChannels samples and take one
+ * gain per channel, which makes them usable as a per-channel trim or a simple
+ * matrix-free mix stage. Up to maxInterleavedChannels channels take the
+ * vectorised path; wider frames fall back to scalar code.
+ */
+constexpr int maxInterleavedChannels = 64;
+
+/** data[f * numChannels + c] *= channelGains[c] */
+void applyGainInterleaved (float* data, int numChannels, int numFrames,
+                           const float* channelGains) noexcept;
+
+/** dest[f * numChannels + c] = source[f * numChannels + c] * channelGains[c] */
+void copyWithGainInterleaved (float* dest, const float* source, int numChannels, int numFrames,
+                              const float* channelGains) noexcept;
+
+//==============================================================================
+/**
+ * Table of single-channel kernels for one instruction set. The multichannel
+ * functions above loop over channels and call through the active table.
+ */
+struct GainKernelTable
+{
+    void (*multiply) (float* data, int numSamples, float gain) noexcept;
+    void (*multiplyCopy) (float* dest, const float* source, int numSamples, float gain) noexcept;
+    void (*multiplyAdd) (float* dest, const float* source, int numSamples, float gain) noexcept;
+    void (*multiplyRamp) (float* data, int numSamples, float firstGain, float gainStep) noexcept;
+    void (*multiplyRampCopy) (float* dest, const float* source, int numSamples,
+                              float firstGain, float gainStep) noexcept;
+    void (*multiplyCurve) (float* data, const float* gains, int numSamples) noexcept;
+    void (*tremoloGains) (float* dest, int numSamples, float firstPhase, float phaseStep,
+                          float firstDepth, float depthStep) noexcept;
+    void (*multiplyInterleaved) (float* dest, const float* source, int numChannels, int numFrames,
+                                 const float* channelGains) noexcept;
+    void (*measure) (const float* data, int numSamples, float* minMaxSumSquares) noexcept;
+};
+
+/** Returns the kernel table for the active level. */
+const GainKernelTable& getGainKernels() noexcept;
+
+} // namespace plugindsp
@@ -0,0 +1,343 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - DSP code shared by the plugin projects
+    GainKernelsImpl - kernel bodies, instantiated once per instruction set
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "GainKernels.h"
+
+// Private to the GainKernels_*.cpp files. Each of those is compiled with its
+// own instruction-set flags and instantiates KernelSet with a vector-ops type
+// that lives in an anonymous namespace, so no code compiled for one level can
+// be shared with (and leak into) another at link time. For the same reason
+// nothing from the standard library is used here.
+
+namespace plugindsp
+{
+namespace detail
+{
+
+//==============================================================================
+alignas (64) static constexpr float laneIndices[16] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+                                                         8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f };
+
+/**
+ * Ops must provide:
+ *   using Vec;  static constexpr int width;
+ *   Vec load (const float*), void store (float*, Vec), Vec broadcast (float),
+ *   Vec mul (Vec, Vec), Vec add (Vec, Vec), Vec sub (Vec, Vec),
+ *   Vec mulAdd (Vec a, Vec b, Vec c)   // a * b + c
+ *   Vec round (Vec)                    // to the nearest integer, ties to even
+ *   Vec min (Vec, Vec), Vec max (Vec, Vec)
+ * Loads and stores are unaligned.
+ */
+template <typename Ops>
+struct KernelSet
+{
+    using Vec = typename Ops::Vec;
+    static constexpr int width = Ops::width;
+    static constexpr int unrolledWidth = width * 4;
+
+    //==============================================================================
+    static void multiply (float* data, int numSamples, float gain) noexcept
+    {
+        const auto g = Ops::broadcast (gain);
+        int i = 0;
+
+        for (; i + unrolledWidth <= numSamples; i += unrolledWidth)
+        {
+            const auto a = Ops::mul (Ops::load (data + i),             g);
+            const auto b = Ops::mul (Ops::load (data + i + width),     g);
+            const auto c = Ops::mul (Ops::load (data + i + width * 2), g);
+            const auto d = Ops::mul (Ops::load (data + i + width * 3), g);
+            Ops::store (data + i,             a);
+            Ops::store (data + i + width,     b);
+            Ops::store (data + i + width * 2, c);
+            Ops::store (data + i + width * 3, d);
+        }
+
+        for (; i + width <= numSamples; i += width)
+            Ops::store (data + i, Ops::mul (Ops::load (data + i), g));
+
+        for (; i < numSamples; ++i)
+            data[i] *= gain;
+    }
+
+    static void multiplyCopy (float* dest, const float* source, int numSamples, float gain) noexcept
+    {
+        const auto g = Ops::broadcast (gain);
+        int i = 0;
+
+        for (; i + unrolledWidth <= numSamples; i += unrolledWidth)
+        {
+            const auto a = Ops::mul (Ops::load (source + i),             g);
+            const auto b = Ops::mul (Ops::load (source + i + width),     g);
+            const auto c = Ops::mul (Ops::load (source + i + width * 2), g);
+            const auto d = Ops::mul (Ops::load (source + i + width * 3), g);
+            Ops::store (dest + i,             a);
+            Ops::store (dest + i + width,     b);
+            Ops::store (dest + i + width * 2, c);
+            Ops::store (dest + i + width * 3, d);
+        }
+
+        for (; i + width <= numSamples; i += width)
+            Ops::store (dest + i, Ops::mul (Ops::load (source + i), g));
+
+        for (; i < numSamples; ++i)
+            dest[i] = source[i] * gain;
+    }
+
+    static void multiplyAdd (float* dest, const float* source, int numSamples, float gain) noexcept
+    {
+        const auto g = Ops::broadcast (gain);
+        int i = 0;
+
+        for (; i + unrolledWidth <= numSamples; i += unrolledWidth)
+        {
+            const auto a = Ops::mulAdd (Ops::load (source + i),             g, Ops::load (dest + i));
+            const auto b = Ops::mulAdd (Ops::load (source + i + width),     g, Ops::load (dest + i + width));
+            const auto c = Ops::mulAdd (Ops::load (source + i + width * 2), g, Ops::load (dest + i + width * 2));
+            const auto d = Ops::mulAdd (Ops::load (source + i + width * 3), g, Ops::load (dest + i + width * 3));
+            Ops::store (dest + i,             a);
+            Ops::store (dest + i + width,     b);
+            Ops::store (dest + i + width * 2, c);
+            Ops::store (dest + i + width * 3, d);
+        }
+
+        for (; i + width <= numSamples; i += width)
+            Ops::store (dest + i, Ops::mulAdd (Ops::load (source + i), g, Ops::load (dest + i)));
+
+        for (; i < numSamples; ++i)
+            dest[i] += source[i] * gain;
+    }
+
+    //==============================================================================
+    // Each vector of gains is computed from its index rather than by repeated
+    // addition, so long ramps end exactly where the scalar formula says.
+    static void multiplyRampCopy (float* dest, const float* source, int numSamples,
+                                  float firstGain, float gainStep) noexcept
+    {
+        const auto first = Ops::broadcast (firstGain);
+        const auto step  = Ops::broadcast (gainStep);
+        const auto lanes = Ops::load (laneIndices);
+        int i = 0;
+
+        for (; i + width <= numSamples; i += width)
+        {
+            const auto index = Ops::add (Ops::broadcast ((float) i), lanes);
+            const auto gains = Ops::mulAdd (index, step, first);
+            Ops::store (dest + i, Ops::mul (Ops::load (source + i), gains));
+        }
+
+        for (; i < numSamples; ++i)
+            dest[i] = source[i] * (firstGain + gainStep * (float) i);
+    }
+
+    static void multiplyRamp (float* data, int numSamples, float firstGain, float gainStep) noexcept
+    {
+        multiplyRampCopy (data, data, numSamples, firstGain, gainStep);
+    }
+
+    static void multiplyCurve (float* data, const float* gains, int numSamples) noexcept
+    {
+        int i = 0;
+
+        for (; i + width <= numSamples; i += width)
+            Ops::store (data + i, Ops::mul (Ops::load (data + i), Ops::load (gains + i)));
+
+        for (; i < numSamples; ++i)
+            data[i] *= gains[i];
+    }
+
+    //==============================================================================
+    // sin (2 pi x): x is reduced to [-0.5, 0.5] and fed to an odd polynomial
+    // fitted to sin (2 pi r) over that range (max error about 1e-7, before
+    // float rounding)
+    static constexpr float sinCoefficients[6] = { 6.2831828f, -41.341419f, 81.596139f,
+                                                  -76.579694f, 41.203767f, -12.268893f };
+
+    static Vec sinTwoPi (Vec x) noexcept
+    {
+        const auto r  = Ops::sub (x, Ops::round (x));
+        const auto r2 = Ops::mul (r, r);
+
+        auto p = Ops::broadcast (sinCoefficients[5]);
+        p = Ops::mulAdd (p, r2, Ops::broadcast (sinCoefficients[4]));
+        p = Ops::mulAdd (p, r2, Ops::broadcast (sinCoefficients[3]));
+        p = Ops::mulAdd (p, r2, Ops::broadcast (sinCoefficients[2]));
+        p = Ops::mulAdd (p, r2, Ops::broadcast (sinCoefficients[1]));
+        p = Ops::mulAdd (p, r2, Ops::broadcast (sinCoefficients[0]));
+        return Ops::mul (p, r);
+    }
+
+    static float sinTwoPiScalar (float x) noexcept
+    {
+        const auto rounded = (float) (long long) (x + (x < 0.0f ? -0.5f : 0.5f));
+        const auto r  = x - rounded;
+        const auto r2 = r * r;
+
+        auto p = sinCoefficients[5];
+
+        for (int k = 4; k >= 0; --k)
+            p = p * r2 + sinCoefficients[k];
+
+        return p * r;
+    }
+
+    // 1 - depth * (0.5 - 0.5 cos), using cos (2 pi x) = sin (2 pi (x + 0.25)),
+    // rearranged as (1 - depth / 2) + (depth / 2) * sin
+    static void tremoloGains (float* dest, int numSamples, float firstPhase, float phaseStep,
+                              float firstDepth, float depthStep) noexcept
+    {
+        const auto phase0 = Ops::broadcast (firstPhase + 0.25f);
+        const auto phaseInc = Ops::broadcast (phaseStep);
+        const auto depth0 = Ops::broadcast (firstDepth);
+        const auto depthInc = Ops::broadcast (depthStep);
+        const auto half = Ops::broadcast (0.5f);
+        const auto one = Ops::broadcast (1.0f);
+        const auto lanes = Ops::load (laneIndices);
+        int i = 0;
+
+        for (; i + width <= numSamples; i += width)
+        {
+            const auto index = Ops::add (Ops::broadcast ((float) i), lanes);
+            const auto halfDepth = Ops::mul (Ops::mulAdd (index, depthInc, depth0), half);
+            const auto sine = sinTwoPi (Ops::mulAdd (index, phaseInc, phase0));
+            Ops::store (dest + i, Ops::mulAdd (halfDepth, sine, Ops::sub (one, halfDepth)));
+        }
+
+        for (; i < numSamples; ++i)
+        {
+            const auto halfDepth = 0.5f * (firstDepth + depthStep * (float) i);
+            const auto sine = sinTwoPiScalar (firstPhase + 0.25f + phaseStep * (float) i);
+            dest[i] = (1.0f - halfDepth) + halfDepth * sine;
+        }
+    }
+
+    //==============================================================================
+    // Interleaved frames: with numChannels channels, the per-sample gain pattern
+    // repeats every numChannels vectors, so those vectors are built once and
+    // then cycled through.
+    static void multiplyInterleaved (float* dest, const float* source, int numChannels, int numFrames,
+                                     const float* channelGains) noexcept
+    {
+        if (numChannels <= 0 || numFrames <= 0)
+            return;
+
+        int frame = 0;
+
+        if (numChannels <= maxInterleavedChannels)
+        {
+            alignas (64) float pattern[maxInterleavedChannels * 16];
+            const auto patternSize = numChannels * width;
+
+            for (int k = 0; k < patternSize; ++k)
+                pattern[k] = channelGains[k % numChannels];
+
+            for (; frame + width <= numFrames; frame += width)
+            {
+                const auto offset = frame * numChannels;
+
+                for (int v = 0; v < numChannels; ++v)
+                {
+                    const auto index = offset + v * width;
+                    Ops::store (dest + index, Ops::mul (Ops::load (source + index),
+                                                        Ops::load (pattern + v * width)));
+                }
+            }
+        }
+
+        for (; frame < numFrames; ++frame)
+            for (int c = 0; c < numChannels; ++c)
+                dest[frame * numChannels + c] = source[frame * numChannels + c] * channelGains[c];
+    }
+
+    //==============================================================================
+    // Minimum, maximum and sum of squares in one pass, with two sets of
+    // accumulators so consecutive vectors don't wait on each other
+    static void measure (const float* data, int numSamples, float* minMaxSumSquares) noexcept
+    {
+        if (numSamples <= 0)
+        {
+            minMaxSumSquares[0] = minMaxSumSquares[1] = minMaxSumSquares[2] = 0.0f;
+            return;
+        }
+
+        auto lowest = data[0], highest = data[0], sumSquares = 0.0f;
+        int i = 0;
+
+        if (numSamples >= width * 2)
+        {
+            auto lowA = Ops::load (data), lowB = lowA;
+            auto highA = lowA, highB = lowA;
+            auto sumA = Ops::broadcast (0.0f), sumB = sumA;
+
+            for (; i + width * 2 <= numSamples; i += width * 2)
+            {
+                const auto a = Ops::load (data + i);
+                const auto b = Ops::load (data + i + width);
+                lowA = Ops::min (lowA, a);
+                lowB = Ops::min (lowB, b);
+                highA = Ops::max (highA, a);
+                highB = Ops::max (highB, b);
+                sumA = Ops::mulAdd (a, a, sumA);
+                sumB = Ops::mulAdd (b, b, sumB);
+            }
+
+            alignas (64) float lows[16], highs[16], sums[16];
+            Ops::store (lows, Ops::min (lowA, lowB));
+            Ops::store (highs, Ops::max (highA, highB));
+            Ops::store (sums, Ops::add (sumA, sumB));
+
+            for (int k = 0; k < width; ++k)
+            {
+                lowest = lows[k] < lowest ? lows[k] : lowest;
+                highest = highs[k] > highest ? highs[k] : highest;
+                sumSquares += sums[k];
+            }
+        }
+
+        for (; i < numSamples; ++i)
+        {
+            lowest = data[i] < lowest ? data[i] : lowest;
+            highest = data[i] > highest ? data[i] : highest;
+            sumSquares += data[i] * data[i];
+        }
+
+        minMaxSumSquares[0] = lowest;
+        minMaxSumSquares[1] = highest;
+        minMaxSumSquares[2] = sumSquares;
+    }
+
+    //==============================================================================
+    static GainKernelTable makeTable() noexcept
+    {
+        GainKernelTable table;
+        table.multiply            = multiply;
+        table.multiplyCopy        = multiplyCopy;
+        table.multiplyAdd         = multiplyAdd;
+        table.multiplyRamp        = multiplyRamp;
+        table.multiplyRampCopy    = multiplyRampCopy;
+        table.multiplyCurve       = multiplyCurve;
+        table.tremoloGains        = tremoloGains;
+        table.multiplyInterleaved = multiplyInterleaved;
+        table.measure             = measure;
+        return table;
+    }
+};
+
+//==============================================================================
+// Defined in the per-instruction-set files. The x86 ones only exist when
+// PLUGINDSP_X86_KERNELS is set by the build.
+GainKernelTable makeScalarKernels() noexcept;
+GainKernelTable makeSse2Kernels() noexcept;
+GainKernelTable makeAvx2Kernels() noexcept;
+GainKernelTable makeAvx512Kernels() noexcept;
+
+} // namespace detail
+} // namespace plugindsp
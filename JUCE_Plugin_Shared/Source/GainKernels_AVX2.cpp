@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - DSP code shared by the plugin projects
+    GainKernels_AVX2 - 8-wide kernels, compiled with AVX2 and FMA enabled
+
+  ==============================================================================
+*/
+
+#include "GainKernelsImpl.h"
+
+#if PLUGINDSP_X86_KERNELS
+
+#include <immintrin.h>
+
+namespace plugindsp
+{
+namespace detail
+{
+
+namespace
+{
+    struct Avx2Ops
+    {
+        using Vec = __m256;
+        static constexpr int width = 8;
+
+        static Vec load (const float* p) noexcept          { return _mm256_loadu_ps (p); }
+        static void store (float* p, Vec v) noexcept       { _mm256_storeu_ps (p, v); }
+        static Vec broadcast (float v) noexcept            { return _mm256_set1_ps (v); }
+        static Vec mul (Vec a, Vec b) noexcept             { return _mm256_mul_ps (a, b); }
+        static Vec add (Vec a, Vec b) noexcept             { return _mm256_add_ps (a, b); }
+        static Vec sub (Vec a, Vec b) noexcept             { return _mm256_sub_ps (a, b); }
+        static Vec mulAdd (Vec a, Vec b, Vec c) noexcept   { return _mm256_fmadd_ps (a, b, c); }
+        static Vec round (Vec v) noexcept                  { return _mm256_round_ps (v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        static Vec min (Vec a, Vec b) noexcept             { return _mm256_min_ps (a, b); }
+        static Vec max (Vec a, Vec b) noexcept             { return _mm256_max_ps (a, b); }
+    };
+}
+
+GainKernelTable makeAvx2Kernels() noexcept
+{
+    return KernelSet<Avx2Ops>::makeTable();
+}
+
+} // namespace detail
+} // namespace plugindsp
+
+#endif
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - DSP code shared by the plugin projects
+    GainKernels_Double - double-precision planar kernels
+
+  ==============================================================================
+*/
+
+#include "GainKernels.h"
+
+#include <algorithm>
+
+namespace plugindsp
+{
+
+//==============================================================================
+void applyGain (double* const* channels, int numChannels, int numSamples, double gain) noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* data = channels[channel];
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] *= gain;
+    }
+}
+
+void applyGainRamp (double* const* channels, int numChannels, int numSamples,
+                    double firstGain, double gainStep) noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* data = channels[channel];
+
+        // Computed from the index, like the float ramps, so it vectorises
+        // and doesn't accumulate rounding errors
+        for (int i = 0; i < numSamples; ++i)
+            data[i] *= firstGain + gainStep * (double) i;
+    }
+}
+
+void applyGainCurve (double* const* channels, int numChannels, int numSamples,
+                     const float* gains) noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* data = channels[channel];
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] *= (double) gains[i];
+    }
+}
+
+void applyChannelGains (double* const* channels, int numChannels, int numSamples,
+                        const float* channelGains) noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+        if (channelGains[channel] != 1.0f)
+            applyGain (channels + channel, 1, numSamples, (double) channelGains[channel]);
+}
+
+void applyChannelGainRamps (double* const* channels, int numChannels, int numSamples,
+                            const float* firstGains, const float* gainSteps) noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        if (gainSteps[channel] != 0.0f)
+            applyGainRamp (channels + channel, 1, numSamples, (double) firstGains[channel], (double) gainSteps[channel]);
+        else if (firstGains[channel] != 1.0f)
+            applyGain (channels + channel, 1, numSamples, (double) firstGains[channel]);
+    }
+}
+
+void measureLevels (const double* const* channels, int numChannels, int numSamples,
+                    LevelSummary* levels) noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* data = channels[channel];
+
+        if (numSamples <= 0)
+        {
+            levels[channel] = {};
+            continue;
+        }
+
+        auto minimum = data[0], maximum = data[0];
+        double sumOfSquares = 0.0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            minimum = std::min (minimum, data[i]);
+            maximum = std::max (maximum, data[i]);
+            sumOfSquares += data[i] * data[i];
+        }
+
+        levels[channel] = { (float) minimum, (float) maximum, (float) sumOfSquares };
+    }
+}
+
+} // namespace plugindsp
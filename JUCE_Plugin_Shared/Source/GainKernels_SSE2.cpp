@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - DSP code shared by the plugin projects
+    GainKernels_SSE2 - 4-wide kernels, compiled with SSE2 enabled
+
+  ==============================================================================
+*/
+
+#include "GainKernelsImpl.h"
+
+#if PLUGINDSP_X86_KERNELS
+
+#include <emmintrin.h>
+
+namespace plugindsp
+{
+namespace detail
+{
+
+namespace
+{
+    struct Sse2Ops
+    {
+        using Vec = __m128;
+        static constexpr int width = 4;
+
+        static Vec load (const float* p) noexcept          { return _mm_loadu_ps (p); }
+        static void store (float* p, Vec v) noexcept       { _mm_storeu_ps (p, v); }
+        static Vec broadcast (float v) noexcept            { return _mm_set1_ps (v); }
+        static Vec mul (Vec a, Vec b) noexcept             { return _mm_mul_ps (a, b); }
+        static Vec add (Vec a, Vec b) noexcept             { return _mm_add_ps (a, b); }
+        static Vec sub (Vec a, Vec b) noexcept             { return _mm_sub_ps (a, b); }
+        static Vec mulAdd (Vec a, Vec b, Vec c) noexcept   { return _mm_add_ps (_mm_mul_ps (a, b), c); }
+        static Vec round (Vec v) noexcept                  { return _mm_cvtepi32_ps (_mm_cvtps_epi32 (v)); }
+        static Vec min (Vec a, Vec b) noexcept             { return _mm_min_ps (a, b); }
+        static Vec max (Vec a, Vec b) noexcept             { return _mm_max_ps (a, b); }
+    };
+}
+
+GainKernelTable makeSse2Kernels() noexcept
+{
+    return KernelSet<Sse2Ops>::makeTable();
+}
+
+} // namespace detail
+} // namespace plugindsp
+
+#endif
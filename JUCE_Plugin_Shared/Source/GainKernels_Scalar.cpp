@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - DSP code shared by the plugin projects
+    GainKernels_Scalar - portable fallback kernels
+
+  ==============================================================================
+*/
+
+#include "GainKernelsImpl.h"
+
+#include <cmath>
+
+namespace plugindsp
+{
+namespace detail
+{
+
+namespace
+{
+    // One float per "vector". Compiled with the project's normal flags, so on
+    // ARM and other non-x86 targets the compiler is free to auto-vectorise.
+    struct ScalarOps
+    {
+        using Vec = float;
+        static constexpr int width = 1;
+
+        static Vec load (const float* p) noexcept          { return *p; }
+        static void store (float* p, Vec v) noexcept       { *p = v; }
+        static Vec broadcast (float v) noexcept            { return v; }
+        static Vec mul (Vec a, Vec b) noexcept             { return a * b; }
+        static Vec add (Vec a, Vec b) noexcept             { return a + b; }
+        static Vec sub (Vec a, Vec b) noexcept             { return a - b; }
+        static Vec mulAdd (Vec a, Vec b, Vec c) noexcept   { return a * b + c; }
+        static Vec round (Vec v) noexcept                  { return std::nearbyint (v); }
+        static Vec min (Vec a, Vec b) noexcept             { return a < b ? a : b; }
+        static Vec max (Vec a, Vec b) noexcept             { return a > b ? a : b; }
+    };
+}
+
+GainKernelTable makeScalarKernels() noexcept
+{
+    return KernelSet<ScalarOps>::makeTable();
+}
+
+} // namespace detail
+} // namespace plugindsp
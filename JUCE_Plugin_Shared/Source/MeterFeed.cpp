@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - DSP code shared by the plugin projects
+    MeterFeed - per-block level summaries passed from the audio thread to an
+    editor's meters through a wait-free FIFO
+
+  ==============================================================================
+*/
+
+#include "MeterFeed.h"
+
+namespace plugindsp
+{
+
+namespace
+{
+    std::uint32_t roundUpToPowerOfTwo (int value) noexcept
+    {
+        std::uint32_t result = 2;
+
+        while ((int) result < value)
+            result <<= 1;
+
+        return result;
+    }
+}
+
+MeterFeed::MeterFeed (int capacity)
+    : slots (roundUpToPowerOfTwo (capacity)),
+      mask ((std::uint32_t) slots.size() - 1)
+{
+}
+
+//==============================================================================
+void MeterFeed::push (const float* const* channels, int numChannels, int numSamples) noexcept
+{
+    pushLevels (channels, numChannels, numSamples);
+}
+
+void MeterFeed::push (const double* const* channels, int numChannels, int numSamples) noexcept
+{
+    pushLevels (channels, numChannels, numSamples);
+}
+
+template <typename SampleType>
+void MeterFeed::pushLevels (const SampleType* const* channels, int numChannels, int numSamples) noexcept
+{
+    if (! hasReader.load (std::memory_order_relaxed))
+        return;
+
+    const auto write = writePosition.load (std::memory_order_relaxed);
+
+    if (write - readPosition.load (std::memory_order_acquire) > mask)
+    {
+        numDropped.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& summary = slots[write & mask];
+    summary.numChannels = numChannels < BlockSummary::maxChannels ? numChannels : BlockSummary::maxChannels;
+    summary.numSamples = numSamples;
+    measureLevels (channels, summary.numChannels, numSamples, summary.channels);
+
+    writePosition.store (write + 1, std::memory_order_release);
+}
+
+//==============================================================================
+MeterFeed::Reader::Reader (MeterFeed& feedToRead) noexcept
+    : feed (feedToRead)
+{
+    // Skip anything left over from a previous reader, then let the audio thread start
+    feed.readPosition.store (feed.writePosition.load (std::memory_order_acquire), std::memory_order_release);
+    feed.hasReader.store (true, std::memory_order_release);
+}
+
+MeterFeed::Reader::~Reader()
+{
+    feed.hasReader.store (false, std::memory_order_release);
+}
+
+bool MeterFeed::Reader::pop (BlockSummary& summary) noexcept
+{
+    const auto read = feed.readPosition.load (std::memory_order_relaxed);
+
+    if (read == feed.writePosition.load (std::memory_order_acquire))
+        return false;
+
+    summary = feed.slots[read & feed.mask];
+    feed.readPosition.store (read + 1, std::memory_order_release);
+    return true;
+}
+
+} // namespace plugindsp
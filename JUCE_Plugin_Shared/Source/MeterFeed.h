@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - DSP code shared by the plugin projects
+    MeterFeed - per-block level summaries passed from the audio thread to an
+    editor's meters through a wait-free FIFO
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "GainKernels.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace plugindsp
+{
+
+//==============================================================================
+/** The levels of one processed block, as passed to the editor. */
+struct BlockSummary
+{
+    static constexpr int maxChannels = 16;
+
+    LevelSummary channels[maxChannels];
+    int numChannels = 0;
+    int numSamples = 0;
+};
+
+//==============================================================================
+/**
+ * Carries compact block summaries (min, max and sum of squares per channel),
+ * not audio, from processBlock() to an editor.
+ *
+ * The audio thread calls push() at the end of each block. It does nothing
+ * unless a Reader exists, so with no editor open the cost is one atomic
+ * load. Otherwise it measures the block with the vectorised measureLevels()
+ * straight into a FIFO slot and publishes it with one atomic store. When the
+ * FIFO is full (the editor has stalled) the block is dropped rather than
+ * waiting. push() never locks or allocates.
+ *
+ * The editor creates one Reader while it's open and drains it each frame.
+ */
+class MeterFeed
+{
+public:
+    /** capacity is rounded up to a power of two. */
+    explicit MeterFeed (int capacity = 256);
+
+    //==============================================================================
+    /** Stored for the reader, which needs it to turn blocks into time. */
+    void setSampleRate (double newSampleRate) noexcept  { sampleRate.store (newSampleRate, std::memory_order_relaxed); }
+    double getSampleRate() const noexcept               { return sampleRate.load (std::memory_order_relaxed); }
+
+    /** True while a reader is attached. */
+    bool isActive() const noexcept                      { return hasReader.load (std::memory_order_relaxed); }
+
+    /** Audio thread: summarises a block if anyone is reading. Channels past maxChannels are left out. */
+    void push (const float* const* channels, int numChannels, int numSamples) noexcept;
+    void push (const double* const* channels, int numChannels, int numSamples) noexcept;
+
+    /** Blocks dropped because the FIFO was full. */
+    std::uint64_t getNumDropped() const noexcept        { return numDropped.load (std::memory_order_relaxed); }
+
+    //==============================================================================
+    /**
+     * Attaches to a feed for as long as it exists. Blocks pushed before the
+     * reader was created are skipped. Only one reader at a time; message
+     * thread only.
+     */
+    class Reader
+    {
+    public:
+        explicit Reader (MeterFeed& feedToRead) noexcept;
+        ~Reader();
+
+        /** Takes the oldest waiting summary. Returns false if there isn't one. */
+        bool pop (BlockSummary& summary) noexcept;
+
+        MeterFeed& getFeed() noexcept   { return feed; }
+
+    private:
+        MeterFeed& feed;
+
+        Reader (const Reader&) = delete;
+        Reader& operator= (const Reader&) = delete;
+    };
+
+private:
+    template <typename SampleType>
+    void pushLevels (const SampleType* const* channels, int numChannels, int numSamples) noexcept;
+
+    std::vector<BlockSummary> slots;
+    const std::uint32_t mask;
+
+    alignas (64) std::atomic<std::uint32_t> writePosition { 0 };
+    alignas (64) std::atomic<std::uint32_t> readPosition { 0 };
+    alignas (64) std::atomic<bool> hasReader { false };
+    std::atomic<std::uint64_t> numDropped { 0 };
+    std::atomic<double> sampleRate { 44100.0 };
+
+    MeterFeed (const MeterFeed&) = delete;
+    MeterFeed& operator= (const MeterFeed&) = delete;
+};
+
+} // namespace plugindsp
@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - plugin state code shared by the plugin projects
+    ParameterState - compact, versioned binary plugin state that can be read
+    in place, without parsing or allocating
+
+  ==============================================================================
+*/
+
+#include "ParameterState.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace plugindsp
+{
+
+namespace
+{
+    //==============================================================================
+    // Explicit byte order, so states move between little- and big-endian machines
+    void writeLittleEndian16 (std::uint8_t* dest, std::uint16_t value) noexcept
+    {
+        dest[0] = (std::uint8_t) value;
+        dest[1] = (std::uint8_t) (value >> 8);
+    }
+
+    void writeLittleEndian32 (std::uint8_t* dest, std::uint32_t value) noexcept
+    {
+        for (int i = 0; i < 4; ++i)
+            dest[i] = (std::uint8_t) (value >> (8 * i));
+    }
+
+    std::uint16_t readLittleEndian16 (const std::uint8_t* source) noexcept
+    {
+        return (std::uint16_t) (source[0] | (source[1] << 8));
+    }
+
+    std::uint32_t readLittleEndian32 (const std::uint8_t* source) noexcept
+    {
+        return (std::uint32_t) source[0]
+             | ((std::uint32_t) source[1] << 8)
+             | ((std::uint32_t) source[2] << 16)
+             | ((std::uint32_t) source[3] << 24);
+    }
+
+    std::uint32_t floatToBits (float value) noexcept
+    {
+        std::uint32_t bits;
+        std::memcpy (&bits, &value, sizeof (bits));
+        return bits;
+    }
+
+    float bitsToFloat (std::uint32_t bits) noexcept
+    {
+        float value;
+        std::memcpy (&value, &bits, sizeof (value));
+        return value;
+    }
+}
+
+//==============================================================================
+std::size_t writeParameterState (void* dest, std::size_t destSize, std::uint32_t magic,
+                                 const ParameterStateEntry* entries, std::size_t numEntries) noexcept
+{
+    const auto size = getParameterStateSize (numEntries);
+
+    if (dest == nullptr || destSize < size || numEntries > 0xffffffffu)
+        return 0;
+
+    auto* bytes = static_cast<std::uint8_t*> (dest);
+
+    writeLittleEndian32 (bytes, magic);
+    writeLittleEndian16 (bytes + 4, parameterstate::currentFormatVersion);
+    writeLittleEndian16 (bytes + 6, (std::uint16_t) parameterstate::headerSize);
+    writeLittleEndian32 (bytes + 8, (std::uint32_t) numEntries);
+    writeLittleEndian16 (bytes + 12, (std::uint16_t) parameterstate::entrySize);
+    writeLittleEndian16 (bytes + 14, 0);
+
+    auto* entry = bytes + parameterstate::headerSize;
+
+    for (std::size_t i = 0; i < numEntries; ++i, entry += parameterstate::entrySize)
+    {
+        writeLittleEndian32 (entry, entries[i].parameterIDHash);
+        writeLittleEndian32 (entry + 4, floatToBits (entries[i].value));
+    }
+
+    return size;
+}
+
+//==============================================================================
+ParameterStateReader::ParameterStateReader (const void* data, std::size_t size, std::uint32_t expectedMagic) noexcept
+{
+    if (data == nullptr || size < parameterstate::headerSize)
+        return;
+
+    const auto* bytes = static_cast<const std::uint8_t*> (data);
+
+    if (readLittleEndian32 (bytes) != expectedMagic)
+        return;
+
+    const auto version    = readLittleEndian16 (bytes + 4);
+    const auto dataOffset = (std::size_t) readLittleEndian16 (bytes + 6);
+    const auto count      = (std::size_t) readLittleEndian32 (bytes + 8);
+    const auto stride     = (std::size_t) readLittleEndian16 (bytes + 12);
+
+    // Later versions may grow the header or the entries, but never shrink them
+    if (version == 0 || dataOffset < parameterstate::headerSize || stride < parameterstate::entrySize)
+        return;
+
+    if (dataOffset > size || count > (size - dataOffset) / stride)
+        return;
+
+    entries = bytes + dataOffset;
+    numEntries = count;
+    entryStride = stride;
+    formatVersion = version;
+    valid = true;
+}
+
+ParameterStateEntry ParameterStateReader::getEntry (std::size_t index) const noexcept
+{
+    if (index >= numEntries)
+        return { 0, 0.0f };
+
+    const auto* entry = entries + index * entryStride;
+    return { readLittleEndian32 (entry), bitsToFloat (readLittleEndian32 (entry + 4)) };
+}
+
+bool ParameterStateReader::findValue (std::uint32_t parameterIDHash, float& value) const noexcept
+{
+    // A linear scan: plugin parameter tables are small, and this touches the
+    // data once, in order
+    for (std::size_t i = 0; i < numEntries; ++i)
+    {
+        const auto* entry = entries + i * entryStride;
+
+        if (readLittleEndian32 (entry) == parameterIDHash)
+        {
+            const auto stored = bitsToFloat (readLittleEndian32 (entry + 4));
+
+            if (! std::isfinite (stored))
+                return false;
+
+            value = stored;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace plugindsp
@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - plugin state code shared by the plugin projects
+    ParameterState - compact, versioned binary plugin state that can be read
+    in place, without parsing or allocating
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace plugindsp
+{
+
+//==============================================================================
+/**
+ * Layout (all fields little-endian):
+ *
+ *     offset  size  field
+ *     0       4     magic           plugin-chosen four-character code
+ *     4       2     formatVersion   bumped when the meaning of fields changes
+ *     6       2     headerSize      bytes before the first entry (16 for version 1)
+ *     8       4     numEntries
+ *     12      2     entrySize       bytes per entry (8 for version 1)
+ *     14      2     reserved        zero
+ *     16      ...   entries         { uint32 parameterIDHash, float32 value } each
+ *
+ * Readers skip header and entry bytes they don't know about, using headerSize
+ * and entrySize, so later versions can add fields without breaking older
+ * plugins. Parameters are looked up by a hash of their ID, so entries can be
+ * added, removed or reordered between versions: unknown entries are ignored
+ * and missing ones keep their current value.
+ */
+namespace parameterstate
+{
+    constexpr std::uint16_t currentFormatVersion = 1;
+    constexpr std::size_t headerSize = 16;
+    constexpr std::size_t entrySize = 8;
+}
+
+/** Builds a magic number from four characters, e.g. makeStateMagic ('V', 'c', 'p', 'l'). */
+constexpr std::uint32_t makeStateMagic (char a, char b, char c, char d) noexcept
+{
+    return (std::uint32_t) (std::uint8_t) a
+         | ((std::uint32_t) (std::uint8_t) b << 8)
+         | ((std::uint32_t) (std::uint8_t) c << 16)
+         | ((std::uint32_t) (std::uint8_t) d << 24);
+}
+
+/** 32-bit FNV-1a hash of a parameter ID. Usable at compile time. */
+constexpr std::uint32_t hashParameterID (const char* parameterID) noexcept
+{
+    std::uint32_t hash = 2166136261u;
+
+    for (; *parameterID != 0; ++parameterID)
+        hash = (hash ^ (std::uint8_t) *parameterID) * 16777619u;
+
+    return hash;
+}
+
+/** One row of the parameter table. */
+struct ParameterStateEntry
+{
+    std::uint32_t parameterIDHash;
+    float value;
+};
+
+//==============================================================================
+/** Bytes needed to write a state with this many entries. */
+constexpr std::size_t getParameterStateSize (std::size_t numEntries) noexcept
+{
+    return parameterstate::headerSize + numEntries * parameterstate::entrySize;
+}
+
+/**
+ * Writes a state into dest, which must hold at least
+ * getParameterStateSize (numEntries) bytes. Returns the number of bytes
+ * written, or 0 if dest is too small.
+ */
+std::size_t writeParameterState (void* dest, std::size_t destSize, std::uint32_t magic,
+                                 const ParameterStateEntry* entries, std::size_t numEntries) noexcept;
+
+//==============================================================================
+/**
+ * A read-only view of a state written by writeParameterState().
+ *
+ * Construction only checks the header; nothing is copied or allocated, so a
+ * host loading thousands of instances pays a few comparisons per parameter.
+ */
+class ParameterStateReader
+{
+public:
+    ParameterStateReader (const void* data, std::size_t size, std::uint32_t expectedMagic) noexcept;
+
+    /** True if the data starts with the expected magic and its table fits in the data. */
+    bool isValid() const noexcept                    { return valid; }
+
+    std::uint16_t getFormatVersion() const noexcept  { return formatVersion; }
+    std::size_t getNumEntries() const noexcept       { return numEntries; }
+
+    ParameterStateEntry getEntry (std::size_t index) const noexcept;
+
+    /**
+     * Looks up a parameter by its ID hash. Returns false (leaving value
+     * untouched) if it isn't there or its stored value isn't finite.
+     */
+    bool findValue (std::uint32_t parameterIDHash, float& value) const noexcept;
+
+private:
+    const std::uint8_t* entries = nullptr;
+    std::size_t numEntries = 0, entryStride = 0;
+    std::uint16_t formatVersion = 0;
+    bool valid = false;
+};
+
+} // namespace plugindsp
@@ -0,0 +1,618 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - preset management shared by the plugin projects
+    PresetCatalog - the preset file format, and a memory-mapped binary index
+    of a preset library for browsing and searching without opening presets
+
+  ==============================================================================
+*/
+
+#include "PresetCatalog.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if defined (_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #ifndef WIN32_LEAN_AND_MEAN
+  #define WIN32_LEAN_AND_MEAN
+ #endif
+ #include <windows.h>
+ #include <filesystem>
+#else
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+
+namespace plugindsp
+{
+
+namespace
+{
+    //==============================================================================
+    // Catalog layout (all fields little-endian):
+    //
+    //   header, 32 bytes:
+    //     0   4  magic "PCat"          16  2  recordSize (48 for version 1)
+    //     4   2  formatVersion         18  2  reserved
+    //     6   2  headerSize            20  4  numParameterEntries
+    //     8   4  pluginMagic           24  4  stringBytes
+    //     12  4  numPresets            28  4  reserved
+    //
+    //   records, recordSize bytes each:
+    //     0   4  nameOffset            20  4  firstParameter
+    //     4   2  nameLength            24  4  numParameters
+    //     6   2  tagsLength            28  4  reserved
+    //     8   4  tagsOffset            32  8  fileSize
+    //     12  4  pathOffset            40  8  modificationTime
+    //     16  2  pathLength
+    //     18  2  reserved
+    //
+    //   parameter entries, 8 bytes each: { u32 parameterIDHash, f32 value }
+    //   strings, referenced by offset and length, not terminated
+    //
+    // Readers skip header and record bytes they don't know about, as with
+    // ParameterState.
+    namespace catalog
+    {
+        constexpr std::uint32_t magic = makeStateMagic ('P', 'C', 'a', 't');
+        constexpr std::uint16_t currentFormatVersion = 1;
+        constexpr std::size_t headerSize = 32;
+        constexpr std::size_t recordSize = 48;
+        constexpr std::size_t parameterSize = 8;
+    }
+
+    //==============================================================================
+    void appendLittleEndian (std::vector<std::uint8_t>& dest, std::uint64_t value, int numBytes)
+    {
+        for (int i = 0; i < numBytes; ++i)
+            dest.push_back ((std::uint8_t) (value >> (8 * i)));
+    }
+
+    std::uint64_t readLittleEndian (const std::uint8_t* source, int numBytes) noexcept
+    {
+        std::uint64_t value = 0;
+
+        for (int i = 0; i < numBytes; ++i)
+            value |= (std::uint64_t) source[i] << (8 * i);
+
+        return value;
+    }
+
+    std::uint16_t read16 (const std::uint8_t* source) noexcept   { return (std::uint16_t) readLittleEndian (source, 2); }
+    std::uint32_t read32 (const std::uint8_t* source) noexcept   { return (std::uint32_t) readLittleEndian (source, 4); }
+
+    float bitsToFloat (std::uint32_t bits) noexcept
+    {
+        float value;
+        std::memcpy (&value, &bits, sizeof (value));
+        return value;
+    }
+
+    std::uint32_t floatToBits (float value) noexcept
+    {
+        std::uint32_t bits;
+        std::memcpy (&bits, &value, sizeof (bits));
+        return bits;
+    }
+
+    /** Strings longer than a u16 length allows are cut. */
+    std::string_view clampLength (std::string_view text) noexcept
+    {
+        return text.substr (0, std::min (text.size(), (std::size_t) 0xffff));
+    }
+
+    //==============================================================================
+    char toLowerAscii (char c) noexcept
+    {
+        return (c >= 'A' && c <= 'Z') ? (char) (c - 'A' + 'a') : c;
+    }
+
+    bool equalsIgnoringCase (std::string_view a, std::string_view b) noexcept
+    {
+        if (a.size() != b.size())
+            return false;
+
+        for (std::size_t i = 0; i < a.size(); ++i)
+            if (toLowerAscii (a[i]) != toLowerAscii (b[i]))
+                return false;
+
+        return true;
+    }
+
+    bool containsIgnoringCase (std::string_view text, std::string_view word) noexcept
+    {
+        if (word.size() > text.size())
+            return false;
+
+        for (std::size_t start = 0; start + word.size() <= text.size(); ++start)
+            if (equalsIgnoringCase (text.substr (start, word.size()), word))
+                return true;
+
+        return false;
+    }
+
+    std::string_view trimSpaces (std::string_view text) noexcept
+    {
+        while (! text.empty() && text.front() == ' ')
+            text.remove_prefix (1);
+
+        while (! text.empty() && text.back() == ' ')
+            text.remove_suffix (1);
+
+        return text;
+    }
+
+    /** Calls visit for each trimmed, non-empty item of a separated list. */
+    template <typename Visitor>
+    void forEachItem (std::string_view list, char separator, Visitor&& visit)
+    {
+        while (! list.empty())
+        {
+            const auto end = std::min (list.find (separator), list.size());
+            const auto item = trimSpaces (list.substr (0, end));
+
+            if (! item.empty())
+                visit (item);
+
+            list.remove_prefix (std::min (end + 1, list.size()));
+        }
+    }
+}
+
+//==============================================================================
+void writePresetFile (std::vector<std::uint8_t>& dest, std::uint32_t pluginMagic,
+                      std::string_view name, std::string_view tags,
+                      const ParameterStateEntry* summary, std::size_t numSummaryEntries,
+                      const void* state, std::size_t stateSize)
+{
+    name = clampLength (name);
+    tags = clampLength (tags);
+
+    dest.clear();
+    appendLittleEndian (dest, presetfile::magic, 4);
+    appendLittleEndian (dest, presetfile::currentFormatVersion, 2);
+    appendLittleEndian (dest, presetfile::headerSize, 2);
+    appendLittleEndian (dest, pluginMagic, 4);
+    appendLittleEndian (dest, 0, 4);
+
+    appendLittleEndian (dest, name.size(), 2);
+    dest.insert (dest.end(), name.begin(), name.end());
+    appendLittleEndian (dest, tags.size(), 2);
+    dest.insert (dest.end(), tags.begin(), tags.end());
+
+    const auto summarySize = getParameterStateSize (numSummaryEntries);
+    appendLittleEndian (dest, summarySize, 4);
+    dest.resize (dest.size() + summarySize);
+    writeParameterState (dest.data() + dest.size() - summarySize, summarySize, pluginMagic, summary, numSummaryEntries);
+
+    const auto* stateBytes = static_cast<const std::uint8_t*> (state);
+    appendLittleEndian (dest, stateSize, 4);
+    dest.insert (dest.end(), stateBytes, stateBytes + stateSize);
+}
+
+PresetFileReader::PresetFileReader (const void* data, std::size_t size, std::uint32_t pluginMagic) noexcept
+    : magic (pluginMagic)
+{
+    if (data == nullptr || size < presetfile::headerSize)
+        return;
+
+    const auto* bytes = static_cast<const std::uint8_t*> (data);
+
+    if (read32 (bytes) != presetfile::magic || read32 (bytes + 8) != pluginMagic)
+        return;
+
+    const auto version = read16 (bytes + 4);
+    auto position = (std::size_t) read16 (bytes + 6);
+
+    if (version == 0 || position < presetfile::headerSize || position > size)
+        return;
+
+    // Each field is a length followed by that many bytes, all of which must fit
+    auto readField = [&] (int lengthBytes, const std::uint8_t*& fieldData, std::size_t& fieldSize)
+    {
+        if (size - position < (std::size_t) lengthBytes)
+            return false;
+
+        fieldSize = (std::size_t) readLittleEndian (bytes + position, lengthBytes);
+        position += (std::size_t) lengthBytes;
+
+        if (size - position < fieldSize)
+            return false;
+
+        fieldData = bytes + position;
+        position += fieldSize;
+        return true;
+    };
+
+    const std::uint8_t* nameData;
+    const std::uint8_t* tagsData;
+    std::size_t nameSize, tagsSize;
+
+    if (! (readField (2, nameData, nameSize) && readField (2, tagsData, tagsSize)
+            && readField (4, summaryData, summarySize) && readField (4, stateData, stateSize)))
+        return;
+
+    name = std::string_view (reinterpret_cast<const char*> (nameData), nameSize);
+    tags = std::string_view (reinterpret_cast<const char*> (tagsData), tagsSize);
+    valid = true;
+}
+
+ParameterStateReader PresetFileReader::getSummary() const noexcept
+{
+    return ParameterStateReader (summaryData, summarySize, magic);
+}
+
+//==============================================================================
+bool writePresetCatalog (const std::string& path, std::uint32_t pluginMagic,
+                         const std::vector<PresetCatalogEntry>& presets)
+{
+    std::size_t numParameterEntries = 0;
+
+    for (const auto& preset : presets)
+        numParameterEntries += preset.parameters.size();
+
+    std::vector<std::uint8_t> header, records, parameterTable;
+    std::string strings;
+
+    records.reserve (presets.size() * catalog::recordSize);
+    parameterTable.reserve (numParameterEntries * catalog::parameterSize);
+
+    std::uint32_t firstParameter = 0;
+
+    for (const auto& preset : presets)
+    {
+        const auto name = clampLength (preset.name);
+        const auto tags = clampLength (preset.tags);
+        const auto presetPath = clampLength (preset.path);
+
+        const auto nameOffset = strings.size();
+        strings += name;
+        const auto tagsOffset = strings.size();
+        strings += tags;
+        const auto pathOffset = strings.size();
+        strings += presetPath;
+
+        appendLittleEndian (records, nameOffset, 4);
+        appendLittleEndian (records, name.size(), 2);
+        appendLittleEndian (records, tags.size(), 2);
+        appendLittleEndian (records, tagsOffset, 4);
+        appendLittleEndian (records, pathOffset, 4);
+        appendLittleEndian (records, presetPath.size(), 2);
+        appendLittleEndian (records, 0, 2);
+        appendLittleEndian (records, firstParameter, 4);
+        appendLittleEndian (records, preset.parameters.size(), 4);
+        appendLittleEndian (records, 0, 4);
+        appendLittleEndian (records, preset.fileSize, 8);
+        appendLittleEndian (records, (std::uint64_t) preset.modificationTime, 8);
+
+        for (const auto& parameter : preset.parameters)
+        {
+            appendLittleEndian (parameterTable, parameter.parameterIDHash, 4);
+            appendLittleEndian (parameterTable, floatToBits (parameter.value), 4);
+        }
+
+        firstParameter += (std::uint32_t) preset.parameters.size();
+    }
+
+    if (strings.size() > 0xffffffffu || presets.size() > 0x7fffffff)
+        return false;
+
+    appendLittleEndian (header, catalog::magic, 4);
+    appendLittleEndian (header, catalog::currentFormatVersion, 2);
+    appendLittleEndian (header, catalog::headerSize, 2);
+    appendLittleEndian (header, pluginMagic, 4);
+    appendLittleEndian (header, presets.size(), 4);
+    appendLittleEndian (header, catalog::recordSize, 2);
+    appendLittleEndian (header, 0, 2);
+    appendLittleEndian (header, numParameterEntries, 4);
+    appendLittleEndian (header, strings.size(), 4);
+    appendLittleEndian (header, 0, 4);
+
+    std::ofstream stream (path, std::ios::binary | std::ios::trunc);
+    stream.write (reinterpret_cast<const char*> (header.data()), (std::streamsize) header.size());
+    stream.write (reinterpret_cast<const char*> (records.data()), (std::streamsize) records.size());
+    stream.write (reinterpret_cast<const char*> (parameterTable.data()), (std::streamsize) parameterTable.size());
+    stream.write (strings.data(), (std::streamsize) strings.size());
+    stream.close();
+
+    return ! stream.fail();
+}
+
+//==============================================================================
+/** A read-only mapping of a whole file. */
+struct PresetCatalog::MappedFile
+{
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+
+   #if defined (_WIN32)
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+
+    bool open (const std::string& path)
+    {
+        // Sharing delete lets a later scan replace older catalogs while this one is mapped
+        fileHandle = CreateFileW (std::filesystem::u8path (path).wstring().c_str(), GENERIC_READ,
+                                  FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        LARGE_INTEGER fileSize;
+
+        if (fileHandle == INVALID_HANDLE_VALUE || ! GetFileSizeEx (fileHandle, &fileSize) || fileSize.QuadPart <= 0)
+            return false;
+
+        mappingHandle = CreateFileMappingW (fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (mappingHandle == nullptr)
+            return false;
+
+        data = static_cast<const std::uint8_t*> (MapViewOfFile (mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        size = (std::size_t) fileSize.QuadPart;
+        return data != nullptr;
+    }
+
+    ~MappedFile()
+    {
+        if (data != nullptr)
+            UnmapViewOfFile (data);
+
+        if (mappingHandle != nullptr)
+            CloseHandle (mappingHandle);
+
+        if (fileHandle != INVALID_HANDLE_VALUE)
+            CloseHandle (fileHandle);
+    }
+   #else
+    bool open (const std::string& path)
+    {
+        const auto descriptor = ::open (path.c_str(), O_RDONLY);
+
+        if (descriptor < 0)
+            return false;
+
+        struct stat info;
+        void* mapping = MAP_FAILED;
+
+        if (fstat (descriptor, &info) == 0 && info.st_size > 0)
+        {
+            size = (std::size_t) info.st_size;
+            mapping = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        }
+
+        // The mapping keeps the file alive on its own
+        ::close (descriptor);
+
+        if (mapping == MAP_FAILED)
+            return false;
+
+        data = static_cast<const std::uint8_t*> (mapping);
+        return true;
+    }
+
+    ~MappedFile()
+    {
+        if (data != nullptr)
+            munmap (const_cast<std::uint8_t*> (data), size);
+    }
+   #endif
+};
+
+//==============================================================================
+std::unique_ptr<PresetCatalog> PresetCatalog::open (const std::string& path, std::uint32_t pluginMagic)
+{
+    auto file = std::make_unique<MappedFile>();
+
+    if (! file->open (path) || file->size < catalog::headerSize)
+        return {};
+
+    const auto* bytes = file->data;
+    const auto size = file->size;
+
+    if (read32 (bytes) != catalog::magic || read32 (bytes + 8) != pluginMagic)
+        return {};
+
+    const auto version        = read16 (bytes + 4);
+    const auto recordsOffset  = (std::size_t) read16 (bytes + 6);
+    const auto presetCount    = read32 (bytes + 12);
+    const auto stride         = (std::size_t) read16 (bytes + 16);
+    const auto parameterCount = read32 (bytes + 20);
+    const auto stringCount    = read32 (bytes + 24);
+
+    // Later versions may grow the header or the records, but never shrink them
+    if (version == 0 || recordsOffset < catalog::headerSize || stride < catalog::recordSize
+         || presetCount > 0x7fffffff)
+        return {};
+
+    const auto parametersOffset = recordsOffset + (std::size_t) presetCount * stride;
+    const auto stringsOffset = parametersOffset + (std::size_t) parameterCount * catalog::parameterSize;
+
+    if (stringsOffset > size || stringCount > size - stringsOffset)
+        return {};
+
+    // Check every record once, so the accessors needn't
+    for (std::uint32_t i = 0; i < presetCount; ++i)
+    {
+        const auto* record = bytes + recordsOffset + i * stride;
+
+        auto fits = [stringCount] (std::uint32_t offset, std::uint32_t length)
+        {
+            return offset <= stringCount && length <= stringCount - offset;
+        };
+
+        if (! fits (read32 (record), read16 (record + 4))
+             || ! fits (read32 (record + 8), read16 (record + 6))
+             || ! fits (read32 (record + 12), read16 (record + 16))
+             || read32 (record + 20) > parameterCount
+             || read32 (record + 24) > parameterCount - read32 (record + 20))
+            return {};
+    }
+
+    std::unique_ptr<PresetCatalog> result (new PresetCatalog());
+    result->records = bytes + recordsOffset;
+    result->parameters = bytes + parametersOffset;
+    result->strings = reinterpret_cast<const char*> (bytes + stringsOffset);
+    result->numPresets = presetCount;
+    result->recordStride = (std::uint32_t) stride;
+    result->numParameterEntries = parameterCount;
+    result->stringBytes = stringCount;
+    result->filePath = path;
+    result->file = std::move (file);
+    return result;
+}
+
+PresetCatalog::~PresetCatalog() = default;
+
+//==============================================================================
+const std::uint8_t* PresetCatalog::getRecord (int index) const noexcept
+{
+    return (index >= 0 && (std::uint32_t) index < numPresets) ? records + (std::size_t) index * recordStride : nullptr;
+}
+
+std::string_view PresetCatalog::getString (std::uint32_t offset, std::uint32_t length) const noexcept
+{
+    return std::string_view (strings + offset, length);
+}
+
+std::string_view PresetCatalog::getName (int index) const noexcept
+{
+    const auto* record = getRecord (index);
+    return record != nullptr ? getString (read32 (record), read16 (record + 4)) : std::string_view();
+}
+
+std::string_view PresetCatalog::getTags (int index) const noexcept
+{
+    const auto* record = getRecord (index);
+    return record != nullptr ? getString (read32 (record + 8), read16 (record + 6)) : std::string_view();
+}
+
+std::string_view PresetCatalog::getPath (int index) const noexcept
+{
+    const auto* record = getRecord (index);
+    return record != nullptr ? getString (read32 (record + 12), read16 (record + 16)) : std::string_view();
+}
+
+std::uint64_t PresetCatalog::getFileSize (int index) const noexcept
+{
+    const auto* record = getRecord (index);
+    return record != nullptr ? readLittleEndian (record + 32, 8) : 0;
+}
+
+std::int64_t PresetCatalog::getModificationTime (int index) const noexcept
+{
+    const auto* record = getRecord (index);
+    return record != nullptr ? (std::int64_t) readLittleEndian (record + 40, 8) : 0;
+}
+
+int PresetCatalog::getNumParameters (int index) const noexcept
+{
+    const auto* record = getRecord (index);
+    return record != nullptr ? (int) read32 (record + 24) : 0;
+}
+
+ParameterStateEntry PresetCatalog::getParameter (int index, int parameter) const noexcept
+{
+    if (parameter < 0 || parameter >= getNumParameters (index))
+        return { 0, 0.0f };
+
+    const auto* entry = parameters + (std::size_t) (read32 (getRecord (index) + 20) + (std::uint32_t) parameter) * catalog::parameterSize;
+    return { read32 (entry), bitsToFloat (read32 (entry + 4)) };
+}
+
+bool PresetCatalog::findParameter (int index, std::uint32_t parameterIDHash, float& value) const noexcept
+{
+    for (int i = 0; i < getNumParameters (index); ++i)
+    {
+        const auto entry = getParameter (index, i);
+
+        if (entry.parameterIDHash == parameterIDHash)
+        {
+            value = entry.value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+PresetCatalogEntry PresetCatalog::getEntry (int index) const
+{
+    PresetCatalogEntry entry;
+    entry.name = getName (index);
+    entry.tags = getTags (index);
+    entry.path = getPath (index);
+    entry.fileSize = getFileSize (index);
+    entry.modificationTime = getModificationTime (index);
+
+    for (int i = 0; i < getNumParameters (index); ++i)
+        entry.parameters.push_back (getParameter (index, i));
+
+    return entry;
+}
+
+//==============================================================================
+bool PresetCatalog::hasTag (int index, std::string_view tag) const noexcept
+{
+    auto found = false;
+
+    forEachItem (getTags (index), ',', [&] (std::string_view item)
+    {
+        found = found || equalsIgnoringCase (item, tag);
+    });
+
+    return found;
+}
+
+void PresetCatalog::search (std::string_view query, std::string_view tag, std::vector<int>& results) const
+{
+    results.clear();
+
+    std::vector<std::string_view> words;
+    forEachItem (query, ' ', [&] (std::string_view word) { words.push_back (word); });
+
+    tag = trimSpaces (tag);
+
+    for (int i = 0; i < getNumPresets(); ++i)
+    {
+        if (! tag.empty() && ! hasTag (i, tag))
+            continue;
+
+        const auto name = getName (i);
+        const auto tags = getTags (i);
+
+        const auto matches = std::all_of (words.begin(), words.end(), [&] (std::string_view word)
+        {
+            return containsIgnoringCase (name, word) || containsIgnoringCase (tags, word);
+        });
+
+        if (matches)
+            results.push_back (i);
+    }
+}
+
+std::vector<std::string_view> PresetCatalog::getAllTags() const
+{
+    std::vector<std::string_view> tags;
+
+    for (int i = 0; i < getNumPresets(); ++i)
+    {
+        forEachItem (getTags (i), ',', [&] (std::string_view tag)
+        {
+            const auto known = std::any_of (tags.begin(), tags.end(),
+                                            [tag] (std::string_view other) { return equalsIgnoringCase (tag, other); });
+
+            if (! known)
+                tags.push_back (tag);
+        });
+    }
+
+    return tags;
+}
+
+} // namespace plugindsp
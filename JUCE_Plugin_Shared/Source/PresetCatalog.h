@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - preset management shared by the plugin projects
+    PresetCatalog - the preset file format, and a memory-mapped binary index
+    of a preset library for browsing and searching without opening presets
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ParameterState.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace plugindsp
+{
+
+//==============================================================================
+/**
+ * Preset file layout (all fields little-endian):
+ *
+ *     offset  size  field
+ *     0       4     magic           "Prst"
+ *     4       2     formatVersion
+ *     6       2     headerSize      bytes before the name (16 for version 1)
+ *     8       4     pluginMagic     the plugin's state magic; other plugins' presets are skipped
+ *     12      4     reserved        zero
+ *     16      ...   name            u16 length + UTF-8
+ *                   tags            u16 length + UTF-8, comma separated
+ *                   summary         u32 length + a ParameterState of normalised
+ *                                   parameter values (with pluginMagic)
+ *                   state           u32 length + the plugin state, as
+ *                                   getStateInformation() wrote it
+ *
+ * The summary lets the catalog describe a preset (and a browser show it)
+ * without the plugin decoding its own state.
+ */
+namespace presetfile
+{
+    constexpr std::uint32_t magic = makeStateMagic ('P', 'r', 's', 't');
+    constexpr std::uint16_t currentFormatVersion = 1;
+    constexpr std::size_t headerSize = 16;
+}
+
+/** Replaces dest with a preset file. */
+void writePresetFile (std::vector<std::uint8_t>& dest, std::uint32_t pluginMagic,
+                      std::string_view name, std::string_view tags,
+                      const ParameterStateEntry* summary, std::size_t numSummaryEntries,
+                      const void* state, std::size_t stateSize);
+
+/** A read-only view of a preset file's fields, checked once on construction. */
+class PresetFileReader
+{
+public:
+    PresetFileReader (const void* data, std::size_t size, std::uint32_t pluginMagic) noexcept;
+
+    bool isValid() const noexcept                       { return valid; }
+
+    std::string_view getName() const noexcept           { return name; }
+    std::string_view getTags() const noexcept           { return tags; }
+
+    /** The summary table; invalid if the preset has none. */
+    ParameterStateReader getSummary() const noexcept;
+
+    const void* getStateData() const noexcept           { return stateData; }
+    std::size_t getStateSize() const noexcept           { return stateSize; }
+
+private:
+    std::string_view name, tags;
+    const std::uint8_t* summaryData = nullptr;
+    std::size_t summarySize = 0;
+    const std::uint8_t* stateData = nullptr;
+    std::size_t stateSize = 0;
+    std::uint32_t magic = 0;
+    bool valid = false;
+};
+
+//==============================================================================
+/** One preset, as written into a catalog. */
+struct PresetCatalogEntry
+{
+    std::string name, tags, path;               // UTF-8
+    std::uint64_t fileSize = 0;
+    std::int64_t modificationTime = 0;          // as the scanner read it; only compared for equality
+    std::vector<ParameterStateEntry> parameters;
+};
+
+/**
+ * Writes a catalog file: a 32-byte header, a fixed-size record per preset,
+ * every preset's parameter summary in one table, then every string. Presets
+ * are stored in the order given. Returns false if the file couldn't be
+ * written.
+ */
+bool writePresetCatalog (const std::string& path, std::uint32_t pluginMagic,
+                         const std::vector<PresetCatalogEntry>& presets);
+
+//==============================================================================
+/**
+ * A catalog file, memory-mapped and read in place.
+ *
+ * open() checks every offset once; after that each accessor is a few loads
+ * from the mapping, and the names, tags and paths are string_views into it.
+ * Opening a catalog of thousands of presets costs a page-in, not a parse,
+ * and nothing is copied until a browser asks for it.
+ *
+ * A catalog never changes once written - a rescan writes a new file - so
+ * any number of threads may read one. The views stay valid for as long as
+ * the catalog exists.
+ */
+class PresetCatalog
+{
+public:
+    /** Maps and validates a catalog. Returns nullptr if it is missing, corrupt or for another plugin. */
+    static std::unique_ptr<PresetCatalog> open (const std::string& path, std::uint32_t pluginMagic);
+
+    ~PresetCatalog();
+
+    //==============================================================================
+    int getNumPresets() const noexcept                  { return (int) numPresets; }
+
+    std::string_view getName (int index) const noexcept;
+    std::string_view getTags (int index) const noexcept;
+    std::string_view getPath (int index) const noexcept;
+    std::uint64_t getFileSize (int index) const noexcept;
+    std::int64_t getModificationTime (int index) const noexcept;
+
+    /** The preset's parameter summary: normalised values by parameter ID hash. */
+    int getNumParameters (int index) const noexcept;
+    ParameterStateEntry getParameter (int index, int parameter) const noexcept;
+    bool findParameter (int index, std::uint32_t parameterIDHash, float& value) const noexcept;
+
+    /** Copies a preset back out, e.g. to carry it into the next catalog unchanged. */
+    PresetCatalogEntry getEntry (int index) const;
+
+    //==============================================================================
+    /**
+     * Replaces results with the indices of the presets matching a query, in
+     * catalog order. Every space-separated word of query must appear in the
+     * name or the tags, ignoring ASCII case; if tag isn't empty the preset
+     * must also have exactly that tag. An empty query matches everything.
+     */
+    void search (std::string_view query, std::string_view tag, std::vector<int>& results) const;
+
+    /** Returns true if a preset's comma-separated tags include tag (ignoring ASCII case). */
+    bool hasTag (int index, std::string_view tag) const noexcept;
+
+    /** Every distinct tag, in order of first appearance. */
+    std::vector<std::string_view> getAllTags() const;
+
+    const std::string& getFilePath() const noexcept     { return filePath; }
+
+private:
+    struct MappedFile;
+
+    PresetCatalog() = default;
+
+    const std::uint8_t* getRecord (int index) const noexcept;
+    std::string_view getString (std::uint32_t offset, std::uint32_t length) const noexcept;
+
+    std::unique_ptr<MappedFile> file;
+    std::string filePath;
+
+    const std::uint8_t* records = nullptr;
+    const std::uint8_t* parameters = nullptr;
+    const char* strings = nullptr;
+    std::uint32_t numPresets = 0, recordStride = 0, numParameterEntries = 0, stringBytes = 0;
+
+    PresetCatalog (const PresetCatalog&) = delete;
+    PresetCatalog& operator= (const PresetCatalog&) = delete;
+};
+
+} // namespace plugindsp
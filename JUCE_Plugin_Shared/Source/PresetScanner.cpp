@@ -0,0 +1,447 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - preset management shared by the plugin projects
+    PresetScanner - keeps a preset directory's catalog up to date on a
+    background thread, and reads presets there for program changes
+
+  ==============================================================================
+*/
+
+#include "PresetScanner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <unordered_map>
+
+namespace plugindsp
+{
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    const std::string catalogPrefix { "presets." };
+    const std::string catalogSuffix { ".catalog" };
+
+    /** Nothing a preset holds comes close to this; anything bigger isn't one. */
+    constexpr std::uintmax_t maxPresetFileSize = 16 * 1024 * 1024;
+
+    bool readFile (const std::string& path, std::vector<std::uint8_t>& dest)
+    {
+        std::error_code error;
+        const auto size = fs::file_size (fs::u8path (path), error);
+
+        if (error || size > maxPresetFileSize)
+            return false;
+
+        std::ifstream stream (fs::u8path (path), std::ios::binary);
+        dest.resize ((std::size_t) size);
+        stream.read (reinterpret_cast<char*> (dest.data()), (std::streamsize) size);
+        return (std::uintmax_t) stream.gcount() == size;
+    }
+
+    /** The generation in "presets.<generation>.catalog", or 0 if the name isn't a catalog's. */
+    std::uint64_t getCatalogGeneration (const std::string& fileName)
+    {
+        if (fileName.size() <= catalogPrefix.size() + catalogSuffix.size()
+             || fileName.compare (0, catalogPrefix.size(), catalogPrefix) != 0
+             || fileName.compare (fileName.size() - catalogSuffix.size(), catalogSuffix.size(), catalogSuffix) != 0)
+            return 0;
+
+        const auto number = fileName.substr (catalogPrefix.size(), fileName.size() - catalogPrefix.size() - catalogSuffix.size());
+
+        if (! std::all_of (number.begin(), number.end(), [] (char c) { return c >= '0' && c <= '9'; }) || number.size() > 18)
+            return 0;
+
+        return std::stoull (number);
+    }
+
+    /** Every catalog file in a directory, newest generation first. */
+    std::vector<std::pair<std::uint64_t, fs::path>> findCatalogs (const std::string& directory)
+    {
+        std::vector<std::pair<std::uint64_t, fs::path>> catalogs;
+        std::error_code error;
+
+        for (fs::directory_iterator it (fs::u8path (directory), error), end; ! error && it != end; it.increment (error))
+            if (const auto generation = getCatalogGeneration (it->path().filename().u8string()); generation > 0)
+                catalogs.emplace_back (generation, it->path());
+
+        std::sort (catalogs.begin(), catalogs.end(), [] (const auto& a, const auto& b) { return a.first > b.first; });
+        return catalogs;
+    }
+
+    bool lessIgnoringCase (const std::string& a, const std::string& b) noexcept
+    {
+        return std::lexicographical_compare (a.begin(), a.end(), b.begin(), b.end(), [] (char x, char y)
+        {
+            auto lower = [] (char c) { return (c >= 'A' && c <= 'Z') ? (char) (c - 'A' + 'a') : c; };
+            return lower (x) < lower (y);
+        });
+    }
+}
+
+//==============================================================================
+PresetScanner::PresetScanner (Options scannerOptions)
+    : options (std::move (scannerOptions))
+{
+    openNewestCatalog();
+    thread = std::thread ([this] { run(); });
+}
+
+PresetScanner::~PresetScanner()
+{
+    {
+        const std::lock_guard<std::mutex> lock (mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+    thread.join();
+}
+
+std::shared_ptr<PresetScanner> PresetScanner::getShared (const Options& options)
+{
+    static std::mutex registryMutex;
+    static std::map<std::string, std::weak_ptr<PresetScanner>> registry;
+
+    const auto key = options.presetDirectory + '\n' + options.catalogDirectory + '\n'
+                      + options.extension + '\n' + std::to_string (options.pluginMagic);
+
+    const std::lock_guard<std::mutex> lock (registryMutex);
+    auto& entry = registry[key];
+
+    if (auto existing = entry.lock())
+        return existing;
+
+    auto scanner = std::make_shared<PresetScanner> (options);
+    entry = scanner;
+    return scanner;
+}
+
+//==============================================================================
+std::shared_ptr<const PresetCatalog> PresetScanner::getCatalog() const
+{
+    const std::lock_guard<std::mutex> lock (mutex);
+    return catalog;
+}
+
+void PresetScanner::rescan()
+{
+    {
+        const std::lock_guard<std::mutex> lock (mutex);
+        scanRequested = true;
+    }
+
+    wake.notify_all();
+}
+
+void PresetScanner::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock (mutex);
+    idle.wait (lock, [this] { return stopping || (! scanRequested && ! scanning && loadRequests.empty()); });
+}
+
+PresetScanner::ScanStats PresetScanner::getLastScanStats() const
+{
+    const std::lock_guard<std::mutex> lock (mutex);
+    return lastScanStats;
+}
+
+void PresetScanner::addListener (Listener* listener)
+{
+    const std::lock_guard<std::mutex> lock (listenerMutex);
+    listeners.push_back (listener);
+}
+
+void PresetScanner::removeListener (Listener* listener)
+{
+    // Waits for a notification in progress, so the listener can be deleted straight after
+    const std::lock_guard<std::mutex> lock (listenerMutex);
+    listeners.erase (std::remove (listeners.begin(), listeners.end(), listener), listeners.end());
+}
+
+//==============================================================================
+void PresetScanner::requestLoad (int index, std::function<void (LoadedPreset&&)> onLoaded)
+{
+    {
+        const std::lock_guard<std::mutex> lock (mutex);
+        loadRequests.push_back ({ catalog, index, std::move (onLoaded) });
+    }
+
+    wake.notify_all();
+}
+
+PresetScanner::LoadedPreset PresetScanner::loadPresetFile (const std::string& path, std::uint32_t pluginMagic)
+{
+    LoadedPreset result;
+    std::vector<std::uint8_t> bytes;
+
+    if (! readFile (path, bytes))
+        return result;
+
+    const PresetFileReader reader (bytes.data(), bytes.size(), pluginMagic);
+
+    if (! reader.isValid())
+        return result;
+
+    const auto* state = static_cast<const std::uint8_t*> (reader.getStateData());
+    result.name = reader.getName();
+    result.state.assign (state, state + reader.getStateSize());
+    result.loaded = true;
+    return result;
+}
+
+bool PresetScanner::handlePendingLoads()
+{
+    for (;;)
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+
+        if (stopping)
+            return false;
+
+        if (loadRequests.empty())
+            return true;
+
+        auto request = std::move (loadRequests.front());
+        loadRequests.pop_front();
+        lock.unlock();
+
+        LoadedPreset preset;
+
+        if (request.catalog != nullptr && request.index >= 0 && request.index < request.catalog->getNumPresets())
+        {
+            preset = loadPresetFile (std::string (request.catalog->getPath (request.index)), options.pluginMagic);
+
+            if (preset.name.empty())
+                preset.name = request.catalog->getName (request.index);
+        }
+
+        preset.index = request.index;
+        request.onLoaded (std::move (preset));
+    }
+}
+
+//==============================================================================
+void PresetScanner::run()
+{
+    std::unique_lock<std::mutex> lock (mutex);
+
+    while (! stopping)
+    {
+        if (! loadRequests.empty())
+        {
+            lock.unlock();
+            handlePendingLoads();
+            lock.lock();
+            continue;
+        }
+
+        if (scanRequested)
+        {
+            scanRequested = false;
+            scanning = true;
+            lock.unlock();
+            scan();
+            lock.lock();
+            scanning = false;
+            continue;
+        }
+
+        idle.notify_all();
+        wake.wait (lock);
+    }
+
+    idle.notify_all();
+}
+
+void PresetScanner::scan()
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto previous = getCatalog();
+
+    ScanStats stats;
+    std::vector<PresetCatalogEntry> entries;
+    std::unordered_map<std::string_view, int> previousByPath;
+
+    if (previous != nullptr)
+        for (int i = 0; i < previous->getNumPresets(); ++i)
+            previousByPath.emplace (previous->getPath (i), i);
+
+    std::error_code error;
+
+    for (fs::recursive_directory_iterator it (fs::u8path (options.presetDirectory), fs::directory_options::skip_permission_denied, error), end;
+         ! error && it != end; it.increment (error))
+    {
+        // A program change shouldn't wait for the whole library to be scanned
+        if (! handlePendingLoads())
+            return;
+
+        std::error_code fileError;
+
+        if (! it->is_regular_file (fileError) || it->path().extension().u8string() != options.extension)
+            continue;
+
+        auto path = it->path().u8string();
+        const auto fileSize = (std::uint64_t) it->file_size (fileError);
+        const auto modified = (std::int64_t) it->last_write_time (fileError).time_since_epoch().count();
+
+        if (fileError)
+        {
+            ++stats.numFilesSkipped;
+            continue;
+        }
+
+        // Unchanged since the last scan: no need to open it
+        const auto found = previousByPath.find (path);
+
+        if (found != previousByPath.end() && previous->getFileSize (found->second) == fileSize
+             && previous->getModificationTime (found->second) == modified)
+        {
+            entries.push_back (previous->getEntry (found->second));
+            ++stats.numFilesReused;
+            continue;
+        }
+
+        std::vector<std::uint8_t> bytes;
+
+        if (! readFile (path, bytes))
+        {
+            ++stats.numFilesSkipped;
+            continue;
+        }
+
+        const PresetFileReader reader (bytes.data(), bytes.size(), options.pluginMagic);
+
+        if (! reader.isValid())
+        {
+            ++stats.numFilesSkipped;
+            continue;
+        }
+
+        PresetCatalogEntry entry;
+        entry.name = reader.getName().empty() ? it->path().stem().u8string() : std::string (reader.getName());
+        entry.tags = reader.getTags();
+        entry.path = std::move (path);
+        entry.fileSize = fileSize;
+        entry.modificationTime = modified;
+
+        const auto summary = reader.getSummary();
+
+        for (std::size_t i = 0; i < summary.getNumEntries(); ++i)
+            entry.parameters.push_back (summary.getEntry (i));
+
+        entries.push_back (std::move (entry));
+        ++stats.numFilesRead;
+    }
+
+    std::sort (entries.begin(), entries.end(), [] (const PresetCatalogEntry& a, const PresetCatalogEntry& b)
+    {
+        if (lessIgnoringCase (a.name, b.name))  return true;
+        if (lessIgnoringCase (b.name, a.name))  return false;
+        return a.path < b.path;
+    });
+
+    stats.numPresets = (int) entries.size();
+
+    // Same files, same order: the mapped catalog is still right
+    auto unchanged = previous != nullptr && previous->getNumPresets() == (int) entries.size();
+
+    for (int i = 0; unchanged && i < (int) entries.size(); ++i)
+        unchanged = previous->getPath (i) == entries[(size_t) i].path
+                     && previous->getFileSize (i) == entries[(size_t) i].fileSize
+                     && previous->getModificationTime (i) == entries[(size_t) i].modificationTime;
+
+    if (! unchanged)
+    {
+        std::uint64_t generation;
+
+        {
+            const std::lock_guard<std::mutex> lock (mutex);
+            generation = catalogGeneration + 1;
+        }
+
+        // Another process may have published meanwhile; never overwrite a catalog
+        std::error_code fileError;
+        fs::create_directories (fs::u8path (options.catalogDirectory), fileError);
+
+        while (fs::exists (fs::u8path (getCatalogPath (generation)), fileError))
+            ++generation;
+
+        const auto path = getCatalogPath (generation);
+        const auto temporaryPath = path + ".tmp" + std::to_string (std::random_device()());
+
+        if (writePresetCatalog (temporaryPath, options.pluginMagic, entries))
+        {
+            fs::rename (fs::u8path (temporaryPath), fs::u8path (path), fileError);
+
+            if (! fileError)
+            {
+                if (auto newCatalog = PresetCatalog::open (path, options.pluginMagic))
+                {
+                    {
+                        const std::lock_guard<std::mutex> lock (mutex);
+                        catalogGeneration = generation;
+                    }
+
+                    publish (std::move (newCatalog));
+                    stats.catalogWritten = true;
+
+                    // Older catalogs still mapped elsewhere go on the next scan instead
+                    for (const auto& older : findCatalogs (options.catalogDirectory))
+                        if (older.first < generation)
+                            fs::remove (older.second, fileError);
+                }
+            }
+        }
+
+        fs::remove (fs::u8path (temporaryPath), fileError);
+    }
+
+    stats.milliseconds = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - start).count();
+
+    const std::lock_guard<std::mutex> lock (mutex);
+    lastScanStats = stats;
+}
+
+//==============================================================================
+void PresetScanner::openNewestCatalog()
+{
+    for (const auto& [generation, path] : findCatalogs (options.catalogDirectory))
+    {
+        if (auto newest = PresetCatalog::open (path.u8string(), options.pluginMagic))
+        {
+            catalog = std::move (newest);
+            catalogGeneration = generation;
+            generationsPublished = 1;
+            return;
+        }
+    }
+}
+
+std::string PresetScanner::getCatalogPath (std::uint64_t generation) const
+{
+    return (fs::u8path (options.catalogDirectory) / fs::u8path (catalogPrefix + std::to_string (generation) + catalogSuffix)).u8string();
+}
+
+void PresetScanner::publish (std::shared_ptr<const PresetCatalog> newCatalog)
+{
+    {
+        const std::lock_guard<std::mutex> lock (mutex);
+        catalog = std::move (newCatalog);
+    }
+
+    generationsPublished.fetch_add (1, std::memory_order_acq_rel);
+
+    const std::lock_guard<std::mutex> lock (listenerMutex);
+
+    for (auto* listener : listeners)
+        listener->presetCatalogChanged();
+}
+
+} // namespace plugindsp
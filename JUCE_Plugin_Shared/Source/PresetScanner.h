@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - preset management shared by the plugin projects
+    PresetScanner - keeps a preset directory's catalog up to date on a
+    background thread, and reads presets there for program changes
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "PresetCatalog.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace plugindsp
+{
+
+//==============================================================================
+/**
+ * Owns a background thread that scans a preset directory (recursively, for
+ * files with the preset extension) into a PresetCatalog file, and publishes
+ * the mapped catalog.
+ *
+ * On construction the newest catalog already on disk is mapped straight
+ * away, so a browser has something to show before the first scan ends. A
+ * scan only opens presets that are new or whose size or modification time
+ * changed; everything else is carried over from the previous catalog. If
+ * nothing changed, no catalog is written. Presets are ordered by name
+ * (ignoring ASCII case), then path, so a program number means the same
+ * preset until the library changes.
+ *
+ * Catalogs are written as "presets.<generation>.catalog" next to each other,
+ * to a temporary name first, so a reader never sees half a file and a
+ * mapped catalog is never overwritten (which Windows wouldn't allow). Older
+ * generations are deleted once a newer one is published.
+ *
+ * The same thread reads preset files for program changes (requestLoad()),
+ * so neither the message thread nor the audio thread touches the disk.
+ *
+ * Scanners are shared: getShared() returns the one scanner for a directory,
+ * so a session with many instances of a plugin scans once.
+ */
+class PresetScanner
+{
+public:
+    struct Options
+    {
+        std::string presetDirectory;    // UTF-8
+        std::string catalogDirectory;   // where catalog files are kept
+        std::string extension;          // including the dot, e.g. ".vcpreset"
+        std::uint32_t pluginMagic = 0;  // the plugin's state magic; see PresetFileReader
+    };
+
+    /** What the last scan did. */
+    struct ScanStats
+    {
+        int numPresets = 0;
+        int numFilesRead = 0;           // new or changed presets that were opened
+        int numFilesReused = 0;         // unchanged presets taken from the previous catalog
+        int numFilesSkipped = 0;        // unreadable, or not presets for this plugin
+        bool catalogWritten = false;
+        double milliseconds = 0.0;
+    };
+
+    /** A preset read for a program change. */
+    struct LoadedPreset
+    {
+        int index = -1;                 // in the catalog it was requested from
+        std::string name;
+        std::vector<std::uint8_t> state;
+        bool loaded = false;            // false if the file was missing or invalid
+    };
+
+    /** Told when a new catalog is published. Called on the scanner's thread. */
+    struct Listener
+    {
+        virtual ~Listener() = default;
+        virtual void presetCatalogChanged() = 0;
+    };
+
+    //==============================================================================
+    /** Maps the newest existing catalog and starts a first scan. */
+    explicit PresetScanner (Options options);
+    ~PresetScanner();
+
+    /** The scanner for these options, created on first use and shared while anyone holds it. */
+    static std::shared_ptr<PresetScanner> getShared (const Options& options);
+
+    const Options& getOptions() const noexcept          { return options; }
+
+    //==============================================================================
+    /** The current catalog (possibly nullptr before the first scan ends). Any thread. */
+    std::shared_ptr<const PresetCatalog> getCatalog() const;
+
+    /** Goes up by one each time a catalog is published. */
+    int getCatalogGeneration() const noexcept           { return generationsPublished.load (std::memory_order_acquire); }
+
+    /** Asks for a scan. Requests made while one runs are merged into one more. */
+    void rescan();
+
+    /** Blocks until no scan is pending or running; for tools and benchmarks. */
+    void waitUntilIdle();
+
+    ScanStats getLastScanStats() const;
+
+    void addListener (Listener* listener);
+    void removeListener (Listener* listener);
+
+    //==============================================================================
+    /**
+     * Reads a preset of the current catalog on the scanner's thread, then
+     * calls onLoaded there with the result. Requests queue in order.
+     */
+    void requestLoad (int index, std::function<void (LoadedPreset&&)> onLoaded);
+
+    /** Reads a preset file on the calling thread. */
+    static LoadedPreset loadPresetFile (const std::string& path, std::uint32_t pluginMagic);
+
+private:
+    //==============================================================================
+    struct LoadRequest
+    {
+        std::shared_ptr<const PresetCatalog> catalog;
+        int index;
+        std::function<void (LoadedPreset&&)> onLoaded;
+    };
+
+    void run();
+    void scan();
+    bool handlePendingLoads();      // false once stopping
+    void openNewestCatalog();
+    std::string getCatalogPath (std::uint64_t generation) const;
+    void publish (std::shared_ptr<const PresetCatalog> newCatalog);
+
+    const Options options;
+
+    mutable std::mutex mutex;           // guards everything below except the atomics
+    std::condition_variable wake, idle;
+    std::shared_ptr<const PresetCatalog> catalog;
+    std::uint64_t catalogGeneration = 0;
+    std::deque<LoadRequest> loadRequests;
+    ScanStats lastScanStats;
+    bool scanRequested = true, scanning = false, stopping = false;
+
+    std::mutex listenerMutex;
+    std::vector<Listener*> listeners;
+
+    std::atomic<int> generationsPublished { 0 };
+    std::thread thread;
+
+    PresetScanner (const PresetScanner&) = delete;
+    PresetScanner& operator= (const PresetScanner&) = delete;
+};
+
+} // namespace plugindsp
@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - DSP code shared by the plugin projects
+    SubBlockScheduler - splits host blocks into fixed-size sub-blocks for
+    control-rate work, and at event positions for sample accuracy
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+
+namespace plugindsp
+{
+
+//==============================================================================
+/** One piece of a host block, as passed to SubBlockScheduler's callback. */
+struct SubBlock
+{
+    /** First sample, counted from the start of the host block. */
+    int start = 0;
+
+    /** Number of samples; never more than the sub-block size. */
+    int length = 0;
+
+    /** True if this piece starts a new fixed-size period, i.e. control-rate
+        work (parameter reads, modulation updates) is due. */
+    bool startsControlPeriod = false;
+};
+
+//==============================================================================
+/**
+ * Splits whatever block sizes the host uses into a steady grid of fixed-size
+ * sub-blocks (32 samples by default).
+ *
+ * The grid runs on across host blocks: two 20-sample blocks give pieces of
+ * 20, 12 and 8 samples, and control-rate work happens every 32 samples of
+ * audio, the same as with one 40-sample block or forty 1-sample blocks. So
+ * its cost per second doesn't depend on the host's buffer size.
+ *
+ * Pieces are also split at every event position passed in (MIDI events,
+ * parameter changes), so anything handled at the start of a piece takes
+ * effect on the exact sample.
+ *
+ * process() is inline and never allocates or locks.
+ */
+class SubBlockScheduler
+{
+public:
+    static constexpr int defaultSubBlockSize = 32;
+
+    explicit SubBlockScheduler (int subBlockSize = defaultSubBlockSize) noexcept
+    {
+        setSubBlockSize (subBlockSize);
+    }
+
+    //==============================================================================
+    /** Changes the period and restarts the grid. */
+    void setSubBlockSize (int newSubBlockSize) noexcept
+    {
+        subBlockSize = std::max (1, newSubBlockSize);
+        reset();
+    }
+
+    int getSubBlockSize() const noexcept    { return subBlockSize; }
+
+    /** Restarts the grid, so the next piece starts a control period. Call it
+        from prepareToPlay() and whenever playback jumps. */
+    void reset() noexcept                   { samplesIntoPeriod = 0; }
+
+    //==============================================================================
+    /**
+     * Calls callback (const SubBlock&) for each piece of a host block of
+     * numSamples, in order.
+     *
+     * splitPositions must be sorted; duplicates and positions outside
+     * (0, numSamples) are ignored.
+     */
+    template <typename Callback>
+    void process (int numSamples, const int* splitPositions, int numSplitPositions, Callback&& callback)
+    {
+        int position = 0;
+        int nextSplit = 0;
+
+        while (position < numSamples)
+        {
+            while (nextSplit < numSplitPositions && splitPositions[nextSplit] <= position)
+                ++nextSplit;
+
+            auto end = std::min (numSamples, position + (subBlockSize - samplesIntoPeriod));
+
+            if (nextSplit < numSplitPositions)
+                end = std::min (end, splitPositions[nextSplit]);
+
+            const SubBlock subBlock { position, end - position, samplesIntoPeriod == 0 };
+            callback (subBlock);
+
+            samplesIntoPeriod += subBlock.length;
+
+            if (samplesIntoPeriod == subBlockSize)
+                samplesIntoPeriod = 0;
+
+            position = end;
+        }
+    }
+
+private:
+    int subBlockSize = defaultSubBlockSize;
+    int samplesIntoPeriod = 0;
+};
+
+} // namespace plugindsp
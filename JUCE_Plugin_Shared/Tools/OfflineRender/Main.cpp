@@ -0,0 +1,283 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - console tools shared by the plugin projects
+    Offline render CLI - renders audio files through the plugin processor
+    that this tool is built with, faster than real time and without a host
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+#include <cmath>
+#include <iostream>
+
+// Provided by the processor sources the tool is compiled with
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+namespace
+{
+    //==============================================================================
+    void printUsage (const juce::String& executableName)
+    {
+        std::cout << "Usage: " << executableName << " [options] <input>...\n"
+                  << "\n"
+                  << "Renders WAV/AIFF files through the plugin's processBlock() without a host.\n"
+                  << "\n"
+                  << "Options:\n"
+                  << "  -o, --output <path>       Output file (one input) or directory (several inputs).\n"
+                  << "                            Default: <input>_rendered.<ext> next to each input.\n"
+                  << "  -b, --block-size <n>      Samples per processBlock() call (default 512)\n"
+                  << "  -a, --automation <csv>    Automation file: seconds,parameterID,normalisedValue\n"
+                  << "  -j, --jobs <n>            Files rendered in parallel (default: number of cores)\n"
+                  << "      --bits <16|24|32>     Output bit depth (default 24)\n"
+                  << "      --no-tail             Don't render the processor's tail\n"
+                  << "      --reference <path>    Null-test each output against a reference file (one input)\n"
+                  << "                            or the file of the same name in a directory\n"
+                  << "      --tolerance-db <dB>   Largest sample difference the null test allows (default -96)\n"
+                  << "  -h, --help                Show this message\n";
+    }
+
+    struct Options
+    {
+        juce::Array<juce::File> inputs;
+        juce::File output;
+        juce::File automation;
+        juce::File reference;
+        double toleranceDb = -96.0;
+        offline::RenderSettings settings;
+        int numJobs = juce::SystemStats::getNumCpus();
+        bool showHelp = false;
+    };
+
+    juce::Result parseOptions (const juce::StringArray& args, Options& options)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+
+            const auto nextValue = [&]() -> juce::String
+            {
+                return i + 1 < args.size() ? args[++i] : juce::String();
+            };
+
+            const auto nextInt = [&] (int minimum, int& destination)
+            {
+                const auto value = nextValue();
+                destination = value.getIntValue();
+                return value.containsOnly ("0123456789") && value.isNotEmpty() && destination >= minimum;
+            };
+
+            if (arg == "-h" || arg == "--help")
+            {
+                options.showHelp = true;
+            }
+            else if (arg == "-o" || arg == "--output")
+            {
+                options.output = juce::File::getCurrentWorkingDirectory().getChildFile (nextValue());
+            }
+            else if (arg == "-a" || arg == "--automation")
+            {
+                options.automation = juce::File::getCurrentWorkingDirectory().getChildFile (nextValue());
+            }
+            else if (arg == "-b" || arg == "--block-size")
+            {
+                if (! nextInt (1, options.settings.blockSize))
+                    return juce::Result::fail ("--block-size needs a positive number");
+            }
+            else if (arg == "-j" || arg == "--jobs")
+            {
+                if (! nextInt (1, options.numJobs))
+                    return juce::Result::fail ("--jobs needs a positive number");
+            }
+            else if (arg == "--bits")
+            {
+                auto& bits = options.settings.bitDepth;
+
+                if (! nextInt (16, bits) || (bits != 16 && bits != 24 && bits != 32))
+                    return juce::Result::fail ("--bits must be 16, 24 or 32");
+            }
+            else if (arg == "--no-tail")
+            {
+                options.settings.includeTail = false;
+            }
+            else if (arg == "--reference")
+            {
+                options.reference = juce::File::getCurrentWorkingDirectory().getChildFile (nextValue());
+            }
+            else if (arg == "--tolerance-db")
+            {
+                const auto value = nextValue();
+
+                if (value.isEmpty() || ! value.containsOnly ("0123456789.-+"))
+                    return juce::Result::fail ("--tolerance-db needs a level in dBFS, e.g. -96");
+
+                options.toleranceDb = value.getDoubleValue();
+            }
+            else if (arg.startsWith ("-"))
+            {
+                return juce::Result::fail ("Unknown option " + arg);
+            }
+            else
+            {
+                options.inputs.add (juce::File::getCurrentWorkingDirectory().getChildFile (arg));
+            }
+        }
+
+        return juce::Result::ok();
+    }
+
+    juce::Array<juce::File> getOutputFiles (const Options& options)
+    {
+        juce::Array<juce::File> outputs;
+
+        for (const auto& input : options.inputs)
+        {
+            const auto defaultName = input.getFileNameWithoutExtension() + "_rendered" + input.getFileExtension();
+
+            if (options.output == juce::File())
+                outputs.add (input.getSiblingFile (defaultName));
+            else if (options.inputs.size() == 1 && ! options.output.isDirectory())
+                outputs.add (options.output);
+            else
+                outputs.add (options.output.getChildFile (defaultName));
+        }
+
+        return outputs;
+    }
+
+    juce::File getReferenceFile (const Options& options, const juce::File& output)
+    {
+        return options.reference.isDirectory() ? options.reference.getChildFile (output.getFileName())
+                                               : options.reference;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+
+    for (int i = 1; i < argc; ++i)
+        args.add (juce::CharPointer_UTF8 (argv[i]));
+
+    const auto executableName = juce::File (juce::CharPointer_UTF8 (argv[0])).getFileName();
+
+    Options options;
+    const auto parsed = parseOptions (args, options);
+
+    if (parsed.failed())
+    {
+        std::cerr << parsed.getErrorMessage() << "\n\n";
+        printUsage (executableName);
+        return 1;
+    }
+
+    if (options.showHelp || options.inputs.isEmpty())
+    {
+        printUsage (executableName);
+        return options.showHelp ? 0 : 1;
+    }
+
+    if (options.reference != juce::File() && options.inputs.size() > 1 && ! options.reference.isDirectory())
+    {
+        std::cerr << "--reference must be a directory when rendering several files\n";
+        return 1;
+    }
+
+    std::vector<offline::AutomationEvent> automation;
+
+    if (options.automation != juce::File())
+    {
+        const auto loaded = offline::parseAutomationCsv (options.automation, automation);
+
+        if (loaded.failed())
+        {
+            std::cerr << loaded.getErrorMessage() << "\n";
+            return 1;
+        }
+    }
+
+    //==============================================================================
+    const auto outputs = getOutputFiles (options);
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    juce::CriticalSection printLock;
+
+    const auto results = offline::renderFiles ([] { return std::unique_ptr<juce::AudioProcessor> (createPluginFilter()); },
+                                               options.inputs, outputs, options.settings, automation,
+                                               options.numJobs,
+                                               [&] (const offline::RenderResult& result)
+                                               {
+                                                   const juce::ScopedLock sl (printLock);
+
+                                                   if (result.result.failed())
+                                                   {
+                                                       std::cerr << "FAILED " << result.result.getErrorMessage() << "\n";
+                                                       return;
+                                                   }
+
+                                                   std::cout << result.output.getFullPathName()
+                                                             << "  " << juce::String (result.audioSeconds, 2) << " s audio"
+                                                             << ", " << juce::String (result.getRealTimeFactor(), 1) << "x real time\n";
+                                               });
+
+    //==============================================================================
+    const auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    double audioSeconds = 0.0, processSeconds = 0.0;
+    int numFailed = 0;
+
+    for (const auto& result : results)
+    {
+        if (result.result.failed())
+        {
+            ++numFailed;
+            continue;
+        }
+
+        audioSeconds += result.audioSeconds;
+        processSeconds += result.processSeconds;
+    }
+
+    //==============================================================================
+    int numNullTestsFailed = 0;
+
+    if (options.reference != juce::File())
+    {
+        std::cout << "\n";
+
+        for (const auto& result : results)
+        {
+            if (result.result.failed())
+                continue;
+
+            const auto test = offline::nullTest (result.output, getReferenceFile (options, result.output),
+                                                 options.toleranceDb);
+
+            if (test.result.failed())
+            {
+                ++numNullTestsFailed;
+                std::cerr << "NULL TEST FAILED " << test.result.getErrorMessage() << "\n";
+                continue;
+            }
+
+            std::cout << "null test passed: " << result.output.getFileName() << "  peak difference "
+                      << (std::isfinite (test.peakDifferenceDb) ? juce::String (test.peakDifferenceDb, 1) + " dBFS"
+                                                                 : juce::String ("none"))
+                      << "\n";
+        }
+    }
+
+    std::cout << "\nRendered " << (int) results.size() - numFailed << " of " << (int) results.size() << " files"
+              << " (" << juce::String (audioSeconds, 1) << " s of audio) in " << juce::String (wallSeconds, 2) << " s\n"
+              << "processBlock real-time factor: "
+              << juce::String (processSeconds > 0.0 ? audioSeconds / processSeconds : 0.0, 1) << "x per instance, "
+              << juce::String (wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0, 1) << "x overall\n";
+
+    if (options.reference != juce::File())
+        std::cout << "null tests: " << numNullTestsFailed << " failed\n";
+
+    return numFailed == 0 && numNullTestsFailed == 0 ? 0 : 1;
+}
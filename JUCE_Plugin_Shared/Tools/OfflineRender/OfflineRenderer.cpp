@@ -0,0 +1,406 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - console tools shared by the plugin projects
+    OfflineRenderer - streams audio files through a plugin processor without
+    a host
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+
+namespace offline
+{
+
+namespace
+{
+    //==============================================================================
+    // Tails longer than this (or "infinite" ones) are not rendered
+    constexpr double maximumTailSeconds = 60.0;
+
+    /** Tries to give the processor's main buses the same channel count as the file. */
+    void matchLayoutToFile (juce::AudioProcessor& processor, int fileChannels)
+    {
+        auto layout = processor.getBusesLayout();
+        const auto channelSet = juce::AudioChannelSet::canonicalChannelSet (fileChannels);
+
+        if (channelSet.isDisabled())
+            return;
+
+        if (! layout.inputBuses.isEmpty())
+            layout.inputBuses.getReference (0) = channelSet;
+
+        if (! layout.outputBuses.isEmpty())
+            layout.outputBuses.getReference (0) = channelSet;
+
+        // If the processor can't take this layout it keeps its default one, and
+        // file channels are mapped onto it in renderFile().
+        if (processor.checkBusesLayoutSupported (layout))
+            processor.setBusesLayout (layout);
+    }
+
+    std::map<juce::String, juce::AudioProcessorParameter*> getParametersByID (juce::AudioProcessor& processor)
+    {
+        std::map<juce::String, juce::AudioProcessorParameter*> parameters;
+
+        for (auto* parameter : processor.getParameters())
+            if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter))
+                parameters[withID->paramID] = parameter;
+
+        return parameters;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> createWriter (juce::AudioFormatManager& formats,
+                                                           const juce::File& output,
+                                                           double sampleRate, int numChannels, int bitDepth,
+                                                           juce::String& error)
+    {
+        auto* format = formats.findFormatForFileExtension (output.getFileExtension());
+
+        if (format == nullptr)
+        {
+            error = "Unsupported output format: " + output.getFileName();
+            return {};
+        }
+
+        if (! output.getParentDirectory().createDirectory() || (output.exists() && ! output.deleteFile()))
+        {
+            error = "Can't write to " + output.getFullPathName();
+            return {};
+        }
+
+        std::unique_ptr<juce::OutputStream> stream (output.createOutputStream());
+
+        if (stream == nullptr)
+        {
+            error = "Can't open " + output.getFullPathName();
+            return {};
+        }
+
+        std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor (stream.get(), sampleRate,
+                                                                                  (unsigned int) numChannels,
+                                                                                  bitDepth, {}, 0));
+        if (writer == nullptr)
+        {
+            error = format->getFormatName() + " can't write " + juce::String (numChannels)
+                  + " channels at " + juce::String (bitDepth) + " bits";
+            return {};
+        }
+
+        stream.release();   // now owned by the writer
+        return writer;
+    }
+}
+
+//==============================================================================
+juce::Result parseAutomationCsv (const juce::File& file, std::vector<AutomationEvent>& events)
+{
+    if (! file.existsAsFile())
+        return juce::Result::fail ("Automation file not found: " + file.getFullPathName());
+
+    juce::StringArray lines;
+    file.readLines (lines);
+
+    events.clear();
+
+    for (int lineNumber = 0; lineNumber < lines.size(); ++lineNumber)
+    {
+        const auto line = lines[lineNumber].trim();
+
+        if (line.isEmpty() || line.startsWithChar ('#'))
+            continue;
+
+        juce::StringArray fields;
+        fields.addTokens (line, ",", "\"");
+        fields.trim();
+        fields.removeEmptyStrings (false);
+
+        const auto isNumber = [] (const juce::String& s)
+        {
+            return s.isNotEmpty() && s.containsOnly ("0123456789.-+eE");
+        };
+
+        if (fields.size() != 3 || ! isNumber (fields[0]) || ! isNumber (fields[2]))
+        {
+            // Allow a header row, but nothing else that doesn't parse
+            if (events.empty() && ! isNumber (fields[0]))
+                continue;
+
+            return juce::Result::fail (file.getFileName() + " line " + juce::String (lineNumber + 1)
+                                       + ": expected seconds,parameterID,normalisedValue");
+        }
+
+        AutomationEvent event;
+        event.timeSeconds = fields[0].getDoubleValue();
+        event.parameterID = fields[1].unquoted();
+        event.normalisedValue = juce::jlimit (0.0f, 1.0f, fields[2].getFloatValue());
+        events.push_back (event);
+    }
+
+    std::stable_sort (events.begin(), events.end(),
+                      [] (const AutomationEvent& a, const AutomationEvent& b) { return a.timeSeconds < b.timeSeconds; });
+
+    return juce::Result::ok();
+}
+
+//==============================================================================
+RenderResult renderFile (const ProcessorFactory& createProcessor,
+                         const juce::File& input, const juce::File& output,
+                         const RenderSettings& settings,
+                         const std::vector<AutomationEvent>& automation)
+{
+    RenderResult result;
+    result.input = input;
+    result.output = output;
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    const auto fail = [&] (const juce::String& message)
+    {
+        result.result = juce::Result::fail (input.getFileName() + ": " + message);
+        return result;
+    };
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (input));
+
+    if (reader == nullptr)
+        return fail ("can't read audio file");
+
+    const auto sampleRate = reader->sampleRate;
+    const auto fileChannels = (int) reader->numChannels;
+    const auto blockSize = juce::jmax (1, settings.blockSize);
+
+    //==============================================================================
+    auto processor = createProcessor();
+
+    if (processor == nullptr)
+        return fail ("couldn't create the processor");
+
+    matchLayoutToFile (*processor, fileChannels);
+    processor->setNonRealtime (true);
+    processor->setRateAndBufferSizeDetails (sampleRate, blockSize);
+    processor->prepareToPlay (sampleRate, blockSize);
+
+    const auto numInputs  = processor->getTotalNumInputChannels();
+    const auto numOutputs = processor->getTotalNumOutputChannels();
+
+    if (numOutputs <= 0)
+        return fail ("processor has no output channels");
+
+    // Resolve automation targets up front so a typo fails before rendering
+    const auto parameters = getParametersByID (*processor);
+    std::vector<juce::AudioProcessorParameter*> eventTargets;
+    eventTargets.reserve (automation.size());
+
+    for (const auto& event : automation)
+    {
+        const auto found = parameters.find (event.parameterID);
+
+        if (found == parameters.end())
+            return fail ("unknown parameter '" + event.parameterID + "' in automation");
+
+        eventTargets.push_back (found->second);
+    }
+
+    juce::String writerError;
+    auto writer = createWriter (formats, output, sampleRate, numOutputs, settings.bitDepth, writerError);
+
+    if (writer == nullptr)
+        return fail (writerError);
+
+    //==============================================================================
+    auto tailSamples = (juce::int64) 0;
+
+    if (settings.includeTail)
+    {
+        const auto tailSeconds = processor->getTailLengthSeconds();
+
+        if (tailSeconds > 0.0 && tailSeconds <= maximumTailSeconds)
+            tailSamples = (juce::int64) std::ceil (tailSeconds * sampleRate);
+    }
+
+    const auto fileLength  = reader->lengthInSamples;
+    const auto totalLength = fileLength + tailSamples;
+
+    juce::AudioBuffer<float> fileBuffer (fileChannels, blockSize);
+    juce::AudioBuffer<float> processBuffer (juce::jmax (numInputs, numOutputs), blockSize);
+    juce::MidiBuffer midi;
+
+    size_t nextEvent = 0;
+    double processMilliseconds = 0.0;
+
+    for (juce::int64 position = 0; position < totalLength; position += blockSize)
+    {
+        const auto numSamples = (int) juce::jmin ((juce::int64) blockSize, totalLength - position);
+        const auto numFromFile = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numSamples, fileLength - position);
+
+        processBuffer.setSize (processBuffer.getNumChannels(), numSamples, false, false, true);
+        processBuffer.clear();
+
+        if (numFromFile > 0)
+        {
+            reader->read (&fileBuffer, 0, numFromFile, position, true, true);
+
+            // A mono file feeds every input; extra file channels are dropped
+            for (int channel = 0; channel < numInputs; ++channel)
+                processBuffer.copyFrom (channel, 0, fileBuffer, channel % fileChannels, 0, numFromFile);
+        }
+
+        // Apply every automation event that falls inside this block
+        const auto blockEnd = (double) (position + numSamples) / sampleRate;
+
+        while (nextEvent < automation.size() && automation[nextEvent].timeSeconds < blockEnd)
+        {
+            eventTargets[nextEvent]->setValueNotifyingHost (automation[nextEvent].normalisedValue);
+            ++nextEvent;
+        }
+
+        midi.clear();
+
+        const auto processStart = juce::Time::getMillisecondCounterHiRes();
+        processor->processBlock (processBuffer, midi);
+        processMilliseconds += juce::Time::getMillisecondCounterHiRes() - processStart;
+
+        if (! writer->writeFromAudioSampleBuffer (processBuffer, 0, numSamples))
+            return fail ("error writing " + output.getFullPathName());
+    }
+
+    processor->releaseResources();
+    writer.reset();
+
+    result.audioSeconds = (double) totalLength / sampleRate;
+    result.processSeconds = processMilliseconds / 1000.0;
+    result.totalSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    return result;
+}
+
+//==============================================================================
+NullTestResult nullTest (const juce::File& rendered, const juce::File& reference, double toleranceDb)
+{
+    NullTestResult test;
+
+    const auto fail = [&] (const juce::String& message)
+    {
+        test.result = juce::Result::fail (rendered.getFileName() + ": " + message);
+        return test;
+    };
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> output (formats.createReaderFor (rendered));
+    std::unique_ptr<juce::AudioFormatReader> golden (formats.createReaderFor (reference));
+
+    if (output == nullptr)
+        return fail ("can't read the rendered file");
+
+    if (golden == nullptr)
+        return fail ("can't read reference " + reference.getFullPathName());
+
+    if (output->sampleRate != golden->sampleRate)
+        return fail ("sample rate " + juce::String (output->sampleRate) + " Hz, reference has "
+                     + juce::String (golden->sampleRate) + " Hz");
+
+    if (output->numChannels != golden->numChannels)
+        return fail (juce::String (output->numChannels) + " channels, reference has "
+                     + juce::String (golden->numChannels));
+
+    if (output->lengthInSamples != golden->lengthInSamples)
+        return fail (juce::String (output->lengthInSamples) + " samples, reference has "
+                     + juce::String (golden->lengthInSamples));
+
+    //==============================================================================
+    constexpr int blockSize = 8192;
+    const auto numChannels = (int) output->numChannels;
+
+    juce::AudioBuffer<float> outputBuffer (numChannels, blockSize);
+    juce::AudioBuffer<float> goldenBuffer (numChannels, blockSize);
+    float peakDifference = 0.0f;
+
+    for (juce::int64 position = 0; position < output->lengthInSamples; position += blockSize)
+    {
+        const auto numSamples = (int) juce::jmin ((juce::int64) blockSize, output->lengthInSamples - position);
+
+        output->read (&outputBuffer, 0, numSamples, position, true, true);
+        golden->read (&goldenBuffer, 0, numSamples, position, true, true);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* a = outputBuffer.getReadPointer (channel);
+            const auto* b = goldenBuffer.getReadPointer (channel);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto difference = std::abs (a[i] - b[i]);
+
+                if (difference > peakDifference)
+                {
+                    peakDifference = difference;
+                    test.peakDifferenceSample = position + i;
+                    test.peakDifferenceChannel = channel;
+                }
+            }
+        }
+    }
+
+    if (peakDifference > 0.0f)
+        test.peakDifferenceDb = 20.0 * std::log10 ((double) peakDifference);
+
+    if (test.peakDifferenceDb > toleranceDb)
+        return fail ("differs from the reference by " + juce::String (test.peakDifferenceDb, 1)
+                     + " dBFS at sample " + juce::String (test.peakDifferenceSample)
+                     + ", channel " + juce::String (test.peakDifferenceChannel + 1)
+                     + " (tolerance " + juce::String (toleranceDb, 1) + " dBFS)");
+
+    return test;
+}
+
+//==============================================================================
+std::vector<RenderResult> renderFiles (const ProcessorFactory& createProcessor,
+                                       const juce::Array<juce::File>& inputs,
+                                       const juce::Array<juce::File>& outputs,
+                                       const RenderSettings& settings,
+                                       const std::vector<AutomationEvent>& automation,
+                                       int numThreads,
+                                       std::function<void (const RenderResult&)> onFileFinished)
+{
+    jassert (inputs.size() == outputs.size());
+
+    std::vector<RenderResult> results ((size_t) inputs.size());
+
+    if (inputs.isEmpty())
+        return results;
+
+    juce::ThreadPool pool (juce::jlimit (1, inputs.size(), numThreads));
+    juce::WaitableEvent allFinished;
+    std::atomic<int> numRemaining { inputs.size() };
+
+    for (int i = 0; i < inputs.size(); ++i)
+    {
+        pool.addJob ([&, i]
+        {
+            auto& result = results[(size_t) i];
+            result = renderFile (createProcessor, inputs[i], outputs[i], settings, automation);
+
+            if (onFileFinished != nullptr)
+                onFileFinished (result);
+
+            if (--numRemaining == 0)
+                allFinished.signal();
+        });
+    }
+
+    allFinished.wait();
+    return results;
+}
+
+} // namespace offline
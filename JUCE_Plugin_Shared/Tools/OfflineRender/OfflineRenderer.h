@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - console tools shared by the plugin projects
+    OfflineRenderer - streams audio files through a plugin processor without
+    a host
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace offline
+{
+
+//==============================================================================
+/** One automation point: set a parameter to a normalised value at a given time. */
+struct AutomationEvent
+{
+    double timeSeconds = 0.0;
+    juce::String parameterID;
+    float normalisedValue = 0.0f;
+};
+
+/**
+ * Reads automation from a CSV file with one event per line:
+ *
+ *     seconds,parameterID,normalisedValue
+ *
+ * Blank lines, lines starting with '#' and a header line are skipped. Events
+ * are returned sorted by time (stable, so equal times keep file order).
+ */
+juce::Result parseAutomationCsv (const juce::File& file, std::vector<AutomationEvent>& events);
+
+//==============================================================================
+struct RenderSettings
+{
+    /** Samples passed to each processBlock() call. */
+    int blockSize = 512;
+
+    /** Output bit depth: 16, 24 or 32 (32 is floating point for WAV). */
+    int bitDepth = 24;
+
+    /** Keep rendering silence for the processor's reported tail length. */
+    bool includeTail = true;
+};
+
+struct RenderResult
+{
+    juce::File input, output;
+    juce::Result result = juce::Result::ok();
+
+    double audioSeconds = 0.0;      // length of the rendered audio
+    double processSeconds = 0.0;    // time spent inside processBlock()
+    double totalSeconds = 0.0;      // wall-clock time including file I/O
+
+    /** How many times faster than real time processBlock() ran. */
+    double getRealTimeFactor() const noexcept
+    {
+        return processSeconds > 0.0 ? audioSeconds / processSeconds : 0.0;
+    }
+};
+
+/** Creates a fresh processor instance for each render. */
+using ProcessorFactory = std::function<std::unique_ptr<juce::AudioProcessor>()>;
+
+//==============================================================================
+/**
+ * Streams one WAV/AIFF file through a new processor at a fixed block size and
+ * writes the result. The output format is chosen from the output file's
+ * extension.
+ *
+ * Automation events are applied at the start of the block they fall in, the
+ * same granularity a host gives a plugin that isn't sample-accurate.
+ */
+RenderResult renderFile (const ProcessorFactory& createProcessor,
+                         const juce::File& input, const juce::File& output,
+                         const RenderSettings& settings,
+                         const std::vector<AutomationEvent>& automation);
+
+/**
+ * Renders every input/output pair, running up to numThreads renders at once,
+ * each with its own processor. The callback (if any) is invoked from the
+ * worker threads as each file finishes.
+ */
+std::vector<RenderResult> renderFiles (const ProcessorFactory& createProcessor,
+                                       const juce::Array<juce::File>& inputs,
+                                       const juce::Array<juce::File>& outputs,
+                                       const RenderSettings& settings,
+                                       const std::vector<AutomationEvent>& automation,
+                                       int numThreads,
+                                       std::function<void (const RenderResult&)> onFileFinished = {});
+
+//==============================================================================
+struct NullTestResult
+{
+    juce::Result result = juce::Result::ok();
+
+    double peakDifferenceDb = -std::numeric_limits<double>::infinity();    // dBFS
+    juce::int64 peakDifferenceSample = 0;
+    int peakDifferenceChannel = 0;
+};
+
+/**
+ * Compares a rendered file with a reference ("golden") file sample by sample.
+ * It passes if they have the same sample rate, channel count and length, and
+ * no sample differs by more than toleranceDb (dBFS). Used to check a change
+ * hasn't altered the processor's output beyond what the bit depth can hold.
+ */
+NullTestResult nullTest (const juce::File& rendered, const juce::File& reference, double toleranceDb);
+
+} // namespace offline
@@ -0,0 +1,474 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - console tools shared by the plugin projects
+    ProcessorBenchmark - processBlock() latency/throughput sweeps with
+    real-time budget reporting and JSON output
+
+  ==============================================================================
+*/
+
+#include "ProcessorBenchmark.h"
+
+#include "BenchmarkUtilities.h"
+#include "GainKernels.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace benchmarks
+{
+
+//==============================================================================
+const char* getAutomationDensityName (AutomationDensity density) noexcept
+{
+    switch (density)
+    {
+        case AutomationDensity::none:        return "none";
+        case AutomationDensity::sparse:      return "sparse";
+        case AutomationDensity::everyBlock:  return "every_block";
+    }
+
+    return "unknown";
+}
+
+const char* getPrecisionName (juce::AudioProcessor::ProcessingPrecision precision) noexcept
+{
+    return precision == juce::AudioProcessor::doublePrecision ? "double" : "float";
+}
+
+//==============================================================================
+namespace
+{
+    template <typename Type>
+    bool parseList (const juce::String& text, juce::Array<Type>& destination)
+    {
+        destination.clearQuick();
+
+        for (const auto& token : juce::StringArray::fromTokens (text, ",", ""))
+        {
+            const auto value = token.trim();
+
+            if (value.isEmpty() || ! value.containsOnly ("0123456789."))
+                return false;
+
+            destination.add ((Type) value.getDoubleValue());
+        }
+
+        return ! destination.isEmpty();
+    }
+}
+
+juce::Result Options::parse (const juce::StringArray& args)
+{
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto& arg = args[i];
+        const auto nextValue = [&]() -> juce::String { return i + 1 < args.size() ? args[++i] : juce::String(); };
+
+        if (arg == "-h" || arg == "--help")
+        {
+            showHelp = true;
+        }
+        else if (arg == "--filter")
+        {
+            filter = nextValue();
+        }
+        else if (arg == "--json")
+        {
+            jsonOutput = juce::File::getCurrentWorkingDirectory().getChildFile (nextValue());
+        }
+        else if (arg == "--seconds")
+        {
+            secondsPerConfig = nextValue().getDoubleValue();
+
+            if (secondsPerConfig <= 0.0)
+                return juce::Result::fail ("--seconds needs a positive number");
+        }
+        else if (arg == "--blocks")
+        {
+            if (! parseList (nextValue(), blockSizes))
+                return juce::Result::fail ("--blocks needs a comma-separated list of block sizes");
+        }
+        else if (arg == "--channels")
+        {
+            if (! parseList (nextValue(), channelCounts))
+                return juce::Result::fail ("--channels needs a comma-separated list of channel counts");
+        }
+        else if (arg == "--rates")
+        {
+            if (! parseList (nextValue(), sampleRates))
+                return juce::Result::fail ("--rates needs a comma-separated list of sample rates");
+        }
+        else if (arg == "--precision")
+        {
+            precisions.clearQuick();
+
+            for (const auto& token : juce::StringArray::fromTokens (nextValue(), ",", ""))
+            {
+                if (token.trim() == "float")
+                    precisions.addIfNotAlreadyThere (juce::AudioProcessor::singlePrecision);
+                else if (token.trim() == "double")
+                    precisions.addIfNotAlreadyThere (juce::AudioProcessor::doublePrecision);
+                else
+                    return juce::Result::fail ("--precision needs float, double or float,double");
+            }
+
+            if (precisions.isEmpty())
+                return juce::Result::fail ("--precision needs float, double or float,double");
+        }
+        else if (arg == "--quick")
+        {
+            blockSizes = { 64, 512, 4096 };
+            sampleRates = { 48000.0 };
+            secondsPerConfig = 0.5;
+        }
+        else
+        {
+            return juce::Result::fail ("Unknown option " + arg);
+        }
+    }
+
+    return juce::Result::ok();
+}
+
+bool Options::matchesFilter (const juce::String& benchmarkName) const
+{
+    return filter.isEmpty() || benchmarkName.contains (filter);
+}
+
+void Options::printUsage (const juce::String& executableName)
+{
+    std::cout << "Usage: " << executableName << " [options]\n"
+              << "\n"
+              << "Options:\n"
+              << "  --filter <text>         Only run benchmarks whose name contains <text>\n"
+              << "  --json <file>           Write results as JSON (for diffing between commits)\n"
+              << "  --seconds <s>           Seconds of audio per configuration (default 2)\n"
+              << "  --blocks <a,b,...>      Block sizes (default 16,32,...,4096)\n"
+              << "  --channels <a,b,...>    Channel counts (default 1,2)\n"
+              << "  --rates <a,b,...>       Sample rates (default 44100,48000,96000,192000)\n"
+              << "  --precision <list>      float, double or float,double (default both)\n"
+              << "  --quick                 Short run: blocks 64,512,4096 at 48 kHz, 0.5 s each\n"
+              << "  -h, --help              Show this message\n";
+}
+
+//==============================================================================
+Report::Report (const juce::String& name)
+    : suiteName (name), context (new juce::DynamicObject())
+{
+    context->setProperty ("suite", suiteName);
+    context->setProperty ("date", juce::Time::getCurrentTime().toISO8601 (true));
+    context->setProperty ("host_name", juce::SystemStats::getComputerName());
+    context->setProperty ("cpu_model", juce::SystemStats::getCpuModel());
+    context->setProperty ("num_cpus", juce::SystemStats::getNumCpus());
+    context->setProperty ("num_physical_cpus", juce::SystemStats::getNumPhysicalCpus());
+    context->setProperty ("cpu_mhz", juce::SystemStats::getCpuSpeedInMegahertz());
+    context->setProperty ("os", juce::SystemStats::getOperatingSystemName());
+    context->setProperty ("juce_version", juce::SystemStats::getJUCEVersion());
+    context->setProperty ("simd_level", plugindsp::getSimdLevelName (plugindsp::getActiveSimdLevel()));
+   #if JUCE_DEBUG
+    context->setProperty ("build_type", "debug");
+   #else
+    context->setProperty ("build_type", "release");
+   #endif
+}
+
+void Report::add (const juce::String& benchmarkName, juce::DynamicObject::Ptr fields)
+{
+    jassert (fields != nullptr);
+
+    auto* result = new juce::DynamicObject();
+    result->setProperty ("name", benchmarkName);
+
+    juce::String line = benchmarkName.paddedRight (' ', 56);
+
+    for (const auto& field : fields->getProperties())
+    {
+        result->setProperty (field.name, field.value);
+
+        const auto& value = field.value;
+        line << "  " << field.name.toString() << "="
+             << (value.isDouble() ? juce::String ((double) value, 2) : value.toString());
+    }
+
+    results.add (juce::var (result));
+    std::cout << line << std::endl;
+}
+
+void Report::setContext (const juce::Identifier& key, const juce::var& value)
+{
+    context->setProperty (key, value);
+}
+
+juce::var Report::toJson() const
+{
+    auto* root = new juce::DynamicObject();
+    root->setProperty ("context", juce::var (context.get()));
+    root->setProperty ("benchmarks", juce::var (results));
+    return juce::var (root);
+}
+
+juce::Result Report::writeTo (const juce::File& file) const
+{
+    if (! file.replaceWithText (juce::JSON::toString (toJson())))
+        return juce::Result::fail ("Couldn't write " + file.getFullPathName());
+
+    return juce::Result::ok();
+}
+
+//==============================================================================
+BlockTimings summariseBlockTimes (std::vector<double> nanoseconds)
+{
+    const auto summary = plugindsp::bench::summarise (std::move (nanoseconds));
+
+    BlockTimings timings;
+    timings.meanNs = summary.mean;
+    timings.p50Ns = summary.p50;
+    timings.p99Ns = summary.p99;
+    timings.maxNs = summary.max;
+    timings.numBlocks = summary.count;
+    return timings;
+}
+
+void addBlockTimingFields (juce::DynamicObject& fields, const BlockTimings& timings,
+                           int blockSize, int numChannels, double sampleRate)
+{
+    // The real-time deadline for one block is its duration at this sample rate
+    const auto deadlineNs = (double) blockSize / sampleRate * 1.0e9;
+    const auto toBudgetPercent = [deadlineNs] (double ns) { return 100.0 * ns / deadlineNs; };
+
+    fields.setProperty ("ns_per_sample", timings.meanNs / (double) blockSize);
+    fields.setProperty ("ns_per_channel_sample", timings.meanNs / (double) (blockSize * juce::jmax (1, numChannels)));
+    fields.setProperty ("block_mean_ns", timings.meanNs);
+    fields.setProperty ("block_p50_ns", timings.p50Ns);
+    fields.setProperty ("block_p99_ns", timings.p99Ns);
+    fields.setProperty ("block_max_ns", timings.maxNs);
+    fields.setProperty ("budget_mean_percent", toBudgetPercent (timings.meanNs));
+    fields.setProperty ("budget_p99_percent", toBudgetPercent (timings.p99Ns));
+    fields.setProperty ("budget_max_percent", toBudgetPercent (timings.maxNs));
+    fields.setProperty ("blocks", timings.numBlocks);
+}
+
+bool setMainBusChannels (juce::AudioProcessor& processor, int numChannels)
+{
+    return setMainBusLayout (processor, juce::AudioChannelSet::canonicalChannelSet (numChannels));
+}
+
+bool setMainBusLayout (juce::AudioProcessor& processor, const juce::AudioChannelSet& channelSet)
+{
+    if (channelSet.isDisabled())
+        return false;
+
+    auto layout = processor.getBusesLayout();
+
+    if (! layout.inputBuses.isEmpty())
+        layout.inputBuses.getReference (0) = channelSet;
+
+    if (! layout.outputBuses.isEmpty())
+        layout.outputBuses.getReference (0) = channelSet;
+
+    return processor.checkBusesLayoutSupported (layout) && processor.setBusesLayout (layout);
+}
+
+//==============================================================================
+namespace
+{
+    struct SweepConfig
+    {
+        int blockSize = 512;
+        int numChannels = 2;
+        double sampleRate = 48000.0;
+        AutomationDensity automation = AutomationDensity::none;
+        juce::AudioProcessor::ProcessingPrecision precision = juce::AudioProcessor::singlePrecision;
+
+        juce::String getName (const juce::String& processorName) const
+        {
+            return processorName + "/processBlock"
+                 + "/ch:" + juce::String (numChannels)
+                 + "/sr:" + juce::String ((int) sampleRate)
+                 + "/block:" + juce::String (blockSize)
+                 + "/automation:" + getAutomationDensityName (automation)
+                 + "/precision:" + getPrecisionName (precision);
+        }
+    };
+
+    /** Times every block after the warm-up, with float or double buffers. */
+    template <typename SampleType>
+    std::vector<double> timeBlocks (juce::AudioProcessor& processor, const SweepConfig& config,
+                                    const Options& options)
+    {
+        const auto numBufferChannels = juce::jmax (processor.getTotalNumInputChannels(),
+                                                   processor.getTotalNumOutputChannels());
+
+        // Fresh input is copied in before every block (outside the timed
+        // region), so the gain never drives the signal towards denormals.
+        juce::AudioBuffer<SampleType> source (numBufferChannels, config.blockSize);
+        juce::AudioBuffer<SampleType> buffer (numBufferChannels, config.blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random (42);
+
+        for (int channel = 0; channel < numBufferChannels; ++channel)
+            for (int i = 0; i < config.blockSize; ++i)
+                source.setSample (channel, i, (SampleType) (random.nextFloat() * 2.0f - 1.0f));
+
+        juce::Array<juce::AudioProcessorParameter*> automated;
+
+        for (auto* parameter : processor.getParameters())
+            if (parameter->isAutomatable())
+                automated.add (parameter);
+
+        const auto blocksPerSecond = config.sampleRate / (double) config.blockSize;
+        const auto numBlocks = juce::jmax (100, (int) std::ceil (options.secondsPerConfig * blocksPerSecond));
+        const auto numWarmupBlocks = juce::jmax (10, numBlocks / 10);
+        const auto sparseInterval = juce::jmax (1, (int) std::round (blocksPerSecond * 0.1));
+
+        std::vector<double> blockTimes;
+        blockTimes.reserve ((size_t) numBlocks);
+
+        for (int block = 0; block < numWarmupBlocks + numBlocks; ++block)
+        {
+            const auto automateThisBlock = config.automation == AutomationDensity::everyBlock
+                                        || (config.automation == AutomationDensity::sparse && block % sparseInterval == 0);
+
+            if (automateThisBlock)
+                for (auto* parameter : automated)
+                    parameter->setValueNotifyingHost (random.nextFloat());
+
+            buffer.makeCopyOf (source, true);
+            midi.clear();
+
+            const auto start = plugindsp::bench::Clock::now();
+            processor.processBlock (buffer, midi);
+            const auto end = plugindsp::bench::Clock::now();
+
+            if (block >= numWarmupBlocks)
+                blockTimes.push_back (plugindsp::bench::nanosecondsBetween (start, end));
+        }
+
+        return blockTimes;
+    }
+
+    void runConfig (const juce::String& name, const SweepConfig& config,
+                    const ProcessorFactory& createProcessor, const Options& options, Report& report)
+    {
+        auto processor = createProcessor();
+
+        if (processor == nullptr || ! setMainBusChannels (*processor, config.numChannels))
+            return;   // layout not supported by this processor
+
+        const auto isDouble = config.precision == juce::AudioProcessor::doublePrecision;
+
+        if (isDouble && ! processor->supportsDoublePrecisionProcessing())
+            return;
+
+        // The precision has to be chosen before prepareToPlay(), as hosts do
+        processor->setProcessingPrecision (config.precision);
+        processor->setNonRealtime (false);
+        processor->setRateAndBufferSizeDetails (config.sampleRate, config.blockSize);
+        processor->prepareToPlay (config.sampleRate, config.blockSize);
+
+        auto blockTimes = isDouble ? timeBlocks<double> (*processor, config, options)
+                                   : timeBlocks<float> (*processor, config, options);
+
+        processor->releaseResources();
+
+        juce::DynamicObject::Ptr fields (new juce::DynamicObject());
+        fields->setProperty ("block_size", config.blockSize);
+        fields->setProperty ("channels", config.numChannels);
+        fields->setProperty ("sample_rate", config.sampleRate);
+        fields->setProperty ("automation", getAutomationDensityName (config.automation));
+        fields->setProperty ("precision", getPrecisionName (config.precision));
+        addBlockTimingFields (*fields, summariseBlockTimes (std::move (blockTimes)),
+                              config.blockSize, config.numChannels, config.sampleRate);
+
+        report.add (name, fields);
+    }
+}
+
+void runProcessBlockSweep (const juce::String& processorName,
+                           const ProcessorFactory& createProcessor,
+                           const Options& options, Report& report)
+{
+    for (auto numChannels : options.channelCounts)
+    {
+        for (auto sampleRate : options.sampleRates)
+        {
+            for (auto blockSize : options.blockSizes)
+            {
+                for (auto automation : options.automationDensities)
+                {
+                    for (auto precision : options.precisions)
+                    {
+                        SweepConfig config;
+                        config.blockSize = blockSize;
+                        config.numChannels = numChannels;
+                        config.sampleRate = sampleRate;
+                        config.automation = automation;
+                        config.precision = precision;
+
+                        const auto name = config.getName (processorName);
+
+                        if (options.matchesFilter (name))
+                            runConfig (name, config, createProcessor, options, report);
+                    }
+                }
+            }
+        }
+    }
+}
+
+//==============================================================================
+int runBenchmarkMain (int argc, char* argv[], const juce::String& processorName,
+                      const ProcessorFactory& createProcessor,
+                      std::function<void (const Options&, Report&)> runExtraSuites)
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+
+    for (int i = 1; i < argc; ++i)
+        args.add (juce::CharPointer_UTF8 (argv[i]));
+
+    const auto executableName = juce::File (juce::CharPointer_UTF8 (argv[0])).getFileName();
+
+    Options options;
+    const auto parsed = options.parse (args);
+
+    if (parsed.failed())
+    {
+        std::cerr << parsed.getErrorMessage() << "\n\n";
+        Options::printUsage (executableName);
+        return 1;
+    }
+
+    if (options.showHelp)
+    {
+        Options::printUsage (executableName);
+        return 0;
+    }
+
+    Report report (processorName);
+    runProcessBlockSweep (processorName, createProcessor, options, report);
+
+    if (runExtraSuites != nullptr)
+        runExtraSuites (options, report);
+
+    if (options.jsonOutput != juce::File())
+    {
+        const auto written = report.writeTo (options.jsonOutput);
+
+        if (written.failed())
+        {
+            std::cerr << written.getErrorMessage() << "\n";
+            return 1;
+        }
+
+        std::cout << "\nWrote " << report.getNumResults() << " results to "
+                  << options.jsonOutput.getFullPathName() << "\n";
+    }
+
+    return 0;
+}
+
+} // namespace benchmarks
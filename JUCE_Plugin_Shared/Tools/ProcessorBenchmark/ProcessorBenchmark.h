@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - console tools shared by the plugin projects
+    ProcessorBenchmark - processBlock() latency/throughput sweeps with
+    real-time budget reporting and JSON output
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace benchmarks
+{
+
+//==============================================================================
+/** Creates a fresh processor instance for each benchmark configuration. */
+using ProcessorFactory = std::function<std::unique_ptr<juce::AudioProcessor>()>;
+
+/** How often the host changes parameter values during a run. */
+enum class AutomationDensity
+{
+    none,           // parameters never change
+    sparse,         // every automatable parameter changes every 100 ms
+    everyBlock      // every automatable parameter changes before every block
+};
+
+const char* getAutomationDensityName (AutomationDensity density) noexcept;
+
+/** "float" or "double", as used in benchmark names. */
+const char* getPrecisionName (juce::AudioProcessor::ProcessingPrecision precision) noexcept;
+
+//==============================================================================
+/** Command-line options shared by all the benchmark apps. */
+struct Options
+{
+    juce::Array<int> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    juce::Array<int> channelCounts { 1, 2 };
+    juce::Array<double> sampleRates { 44100.0, 48000.0, 96000.0, 192000.0 };
+    juce::Array<AutomationDensity> automationDensities { AutomationDensity::none,
+                                                         AutomationDensity::sparse,
+                                                         AutomationDensity::everyBlock };
+
+    /** Sample types to run; double is skipped for processors that don't support it. */
+    juce::Array<juce::AudioProcessor::ProcessingPrecision> precisions { juce::AudioProcessor::singlePrecision,
+                                                                        juce::AudioProcessor::doublePrecision };
+
+    /** Seconds of audio processed per configuration (after warm-up). */
+    double secondsPerConfig = 2.0;
+
+    /** Only benchmarks whose name contains this string are run. */
+    juce::String filter;
+
+    /** If set, results are written here as JSON. */
+    juce::File jsonOutput;
+
+    bool showHelp = false;
+
+    /** Parses the arguments (without the executable name). */
+    juce::Result parse (const juce::StringArray& args);
+
+    bool matchesFilter (const juce::String& benchmarkName) const;
+
+    static void printUsage (const juce::String& executableName);
+};
+
+//==============================================================================
+/**
+ * Collects benchmark results, prints each one as it arrives and writes them
+ * out in a Google-Benchmark-like JSON layout:
+ *
+ *     { "context": { ... }, "benchmarks": [ { "name": ..., ... }, ... ] }
+ *
+ * so that runs from different commits can be diffed.
+ */
+class Report
+{
+public:
+    explicit Report (const juce::String& suiteName);
+
+    /** Adds a result. The fields object should hold plain numbers and strings. */
+    void add (const juce::String& benchmarkName, juce::DynamicObject::Ptr fields);
+
+    /** Adds a field to the "context" section, e.g. a build option. */
+    void setContext (const juce::Identifier& key, const juce::var& value);
+
+    juce::var toJson() const;
+    juce::Result writeTo (const juce::File& file) const;
+
+    int getNumResults() const noexcept   { return results.size(); }
+
+private:
+    juce::String suiteName;
+    juce::DynamicObject::Ptr context;
+    juce::Array<juce::var> results;
+
+    JUCE_DECLARE_NON_COPYABLE (Report)
+};
+
+//==============================================================================
+/** Timing statistics for a list of per-block durations. */
+struct BlockTimings
+{
+    double meanNs = 0.0, p50Ns = 0.0, p99Ns = 0.0, maxNs = 0.0;
+    int numBlocks = 0;
+};
+
+BlockTimings summariseBlockTimes (std::vector<double> nanoseconds);
+
+/**
+ * Adds the standard per-block fields (ns/sample, p50/p99/max block time and
+ * the share of the real-time deadline used) to a result object.
+ */
+void addBlockTimingFields (juce::DynamicObject& fields, const BlockTimings& timings,
+                           int blockSize, int numChannels, double sampleRate);
+
+/**
+ * Tries to set both main buses to the given channel count.
+ * Returns false if the processor doesn't support it.
+ */
+bool setMainBusChannels (juce::AudioProcessor& processor, int numChannels);
+
+/** As setMainBusChannels(), with a specific layout (e.g. 7.1.4 or ambisonics). */
+bool setMainBusLayout (juce::AudioProcessor& processor, const juce::AudioChannelSet& channelSet);
+
+//==============================================================================
+/**
+ * Runs processBlock() for every combination of block size, channel count,
+ * sample rate, automation density and precision in the options.
+ * Configurations whose channel count or precision the processor rejects are
+ * skipped.
+ */
+void runProcessBlockSweep (const juce::String& processorName,
+                           const ProcessorFactory& createProcessor,
+                           const Options& options, Report& report);
+
+/** Parses the command line, runs the processBlock sweep and writes the report. */
+int runBenchmarkMain (int argc, char* argv[], const juce::String& processorName,
+                      const ProcessorFactory& createProcessor,
+                      std::function<void (const Options&, Report&)> runExtraSuites = {});
+
+} // namespace benchmarks
@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - processor tests
+    ProcessorTests - helpers for a plugin's Catch2 tests: processBlock()
+    under the real-time checker, and null tests against reference renders
+
+  ==============================================================================
+*/
+
+#include "ProcessorTests.h"
+
+#include <cmath>
+
+namespace processortests
+{
+
+namespace
+{
+    /** Fills the buffer with a -6 dBFS tone, a different frequency per channel. */
+    template <typename SampleType>
+    void fillTestTone (juce::AudioBuffer<SampleType>& buffer, double sampleRate, juce::int64 position)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            const auto frequency = 440.0 * (1.0 + 0.5 * channel);
+            auto* data = buffer.getWritePointer (channel);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                data[i] = (SampleType) (0.5 * std::sin (juce::MathConstants<double>::twoPi * frequency
+                                                        * (double) (position + i) / sampleRate));
+        }
+    }
+
+    template <typename SampleType>
+    rtcheck::Report runBlocks (juce::AudioProcessor& processor, const BlockSettings& settings)
+    {
+        // Everything a host would allocate up front, before the first check
+        const auto numChannels = juce::jmax (processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+        juce::AudioBuffer<SampleType> buffer (numChannels, settings.blockSize);
+        juce::MidiBuffer midi;
+        midi.ensureSize (4096);
+
+        rtcheck::Report report;
+
+        for (int block = 0; block < settings.numBlocks; ++block)
+        {
+            fillTestTone (buffer, settings.sampleRate, (juce::int64) block * settings.blockSize);
+            midi.clear();
+
+            if (settings.beforeBlock != nullptr)
+                settings.beforeBlock (block, midi);
+
+            const rtcheck::ScopedRealtimeCheck check;
+
+            if (settings.onAudioThread != nullptr)
+                settings.onAudioThread (block);
+
+            processor.processBlock (buffer, midi);
+            report.add (check.getReport());
+        }
+
+        return report;
+    }
+}
+
+//==============================================================================
+rtcheck::Report runBlocksUnderCheck (juce::AudioProcessor& processor, const BlockSettings& settings)
+{
+    const auto useDouble = settings.precision == juce::AudioProcessor::doublePrecision
+                            && processor.supportsDoublePrecisionProcessing();
+
+    processor.setProcessingPrecision (useDouble ? juce::AudioProcessor::doublePrecision
+                                                : juce::AudioProcessor::singlePrecision);
+    processor.setRateAndBufferSizeDetails (settings.sampleRate, settings.blockSize);
+    processor.prepareToPlay (settings.sampleRate, settings.blockSize);
+
+    const auto report = useDouble ? runBlocks<double> (processor, settings)
+                                  : runBlocks<float> (processor, settings);
+
+    processor.releaseResources();
+    return report;
+}
+
+//==============================================================================
+juce::AudioProcessorParameter* findParameter (juce::AudioProcessor& processor, const juce::String& parameterID)
+{
+    for (auto* parameter : processor.getParameters())
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter))
+            if (withID->paramID == parameterID)
+                return parameter;
+
+    return nullptr;
+}
+
+offline::ProcessorFactory withParameterValues (offline::ProcessorFactory createProcessor,
+                                               std::vector<ParameterValue> values)
+{
+    return [createProcessor = std::move (createProcessor), values = std::move (values)]() -> std::unique_ptr<juce::AudioProcessor>
+    {
+        auto processor = createProcessor();
+
+        if (processor == nullptr)
+            return {};
+
+        for (const auto& value : values)
+        {
+            auto* parameter = findParameter (*processor, value.parameterID);
+
+            if (parameter == nullptr)
+                return {};
+
+            parameter->setValueNotifyingHost (value.normalisedValue);
+        }
+
+        return processor;
+    };
+}
+
+offline::NullTestResult renderAndNullTest (const offline::ProcessorFactory& createProcessor,
+                                           const juce::File& input, const juce::File& reference,
+                                           double toleranceDb, int blockSize)
+{
+    const juce::TemporaryFile rendered (".wav");
+
+    offline::RenderSettings settings;
+    settings.blockSize = blockSize;
+    settings.bitDepth = 32;
+
+    const auto render = offline::renderFile (createProcessor, input, rendered.getFile(), settings, {});
+
+    if (render.result.failed())
+    {
+        offline::NullTestResult failed;
+        failed.result = render.result;
+        return failed;
+    }
+
+    return offline::nullTest (rendered.getFile(), reference, toleranceDb);
+}
+
+} // namespace processortests
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - processor tests
+    ProcessorTests - helpers for a plugin's Catch2 tests: processBlock()
+    under the real-time checker, and null tests against reference renders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OfflineRenderer.h"
+#include "RealtimeChecks.h"
+
+#include <functional>
+#include <vector>
+
+namespace processortests
+{
+
+//==============================================================================
+struct BlockSettings
+{
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+    int numBlocks = 200;
+
+    /** Double precision is only used if the processor supports it. */
+    juce::AudioProcessor::ProcessingPrecision precision = juce::AudioProcessor::singlePrecision;
+
+    /**
+     * Called before each block, outside the check, as a host's message
+     * thread or the host itself would: change parameters, load a state, or
+     * add MIDI events to the (already cleared) buffer.
+     */
+    std::function<void (int block, juce::MidiBuffer& midi)> beforeBlock;
+
+    /**
+     * Called before each block inside the check, for calls a host makes on
+     * the audio thread, such as setCurrentProgram(): they're held to the
+     * same rules as processBlock().
+     */
+    std::function<void (int block)> onAudioThread;
+};
+
+/**
+ * Prepares the processor and runs numBlocks blocks of a stereo test tone
+ * through it, each processBlock() call inside an rtcheck::ScopedRealtimeCheck.
+ * Returns what every call did together: a real-time safe processor's report
+ * is clean.
+ */
+rtcheck::Report runBlocksUnderCheck (juce::AudioProcessor& processor, const BlockSettings& settings);
+
+//==============================================================================
+/** The parameter with this ID, or nullptr. */
+juce::AudioProcessorParameter* findParameter (juce::AudioProcessor& processor, const juce::String& parameterID);
+
+/** A parameter value, set before the processor is prepared. */
+struct ParameterValue
+{
+    juce::String parameterID;
+    float normalisedValue = 0.0f;
+};
+
+/**
+ * Wraps a processor factory so every processor it creates starts with these
+ * parameter values. They're set before prepareToPlay(), so there's no
+ * smoothing ramp from the defaults at the start of a render. The factory
+ * returns nullptr if a parameter ID doesn't exist.
+ */
+offline::ProcessorFactory withParameterValues (offline::ProcessorFactory createProcessor,
+                                               std::vector<ParameterValue> values);
+
+/**
+ * Renders the input through a new processor to a temporary 32-bit float WAV
+ * file and null-tests it against the reference (see offline::nullTest()).
+ * A failed render is returned as a failed result.
+ */
+offline::NullTestResult renderAndNullTest (const offline::ProcessorFactory& createProcessor,
+                                           const juce::File& input, const juce::File& reference,
+                                           double toleranceDb, int blockSize = 512);
+
+} // namespace processortests
@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - processor tests
+    TestMain - Catch2 entry point for a plugin's test executable, with JUCE
+    initialised for the whole run
+
+  ==============================================================================
+*/
+
+#define CATCH_CONFIG_RUNNER
+#include <catch2/catch.hpp>
+
+#include <juce_events/juce_events.h>
+
+int main (int argc, char* argv[])
+{
+    // Processors create parameters, timers and listeners that expect a
+    // message manager, as they would in a host
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    return Catch::Session().run (argc, argv);
+}
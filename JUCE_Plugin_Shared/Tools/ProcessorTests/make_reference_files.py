@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+#
+# JUCE Plugin Shared - processor tests
+# Writes the small input files the processor tests render, and reference
+# renders of them for a given gain per channel. Only the standard library is
+# used, and the output is deterministic, so the files can be regenerated
+# byte for byte.
+#
+#   make_reference_files.py inputs <dir>
+#       writes <dir>/sine.wav and <dir>/noise_burst.wav: 0.1 s of 16-bit
+#       stereo at 48 kHz
+#
+#   make_reference_files.py reference <input.wav> <output.wav> <gain>...
+#       writes the input times a linear gain per channel (the last gain is
+#       repeated for any further channels) as 32-bit float
+#
+# The gains are what the processor should do at the test's parameter values,
+# worked out from its documented behaviour rather than from a render, so a
+# reference can't inherit a bug from the code it checks.
+
+import math
+import struct
+import sys
+
+SAMPLE_RATE = 48000
+NUM_FRAMES = 4800   # 0.1 s: ten blocks of 512, the last one partial
+
+
+def write_wav(path, channels, bits):
+    """channels: one list of samples per channel, in [-1, 1)."""
+    num_channels = len(channels)
+    num_frames = len(channels[0])
+
+    if bits == 16:
+        format_tag, pack = 1, lambda x: struct.pack('<h', max(-32768, min(32767, int(round(x * 32768.0)))))
+    else:
+        format_tag, pack = 3, lambda x: struct.pack('<f', x)
+
+    block_align = num_channels * bits // 8
+    data = b''.join(pack(channels[c][i]) for i in range(num_frames) for c in range(num_channels))
+
+    with open(path, 'wb') as f:
+        f.write(b'RIFF' + struct.pack('<I', 36 + len(data)) + b'WAVE')
+        f.write(b'fmt ' + struct.pack('<IHHIIHH', 16, format_tag, num_channels, SAMPLE_RATE,
+                                      SAMPLE_RATE * block_align, block_align, bits))
+        f.write(b'data' + struct.pack('<I', len(data)) + data)
+
+
+def read_wav16(path):
+    with open(path, 'rb') as f:
+        riff = f.read()
+
+    position = 12
+    num_channels = None
+
+    while position < len(riff):
+        chunk_id, size = riff[position:position + 4], struct.unpack('<I', riff[position + 4:position + 8])[0]
+        body = riff[position + 8:position + 8 + size]
+
+        if chunk_id == b'fmt ':
+            format_tag, num_channels, _, _, _, bits = struct.unpack('<HHIIHH', body[:16])
+
+            if format_tag != 1 or bits != 16:
+                sys.exit(path + ': expected 16-bit PCM')
+        elif chunk_id == b'data':
+            samples = struct.unpack('<%dh' % (size // 2), body)
+            return [[s / 32768.0 for s in samples[c::num_channels]] for c in range(num_channels)]
+
+        position += 8 + size + (size & 1)
+
+    sys.exit(path + ': no data chunk')
+
+
+def make_inputs(directory):
+    # A different frequency per channel, so a swapped or shared channel shows up
+    sine = [[0.5 * math.sin(2.0 * math.pi * frequency * i / SAMPLE_RATE) for i in range(NUM_FRAMES)]
+            for frequency in (440.0, 660.0)]
+    write_wav(directory + '/sine.wav', sine, 16)
+
+    # 20 ms of silence, 50 ms of white noise at -12 dBFS peak, then silence.
+    # A fixed linear congruential generator, so every platform writes the same file.
+    state = 12345
+    noise = [[], []]
+
+    for i in range(NUM_FRAMES):
+        for channel in noise:
+            state = (state * 1103515245 + 12345) % (1 << 31)
+            value = (state / float(1 << 30) - 1.0) * 0.25
+            channel.append(value if 960 <= i < 3360 else 0.0)
+
+    write_wav(directory + '/noise_burst.wav', noise, 16)
+
+
+def make_reference(input_path, output_path, gains):
+    channels = read_wav16(input_path)
+    gains = gains + [gains[-1]] * (len(channels) - len(gains))
+    write_wav(output_path, [[x * gain for x in channel] for channel, gain in zip(channels, gains)], 32)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) == 3 and sys.argv[1] == 'inputs':
+        make_inputs(sys.argv[2])
+    elif len(sys.argv) >= 5 and sys.argv[1] == 'reference':
+        make_reference(sys.argv[2], sys.argv[3], [float(g) for g in sys.argv[4:]])
+    else:
+        sys.exit('usage: make_reference_files.py inputs <dir>\n'
+                 '       make_reference_files.py reference <input.wav> <output.wav> <gain>...')
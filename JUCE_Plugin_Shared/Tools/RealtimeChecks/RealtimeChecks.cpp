@@ -0,0 +1,650 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - test tools shared by the plugin projects
+    RealtimeChecks - catches allocations, locks and blocking system calls
+    made by code that must be real-time safe, for the test executables
+
+  ==============================================================================
+*/
+
+// The interposed functions below must be plain declarations, not the
+// inline checking wrappers fortified builds put in their place
+#undef _FORTIFY_SOURCE
+
+#include "RealtimeChecks.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined (__has_feature)
+ #if __has_feature (address_sanitizer) || __has_feature (thread_sanitizer) || __has_feature (memory_sanitizer)
+  #define RTCHECK_SANITIZER 1
+ #endif
+#endif
+
+#if defined (__SANITIZE_ADDRESS__) || defined (__SANITIZE_THREAD__)
+ #define RTCHECK_SANITIZER 1
+#endif
+
+#ifndef RTCHECK_SANITIZER
+ #define RTCHECK_SANITIZER 0
+#endif
+
+// With glibc the C allocator and the blocking calls can be interposed:
+// definitions in the executable take precedence over the C library's, which
+// are still reachable (the allocator through its __libc_ names, the rest
+// through dlsym). Sanitizer runtimes interpose the same functions, so they
+// are left alone there.
+#if defined (__linux__) && defined (__GLIBC__) && ! RTCHECK_SANITIZER
+ #define RTCHECK_INTERPOSE 1
+#else
+ #define RTCHECK_INTERPOSE 0
+#endif
+
+#if RTCHECK_INTERPOSE
+ #include <cstdarg>
+ #include <dlfcn.h>
+ #include <fcntl.h>
+ #include <malloc.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <time.h>
+ #include <unistd.h>
+#endif
+
+namespace rtcheck
+{
+
+namespace
+{
+    //==============================================================================
+    // Plain data, so every thread's copy is zero-initialised without a guard
+    // or an allocation (this is read inside malloc)
+    struct RecordedCall
+    {
+        int kind;
+        const char* function;
+        std::size_t bytes;
+    };
+
+    struct ThreadState
+    {
+        int depth;          // open checks on this thread
+        int busy;           // set while recording, so recording can't recurse
+        int counts[numViolationKinds];
+        RecordedCall recorded[Report::maxRecorded];
+        int numRecorded;
+    };
+
+    thread_local ThreadState threadState;
+
+    std::atomic<bool> abortOnViolation { false };
+
+    void writeToStandardError (const char* text) noexcept;
+
+    void record (ViolationKind kind, const char* function, std::size_t bytes = 0) noexcept
+    {
+        auto& state = threadState;
+
+        if (state.depth == 0 || state.busy != 0)
+            return;
+
+        state.busy = 1;
+        ++state.counts[(int) kind];
+
+        if (state.numRecorded < Report::maxRecorded)
+            state.recorded[state.numRecorded++] = { (int) kind, function, bytes };
+
+        if (abortOnViolation.load (std::memory_order_relaxed))
+        {
+            // Formatted into a fixed buffer: nothing here may allocate
+            char message[160];
+            std::snprintf (message, sizeof (message), "rtcheck: %s in a real-time check (%s, %zu bytes); aborting\n",
+                           getViolationKindName (kind), function, bytes);
+            writeToStandardError (message);
+            std::abort();
+        }
+
+        state.busy = 0;
+    }
+
+    Report getThreadReport() noexcept
+    {
+        const auto& state = threadState;
+        Report report;
+
+        for (int i = 0; i < numViolationKinds; ++i)
+            report.counts[(size_t) i] = state.counts[i];
+
+        for (int i = 0; i < state.numRecorded; ++i)
+            report.firstViolations[(size_t) i] = { (ViolationKind) state.recorded[i].kind,
+                                                   state.recorded[i].function,
+                                                   state.recorded[i].bytes };
+
+        report.numRecorded = state.numRecorded;
+        return report;
+    }
+
+    void setThreadReport (const Report& report) noexcept
+    {
+        auto& state = threadState;
+
+        for (int i = 0; i < numViolationKinds; ++i)
+            state.counts[i] = report.counts[(size_t) i];
+
+        for (int i = 0; i < report.numRecorded; ++i)
+        {
+            const auto& violation = report.firstViolations[(size_t) i];
+            state.recorded[i] = { (int) violation.kind, violation.function, violation.bytes };
+        }
+
+        state.numRecorded = report.numRecorded;
+    }
+}
+
+//==============================================================================
+const char* getViolationKindName (ViolationKind kind) noexcept
+{
+    switch (kind)
+    {
+        case ViolationKind::allocation:     return "allocation";
+        case ViolationKind::deallocation:   return "deallocation";
+        case ViolationKind::lock:           return "lock";
+        case ViolationKind::wait:           return "wait";
+        case ViolationKind::sleep:          return "sleep";
+        case ViolationKind::fileIO:         return "file I/O";
+        case ViolationKind::threadCreation: return "thread creation";
+    }
+
+    return "unknown";
+}
+
+int Report::getTotal() const noexcept
+{
+    int total = 0;
+
+    for (const auto count : counts)
+        total += count;
+
+    return total;
+}
+
+void Report::add (const Report& other) noexcept
+{
+    for (size_t i = 0; i < counts.size(); ++i)
+        counts[i] += other.counts[i];
+
+    for (int i = 0; i < other.numRecorded && numRecorded < maxRecorded; ++i)
+        firstViolations[(size_t) numRecorded++] = other.firstViolations[(size_t) i];
+
+    numChecks += other.numChecks;
+}
+
+std::string Report::describe() const
+{
+    if (isClean())
+        return "clean";
+
+    std::string text;
+
+    for (int i = 0; i < numViolationKinds; ++i)
+    {
+        if (counts[(size_t) i] == 0)
+            continue;
+
+        if (! text.empty())
+            text += ", ";
+
+        const auto kind = (ViolationKind) i;
+        text += std::to_string (counts[(size_t) i]) + " " + getViolationKindName (kind);
+
+        if (counts[(size_t) i] > 1 && kind != ViolationKind::fileIO)
+            text += "s";
+    }
+
+    text += " (first:";
+
+    for (int i = 0; i < numRecorded; ++i)
+    {
+        const auto& violation = firstViolations[(size_t) i];
+        text += std::string (i > 0 ? ", " : " ") + violation.function;
+
+        if (violation.kind == ViolationKind::allocation)
+            text += " " + std::to_string (violation.bytes) + " bytes";
+    }
+
+    return text + ")";
+}
+
+//==============================================================================
+ScopedRealtimeCheck::ScopedRealtimeCheck() noexcept
+    : saved (getThreadReport())
+{
+    setThreadReport ({});
+    ++threadState.depth;
+}
+
+ScopedRealtimeCheck::~ScopedRealtimeCheck()
+{
+    // The enclosing check sees what this one caught, too
+    auto outer = saved;
+    outer.add (getThreadReport());
+    --threadState.depth;
+    setThreadReport (outer);
+}
+
+Report ScopedRealtimeCheck::getReport() const noexcept
+{
+    auto report = getThreadReport();
+    report.numChecks = 1;
+    return report;
+}
+
+bool canDetectCAllocations() noexcept   { return RTCHECK_INTERPOSE != 0; }
+bool canDetectSystemCalls() noexcept    { return RTCHECK_INTERPOSE != 0; }
+
+void setAbortOnViolation (bool shouldAbort) noexcept
+{
+    abortOnViolation.store (shouldAbort, std::memory_order_relaxed);
+}
+
+} // namespace rtcheck
+
+#if RTCHECK_INTERPOSE
+//==============================================================================
+// The C library's own allocator entry points
+extern "C"
+{
+    void* __libc_malloc (std::size_t);
+    void* __libc_calloc (std::size_t, std::size_t);
+    void* __libc_realloc (void*, std::size_t);
+    void* __libc_memalign (std::size_t, std::size_t);
+    void __libc_free (void*);
+}
+
+namespace rtcheck
+{
+namespace
+{
+    /** The next definition of a function after this executable's, looked up once. */
+    template <typename Function>
+    Function getNext (std::atomic<void*>& cache, const char* name) noexcept
+    {
+        auto* function = cache.load (std::memory_order_relaxed);
+
+        if (function == nullptr)
+        {
+            function = dlsym (RTLD_NEXT, name);
+            cache.store (function, std::memory_order_relaxed);
+        }
+
+        return reinterpret_cast<Function> (function);
+    }
+
+    #define RTCHECK_NEXT(name) \
+        ::rtcheck::getNext<decltype (&::name)> (::rtcheck::next::name, #name)
+
+    namespace next
+    {
+        std::atomic<void*> pthread_mutex_lock, pthread_rwlock_rdlock, pthread_rwlock_wrlock,
+                           pthread_cond_wait, pthread_cond_timedwait, sem_wait, pthread_join,
+                           nanosleep, usleep, sleep,
+                           open, open64, openat, read, write, close, fsync, fopen, fopen64, fread, fwrite,
+                           pthread_create;
+    }
+
+    /** Looks everything up at startup: dlsym itself may allocate. */
+    struct ResolveAtStartup
+    {
+        ResolveAtStartup() noexcept
+        {
+            RTCHECK_NEXT (pthread_mutex_lock);
+            RTCHECK_NEXT (pthread_rwlock_rdlock);
+            RTCHECK_NEXT (pthread_rwlock_wrlock);
+            RTCHECK_NEXT (pthread_cond_wait);
+            RTCHECK_NEXT (pthread_cond_timedwait);
+            RTCHECK_NEXT (sem_wait);
+            RTCHECK_NEXT (pthread_join);
+            RTCHECK_NEXT (nanosleep);
+            RTCHECK_NEXT (usleep);
+            RTCHECK_NEXT (sleep);
+            RTCHECK_NEXT (open);
+            RTCHECK_NEXT (open64);
+            RTCHECK_NEXT (openat);
+            RTCHECK_NEXT (read);
+            RTCHECK_NEXT (write);
+            RTCHECK_NEXT (close);
+            RTCHECK_NEXT (fsync);
+            RTCHECK_NEXT (fopen);
+            RTCHECK_NEXT (fopen64);
+            RTCHECK_NEXT (fread);
+            RTCHECK_NEXT (fwrite);
+            RTCHECK_NEXT (pthread_create);
+        }
+    };
+
+    const ResolveAtStartup resolveAtStartup;
+
+    void writeToStandardError (const char* text) noexcept
+    {
+        RTCHECK_NEXT (write) (STDERR_FILENO, text, std::strlen (text));
+    }
+
+    mode_t getMode (int flags, va_list& args) noexcept
+    {
+        return (flags & (O_CREAT | O_TMPFILE)) != 0 ? (mode_t) va_arg (args, unsigned int) : (mode_t) 0;
+    }
+}
+}
+
+using rtcheck::ViolationKind;
+using rtcheck::record;
+
+//==============================================================================
+// Allocation (operator new and delete end up here too)
+extern "C"
+{
+    void* malloc (std::size_t size) __THROW
+    {
+        record (ViolationKind::allocation, "malloc", size);
+        return __libc_malloc (size);
+    }
+
+    void* calloc (std::size_t count, std::size_t size) __THROW
+    {
+        record (ViolationKind::allocation, "calloc", count * size);
+        return __libc_calloc (count, size);
+    }
+
+    void* realloc (void* pointer, std::size_t size) __THROW
+    {
+        record (ViolationKind::allocation, "realloc", size);
+        return __libc_realloc (pointer, size);
+    }
+
+    void free (void* pointer) __THROW
+    {
+        if (pointer != nullptr)
+            record (ViolationKind::deallocation, "free");
+
+        __libc_free (pointer);
+    }
+
+    void* memalign (std::size_t alignment, std::size_t size) __THROW
+    {
+        record (ViolationKind::allocation, "memalign", size);
+        return __libc_memalign (alignment, size);
+    }
+
+    void* aligned_alloc (std::size_t alignment, std::size_t size) __THROW
+    {
+        record (ViolationKind::allocation, "aligned_alloc", size);
+        return __libc_memalign (alignment, size);
+    }
+
+    int posix_memalign (void** result, std::size_t alignment, std::size_t size) __THROW
+    {
+        record (ViolationKind::allocation, "posix_memalign", size);
+
+        if (alignment < sizeof (void*) || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+
+        *result = __libc_memalign (alignment, size);
+        return *result != nullptr || size == 0 ? 0 : ENOMEM;
+    }
+
+    //==============================================================================
+    // Locks and waits
+    int pthread_mutex_lock (pthread_mutex_t* mutex) __THROWNL
+    {
+        record (ViolationKind::lock, "pthread_mutex_lock");
+        return RTCHECK_NEXT (pthread_mutex_lock) (mutex);
+    }
+
+    int pthread_rwlock_rdlock (pthread_rwlock_t* lock) __THROWNL
+    {
+        record (ViolationKind::lock, "pthread_rwlock_rdlock");
+        return RTCHECK_NEXT (pthread_rwlock_rdlock) (lock);
+    }
+
+    int pthread_rwlock_wrlock (pthread_rwlock_t* lock) __THROWNL
+    {
+        record (ViolationKind::lock, "pthread_rwlock_wrlock");
+        return RTCHECK_NEXT (pthread_rwlock_wrlock) (lock);
+    }
+
+    int pthread_cond_wait (pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        record (ViolationKind::wait, "pthread_cond_wait");
+        return RTCHECK_NEXT (pthread_cond_wait) (condition, mutex);
+    }
+
+    int pthread_cond_timedwait (pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time)
+    {
+        record (ViolationKind::wait, "pthread_cond_timedwait");
+        return RTCHECK_NEXT (pthread_cond_timedwait) (condition, mutex, time);
+    }
+
+    int sem_wait (sem_t* semaphore)
+    {
+        record (ViolationKind::wait, "sem_wait");
+        return RTCHECK_NEXT (sem_wait) (semaphore);
+    }
+
+    int pthread_join (pthread_t thread, void** result)
+    {
+        record (ViolationKind::wait, "pthread_join");
+        return RTCHECK_NEXT (pthread_join) (thread, result);
+    }
+
+    int pthread_create (pthread_t* thread, const pthread_attr_t* attributes, void* (*function) (void*), void* argument) __THROWNL
+    {
+        record (ViolationKind::threadCreation, "pthread_create");
+        return RTCHECK_NEXT (pthread_create) (thread, attributes, function, argument);
+    }
+
+    //==============================================================================
+    // Sleeps
+    int nanosleep (const struct timespec* duration, struct timespec* remaining)
+    {
+        record (ViolationKind::sleep, "nanosleep");
+        return RTCHECK_NEXT (nanosleep) (duration, remaining);
+    }
+
+    int usleep (useconds_t microseconds)
+    {
+        record (ViolationKind::sleep, "usleep");
+        return RTCHECK_NEXT (usleep) (microseconds);
+    }
+
+    unsigned int sleep (unsigned int seconds)
+    {
+        record (ViolationKind::sleep, "sleep");
+        return RTCHECK_NEXT (sleep) (seconds);
+    }
+
+    //==============================================================================
+    // File I/O
+    int open (const char* path, int flags, ...)
+    {
+        va_list args;
+        va_start (args, flags);
+        const auto mode = rtcheck::getMode (flags, args);
+        va_end (args);
+
+        record (ViolationKind::fileIO, "open");
+        return RTCHECK_NEXT (open) (path, flags, mode);
+    }
+
+    int open64 (const char* path, int flags, ...)
+    {
+        va_list args;
+        va_start (args, flags);
+        const auto mode = rtcheck::getMode (flags, args);
+        va_end (args);
+
+        record (ViolationKind::fileIO, "open64");
+        return RTCHECK_NEXT (open64) (path, flags, mode);
+    }
+
+    int openat (int directory, const char* path, int flags, ...)
+    {
+        va_list args;
+        va_start (args, flags);
+        const auto mode = rtcheck::getMode (flags, args);
+        va_end (args);
+
+        record (ViolationKind::fileIO, "openat");
+        return RTCHECK_NEXT (openat) (directory, path, flags, mode);
+    }
+
+    ssize_t read (int file, void* buffer, std::size_t size)
+    {
+        record (ViolationKind::fileIO, "read");
+        return RTCHECK_NEXT (read) (file, buffer, size);
+    }
+
+    ssize_t write (int file, const void* buffer, std::size_t size)
+    {
+        record (ViolationKind::fileIO, "write");
+        return RTCHECK_NEXT (write) (file, buffer, size);
+    }
+
+    int close (int file)
+    {
+        record (ViolationKind::fileIO, "close");
+        return RTCHECK_NEXT (close) (file);
+    }
+
+    int fsync (int file)
+    {
+        record (ViolationKind::fileIO, "fsync");
+        return RTCHECK_NEXT (fsync) (file);
+    }
+
+    FILE* fopen (const char* __restrict path, const char* __restrict mode)
+    {
+        record (ViolationKind::fileIO, "fopen");
+        return RTCHECK_NEXT (fopen) (path, mode);
+    }
+
+    FILE* fopen64 (const char* __restrict path, const char* __restrict mode)
+    {
+        record (ViolationKind::fileIO, "fopen64");
+        return RTCHECK_NEXT (fopen64) (path, mode);
+    }
+
+    std::size_t fread (void* __restrict buffer, std::size_t size, std::size_t count, FILE* __restrict file)
+    {
+        record (ViolationKind::fileIO, "fread");
+        return RTCHECK_NEXT (fread) (buffer, size, count, file);
+    }
+
+    std::size_t fwrite (const void* __restrict buffer, std::size_t size, std::size_t count, FILE* __restrict file)
+    {
+        record (ViolationKind::fileIO, "fwrite");
+        return RTCHECK_NEXT (fwrite) (buffer, size, count, file);
+    }
+}
+
+#else
+//==============================================================================
+// Without interposition only C++ allocations can be seen, by replacing the
+// global operator new and delete
+#if defined (_WIN32)
+ #include <malloc.h>
+#endif
+
+namespace rtcheck
+{
+namespace
+{
+    void writeToStandardError (const char* text) noexcept
+    {
+        std::fputs (text, stderr);
+    }
+
+    void* allocate (std::size_t size) noexcept
+    {
+        record (ViolationKind::allocation, "operator new", size);
+        return std::malloc (size > 0 ? size : 1);
+    }
+
+    void* allocateAligned (std::size_t size, std::align_val_t alignment) noexcept
+    {
+        record (ViolationKind::allocation, "operator new", size);
+        const auto align = static_cast<std::size_t> (alignment);
+
+       #if defined (_WIN32)
+        return _aligned_malloc (size > 0 ? size : 1, align);
+       #else
+        void* result = nullptr;
+        return posix_memalign (&result, align, size > 0 ? size : 1) == 0 ? result : nullptr;
+       #endif
+    }
+
+    void deallocate (void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            record (ViolationKind::deallocation, "operator delete");
+
+        std::free (pointer);
+    }
+
+    void deallocateAligned (void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            record (ViolationKind::deallocation, "operator delete");
+
+       #if defined (_WIN32)
+        _aligned_free (pointer);
+       #else
+        std::free (pointer);
+       #endif
+    }
+}
+}
+
+void* operator new (std::size_t size)
+{
+    if (auto* result = rtcheck::allocate (size))
+        return result;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)                                     { return operator new (size); }
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept       { return rtcheck::allocate (size); }
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept     { return rtcheck::allocate (size); }
+
+void* operator new (std::size_t size, std::align_val_t alignment)
+{
+    if (auto* result = rtcheck::allocateAligned (size, alignment))
+        return result;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size, std::align_val_t alignment)        { return operator new (size, alignment); }
+void* operator new (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept      { return rtcheck::allocateAligned (size, alignment); }
+void* operator new[] (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept    { return rtcheck::allocateAligned (size, alignment); }
+
+void operator delete (void* pointer) noexcept                               { rtcheck::deallocate (pointer); }
+void operator delete[] (void* pointer) noexcept                             { rtcheck::deallocate (pointer); }
+void operator delete (void* pointer, std::size_t) noexcept                  { rtcheck::deallocate (pointer); }
+void operator delete[] (void* pointer, std::size_t) noexcept                { rtcheck::deallocate (pointer); }
+void operator delete (void* pointer, const std::nothrow_t&) noexcept        { rtcheck::deallocate (pointer); }
+void operator delete[] (void* pointer, const std::nothrow_t&) noexcept      { rtcheck::deallocate (pointer); }
+
+void operator delete (void* pointer, std::align_val_t) noexcept                         { rtcheck::deallocateAligned (pointer); }
+void operator delete[] (void* pointer, std::align_val_t) noexcept                       { rtcheck::deallocateAligned (pointer); }
+void operator delete (void* pointer, std::size_t, std::align_val_t) noexcept            { rtcheck::deallocateAligned (pointer); }
+void operator delete[] (void* pointer, std::size_t, std::align_val_t) noexcept          { rtcheck::deallocateAligned (pointer); }
+void operator delete (void* pointer, std::align_val_t, const std::nothrow_t&) noexcept  { rtcheck::deallocateAligned (pointer); }
+void operator delete[] (void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { rtcheck::deallocateAligned (pointer); }
+#endif
@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - test tools shared by the plugin projects
+    RealtimeChecks - catches allocations, locks and blocking system calls
+    made by code that must be real-time safe, for the test executables
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+namespace rtcheck
+{
+
+//==============================================================================
+/**
+ * Link PluginSharedRealtimeChecks into a test executable (never a plugin) and
+ * wrap audio-thread code in a ScopedRealtimeCheck:
+ *
+ *     rtcheck::ScopedRealtimeCheck check;
+ *     processor.processBlock (buffer, midi);
+ *     report.add (check.getReport());
+ *
+ * While a check is open on a thread, anything that thread does that a
+ * real-time thread mustn't is counted against it:
+ *
+ *  - allocation: malloc, calloc, realloc, the aligned allocators and
+ *    operator new; deallocation: free and operator delete
+ *  - lock: pthread mutex and rwlock locking, including std::mutex
+ *  - wait: condition variables, semaphores, joining a thread
+ *  - sleep: nanosleep, usleep, sleep
+ *  - file I/O: open, read, write, close, fsync and the stdio equivalents
+ *  - thread creation: pthread_create
+ *
+ * How much is caught depends on the platform. With glibc the C allocator
+ * and the listed functions are interposed, which also catches allocations
+ * made through JUCE's HeapBlock and the standard library. Elsewhere, and
+ * in sanitizer builds (whose runtimes interpose the same functions), only
+ * the global operator new and delete are replaced, so only C++
+ * allocations are seen. Other threads are never affected.
+ *
+ * Uncontended locks are counted too: they're cheap until the one time the
+ * other side holds them.
+ */
+enum class ViolationKind
+{
+    allocation,
+    deallocation,
+    lock,
+    wait,
+    sleep,
+    fileIO,
+    threadCreation
+};
+
+constexpr int numViolationKinds = 7;
+
+const char* getViolationKindName (ViolationKind kind) noexcept;
+
+/** One call made inside a check. */
+struct Violation
+{
+    ViolationKind kind = ViolationKind::allocation;
+    const char* function = "";      // e.g. "malloc" or "pthread_mutex_lock"
+    std::size_t bytes = 0;          // for allocations
+};
+
+//==============================================================================
+/** What happened inside one or more checks. */
+struct Report
+{
+    static constexpr int maxRecorded = 8;
+
+    std::array<int, numViolationKinds> counts {};
+    std::array<Violation, maxRecorded> firstViolations {};  // the first few, in order
+    int numRecorded = 0;
+    int numChecks = 0;
+
+    int getCount (ViolationKind kind) const noexcept    { return counts[(size_t) kind]; }
+    int getTotal() const noexcept;
+    bool isClean() const noexcept                       { return getTotal() == 0; }
+
+    /** Adds another report's counts, keeping the first violations of both. */
+    void add (const Report& other) noexcept;
+
+    /** e.g. "3 allocations, 1 lock (first: malloc 512 bytes, pthread_mutex_lock)" */
+    std::string describe() const;
+};
+
+//==============================================================================
+/**
+ * Checks the calling thread from construction to destruction. Checks may
+ * nest; an inner check sees only what happens inside it.
+ */
+class ScopedRealtimeCheck
+{
+public:
+    ScopedRealtimeCheck() noexcept;
+    ~ScopedRealtimeCheck();
+
+    /** What this check has caught so far. */
+    Report getReport() const noexcept;
+
+private:
+    Report saved;       // the enclosing check's report, restored on exit
+
+    ScopedRealtimeCheck (const ScopedRealtimeCheck&) = delete;
+    ScopedRealtimeCheck& operator= (const ScopedRealtimeCheck&) = delete;
+};
+
+//==============================================================================
+/** True if C allocations (not just operator new) are caught in this build. */
+bool canDetectCAllocations() noexcept;
+
+/** True if locks, waits, sleeps, file I/O and thread creation are caught in this build. */
+bool canDetectSystemCalls() noexcept;
+
+/**
+ * Makes the first violation print what it was and abort, so a debugger or
+ * core dump shows the call stack that caused it. Off by default.
+ */
+void setAbortOnViolation (bool shouldAbort) noexcept;
+
+} // namespace rtcheck
@@ -0,0 +1,846 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - console tools shared by the plugin projects
+    StressHost - runs many processor instances as a DAW-style graph on a
+    work-stealing pool, with concurrent automation and state save/load
+
+  ==============================================================================
+*/
+
+#include "StressHost.h"
+#include "WorkStealingPool.h"
+
+#include "BenchmarkUtilities.h"
+#include "ProcessorBenchmark.h"
+
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace stress
+{
+
+//==============================================================================
+const char* getInstanceLayoutName (InstanceLayout layout) noexcept
+{
+    switch (layout)
+    {
+        case InstanceLayout::packed:  return "packed";
+        case InstanceLayout::spread:  return "spread";
+    }
+
+    return "unknown";
+}
+
+double RunResult::getInstanceBlocksPerSecond() const noexcept
+{
+    return wallSeconds > 0.0 ? (double) numCycles * (double) numInstances / wallSeconds : 0.0;
+}
+
+//==============================================================================
+juce::Result Options::parse (const juce::StringArray& args)
+{
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto& arg = args[i];
+        const auto nextValue = [&]() -> juce::String { return i + 1 < args.size() ? args[++i] : juce::String(); };
+
+        const auto nextInt = [&] (int minimum, int& destination)
+        {
+            const auto value = nextValue();
+            destination = value.getIntValue();
+            return value.containsOnly ("0123456789") && value.isNotEmpty() && destination >= minimum;
+        };
+
+        const auto nextDouble = [&] (double minimum, double& destination)
+        {
+            const auto value = nextValue();
+            destination = value.getDoubleValue();
+            return value.containsOnly ("0123456789.") && value.isNotEmpty() && destination >= minimum;
+        };
+
+        if (arg == "-h" || arg == "--help")
+        {
+            showHelp = true;
+        }
+        else if (arg == "-n" || arg == "--instances")
+        {
+            if (! nextInt (1, numInstances))
+                return juce::Result::fail ("--instances needs a positive number");
+        }
+        else if (arg == "--chain")
+        {
+            if (! nextInt (1, chainLength))
+                return juce::Result::fail ("--chain needs a positive number");
+        }
+        else if (arg == "--tracks-per-bus")
+        {
+            if (! nextInt (1, tracksPerBus))
+                return juce::Result::fail ("--tracks-per-bus needs a positive number");
+        }
+        else if (arg == "-b" || arg == "--block-size")
+        {
+            if (! nextInt (1, blockSize))
+                return juce::Result::fail ("--block-size needs a positive number");
+        }
+        else if (arg == "--channels")
+        {
+            if (! nextInt (1, numChannels))
+                return juce::Result::fail ("--channels needs a positive number");
+        }
+        else if (arg == "--rate")
+        {
+            if (! nextDouble (1.0, sampleRate))
+                return juce::Result::fail ("--rate needs a sample rate");
+        }
+        else if (arg == "--seconds")
+        {
+            if (! nextDouble (0.001, secondsPerRun))
+                return juce::Result::fail ("--seconds needs a positive number");
+        }
+        else if (arg == "-t" || arg == "--threads")
+        {
+            threadCounts.clearQuick();
+
+            for (const auto& token : juce::StringArray::fromTokens (nextValue(), ",", ""))
+            {
+                const auto count = token.trim().getIntValue();
+
+                if (count <= 0 || ! token.trim().containsOnly ("0123456789"))
+                    return juce::Result::fail ("--threads needs a comma-separated list of thread counts");
+
+                threadCounts.addIfNotAlreadyThere (count);
+            }
+
+            if (threadCounts.isEmpty())
+                return juce::Result::fail ("--threads needs a comma-separated list of thread counts");
+        }
+        else if (arg == "--automation-rate")
+        {
+            if (! nextDouble (0.0, automationEventsPerSecond))
+                return juce::Result::fail ("--automation-rate needs a number of events per second");
+        }
+        else if (arg == "--state-rate")
+        {
+            if (! nextDouble (0.0, stateRestoresPerSecond))
+                return juce::Result::fail ("--state-rate needs a number of restores per second");
+        }
+        else if (arg == "--seed")
+        {
+            randomSeed = nextValue().getLargeIntValue();
+        }
+        else if (arg == "--no-layout-compare")
+        {
+            compareLayouts = false;
+        }
+        else if (arg == "--json")
+        {
+            jsonOutput = juce::File::getCurrentWorkingDirectory().getChildFile (nextValue());
+        }
+        else
+        {
+            return juce::Result::fail ("Unknown option " + arg);
+        }
+    }
+
+    return juce::Result::ok();
+}
+
+juce::Array<int> Options::getThreadCounts() const
+{
+    if (! threadCounts.isEmpty())
+        return threadCounts;
+
+    const auto numCpus = juce::jmax (1, juce::SystemStats::getNumCpus());
+    juce::Array<int> counts;
+
+    for (int count = 1; count < numCpus; count *= 2)
+        counts.add (count);
+
+    counts.add (numCpus);
+    return counts;
+}
+
+void Options::printUsage (const juce::String& executableName)
+{
+    std::cout << "Usage: " << executableName << " [options]\n"
+              << "\n"
+              << "Runs many processor instances as a mixer-shaped graph on a work-stealing\n"
+              << "thread pool while other threads automate parameters and save/restore state,\n"
+              << "and reports how throughput scales with the number of worker threads.\n"
+              << "\n"
+              << "Options:\n"
+              << "  -n, --instances <n>         Processor instances (default 200)\n"
+              << "      --chain <n>             Instances in series on each track (default 4)\n"
+              << "      --tracks-per-bus <n>    Tracks summed into each bus (default 8)\n"
+              << "  -b, --block-size <n>        Samples per block (default 256)\n"
+              << "      --channels <n>          Channels per instance (default 2)\n"
+              << "      --rate <hz>             Sample rate (default 48000)\n"
+              << "      --seconds <s>           Wall-clock seconds per run (default 3)\n"
+              << "  -t, --threads <a,b,...>     Worker counts (default 1,2,4,... up to the core count)\n"
+              << "      --automation-rate <n>   Parameter changes per second (default 5000, 0 = off)\n"
+              << "      --state-rate <n>        State save/restores per second (default 50, 0 = off)\n"
+              << "      --seed <n>              Random seed for automation and state traffic\n"
+              << "      --no-layout-compare     Skip the packed vs spread memory layout run\n"
+              << "      --json <file>           Write results as JSON\n"
+              << "  -h, --help                  Show this message\n";
+}
+
+//==============================================================================
+namespace
+{
+    // Allocated between instances in the spread layout: more than a few pages,
+    // so neighbouring instances can't share a cache line or a prefetch window
+    constexpr size_t spreadPaddingBytes = 16 * 1024;
+
+    //==============================================================================
+    /**
+     * One node of the graph: a processor instance, or a mixer sum (bus/master)
+     * when processor is null. Each node is on its own cache lines so that the
+     * harness's own bookkeeping doesn't add false sharing between nodes.
+     */
+    struct alignas (64) Node
+    {
+        std::unique_ptr<juce::AudioProcessor> processor;
+        std::vector<int> inputs;           // nodes whose outputs are summed into this one
+        std::vector<int> dependents;       // nodes that read this one's output
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+
+        std::atomic<int> numPendingInputs { 0 };
+
+        // Only touched by the worker running the node; read between runs
+        double processNanoseconds = 0.0;
+        juce::uint64 numProcessed = 0;
+    };
+
+    //==============================================================================
+    class ProcessingGraph
+    {
+    public:
+        ProcessingGraph (const ProcessorFactory& createProcessor, const Options& opts,
+                         int numThreads, InstanceLayout layout)
+            : options (opts)
+        {
+            build (createProcessor, layout);
+
+            if (result.wasOk())
+                pool = std::make_unique<WorkStealingPool> (numThreads, (int) nodes.size(),
+                                                           [this] (int node, int worker) { processNode (node, worker); });
+        }
+
+        ~ProcessingGraph()
+        {
+            pool.reset();
+
+            for (auto& node : nodes)
+                if (node->processor != nullptr)
+                    node->processor->releaseResources();
+        }
+
+        const juce::Result& getResult() const noexcept                        { return result; }
+        const std::vector<juce::AudioProcessor*>& getProcessors() const noexcept { return processors; }
+        WorkStealingPool& getPool() noexcept                                  { return *pool; }
+
+        /** Processes one block through the whole graph and returns when the master is done. */
+        void runCycle()
+        {
+            for (auto& node : nodes)
+                node->numPendingInputs.store ((int) node->inputs.size(), std::memory_order_relaxed);
+
+            for (auto root : roots)
+                pool->pushExternal (root);
+
+            cycleFinished.wait();
+        }
+
+        bool isMasterOutputFinite() const
+        {
+            const auto& master = nodes.back()->buffer;
+
+            for (int channel = 0; channel < master.getNumChannels(); ++channel)
+            {
+                const auto range = master.findMinMax (channel, 0, master.getNumSamples());
+
+                if (! std::isfinite (range.getStart()) || ! std::isfinite (range.getEnd()))
+                    return false;
+            }
+
+            return true;
+        }
+
+        void resetNodeStats()
+        {
+            for (auto& node : nodes)
+            {
+                node->processNanoseconds = 0.0;
+                node->numProcessed = 0;
+            }
+        }
+
+        double getMeanInstanceBlockNanoseconds() const
+        {
+            double total = 0.0;
+            juce::uint64 count = 0;
+
+            for (auto& node : nodes)
+            {
+                total += node->processNanoseconds;
+                count += node->numProcessed;
+            }
+
+            return count > 0 ? total / (double) count : 0.0;
+        }
+
+    private:
+        //==============================================================================
+        int addNode (std::vector<std::unique_ptr<char[]>>& padding, InstanceLayout layout)
+        {
+            if (layout == InstanceLayout::spread)
+                padding.push_back (std::make_unique<char[]> (spreadPaddingBytes));
+
+            nodes.push_back (std::make_unique<Node>());
+            return (int) nodes.size() - 1;
+        }
+
+        void connect (int source, int destination)
+        {
+            nodes[(size_t) destination]->inputs.push_back (source);
+            nodes[(size_t) source]->dependents.push_back (destination);
+        }
+
+        void build (const ProcessorFactory& createProcessor, InstanceLayout layout)
+        {
+            // Only needed while allocating; freeing it afterwards leaves the gaps in place
+            std::vector<std::unique_ptr<char[]>> padding;
+
+            std::vector<int> trackOutputs;
+            int previousOnTrack = -1;
+
+            for (int instance = 0; instance < options.numInstances; ++instance)
+            {
+                const auto index = addNode (padding, layout);
+                auto& node = *nodes[(size_t) index];
+
+                node.processor = createProcessor();
+
+                if (node.processor == nullptr)
+                {
+                    result = juce::Result::fail ("couldn't create processor instance " + juce::String (instance));
+                    return;
+                }
+
+                if (! benchmarks::setMainBusChannels (*node.processor, options.numChannels))
+                {
+                    result = juce::Result::fail ("processor doesn't support " + juce::String (options.numChannels) + " channels");
+                    return;
+                }
+
+                node.processor->setNonRealtime (false);
+                node.processor->setRateAndBufferSizeDetails (options.sampleRate, options.blockSize);
+                node.processor->prepareToPlay (options.sampleRate, options.blockSize);
+                processors.push_back (node.processor.get());
+
+                // A new track starts every chainLength instances
+                const auto startsTrack = instance % options.chainLength == 0;
+
+                if (startsTrack)
+                {
+                    if (previousOnTrack >= 0)
+                        trackOutputs.push_back (previousOnTrack);
+
+                    roots.push_back (index);
+                }
+                else
+                {
+                    connect (previousOnTrack, index);
+                }
+
+                previousOnTrack = index;
+            }
+
+            trackOutputs.push_back (previousOnTrack);
+
+            // Sum groups of tracks into buses, then the buses into the master
+            std::vector<int> busOutputs;
+
+            for (size_t first = 0; first < trackOutputs.size(); first += (size_t) options.tracksPerBus)
+            {
+                const auto bus = addNode (padding, layout);
+                const auto last = juce::jmin (trackOutputs.size(), first + (size_t) options.tracksPerBus);
+
+                for (auto track = first; track < last; ++track)
+                    connect (trackOutputs[track], bus);
+
+                busOutputs.push_back (bus);
+            }
+
+            const auto master = addNode (padding, layout);
+
+            for (auto bus : busOutputs)
+                connect (bus, master);
+
+            //==============================================================================
+            for (auto& node : nodes)
+            {
+                auto numBufferChannels = options.numChannels;
+
+                if (node->processor != nullptr)
+                    numBufferChannels = juce::jmax (numBufferChannels,
+                                                    node->processor->getTotalNumInputChannels(),
+                                                    node->processor->getTotalNumOutputChannels());
+
+                if (layout == InstanceLayout::spread)
+                    padding.push_back (std::make_unique<char[]> (spreadPaddingBytes));
+
+                node->buffer.setSize (numBufferChannels, options.blockSize);
+                node->midi.ensureSize (256);
+            }
+
+            // A quiet noise source feeds the first instance of every track
+            source.setSize (options.numChannels, options.blockSize);
+            juce::Random random (options.randomSeed);
+
+            for (int channel = 0; channel < source.getNumChannels(); ++channel)
+                for (int i = 0; i < source.getNumSamples(); ++i)
+                    source.setSample (channel, i, (random.nextFloat() * 2.0f - 1.0f) * 0.25f);
+        }
+
+        //==============================================================================
+        void processNode (int index, int workerIndex)
+        {
+            auto& node = *nodes[(size_t) index];
+            auto& buffer = node.buffer;
+            const auto numSamples = options.blockSize;
+
+            if (node.inputs.empty())
+            {
+                for (int channel = 0; channel < options.numChannels; ++channel)
+                    buffer.copyFrom (channel, 0, source, channel, 0, numSamples);
+            }
+            else
+            {
+                for (size_t i = 0; i < node.inputs.size(); ++i)
+                {
+                    const auto& input = nodes[(size_t) node.inputs[i]]->buffer;
+
+                    for (int channel = 0; channel < options.numChannels; ++channel)
+                    {
+                        if (i == 0)
+                            buffer.copyFrom (channel, 0, input, channel, 0, numSamples);
+                        else
+                            buffer.addFrom (channel, 0, input, channel, 0, numSamples);
+                    }
+                }
+            }
+
+            if (node.processor != nullptr)
+            {
+                // Channels beyond the main bus (e.g. a sidechain) get silence
+                for (int channel = options.numChannels; channel < buffer.getNumChannels(); ++channel)
+                    buffer.clear (channel, 0, numSamples);
+
+                node.midi.clear();
+
+                const auto start = plugindsp::bench::Clock::now();
+                node.processor->processBlock (buffer, node.midi);
+                node.processNanoseconds += plugindsp::bench::nanosecondsBetween (start, plugindsp::bench::Clock::now());
+                ++node.numProcessed;
+            }
+
+            if (node.dependents.empty())
+            {
+                cycleFinished.signal();     // only the master has no dependents
+                return;
+            }
+
+            for (auto dependent : node.dependents)
+                if (nodes[(size_t) dependent]->numPendingInputs.fetch_sub (1, std::memory_order_acq_rel) == 1)
+                    pool->push (workerIndex, dependent);
+        }
+
+        //==============================================================================
+        const Options& options;
+        juce::Result result = juce::Result::ok();
+
+        std::vector<std::unique_ptr<Node>> nodes;      // the master is always last
+        std::vector<int> roots;
+        std::vector<juce::AudioProcessor*> processors;
+        juce::AudioBuffer<float> source;
+
+        juce::WaitableEvent cycleFinished;
+        std::unique_ptr<WorkStealingPool> pool;
+    };
+
+    //==============================================================================
+    /** Base for the threads that hit the instances while the graph runs. */
+    class TrafficThread  : public juce::Thread
+    {
+    public:
+        TrafficThread (const juce::String& name, double eventsPerSecond, juce::int64 seed)
+            : juce::Thread (name), rate (eventsPerSecond), random (seed)
+        {
+        }
+
+        void run() override
+        {
+            auto lastTime = juce::Time::getMillisecondCounterHiRes();
+            double owed = 0.0;
+
+            while (! threadShouldExit())
+            {
+                const auto now = juce::Time::getMillisecondCounterHiRes();
+                owed += rate * (now - lastTime) / 1000.0;
+                lastTime = now;
+
+                for (; owed >= 1.0 && ! threadShouldExit(); owed -= 1.0)
+                {
+                    sendEvent (random);
+                    numEvents.fetch_add (1, std::memory_order_relaxed);
+                }
+
+                wait (1);
+            }
+        }
+
+        juce::uint64 getNumEvents() const noexcept   { return numEvents.load(); }
+
+    protected:
+        virtual void sendEvent (juce::Random&) = 0;
+
+    private:
+        const double rate;
+        juce::Random random;
+        std::atomic<juce::uint64> numEvents { 0 };
+    };
+
+    /** Sets random parameters of random instances to random values, as host automation would. */
+    class AutomationThread  : public TrafficThread
+    {
+    public:
+        AutomationThread (const std::vector<juce::AudioProcessor*>& processors, double rate, juce::int64 seed)
+            : TrafficThread ("Stress automation", rate, seed)
+        {
+            for (auto* processor : processors)
+                for (auto* parameter : processor->getParameters())
+                    if (parameter->isAutomatable())
+                        parameters.push_back (parameter);
+        }
+
+    protected:
+        void sendEvent (juce::Random& random) override
+        {
+            if (! parameters.empty())
+                parameters[(size_t) random.nextInt ((int) parameters.size())]->setValueNotifyingHost (random.nextFloat());
+        }
+
+    private:
+        std::vector<juce::AudioProcessorParameter*> parameters;
+    };
+
+    /** Copies the state of one random instance into another, as a host does on preset/session recall. */
+    class StateThread  : public TrafficThread
+    {
+    public:
+        StateThread (const std::vector<juce::AudioProcessor*>& p, double rate, juce::int64 seed)
+            : TrafficThread ("Stress state", rate, seed), processors (p)
+        {
+        }
+
+        double getMaxRestoreNanoseconds() const noexcept   { return maxRestoreNanoseconds.load(); }
+
+    protected:
+        void sendEvent (juce::Random& random) override
+        {
+            const auto numProcessors = (int) processors.size();
+            auto* from = processors[(size_t) random.nextInt (numProcessors)];
+            auto* to   = processors[(size_t) random.nextInt (numProcessors)];
+
+            const auto start = plugindsp::bench::Clock::now();
+            from->getStateInformation (state);
+            to->setStateInformation (state.getData(), (int) state.getSize());
+            const auto elapsed = plugindsp::bench::nanosecondsBetween (start, plugindsp::bench::Clock::now());
+
+            if (elapsed > maxRestoreNanoseconds.load())
+                maxRestoreNanoseconds.store (elapsed);
+        }
+
+    private:
+        const std::vector<juce::AudioProcessor*>& processors;
+        juce::MemoryBlock state;
+        std::atomic<double> maxRestoreNanoseconds { 0.0 };
+    };
+}
+
+//==============================================================================
+RunResult runStressTest (const ProcessorFactory& createProcessor, const Options& options,
+                         int numThreads, InstanceLayout layout)
+{
+    RunResult run;
+    run.numThreads = numThreads;
+    run.layout = layout;
+    run.numInstances = options.numInstances;
+
+    ProcessingGraph graph (createProcessor, options, numThreads, layout);
+
+    if (graph.getResult().failed())
+    {
+        run.result = graph.getResult();
+        return run;
+    }
+
+    // Warm up caches, branch predictors and the workers' clocks
+    for (int i = 0; i < 50; ++i)
+        graph.runCycle();
+
+    graph.resetNodeStats();
+    graph.getPool().resetStats();
+
+    std::unique_ptr<AutomationThread> automation;
+    std::unique_ptr<StateThread> stateTraffic;
+
+    if (options.automationEventsPerSecond > 0.0)
+    {
+        automation = std::make_unique<AutomationThread> (graph.getProcessors(), options.automationEventsPerSecond,
+                                                         options.randomSeed + 1);
+        automation->startThread();
+    }
+
+    if (options.stateRestoresPerSecond > 0.0)
+    {
+        stateTraffic = std::make_unique<StateThread> (graph.getProcessors(), options.stateRestoresPerSecond,
+                                                      options.randomSeed + 2);
+        stateTraffic->startThread();
+    }
+
+    //==============================================================================
+    const auto deadlineNs = (double) options.blockSize / options.sampleRate * 1.0e9;
+    const auto runStart = plugindsp::bench::Clock::now();
+    const auto runNanoseconds = options.secondsPerRun * 1.0e9;
+
+    std::vector<double> cycleTimes;
+    cycleTimes.reserve (1 << 16);
+
+    for (;;)
+    {
+        const auto start = plugindsp::bench::Clock::now();
+        graph.runCycle();
+        const auto end = plugindsp::bench::Clock::now();
+
+        const auto cycleNs = plugindsp::bench::nanosecondsBetween (start, end);
+        cycleTimes.push_back (cycleNs);
+
+        if (cycleNs > deadlineNs)
+            ++run.numDeadlineMisses;
+
+        run.outputIsFinite = run.outputIsFinite && graph.isMasterOutputFinite();
+
+        if (plugindsp::bench::nanosecondsBetween (runStart, end) >= runNanoseconds)
+            break;
+    }
+
+    run.wallSeconds = plugindsp::bench::nanosecondsBetween (runStart, plugindsp::bench::Clock::now()) / 1.0e9;
+
+    //==============================================================================
+    if (automation != nullptr)
+    {
+        automation->stopThread (2000);
+        run.numAutomationEvents = automation->getNumEvents();
+    }
+
+    if (stateTraffic != nullptr)
+    {
+        stateTraffic->stopThread (2000);
+        run.numStateRestores = stateTraffic->getNumEvents();
+        run.stateRestoreMaxNs = stateTraffic->getMaxRestoreNanoseconds();
+    }
+
+    const auto summary = plugindsp::bench::summarise (std::move (cycleTimes));
+    run.numCycles = summary.count;
+    run.cycleMeanNs = summary.mean;
+    run.cycleP50Ns = summary.p50;
+    run.cycleP99Ns = summary.p99;
+    run.cycleMaxNs = summary.max;
+    run.instanceBlockMeanNs = graph.getMeanInstanceBlockNanoseconds();
+
+    const auto poolStats = graph.getPool().getStats();
+    run.numTasks = poolStats.tasksRun;
+    run.numStolenTasks = poolStats.tasksStolen;
+    run.numWorkerSleeps = poolStats.sleeps;
+
+    return run;
+}
+
+//==============================================================================
+namespace
+{
+    juce::DynamicObject::Ptr toFields (const RunResult& run, const RunResult& baseline, const Options& options)
+    {
+        const auto deadlineNs = (double) options.blockSize / options.sampleRate * 1.0e9;
+        const auto throughput = run.getInstanceBlocksPerSecond();
+        const auto baselineThroughput = baseline.getInstanceBlocksPerSecond();
+        const auto speedup = baselineThroughput > 0.0 ? throughput / baselineThroughput : 0.0;
+        const auto speedupPerThread = (double) run.numThreads / (double) juce::jmax (1, baseline.numThreads);
+
+        juce::DynamicObject::Ptr fields (new juce::DynamicObject());
+        fields->setProperty ("threads", run.numThreads);
+        fields->setProperty ("layout", getInstanceLayoutName (run.layout));
+        fields->setProperty ("instance_blocks_per_second", throughput);
+        fields->setProperty ("speedup", speedup);
+        fields->setProperty ("efficiency_percent", 100.0 * speedup / speedupPerThread);
+        fields->setProperty ("cycle_p50_ns", run.cycleP50Ns);
+        fields->setProperty ("cycle_p99_ns", run.cycleP99Ns);
+        fields->setProperty ("cycle_max_ns", run.cycleMaxNs);
+        fields->setProperty ("budget_p99_percent", 100.0 * run.cycleP99Ns / deadlineNs);
+        fields->setProperty ("deadline_misses", run.numDeadlineMisses);
+        fields->setProperty ("cycles", run.numCycles);
+        fields->setProperty ("instance_block_ns", run.instanceBlockMeanNs);
+
+        // How much slower each instance's processBlock() runs than in the
+        // baseline run: the cost of sharing caches, memory bandwidth and locks
+        fields->setProperty ("instance_slowdown", baseline.instanceBlockMeanNs > 0.0
+                                                     ? run.instanceBlockMeanNs / baseline.instanceBlockMeanNs : 0.0);
+
+        fields->setProperty ("stolen_percent", run.numTasks > 0 ? 100.0 * (double) run.numStolenTasks / (double) run.numTasks : 0.0);
+        fields->setProperty ("worker_sleeps", (juce::int64) run.numWorkerSleeps);
+        fields->setProperty ("automation_events", (juce::int64) run.numAutomationEvents);
+        fields->setProperty ("state_restores", (juce::int64) run.numStateRestores);
+        fields->setProperty ("state_restore_max_ns", run.stateRestoreMaxNs);
+        return fields;
+    }
+}
+
+int runStressHostMain (int argc, char* argv[], const juce::String& processorName,
+                       const ProcessorFactory& createProcessor)
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+
+    for (int i = 1; i < argc; ++i)
+        args.add (juce::CharPointer_UTF8 (argv[i]));
+
+    const auto executableName = juce::File (juce::CharPointer_UTF8 (argv[0])).getFileName();
+
+    Options options;
+    const auto parsed = options.parse (args);
+
+    if (parsed.failed())
+    {
+        std::cerr << parsed.getErrorMessage() << "\n\n";
+        Options::printUsage (executableName);
+        return 1;
+    }
+
+    if (options.showHelp)
+    {
+        Options::printUsage (executableName);
+        return 0;
+    }
+
+    const auto numTracks = (options.numInstances + options.chainLength - 1) / options.chainLength;
+
+    std::cout << processorName << ": " << options.numInstances << " instances on " << numTracks
+              << " tracks of " << options.chainLength << ", " << options.blockSize << " samples at "
+              << options.sampleRate << " Hz, " << options.numChannels << " channels\n"
+              << "At most " << numTracks << " instances can run at once, so speedup flattens beyond that.\n\n";
+
+    benchmarks::Report report (processorName + " stress host");
+    report.setContext ("instances", options.numInstances);
+    report.setContext ("chain_length", options.chainLength);
+    report.setContext ("tracks_per_bus", options.tracksPerBus);
+    report.setContext ("block_size", options.blockSize);
+    report.setContext ("sample_rate", options.sampleRate);
+    report.setContext ("channels", options.numChannels);
+    report.setContext ("automation_events_per_second", options.automationEventsPerSecond);
+    report.setContext ("state_restores_per_second", options.stateRestoresPerSecond);
+
+    //==============================================================================
+    const auto threadCounts = options.getThreadCounts();
+    std::vector<RunResult> runs;
+    bool allPassed = true;
+
+    const auto addRun = [&] (int numThreads, InstanceLayout layout)
+    {
+        auto run = runStressTest (createProcessor, options, numThreads, layout);
+
+        if (run.result.failed())
+        {
+            std::cerr << "FAILED " << run.result.getErrorMessage() << "\n";
+            allPassed = false;
+            return false;
+        }
+
+        if (! run.outputIsFinite)
+        {
+            std::cerr << "FAILED non-finite output with " << numThreads << " threads\n";
+            allPassed = false;
+        }
+
+        runs.push_back (run);
+        const auto& baseline = runs.front();
+
+        report.add (processorName + "/stress/threads:" + juce::String (numThreads)
+                      + "/layout:" + getInstanceLayoutName (layout),
+                    toFields (run, baseline, options));
+        return true;
+    };
+
+    for (auto numThreads : threadCounts)
+        if (! addRun (numThreads, InstanceLayout::packed))
+            return 1;
+
+    //==============================================================================
+    // Copies, as the layout run below adds to runs
+    const auto widest = runs.back();
+    const auto baseline = runs.front();
+
+    if (widest.numThreads > baseline.numThreads && baseline.instanceBlockMeanNs > 0.0)
+    {
+        const auto slowdown = widest.instanceBlockMeanNs / baseline.instanceBlockMeanNs;
+
+        std::cout << "\nWith " << widest.numThreads << " threads each processBlock() took "
+                  << juce::String ((slowdown - 1.0) * 100.0, 1) << "% longer than with "
+                  << baseline.numThreads << ".\n";
+
+        if (slowdown > 1.1)
+            std::cout << "Instances are contending for shared state, caches or memory bandwidth.\n";
+    }
+
+    if (options.compareLayouts && widest.numThreads > 1)
+    {
+        if (! addRun (widest.numThreads, InstanceLayout::spread))
+            return 1;
+
+        const auto& spread = runs.back();
+        const auto gain = widest.getInstanceBlocksPerSecond() > 0.0
+                            ? spread.getInstanceBlocksPerSecond() / widest.getInstanceBlocksPerSecond() - 1.0 : 0.0;
+
+        std::cout << "\nSpreading instances apart in memory changed throughput by "
+                  << juce::String (gain * 100.0, 1) << "%.\n";
+
+        if (gain > 0.05)
+            std::cout << "Neighbouring instances are likely false sharing cache lines.\n";
+    }
+
+    //==============================================================================
+    if (options.jsonOutput != juce::File())
+    {
+        const auto written = report.writeTo (options.jsonOutput);
+
+        if (written.failed())
+        {
+            std::cerr << written.getErrorMessage() << "\n";
+            return 1;
+        }
+
+        std::cout << "\nWrote " << report.getNumResults() << " results to "
+                  << options.jsonOutput.getFullPathName() << "\n";
+    }
+
+    return allPassed ? 0 : 1;
+}
+
+} // namespace stress
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - console tools shared by the plugin projects
+    StressHost - runs many processor instances as a DAW-style graph on a
+    work-stealing pool, with concurrent automation and state save/load
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <functional>
+#include <memory>
+
+namespace stress
+{
+
+//==============================================================================
+/** Creates one processor instance; called once per instance in the graph. */
+using ProcessorFactory = std::function<std::unique_ptr<juce::AudioProcessor>()>;
+
+/**
+ * How the instances are laid out in memory. Comparing the two surfaces false
+ * sharing: instances created back to back can share cache lines, so if the
+ * spread layout is noticeably faster, instances are interfering.
+ */
+enum class InstanceLayout
+{
+    packed,     // instances allocated back to back, as a host normally would
+    spread      // a padding allocation between every instance and every buffer
+};
+
+const char* getInstanceLayoutName (InstanceLayout layout) noexcept;
+
+//==============================================================================
+/**
+ * Command-line options for the stress host.
+ *
+ * The graph is shaped like a mixer: tracks made of chainLength instances in
+ * series, tracks summed into buses of tracksPerBus, and buses summed into a
+ * master. Tracks and buses can run in parallel; each track's chain can't.
+ */
+struct Options
+{
+    int numInstances = 200;
+    int chainLength = 4;
+    int tracksPerBus = 8;
+
+    int blockSize = 256;
+    int numChannels = 2;
+    double sampleRate = 48000.0;
+
+    /** Wall-clock seconds per run (after warm-up). */
+    double secondsPerRun = 3.0;
+
+    /** Worker counts to measure; empty means 1, 2, 4... up to the number of cores. */
+    juce::Array<int> threadCounts;
+
+    /** Parameter changes per second, spread over random instances (0 to disable). */
+    double automationEventsPerSecond = 5000.0;
+
+    /** getStateInformation()/setStateInformation() round trips per second (0 to disable). */
+    double stateRestoresPerSecond = 50.0;
+
+    juce::int64 randomSeed = 1;
+    bool compareLayouts = true;
+
+    /** If set, results are written here as JSON. */
+    juce::File jsonOutput;
+
+    bool showHelp = false;
+
+    /** Parses the arguments (without the executable name). */
+    juce::Result parse (const juce::StringArray& args);
+
+    /** The thread counts to run, with the default filled in. */
+    juce::Array<int> getThreadCounts() const;
+
+    static void printUsage (const juce::String& executableName);
+};
+
+//==============================================================================
+/** What one run of the graph measured. */
+struct RunResult
+{
+    juce::Result result = juce::Result::ok();
+
+    int numThreads = 0;
+    InstanceLayout layout = InstanceLayout::packed;
+    int numInstances = 0;
+
+    int numCycles = 0;                  // whole-graph blocks
+    double wallSeconds = 0.0;
+    double cycleMeanNs = 0.0, cycleP50Ns = 0.0, cycleP99Ns = 0.0, cycleMaxNs = 0.0;
+    int numDeadlineMisses = 0;          // cycles slower than the block's duration
+
+    /** Mean processBlock() time of one instance. Grows under contention. */
+    double instanceBlockMeanNs = 0.0;
+
+    juce::uint64 numTasks = 0, numStolenTasks = 0, numWorkerSleeps = 0;
+
+    juce::uint64 numAutomationEvents = 0;
+    juce::uint64 numStateRestores = 0;
+    double stateRestoreMaxNs = 0.0;
+
+    /** False if the master output ever contained NaN or infinity. */
+    bool outputIsFinite = true;
+
+    double getInstanceBlocksPerSecond() const noexcept;
+};
+
+/** Builds the graph, runs it for options.secondsPerRun and tears it down. */
+RunResult runStressTest (const ProcessorFactory& createProcessor, const Options& options,
+                         int numThreads, InstanceLayout layout);
+
+/** Parses the command line, runs every thread count and prints a scaling report. */
+int runStressHostMain (int argc, char* argv[], const juce::String& processorName,
+                       const ProcessorFactory& createProcessor);
+
+} // namespace stress
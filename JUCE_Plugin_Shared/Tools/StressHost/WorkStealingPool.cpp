@@ -0,0 +1,235 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - console tools shared by the plugin projects
+    WorkStealingPool - a small work-stealing thread pool for running audio
+    graph nodes, the way a DAW spreads a processing graph over its cores
+
+  ==============================================================================
+*/
+
+#include "WorkStealingPool.h"
+
+namespace stress
+{
+
+//==============================================================================
+void WorkStealingPool::WorkQueue::push (int task) noexcept
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+
+    // The ring is sized for the largest number of tasks that can be ready at once
+    jassert (tail - head < tasks.size());
+
+    tasks[tail++ & (tasks.size() - 1)] = task;
+}
+
+bool WorkStealingPool::WorkQueue::popBack (int& task) noexcept
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+
+    if (tail == head)
+        return false;
+
+    task = tasks[--tail & (tasks.size() - 1)];
+    return true;
+}
+
+bool WorkStealingPool::WorkQueue::popFront (int& task) noexcept
+{
+    const juce::SpinLock::ScopedLockType sl (lock);
+
+    if (tail == head)
+        return false;
+
+    task = tasks[head++ & (tasks.size() - 1)];
+    return true;
+}
+
+//==============================================================================
+class WorkStealingPool::Worker  : public juce::Thread
+{
+public:
+    Worker (WorkStealingPool& p, int index)
+        : juce::Thread ("Stress worker " + juce::String (index)),
+          pool (p), workerIndex (index), randomState ((juce::uint32) index * 2654435761u + 1u)
+    {
+    }
+
+    void run() override
+    {
+        // Spin this many times without finding work before going to sleep
+        constexpr int spinsBeforeSleeping = 2000;
+        int idleSpins = 0;
+
+        while (! threadShouldExit())
+        {
+            int task = 0;
+            const auto gotLocal = pool.tryPop (workerIndex, task);
+
+            if (gotLocal || pool.trySteal (workerIndex, randomState, task))
+            {
+                idleSpins = 0;
+                pool.runTask (task, workerIndex);
+
+                tasksRun.fetch_add (1, std::memory_order_relaxed);
+
+                if (! gotLocal)
+                    tasksStolen.fetch_add (1, std::memory_order_relaxed);
+
+                continue;
+            }
+
+            if (++idleSpins < spinsBeforeSleeping)
+            {
+                if ((idleSpins & 63) == 0)
+                    juce::Thread::yield();
+
+                continue;
+            }
+
+            idleSpins = 0;
+            sleeps.fetch_add (1, std::memory_order_relaxed);
+
+            // Re-check after announcing ourselves so a push in between isn't
+            // missed; the timeout bounds the cost of any wake-up that still is.
+            pool.numSleepingWorkers.fetch_add (1);
+
+            if (pool.numQueuedTasks.load() == 0)
+                pool.workAvailable.wait (1);
+
+            pool.numSleepingWorkers.fetch_sub (1);
+        }
+    }
+
+    // Only written by this worker, so the counters never bounce between cores
+    alignas (64) std::atomic<juce::uint64> tasksRun { 0 };
+    std::atomic<juce::uint64> tasksStolen { 0 };
+    std::atomic<juce::uint64> sleeps { 0 };
+
+private:
+    WorkStealingPool& pool;
+    const int workerIndex;
+    juce::uint32 randomState;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Worker)
+};
+
+//==============================================================================
+WorkStealingPool::WorkStealingPool (int numWorkers, int maxQueuedTasks, TaskFunction taskFunction)
+    : runTask (std::move (taskFunction))
+{
+    jassert (numWorkers > 0 && runTask != nullptr);
+
+    const auto capacity = (size_t) juce::nextPowerOfTwo (juce::jmax (2, maxQueuedTasks));
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        queues.push_back (std::make_unique<WorkQueue>());
+        queues.back()->tasks.resize (capacity);
+    }
+
+    for (int i = 0; i < numWorkers; ++i)
+        workers.push_back (std::make_unique<Worker> (*this, i));
+
+    for (auto& worker : workers)
+        worker->startThread (juce::Thread::Priority::high);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    for (auto& worker : workers)
+        worker->signalThreadShouldExit();
+
+    for (auto& worker : workers)
+    {
+        workAvailable.signal();
+        worker->stopThread (1000);
+    }
+}
+
+//==============================================================================
+void WorkStealingPool::push (int workerIndex, int task) noexcept
+{
+    jassert (juce::isPositiveAndBelow (workerIndex, (int) queues.size()));
+
+    numQueuedTasks.fetch_add (1);
+    queues[(size_t) workerIndex]->push (task);
+    wakeSleepingWorker();
+}
+
+void WorkStealingPool::pushExternal (int task) noexcept
+{
+    const auto queueIndex = nextExternalQueue.fetch_add (1, std::memory_order_relaxed) % (int) queues.size();
+    push (queueIndex, task);
+}
+
+bool WorkStealingPool::tryPop (int workerIndex, int& task) noexcept
+{
+    if (! queues[(size_t) workerIndex]->popBack (task))
+        return false;
+
+    numQueuedTasks.fetch_sub (1);
+    return true;
+}
+
+bool WorkStealingPool::trySteal (int workerIndex, juce::uint32& randomState, int& task) noexcept
+{
+    const auto numQueues = (juce::uint32) queues.size();
+
+    if (numQueues < 2 || numQueuedTasks.load (std::memory_order_relaxed) == 0)
+        return false;
+
+    // xorshift32: start at a random victim so thieves don't all hit the same deque
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+
+    const auto start = randomState % numQueues;
+
+    for (juce::uint32 i = 0; i < numQueues; ++i)
+    {
+        const auto victim = (start + i) % numQueues;
+
+        if ((int) victim != workerIndex && queues[victim]->popFront (task))
+        {
+            numQueuedTasks.fetch_sub (1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WorkStealingPool::wakeSleepingWorker() noexcept
+{
+    if (numSleepingWorkers.load() > 0)
+        workAvailable.signal();
+}
+
+//==============================================================================
+WorkStealingPool::Stats WorkStealingPool::getStats() const noexcept
+{
+    Stats stats;
+
+    for (auto& worker : workers)
+    {
+        stats.tasksRun    += worker->tasksRun.load (std::memory_order_relaxed);
+        stats.tasksStolen += worker->tasksStolen.load (std::memory_order_relaxed);
+        stats.sleeps      += worker->sleeps.load (std::memory_order_relaxed);
+    }
+
+    return stats;
+}
+
+void WorkStealingPool::resetStats() noexcept
+{
+    for (auto& worker : workers)
+    {
+        worker->tasksRun.store (0, std::memory_order_relaxed);
+        worker->tasksStolen.store (0, std::memory_order_relaxed);
+        worker->sleeps.store (0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace stress
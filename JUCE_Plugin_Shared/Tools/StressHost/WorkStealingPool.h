@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    JUCE Plugin Shared - console tools shared by the plugin projects
+    WorkStealingPool - a small work-stealing thread pool for running audio
+    graph nodes, the way a DAW spreads a processing graph over its cores
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace stress
+{
+
+//==============================================================================
+/**
+ * Runs integer tasks (e.g. graph node indices) on a fixed set of workers.
+ *
+ * Each worker has its own deque. A worker pushes the tasks it makes ready onto
+ * the back of its own deque and pops from the back (so a node's successor
+ * usually runs on the same core while its buffers are still in cache). An
+ * idle worker steals from the front of another worker's deque.
+ *
+ * The deques are fixed-size rings that never allocate after construction;
+ * each is guarded by its own spin lock and sits on its own cache line. Idle
+ * workers spin briefly, then sleep until new work is pushed.
+ */
+class WorkStealingPool
+{
+public:
+    using TaskFunction = std::function<void (int task, int workerIndex)>;
+
+    /**
+     * Starts numWorkers threads. maxQueuedTasks bounds how many tasks can be
+     * queued on a single worker at once (e.g. the number of graph nodes).
+     */
+    WorkStealingPool (int numWorkers, int maxQueuedTasks, TaskFunction runTask);
+    ~WorkStealingPool();
+
+    int getNumWorkers() const noexcept   { return (int) workers.size(); }
+
+    /** Queues a task on a worker's own deque. Call it from inside a task. */
+    void push (int workerIndex, int task) noexcept;
+
+    /** Queues a task from outside the pool, spreading tasks round-robin. */
+    void pushExternal (int task) noexcept;
+
+    //==============================================================================
+    struct Stats
+    {
+        juce::uint64 tasksRun = 0;
+        juce::uint64 tasksStolen = 0;      // tasks taken from another worker's deque
+        juce::uint64 sleeps = 0;           // times a worker ran out of work and slept
+    };
+
+    /** Totals for all workers since the last resetStats(). */
+    Stats getStats() const noexcept;
+    void resetStats() noexcept;
+
+private:
+    //==============================================================================
+    struct alignas (64) WorkQueue
+    {
+        juce::SpinLock lock;
+        std::vector<int> tasks;            // ring buffer, size is a power of two
+        size_t head = 0, tail = 0;         // head: thieves take here, tail: owner pushes/pops here
+
+        void push (int task) noexcept;
+        bool popBack (int& task) noexcept;
+        bool popFront (int& task) noexcept;
+    };
+
+    class Worker;
+
+    bool tryPop (int workerIndex, int& task) noexcept;
+    bool trySteal (int workerIndex, juce::uint32& randomState, int& task) noexcept;
+    void wakeSleepingWorker() noexcept;
+
+    TaskFunction runTask;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    alignas (64) std::atomic<int> numQueuedTasks { 0 };
+    alignas (64) std::atomic<int> numSleepingWorkers { 0 };
+    std::atomic<int> nextExternalQueue { 0 };
+    juce::WaitableEvent workAvailable;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkStealingPool)
+};
+
+} // namespace stress
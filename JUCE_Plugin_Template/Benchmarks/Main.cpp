@@ -0,0 +1,25 @@
+/*
+  ==============================================================================
+
+    Plugin Benchmarks
+    
+    Runs processBlock() latency/throughput sweeps on the plugin processor.
+    Run with --help for options, e.g.
+        YourPluginName_Benchmarks --quick --json results.json
+
+  ==============================================================================
+*/
+
+#include "ProcessorBenchmark.h"
+#include "PluginProcessor.h"
+
+// Defined in PluginProcessor.cpp
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // CUSTOMIZE: Add your own benchmark suites through the last argument
+    return benchmarks::runBenchmarkMain (argc, argv, "YourPlugin",
+                                         [] { return std::unique_ptr<juce::AudioProcessor> (createPluginFilter()); });
+}
@@ -0,0 +1,25 @@
+/*
+  ==============================================================================
+
+    Plugin Stress Host
+    
+    Runs many instances of the plugin processor as a DAW-style graph on a
+    work-stealing pool, with concurrent automation and state save/load.
+    Run with --help for options, e.g.
+        YourPluginName_StressHost --instances 200 --json stress.json
+
+  ==============================================================================
+*/
+
+#include "StressHost.h"
+#include "PluginProcessor.h"
+
+// Defined in PluginProcessor.cpp
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    return stress::runStressHostMain (argc, argv, "YourPlugin",
+                                      [] { return std::unique_ptr<juce::AudioProcessor> (createPluginFilter()); });
+}
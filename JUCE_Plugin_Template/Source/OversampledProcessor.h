@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    Oversampled Processor
+
+    Runs a juce::dsp processing chain at 1x, 2x, 4x or 8x the host sample
+    rate, so nonlinear stages (saturation, clipping, waveshaping) alias less.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+ * Wraps a processor (anything with juce::dsp-style prepare/reset/process
+ * methods for SampleType) in juce::dsp::Oversampling.
+ *
+ * Everything is allocated in prepare(): one copy of the processor per
+ * factor, each prepared at its own sample rate, and two oversamplers per
+ * factor, one for each quality tier:
+ *
+ * - Quality::live uses polyphase IIR half-band filters: cheap, with a few
+ *   samples of latency, but not linear phase.
+ * - Quality::offline uses linear-phase FIR half-band filters at maximum
+ *   quality: more CPU and more latency, which doesn't matter when rendering.
+ *
+ * setMode() can then switch factor or tier from processBlock() without
+ * allocating. Both oversamplers use integer latency, so getLatencySamples()
+ * is exact and can be passed straight to AudioProcessor::setLatencySamples().
+ *
+ * Each copy of the processor keeps its own state, so give every copy the
+ * same parameters (see forEachProcessor()). Heavy processors are prepared
+ * four times; if that is too much memory, limit maxOrder.
+ */
+template <typename SampleType, typename ProcessorType>
+class OversampledProcessor
+{
+public:
+    //==============================================================================
+    enum class Quality
+    {
+        live,       // polyphase IIR, for real-time playback
+        offline     // linear-phase FIR, for offline renders
+    };
+
+    /* Order 0 runs at the host rate; order n at 2^n times it (8x at most) */
+    static constexpr int maxOrder = 3;
+
+    /* Choice names for an oversampling parameter, indexed by order */
+    static juce::StringArray getOrderNames() { return { "Off", "2x", "4x", "8x" }; }
+
+    //==============================================================================
+    /* Allocates everything; call from prepareToPlay() */
+    void prepare (const juce::dsp::ProcessSpec& spec)
+    {
+        for (int order = 0; order <= maxOrder; ++order)
+        {
+            const auto factor = (juce::uint32) 1 << order;
+
+            processors[(size_t) order].prepare ({ spec.sampleRate * factor,
+                                                  spec.maximumBlockSize * factor,
+                                                  spec.numChannels });
+
+            if (order == 0)
+                continue;
+
+            for (auto quality : { Quality::live, Quality::offline })
+            {
+                auto& oversampler = getOversamplerSlot (order, quality);
+
+                oversampler = std::make_unique<juce::dsp::Oversampling<SampleType>> (
+                    (size_t) spec.numChannels,
+                    (size_t) order,
+                    quality == Quality::live ? juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR
+                                             : juce::dsp::Oversampling<SampleType>::filterHalfBandFIREquiripple,
+                    quality == Quality::offline,    // maximum filter quality
+                    true);                          // integer latency
+
+                oversampler->initProcessing ((size_t) spec.maximumBlockSize);
+            }
+        }
+
+        reset();
+    }
+
+    /* Clears the filter and processor state of the current mode */
+    void reset() noexcept
+    {
+        processors[(size_t) currentOrder].reset();
+
+        if (auto* oversampler = getCurrentOversampler())
+            oversampler->reset();
+    }
+
+    //==============================================================================
+    /* Selects the factor and tier. Returns true if the mode changed, in which
+       case the newly used filters and processor are reset and the latency may
+       be different. Doesn't allocate, so it's safe in processBlock(). */
+    bool setMode (int order, Quality quality) noexcept
+    {
+        order = juce::jlimit (0, maxOrder, order);
+
+        if (order == currentOrder && (order == 0 || quality == currentQuality))
+        {
+            currentQuality = quality;
+            return false;
+        }
+
+        currentOrder = order;
+        currentQuality = quality;
+        reset();
+        return true;
+    }
+
+    int getOrder() const noexcept         { return currentOrder; }
+    Quality getQuality() const noexcept   { return currentQuality; }
+
+    /* Latency of the current mode at the host sample rate */
+    int getLatencySamples() const noexcept
+    {
+        if (auto* oversampler = getCurrentOversampler())
+            return juce::roundToInt (oversampler->getLatencyInSamples());
+
+        return 0;
+    }
+
+    //==============================================================================
+    /* Calls fn (ProcessorType&) on every copy, e.g. to set parameters */
+    template <typename Function>
+    void forEachProcessor (Function&& fn)
+    {
+        for (auto& processor : processors)
+            fn (processor);
+    }
+
+    //==============================================================================
+    /* Upsamples the block, runs the processor at the higher rate and
+       downsamples back into the block */
+    void process (juce::dsp::AudioBlock<SampleType> block) noexcept
+    {
+        auto& processor = processors[(size_t) currentOrder];
+        auto* oversampler = getCurrentOversampler();
+
+        if (oversampler == nullptr)
+        {
+            processor.process (juce::dsp::ProcessContextReplacing<SampleType> (block));
+            return;
+        }
+
+        auto oversampledBlock = oversampler->processSamplesUp (block);
+        processor.process (juce::dsp::ProcessContextReplacing<SampleType> (oversampledBlock));
+        oversampler->processSamplesDown (block);
+    }
+
+private:
+    //==============================================================================
+    std::unique_ptr<juce::dsp::Oversampling<SampleType>>& getOversamplerSlot (int order, Quality quality) noexcept
+    {
+        return oversamplers[(size_t) (order - 1)][(size_t) quality];
+    }
+
+    juce::dsp::Oversampling<SampleType>* getCurrentOversampler() const noexcept
+    {
+        return currentOrder == 0 ? nullptr
+                                 : oversamplers[(size_t) (currentOrder - 1)][(size_t) currentQuality].get();
+    }
+
+    std::array<ProcessorType, maxOrder + 1> processors;
+    std::array<std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, 2>, maxOrder> oversamplers;
+
+    int currentOrder = 0;
+    Quality currentQuality = Quality::live;
+};
@@ -22,6 +22,9 @@ YourPluginAudioProcessorEditor::YourPluginAudioProcessorEditor (YourPluginAudioP
     // The size of your plugin window in pixels
     setSize (400, 300);
     
+    // Output level meter and scope along the bottom (see resized())
+    addAndMakeVisible (signalMonitor);
+    
     // Example of adding a slider:
     // ----------------------------
     // // Create and set up the volume slider
@@ -43,9 +46,12 @@ YourPluginAudioProcessorEditor::YourPluginAudioProcessorEditor (YourPluginAudioP
     // // Add a listener to handle slider value changes
     // volumeSlider.addListener(this);
     // 
-    // // Or connect to an AudioProcessorValueTreeState like this:
-    // volumeSliderAttachment = new juce::AudioProcessorValueTreeState::SliderAttachment(
-    //     audioProcessor.parameters, "volume", volumeSlider);
+    // // Or, better, connect it to the parameter. This keeps the slider in sync
+    // // with automation and sends drags to the host as begin/end gestures,
+    // // with at most 30 updates a second (needs #include "BatchedSliderAttachment.h"
+    // // and a std::unique_ptr<params::BatchedSliderAttachment> member):
+    // volumeAttachment = std::make_unique<params::BatchedSliderAttachment> (
+    //     *audioProcessor.parameters.getParameter ("volume"), volumeSlider);
 }
 
 YourPluginAudioProcessorEditor::~YourPluginAudioProcessorEditor()
@@ -89,6 +95,8 @@ void YourPluginAudioProcessorEditor::resized()
     // This is called when the editor is resized.
     // If you add any components to your editor, you should position them here.
     
+    signalMonitor.setBounds (getLocalBounds().removeFromBottom (80).reduced (10));
+    
     // Example of positioning UI components:
     // ------------------------------------
     // Rectangle layout:
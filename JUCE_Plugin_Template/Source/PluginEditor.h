@@ -13,6 +13,7 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "SignalMonitor.h"
 
 //==============================================================================
 /**
@@ -48,5 +49,8 @@ private:
     // This reference is provided as a quick way to access the processor
     YourPluginAudioProcessor& audioProcessor;
 
+    // Output level meter and scope; the processor only measures while it exists
+    gfx::SignalMonitor signalMonitor { audioProcessor.getMeterFeed() };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (YourPluginAudioProcessorEditor)
 };
\ No newline at end of file
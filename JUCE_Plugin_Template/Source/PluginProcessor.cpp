@@ -14,6 +14,11 @@
 
 //==============================================================================
 YourPluginAudioProcessor::YourPluginAudioProcessor()
+    : YourPluginAudioProcessor (makeDefaultPresetOptions())
+{
+}
+
+YourPluginAudioProcessor::YourPluginAudioProcessor (const plugindsp::PresetScanner::Options& presetOptions)
 #ifndef JucePlugin_PreferredChannelConfigurations
      : AudioProcessor (BusesProperties()
                      #if ! JucePlugin_IsMidiEffect
@@ -22,19 +27,13 @@ YourPluginAudioProcessor::YourPluginAudioProcessor()
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
-                       )
+                       ),
+#else
+     :
 #endif
+       parameters (*this, nullptr, "Parameters", createParameterLayout()),
+       presetLibrary (*this, presetOptions)
 {
-    // CUSTOMIZE: Initialize your parameters here
-    // Example:
-    // addParameter(volumeParameter = new juce::AudioParameterFloat(
-    //     "volume",                  // Parameter ID
-    //     "Volume",                  // Parameter name
-    //     0.0f,                      // Minimum value
-    //     1.0f,                      // Maximum value
-    //     0.7f                       // Default value
-    // ));
-    
     // CUSTOMIZE: Initialize any other member variables or processing objects here
 }
 
@@ -43,6 +42,49 @@ YourPluginAudioProcessor::~YourPluginAudioProcessor()
     // CUSTOMIZE: Add any cleanup code here if needed
 }
 
+juce::AudioProcessorValueTreeState::ParameterLayout YourPluginAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+    // Output gain applied after your processing (see processBlock)
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID { "outputGain", 1 },  // Parameter ID and version hint
+        "Output Gain",                          // Parameter name
+        0.0f,                                   // Minimum value
+        1.0f,                                   // Maximum value
+        1.0f                                    // Default value
+    ));
+
+    // Drive into the saturator in ProcessingChain (0 dB leaves it off)
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID { "drive", 1 },
+        "Drive",
+        juce::NormalisableRange<float> (0.0f, 24.0f, 0.1f),
+        0.0f,
+        juce::AudioParameterFloatAttributes().withLabel ("dB")
+    ));
+
+    // How far ProcessingChain is oversampled (Off, 2x, 4x, 8x)
+    layout.add (std::make_unique<juce::AudioParameterChoice> (
+        juce::ParameterID { "oversampling", 1 },
+        "Oversampling",
+        OversampledChain<float>::getOrderNames(),
+        0
+    ));
+
+    // CUSTOMIZE: Add your parameters here
+    // Example:
+    // layout.add (std::make_unique<juce::AudioParameterFloat> (
+    //     juce::ParameterID { "volume", 1 },  // Parameter ID and version hint
+    //     "Volume",                           // Parameter name
+    //     0.0f,                               // Minimum value
+    //     1.0f,                               // Maximum value
+    //     0.7f                                // Default value
+    // ));
+
+    return layout;
+}
+
 //==============================================================================
 const juce::String YourPluginAudioProcessor::getName() const
 {
@@ -86,26 +128,24 @@ double YourPluginAudioProcessor::getTailLengthSeconds() const
 
 int YourPluginAudioProcessor::getNumPrograms()
 {
-    // CUSTOMIZE: Update this if your plugin uses programs (presets)
-    return 1;   // Default: 1 program (preset)
+    // Programs are the presets in the user's library (see PresetLibrary)
+    return presetLibrary.getNumPrograms();
 }
 
 int YourPluginAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return presetLibrary.getCurrentProgram();
 }
 
 void YourPluginAudioProcessor::setCurrentProgram (int index)
 {
-    // CUSTOMIZE: Add code to switch between presets
-    juce::ignoreUnused(index);
+    // Safe from any thread: the preset is read and applied off the audio thread
+    presetLibrary.setCurrentProgram (index);
 }
 
 const juce::String YourPluginAudioProcessor::getProgramName (int index)
 {
-    // CUSTOMIZE: Return the name of the specified preset
-    juce::ignoreUnused(index);
-    return {};
+    return presetLibrary.getProgramName (index);
 }
 
 void YourPluginAudioProcessor::changeProgramName (int index, const juce::String& newName)
@@ -131,7 +171,32 @@ void YourPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerB
     
     // Reset any processing state if needed
     
-    juce::ignoreUnused(sampleRate, samplesPerBlock);
+    // Allocates the processing chain at every oversampling factor, and the
+    // filters for both quality tiers, so processBlock() can switch between
+    // them without allocating. Hosts choose the precision before preparing,
+    // so only the chain for that precision is allocated.
+    const auto numChannels = juce::jmax (getTotalNumInputChannels(), getTotalNumOutputChannels());
+    const juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) samplesPerBlock, (juce::uint32) numChannels };
+    
+    const auto prepareChain = [&] (auto& oversampledChain)
+    {
+        oversampledChain.prepare (spec);
+        updateOversamplingMode (oversampledChain);
+        setLatencySamples (oversampledChain.getLatencySamples());
+    };
+    
+    if (isUsingDoublePrecision())
+        prepareChain (doubleChain);
+    else
+        prepareChain (floatChain);
+    
+    // Start a fresh 32-sample grid, with room to split at this many distinct
+    // MIDI event times per block
+    subBlocks.reset();
+    splitPositions.reserve ((size_t) maxSplitPositionsPerBlock);
+    
+    // The scope needs the sample rate to show a fixed time span
+    meterFeed.setSampleRate (sampleRate);
 }
 
 void YourPluginAudioProcessor::releaseResources()
@@ -167,8 +232,23 @@ bool YourPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layout
 #endif
 
 void YourPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples (buffer, midiMessages);
+}
+
+void YourPluginAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    // Called instead of the float version when the host processes at 64 bits
+    // (see supportsDoublePrecisionProcessing()), so it doesn't convert
+    processSamples (buffer, midiMessages);
+}
+
+template <typename SampleType>
+void YourPluginAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages)
 {
     // CUSTOMIZE: This is where you implement your audio processing!
+    // It's compiled once for float and once for double, so write it in terms
+    // of SampleType; there's no per-sample check of the precision.
     
     // Safety checks - don't modify these
     juce::ScopedNoDenormals noDenormals;
@@ -183,8 +263,8 @@ void YourPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, j
     // -----------------------------------------
     // Examples:
     
-    // 1. Simple gain control:
-    // float gainValue = *volumeParameter;
+    // 1. Simple gain control (volume is a params::RawParameter):
+    // float gainValue = volume.get();
     // for (int channel = 0; channel < totalNumInputChannels; ++channel)
     // {
     //     auto* channelData = buffer.getWritePointer(channel);
@@ -197,28 +277,126 @@ void YourPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, j
     // 2. Using JUCE's DSP module:
     // juce::dsp::AudioBlock<float> block(buffer);
     // juce::dsp::ProcessContextReplacing<float> context(block);
-    // gainProcessor.setGainLinear(*volumeParameter);
+    // gainProcessor.setGainLinear(volume.get());
     // gainProcessor.process(context);
     
-    // 3. Process MIDI data (if your plugin uses MIDI):
-    // for (const auto metadata : midiMessages)
+    // 3. Process MIDI data (if your plugin uses MIDI): see handleMidiMessage()
+    
+    // Read parameters through params::RawParameter members (see PluginProcessor.h)
+    
+    // The oversampling mode changes the latency, so it's set per host block
+    // and the host is told whenever it changes. Offline renders switch to
+    // the linear-phase filters.
+    auto& oversampledChain = getOversampledChain<SampleType>();
+    
+    if (updateOversamplingMode (oversampledChain))
+        setLatencySamples (oversampledChain.getLatencySamples());
+    
+    // Split the block at every MIDI event so each one lands on its exact
+    // sample. (Capacity is reserved in prepareToPlay(); in the unlikely case
+    // of more distinct event times than that, the rest share a sub-block.)
+    const auto numSamples = buffer.getNumSamples();
+    splitPositions.clear();
+    
+    for (const auto metadata : midiMessages)
+        if (metadata.samplePosition < numSamples
+             && splitPositions.size() < splitPositions.capacity()
+             && (splitPositions.empty() || splitPositions.back() != metadata.samplePosition))
+            splitPositions.push_back (metadata.samplePosition);
+    
+    // CUSTOMIZE: Work per sub-block rather than per host block. Control-rate
+    // work (in updateControlState()) then runs every 32 samples whatever
+    // buffer size the host uses, and MIDI is handled on the exact sample.
+    juce::dsp::AudioBlock<SampleType> block (buffer);
+    auto nextMidiEvent = midiMessages.cbegin();
+    
+    subBlocks.process (buffer.getNumSamples(), splitPositions.data(), (int) splitPositions.size(),
+                       [&] (const plugindsp::SubBlock& subBlock)
+    {
+        bool handledEvents = false;
+        
+        // Events a host put past the end of the block are handled before the
+        // last sub-block rather than dropped
+        for (; nextMidiEvent != midiMessages.cend()
+                 && juce::jmin ((*nextMidiEvent).samplePosition, numSamples - 1) < subBlock.start + subBlock.length;
+             ++nextMidiEvent)
+        {
+            handleMidiMessage (*nextMidiEvent);
+            handledEvents = true;
+        }
+        
+        if (subBlock.startsControlPeriod || handledEvents)
+            updateControlState (oversampledChain);
+        
+        processSubBlock (oversampledChain, block.getSubBlock ((size_t) subBlock.start, (size_t) subBlock.length));
+    });
+    
+    // Apply the output gain with the shared gain kernels (plugindsp::; SIMD
+    // dispatched for float, with a double overload). Skipped at unity gain so the template passes audio through untouched.
+    const auto outputGainValue = outputGain.get();
+
+    if (outputGainValue != 1.0f)
+        plugindsp::applyGain (buffer.getArrayOfWritePointers(), buffer.getNumChannels(),
+                              buffer.getNumSamples(), (SampleType) outputGainValue);
+    
+    // Level summaries for the editor's meter and scope (free when no editor is open)
+    meterFeed.push (buffer.getArrayOfReadPointers(), totalNumOutputChannels, buffer.getNumSamples());
+}
+
+template <typename SampleType>
+void YourPluginAudioProcessor::updateControlState (OversampledChain<SampleType>& oversampledChain) noexcept
+{
+    // CUSTOMIZE: Read parameters and update modulation here. It runs at the
+    // start of every 32-sample period and after MIDI events, not per sample.
+    driveDecibels = drive.get();
+    
+    oversampledChain.forEachProcessor ([this] (ProcessingChain<SampleType>& chain)
+    {
+        chain.setDriveDecibels (driveDecibels);
+    });
+}
+
+void YourPluginAudioProcessor::handleMidiMessage (const juce::MidiMessageMetadata& metadata) noexcept
+{
+    // CUSTOMIZE: Handle MIDI here. It's called just before the sub-block
+    // that starts at the message's sample position.
+    // Read the raw bytes: building a juce::MidiMessage (getMessage()) would
+    // allocate for long SysEx messages, here on the audio thread.
+    // Example:
+    // const auto status = metadata.numBytes >= 3 ? metadata.data[0] & 0xf0 : 0;
+    //
+    // if (status == 0x90 && metadata.data[2] > 0)
     // {
-    //     const auto message = metadata.getMessage();
-    //     const auto samplePosition = metadata.samplePosition;
-    //     
-    //     if (message.isNoteOn())
-    //     {
-    //         // Handle note on
-    //     }
-    //     else if (message.isNoteOff())
-    //     {
-    //         // Handle note off
-    //     }
+    //     // Handle note on: note metadata.data[1], velocity metadata.data[2]
+    // }
+    // else if (status == 0x80 || status == 0x90)
+    // {
+    //     // Handle note off
     // }
     
-    // Don't forget to handle any relevant parameters from the AudioProcessorValueTreeState
+    juce::ignoreUnused (metadata);
+}
+
+template <typename SampleType>
+void YourPluginAudioProcessor::processSubBlock (OversampledChain<SampleType>& oversampledChain,
+                                                juce::dsp::AudioBlock<SampleType> block) noexcept
+{
+    // CUSTOMIZE: Per-sample processing of one sub-block (at most 32 samples)
     
-    juce::ignoreUnused(midiMessages);
+    // Nonlinear processing, oversampled if enabled
+    if (driveDecibels > 0.0f || oversampledChain.getOrder() > 0)
+        oversampledChain.process (block);
+}
+
+template <typename SampleType>
+bool YourPluginAudioProcessor::updateOversamplingMode (OversampledChain<SampleType>& oversampledChain) noexcept
+{
+    // Hosts set the non-realtime flag before preparing for a render, but some
+    // change it between blocks, so this is checked every block
+    using Quality = typename OversampledChain<SampleType>::Quality;
+    const auto quality = isNonRealtime() ? Quality::offline : Quality::live;
+
+    return oversampledChain.setMode ((int) oversampling.get(), quality);
 }
 
 //==============================================================================
@@ -244,15 +422,11 @@ void YourPluginAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     // CUSTOMIZE: Store your parameters for session recall
     // This saves the plugin's state when the DAW's session is saved
     
-    // Example using ValueTreeState:
-    // auto state = parameters.copyState();
-    // std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    // copyXmlToBinary(*xml, destData);
-    
-    // Example without ValueTreeState:
-    // juce::MemoryOutputStream stream(destData, true);
-    // stream.writeFloat(*volumeParameter);
-    juce::ignoreUnused(destData);
+    // Saves every parameter in the ValueTreeState. Anything else you add to
+    // parameters.state (e.g. non-parameter settings) is saved too.
+    auto state = parameters.copyState();
+    std::unique_ptr<juce::XmlElement> xml (state.createXml());
+    copyXmlToBinary (*xml, destData);
 }
 
 void YourPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -260,16 +434,22 @@ void YourPluginAudioProcessor::setStateInformation (const void* data, int sizeIn
     // CUSTOMIZE: Restore your parameters from session data
     // This loads the plugin's state when the DAW's session is opened
     
-    // Example using ValueTreeState:
-    // std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
-    // if (xmlState.get() != nullptr && xmlState->hasTagName(parameters.state.getType()))
-    //     parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
-    
-    // Example without ValueTreeState:
-    // juce::MemoryInputStream stream(data, static_cast<size_t> (sizeInBytes), false);
-    // float savedVolume = stream.readFloat();
-    // *volumeParameter = savedVolume;
-    juce::ignoreUnused(data, sizeInBytes);
+    std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
+
+    if (xmlState != nullptr)
+    {
+        if (xmlState->hasTagName (parameters.state.getType()))
+            parameters.replaceState (juce::ValueTree::fromXml (*xmlState));
+
+        return;
+    }
+
+    // Earlier versions of the template stored just the output gain as a raw float
+    if (sizeInBytes == (int) sizeof (float))
+    {
+        juce::MemoryInputStream stream (data, static_cast<size_t> (sizeInBytes), false);
+        outputGain.setValueNotifyingHost (stream.readFloat());
+    }
 }
 
 //==============================================================================
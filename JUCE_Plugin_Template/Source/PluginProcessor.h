@@ -12,6 +12,13 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "GainKernels.h"
+#include "MeterFeed.h"
+#include "OversampledProcessor.h"
+#include "ProcessingChain.h"
+#include "SubBlockScheduler.h"
+#include "RawParameter.h"
+#include "PresetLibrary.h"
 
 //==============================================================================
 /**
@@ -29,6 +36,9 @@ public:
     //==============================================================================
     /* Constructor and Destructor */
     YourPluginAudioProcessor();
+    /* With the presets somewhere else, such as a test's temporary directory,
+       or none at all (default-constructed options) */
+    explicit YourPluginAudioProcessor (const plugindsp::PresetScanner::Options& presetOptions);
     ~YourPluginAudioProcessor() override;
 
     //==============================================================================
@@ -45,6 +55,9 @@ public:
     //==============================================================================
     /* The core audio processing function - implement your DSP here */
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    /* The same processing at 64 bits, for hosts that ask for it */
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     /* Creates editor UI */
@@ -80,15 +93,97 @@ public:
     //==============================================================================
     /* CUSTOMIZE: Add your own parameters, member variables, and methods here */
 
-    /* Example: Create an AudioParameterFloat for a volume control */
-    // juce::AudioParameterFloat* volumeParameter;
+    /* Declares every parameter; add yours here (see PluginProcessor.cpp) */
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+
+    /* Owns the parameters. Editors attach to them by ID, e.g. with
+       params::BatchedSliderAttachment or AudioProcessorValueTreeState::SliderAttachment */
+    juce::AudioProcessorValueTreeState parameters;
+
+    /* Output gain, applied with the shared gain kernels at the end of processBlock() */
+    juce::RangedAudioParameter& getOutputGainParameter() { return outputGain.getParameter(); }
+
+    /* Per-block output levels for an editor's gfx::SignalMonitor (meter and scope) */
+    plugindsp::MeterFeed& getMeterFeed() { return meterFeed; }
+
+    /* The user's presets, which are also the host's programs. Show them in an
+       editor with a presets::PresetBrowser */
+    presets::PresetLibrary& getPresetLibrary() { return presetLibrary; }
 
 private:
     //==============================================================================
     /* CUSTOMIZE: Add your private member variables and methods here */
 
+    /* Cached raw parameter values for processBlock(): one atomic load each,
+       with no virtual call or ID lookup. Example for your own parameter: */
+    // params::RawParameter volume { parameters, "volume" };
+
+    /* Output gain (0.0 to 1.0, default 1.0 so audio passes through unchanged) */
+    params::RawParameter outputGain { parameters, "outputGain" };
+
+    /* Saturation drive (dB) and oversampling order for the processing chain */
+    params::RawParameter drive { parameters, "drive" };
+    params::RawParameter oversampling { parameters, "oversampling" };
+
+    /* The nonlinear processing, run at 1x-8x. CUSTOMIZE: ProcessingChain.h
+       There's one for each precision; prepareToPlay() prepares the one in use. */
+    template <typename SampleType>
+    using OversampledChain = OversampledProcessor<SampleType, ProcessingChain<SampleType>>;
+
+    OversampledChain<float> floatChain;
+    OversampledChain<double> doubleChain;
+
+    template <typename SampleType>
+    OversampledChain<SampleType>& getOversampledChain() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleChain;
+        else
+            return floatChain;
+    }
+
+    /* Picks the oversampling factor from its parameter and the filter quality
+       from isNonRealtime(); returns true if the latency may have changed */
+    template <typename SampleType>
+    bool updateOversamplingMode (OversampledChain<SampleType>& oversampledChain) noexcept;
+
+    /* The DSP for both processBlock() overloads, compiled once per sample type */
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages);
+
+    /* Splits host blocks into 32-sample sub-blocks, and at MIDI events */
+    plugindsp::SubBlockScheduler subBlocks;
+    std::vector<int> splitPositions;
+    static constexpr int maxSplitPositionsPerBlock = 1024;
+
+    /* Control-rate state, set by updateControlState() */
+    float driveDecibels = 0.0f;
+
+    /* Runs at the start of each 32-sample period and after MIDI events */
+    template <typename SampleType>
+    void updateControlState (OversampledChain<SampleType>& oversampledChain) noexcept;
+    /* Called for each MIDI message, on its sample; the raw bytes, so long SysEx doesn't allocate */
+    void handleMidiMessage (const juce::MidiMessageMetadata& metadata) noexcept;
+    /* Processes one sub-block of audio */
+    template <typename SampleType>
+    void processSubBlock (OversampledChain<SampleType>& oversampledChain,
+                          juce::dsp::AudioBlock<SampleType> block) noexcept;
+
+    /* Output levels for the editor; pushing costs one atomic load while no editor reads it */
+    plugindsp::MeterFeed meterFeed;
+
     /* For example, you might declare DSP processing objects here, such as: */
     // juce::dsp::Gain<float> gainProcessor;
+
+    /* Presets, saved from and loaded through get/setStateInformation().
+       CUSTOMIZE: your plugin's name, a four-character code and a file extension. */
+    static plugindsp::PresetScanner::Options makeDefaultPresetOptions()
+    {
+        return presets::PresetLibrary::makeDefaultOptions ("YourPlugin", plugindsp::makeStateMagic ('Y', 'p', 'l', 'g'), ".preset");
+    }
+
+    /* Declared last so it goes first, before anything a program change touches */
+    presets::PresetLibrary presetLibrary;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (YourPluginAudioProcessor)
 };
\ No newline at end of file
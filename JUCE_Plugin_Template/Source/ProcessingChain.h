@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    Processing Chain
+
+    The template's nonlinear processing: a drive stage into a soft clipper.
+    It runs inside OversampledProcessor, at up to 8x the host sample rate.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+ * Drive -> tanh saturation -> make-up trim, as a juce::dsp::ProcessorChain.
+ *
+ * It's a template on the sample type, so the float and double processBlock()
+ * paths each get their own compiled copy with no per-sample branching.
+ *
+ * CUSTOMIZE: Replace or extend the stages with your own. Anything that
+ * creates new harmonics (clipping, waveshaping, distortion) belongs in here,
+ * so it runs at the oversampled rate; linear processing (EQ, gain) is
+ * cheaper outside it, in processBlock().
+ */
+template <typename SampleType>
+class ProcessingChain
+{
+public:
+    ProcessingChain()
+    {
+        chain.template get<shaperIndex>().functionToUse = [] (SampleType x) { return std::tanh (x); };
+
+        // Short ramps so drive automation doesn't zipper
+        chain.template get<driveIndex>().setRampDurationSeconds (0.02);
+        chain.template get<trimIndex>().setRampDurationSeconds (0.02);
+    }
+
+    //==============================================================================
+    /* juce::dsp processor interface, used by OversampledProcessor */
+    void prepare (const juce::dsp::ProcessSpec& spec)   { chain.prepare (spec); }
+    void reset() noexcept                               { chain.reset(); }
+
+    void process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+    {
+        chain.process (context);
+    }
+
+    //==============================================================================
+    /* Gain into the saturator; the output is trimmed by half as much */
+    void setDriveDecibels (float newDriveDecibels) noexcept
+    {
+        // tanh flattens loud signals, so only trim back part of the drive
+        chain.template get<driveIndex>().setGainDecibels ((SampleType) newDriveDecibels);
+        chain.template get<trimIndex>().setGainDecibels ((SampleType) (newDriveDecibels * -0.5f));
+
+        // At 0 dB the chain is clean, so oversampling alone doesn't colour the sound
+        chain.template setBypassed<shaperIndex> (newDriveDecibels <= 0.0f);
+    }
+
+private:
+    enum
+    {
+        driveIndex,
+        shaperIndex,
+        trimIndex
+    };
+
+    juce::dsp::ProcessorChain<juce::dsp::Gain<SampleType>,
+                              juce::dsp::WaveShaper<SampleType>,
+                              juce::dsp::Gain<SampleType>> chain;
+};
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    Plugin Tests - real-time safety
+
+    Runs every processBlock() call under the real-time checker and fails on
+    any allocation, lock or blocking call. Add a section here for each
+    parameter or MIDI path you add to the processor.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "ProcessorTests.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+    void requireRealtimeSafe (const rtcheck::Report& report)
+    {
+        INFO (report.describe());
+        CHECK (report.numChecks > 0);
+        CHECK (report.isClean());
+    }
+
+    void setParameter (juce::AudioProcessor& processor, const juce::String& parameterID, float normalisedValue)
+    {
+        auto* parameter = processortests::findParameter (processor, parameterID);
+        REQUIRE (parameter != nullptr);
+        parameter->setValueNotifyingHost (normalisedValue);
+    }
+}
+
+//==============================================================================
+TEST_CASE ("processBlock() is real-time safe", "[realtime]")
+{
+    YourPluginAudioProcessor processor;
+    processortests::BlockSettings settings;
+
+    SECTION ("single precision")
+    {
+        requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+    }
+
+    SECTION ("double precision")
+    {
+        settings.precision = juce::AudioProcessor::doublePrecision;
+        requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+    }
+
+    SECTION ("program changes from the audio thread")
+    {
+        // Some hosts call setCurrentProgram() on the audio thread; it may only note the index
+        settings.onAudioThread = [&] (int block) { processor.setCurrentProgram (block % 3); };
+        requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+        CHECK (processor.getCurrentProgram() == (settings.numBlocks - 1) % 3);
+    }
+}
+
+TEST_CASE ("processBlock() is real-time safe at every oversampling factor", "[realtime]")
+{
+    YourPluginAudioProcessor processor;
+    processortests::BlockSettings settings;
+    settings.numBlocks = 50;
+
+    // Off, 2x, 4x and 8x with the drive on, then switching factor every block
+    for (int order = 0; order < 4; ++order)
+    {
+        INFO ("oversampling choice " << order);
+        setParameter (processor, "drive", 0.5f);
+        setParameter (processor, "oversampling", (float) order / 3.0f);
+        requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+    }
+
+    settings.beforeBlock = [&] (int block, juce::MidiBuffer&)
+    {
+        setParameter (processor, "oversampling", (float) (block % 4) / 3.0f);
+        setParameter (processor, "outputGain", (float) (block % 10) / 10.0f);
+    };
+
+    requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+}
+
+TEST_CASE ("processBlock() is real-time safe when MIDI splits the block", "[realtime]")
+{
+    YourPluginAudioProcessor processor;
+    processortests::BlockSettings settings;
+
+    // A long SysEx message, too big for a MidiMessage's inline storage
+    std::vector<juce::uint8> sysex (256);
+
+    for (size_t i = 0; i < sysex.size(); ++i)
+        sysex[i] = (juce::uint8) (i % 128);
+
+    const auto sysexMessage = juce::MidiMessage::createSysExMessage (sysex.data(), (int) sysex.size());
+
+    // More distinct event times than the split positions reserved in prepareToPlay(),
+    // the SysEx, and an event a host put past the end of the block
+    settings.beforeBlock = [&] (int, juce::MidiBuffer& midi)
+    {
+        for (int i = 0; i < settings.blockSize; i += 3)
+            midi.addEvent (juce::MidiMessage::controllerEvent (1, 1, i % 128), i);
+
+        midi.addEvent (sysexMessage, settings.blockSize / 2);
+        midi.addEvent (juce::MidiMessage::noteOff (1, 60), settings.blockSize + 10);
+    };
+
+    requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+}
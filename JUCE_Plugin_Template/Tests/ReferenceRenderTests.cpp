@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    Plugin Tests - reference renders
+
+    Null tests of offline renders against the reference files in
+    Tests/Golden. The input is 0.1 s of 16-bit stereo at 48 kHz, and the
+    reference is the input at half gain, as 32-bit float, written by
+    JUCE_Plugin_Shared/Tools/ProcessorTests/make_reference_files.py:
+
+        make_reference_files.py inputs Golden
+        make_reference_files.py reference Golden/sine.wav Golden/sine_output_gain_0.5.wav 0.5
+
+    CUSTOMIZE: Once your processor does more than apply a gain, render
+    reference files with a build you've checked by ear (YourPluginName_Render
+    --bits 32) and add a test for each, so later changes that alter the sound
+    are caught.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "ProcessorTests.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+    /**
+     * The largest sample difference allowed, in dBFS. Float rounding stays
+     * well below this; any change to the sound is far above it.
+     */
+    constexpr double toleranceDb = -100.0;
+
+    juce::File getGoldenFile (const char* name)
+    {
+        return juce::File (PLUGIN_GOLDEN_DIR).getChildFile (name);
+    }
+}
+
+//==============================================================================
+TEST_CASE ("Renders a sine at half output gain with no drive", "[reference]")
+{
+    const auto factory = processortests::withParameterValues (
+        [] { return std::make_unique<YourPluginAudioProcessor>(); },
+        { { "outputGain", 0.5f }, { "drive", 0.0f }, { "oversampling", 0.0f } });
+
+    const auto test = processortests::renderAndNullTest (factory, getGoldenFile ("sine.wav"),
+                                                         getGoldenFile ("sine_output_gain_0.5.wav"), toleranceDb);
+
+    INFO (test.result.getErrorMessage());
+    REQUIRE (test.result.wasOk());
+    CHECK (test.peakDifferenceDb <= toleranceDb);
+}
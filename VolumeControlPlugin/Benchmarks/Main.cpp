@@ -0,0 +1,693 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    Benchmarks - processBlock() latency/throughput sweeps, state save/load
+    time per instance, clicks when switching state during playback, the
+    cost and host sync of the tempo LFO, how
+    processBlock() scales from mono to 16 channels, MIDI gain under dense
+    controller streams, and scanning, searching and loading a large preset
+    library
+
+    Run with --help for options, e.g.
+        VolumeControlBenchmarks --quick --json results.json
+
+  ==============================================================================
+*/
+
+#include "ProcessorBenchmark.h"
+#include "PluginProcessor.h"
+
+#include "BenchmarkUtilities.h"
+#include "PresetScanner.h"
+
+// Defined in PluginProcessor.cpp
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+namespace
+{
+    //==============================================================================
+    /** What getStateInformation() did before the binary format. */
+    void writeLegacyXmlState (float volume, juce::MemoryBlock& destData)
+    {
+        auto state = std::make_unique<juce::XmlElement> ("VolumeControlState");
+        state->setAttribute ("volume", (double) volume);
+        juce::AudioProcessor::copyXmlToBinary (*state, destData);
+    }
+
+    void addStateResult (benchmarks::Report& report, const juce::String& name,
+                         const std::vector<double>& timings, size_t stateBytes)
+    {
+        const auto summary = plugindsp::bench::summarise (timings);
+
+        juce::DynamicObject::Ptr fields (new juce::DynamicObject());
+        fields->setProperty ("ns_per_instance", summary.mean);
+        fields->setProperty ("p50_ns", summary.p50);
+        fields->setProperty ("p99_ns", summary.p99);
+        fields->setProperty ("ms_per_1000_instances", summary.mean * 1000.0 / 1.0e6);
+        fields->setProperty ("state_bytes", (int) stateBytes);
+        report.add (name, fields);
+    }
+
+    /**
+     * Times saving and restoring one instance's state in the binary format
+     * and in the legacy XML format that sessions saved with 1.0.0 contain.
+     */
+    void runStateSuite (const benchmarks::Options& options, benchmarks::Report& report)
+    {
+        std::unique_ptr<juce::AudioProcessor> processor (createPluginFilter());
+        auto& volume = *static_cast<VolumeControlProcessor&> (*processor).getVolumeParameter();
+
+        constexpr int callsPerBatch = 100;
+        const auto numBatches = options.secondsPerConfig < 1.0 ? 200 : 1000;
+
+        juce::MemoryBlock binaryState, xmlState;
+        processor->getStateInformation (binaryState);
+        writeLegacyXmlState (volume.get(), xmlState);
+
+        const auto run = [&] (const juce::String& name, size_t stateBytes, auto&& fn)
+        {
+            const auto fullName = "VolumeControl/state/" + name;
+
+            if (options.matchesFilter (fullName))
+                addStateResult (report, fullName,
+                                plugindsp::bench::timeBatches (fn, callsPerBatch, numBatches / 10, numBatches),
+                                stateBytes);
+        };
+
+        juce::MemoryBlock destination;
+
+        run ("save/binary", binaryState.getSize(), [&] { processor->getStateInformation (destination); });
+        run ("save/legacy_xml", xmlState.getSize(), [&] { writeLegacyXmlState (volume.get(), destination); });
+        run ("load/binary", binaryState.getSize(),
+             [&] { processor->setStateInformation (binaryState.getData(), (int) binaryState.getSize()); });
+        run ("load/legacy_xml", xmlState.getSize(),
+             [&] { processor->setStateInformation (xmlState.getData(), (int) xmlState.getSize()); });
+    }
+
+    //==============================================================================
+    /**
+     * Loads two very different states alternately while audio runs (every
+     * 8 blocks, as a user flicking through presets might), with the state
+     * crossfade off and at a few lengths. The input is DC, so the output is
+     * the gain curve itself: max_step, the largest change between adjacent
+     * samples, is the size of the worst click. Also reports the block times,
+     * which include the blocks spent crossfading.
+     */
+    void runStateSwitchSuite (const benchmarks::Options& options, benchmarks::Report& report)
+    {
+        constexpr int blockSize = 256;
+        constexpr int numChannels = 2;
+        constexpr double sampleRate = 48000.0;
+        constexpr int blocksPerSwitch = 8;
+
+        const auto numBlocks = juce::roundToInt (juce::jmax (1.0, options.secondsPerConfig) * sampleRate / blockSize);
+
+        // Two states far apart: loud with a slow deep tremolo, quiet with a fast shallow one
+        juce::MemoryBlock states[2];
+
+        {
+            std::unique_ptr<juce::AudioProcessor> processor (createPluginFilter());
+            auto& state = static_cast<VolumeControlProcessor&> (*processor).getValueTreeState();
+            const float settings[2][3] = { { 1.0f, 0.8f, 0.0f }, { 0.2f, 0.3f, 1.0f } };
+
+            for (int i = 0; i < 2; ++i)
+            {
+                state.getParameter ("volume")->setValueNotifyingHost (settings[i][0]);
+                state.getParameter ("lfoDepth")->setValueNotifyingHost (settings[i][1]);
+                state.getParameter ("lfoRate")->setValueNotifyingHost (settings[i][2]);
+                processor->getStateInformation (states[i]);
+            }
+        }
+
+        const auto runConfig = [&] (const juce::String& name, int fadeLength)
+        {
+            const auto fullName = "VolumeControl/state/switch/" + name;
+
+            if (! options.matchesFilter (fullName))
+                return;
+
+            std::unique_ptr<juce::AudioProcessor> processor (createPluginFilter());
+            auto& volumeControl = static_cast<VolumeControlProcessor&> (*processor);
+            processor->setStateInformation (states[0].getData(), (int) states[0].getSize());
+
+            benchmarks::setMainBusChannels (*processor, numChannels);
+            processor->setRateAndBufferSizeDetails (sampleRate, blockSize);
+            processor->prepareToPlay (sampleRate, blockSize);
+
+            if (fadeLength >= 0)
+                volumeControl.setStateCrossfadeLength (fadeLength);
+
+            juce::AudioBuffer<float> buffer (numChannels, blockSize);
+            juce::MidiBuffer midi;
+            std::vector<double> blockTimes;
+            blockTimes.reserve ((size_t) numBlocks);
+
+            auto previousSample = 0.0f;
+            auto maxStep = 0.0f;
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                // Loaded between blocks, as the message thread would
+                if (block > 0 && block % blocksPerSwitch == 0)
+                {
+                    const auto& next = states[(block / blocksPerSwitch) % 2];
+                    processor->setStateInformation (next.getData(), (int) next.getSize());
+                }
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    juce::FloatVectorOperations::fill (buffer.getWritePointer (channel), 0.5f, blockSize);
+
+                const auto start = plugindsp::bench::Clock::now();
+                processor->processBlock (buffer, midi);
+                blockTimes.push_back (plugindsp::bench::nanosecondsBetween (start, plugindsp::bench::Clock::now()));
+
+                // The first blocks settle from the prepared state
+                const auto* samples = buffer.getReadPointer (0);
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    if (block >= 2)
+                        maxStep = juce::jmax (maxStep, std::abs (samples[i] - previousSample));
+
+                    previousSample = samples[i];
+                }
+            }
+
+            processor->releaseResources();
+
+            juce::DynamicObject::Ptr fields (new juce::DynamicObject());
+            benchmarks::addBlockTimingFields (*fields, benchmarks::summariseBlockTimes (std::move (blockTimes)),
+                                              blockSize, numChannels, sampleRate);
+            fields->setProperty ("fade_samples", volumeControl.getStateCrossfadeLength());
+            fields->setProperty ("max_step", maxStep);
+            report.add (fullName, fields);
+        };
+
+        runConfig ("no_fade", 0);
+        runConfig ("fade_256", 256);
+        runConfig ("fade_default", -1);
+        runConfig ("fade_4800", 4800);
+    }
+
+    //==============================================================================
+    /** A host transport playing a loop, with the tempo set by the benchmark. */
+    class SimulatedPlayHead  : public juce::AudioPlayHead
+    {
+    public:
+        juce::Optional<PositionInfo> getPosition() const override
+        {
+            PositionInfo info;
+            info.setIsPlaying (true);
+            info.setPpqPosition (ppq);
+            info.setBpm (bpm);
+            info.setTimeSignature (TimeSignature { 4, 4 });
+            info.setIsLooping (isLooping);
+            info.setLoopPoints (LoopPoints { loopStart, loopEnd });
+            return info;
+        }
+
+        /** Moves on by one block, wrapping at the loop end as a host would. */
+        void advance (int numSamples, double sampleRate)
+        {
+            ppq += numSamples * bpm / (60.0 * sampleRate);
+
+            if (isLooping && ppq >= loopEnd)
+                ppq = loopStart + (ppq - loopEnd);
+        }
+
+        double ppq = 0.0, bpm = 120.0;
+        bool isLooping = false;
+        double loopStart = 0.0, loopEnd = 8.0;
+    };
+
+    /**
+     * Times processBlock() with the tremolo off and on, and checks the LFO
+     * stays locked to the host over an hour of tempo changes and loop jumps.
+     */
+    void runLfoSuite (const benchmarks::Options& options, benchmarks::Report& report)
+    {
+        constexpr int blockSize = 512;
+        constexpr int numChannels = 2;
+        constexpr double sampleRate = 48000.0;
+
+        const auto numBlocks = juce::roundToInt (juce::jmax (1.0, options.secondsPerConfig) * sampleRate / blockSize);
+
+        const auto runConfig = [&] (const juce::String& name, float depth, bool looping, bool changeTempo)
+        {
+            const auto fullName = "VolumeControl/lfo/" + name;
+
+            if (! options.matchesFilter (fullName))
+                return;
+
+            std::unique_ptr<juce::AudioProcessor> processor (createPluginFilter());
+            auto& state = static_cast<VolumeControlProcessor&> (*processor).getValueTreeState();
+            state.getParameter ("lfoDepth")->setValueNotifyingHost (depth);
+            state.getParameter ("lfoRate")->setValueNotifyingHost (state.getParameter ("lfoRate")->convertTo0to1 (6.0f));
+
+            SimulatedPlayHead playHead;
+            playHead.isLooping = looping;
+            processor->setPlayHead (&playHead);
+
+            benchmarks::setMainBusChannels (*processor, numChannels);
+            processor->setRateAndBufferSizeDetails (sampleRate, blockSize);
+            processor->prepareToPlay (sampleRate, blockSize);
+
+            juce::AudioBuffer<float> buffer (numChannels, blockSize);
+            juce::MidiBuffer midi;
+            std::vector<double> blockTimes;
+            blockTimes.reserve ((size_t) numBlocks);
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    juce::FloatVectorOperations::fill (buffer.getWritePointer (channel), 0.5f, blockSize);
+
+                if (changeTempo)
+                    playHead.bpm = 120.0 + 20.0 * std::sin (block * 0.01);
+
+                const auto start = plugindsp::bench::Clock::now();
+                processor->processBlock (buffer, midi);
+                blockTimes.push_back (plugindsp::bench::nanosecondsBetween (start, plugindsp::bench::Clock::now()));
+
+                playHead.advance (blockSize, sampleRate);
+            }
+
+            processor->releaseResources();
+            processor->setPlayHead (nullptr);
+
+            juce::DynamicObject::Ptr fields (new juce::DynamicObject());
+            benchmarks::addBlockTimingFields (*fields, benchmarks::summariseBlockTimes (std::move (blockTimes)),
+                                              blockSize, numChannels, sampleRate);
+            report.add (fullName, fields);
+        };
+
+        runConfig ("depth_0", 0.0f, false, false);
+        runConfig ("depth_1", 1.0f, false, false);
+        runConfig ("depth_1/loop_tempo_changes", 1.0f, true, true);
+
+        // Sync check: an hour at an odd block size, with the tempo changing
+        // every block and a loop whose end falls mid-block. After every block
+        // the LFO's phase must match the host position exactly.
+        const auto driftName = juce::String ("VolumeControl/lfo/sync_error_1h");
+
+        if (! options.matchesFilter (driftName))
+            return;
+
+        constexpr int oddBlockSize = 509;
+        const auto numSyncBlocks = (int) (3600.0 * sampleRate / oddBlockSize);
+        const auto beatsPerCycle = TempoSyncedLFO::getBeatsPerCycle (6, 4.0);
+
+        TempoSyncedLFO lfo;
+        lfo.prepare (sampleRate, oddBlockSize);
+
+        SimulatedPlayHead playHead;
+        playHead.isLooping = true;
+        playHead.loopEnd = 7.3;
+
+        juce::AudioBuffer<float> buffer (1, oddBlockSize);
+        double maxError = 0.0;
+
+        for (int block = 0; block < numSyncBlocks; ++block)
+        {
+            playHead.bpm = 90.0 + 60.0 * std::abs (std::sin (block * 0.003));
+
+            lfo.process (buffer, oddBlockSize, TempoSyncedLFO::Transport::fromPlayHead (&playHead), 6, 0.0f);
+            playHead.advance (oddBlockSize, sampleRate);
+
+            const auto expected = playHead.ppq / beatsPerCycle;
+            auto error = std::abs (lfo.getNextPhase() - (expected - std::floor (expected)));
+            maxError = juce::jmax (maxError, juce::jmin (error, 1.0 - error));
+        }
+
+        juce::DynamicObject::Ptr fields (new juce::DynamicObject());
+        fields->setProperty ("blocks", numSyncBlocks);
+        fields->setProperty ("max_phase_error_cycles", maxError);
+        report.add (driftName, fields);
+    }
+
+    //==============================================================================
+    /**
+     * Times processBlock() on surround and ambisonic layouts, with every
+     * channel trimmed differently and the tremolo on, and fits the block time
+     * to fixed + perChannel * channels. If processing really is one pass per
+     * channel, the fit is close to linear (R^2 near 1) and the cost per
+     * channel-sample at 16 channels is no worse than at 1.
+     */
+    void runChannelScalingSuite (const benchmarks::Options& options, benchmarks::Report& report)
+    {
+        constexpr int blockSize = 512;
+        constexpr double sampleRate = 48000.0;
+
+        const auto numBlocks = juce::roundToInt (juce::jmax (1.0, options.secondsPerConfig) * sampleRate / blockSize);
+
+        const std::pair<const char*, juce::AudioChannelSet> layouts[] =
+        {
+            { "mono",          juce::AudioChannelSet::mono() },
+            { "stereo",        juce::AudioChannelSet::stereo() },
+            { "5.1",           juce::AudioChannelSet::create5point1() },
+            { "7.1",           juce::AudioChannelSet::create7point1() },
+            { "7.1.4",         juce::AudioChannelSet::create7point1point4() },
+            { "ambisonic_3rd", juce::AudioChannelSet::ambisonic (3) }
+        };
+
+        std::vector<double> channelCounts, meanBlockTimes;
+
+        for (const auto& layout : layouts)
+        {
+            const auto fullName = juce::String ("VolumeControl/channels/") + layout.first;
+
+            if (! options.matchesFilter (fullName))
+                continue;
+
+            std::unique_ptr<juce::AudioProcessor> processor (createPluginFilter());
+
+            if (! benchmarks::setMainBusLayout (*processor, layout.second))
+                continue;
+
+            const auto numChannels = layout.second.size();
+            auto& state = static_cast<VolumeControlProcessor&> (*processor).getValueTreeState();
+            state.getParameter ("volume")->setValueNotifyingHost (0.5f);
+            state.getParameter ("lfoDepth")->setValueNotifyingHost (0.5f);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* trim = state.getParameter (VolumeControlProcessor::getTrimParameterID (channel));
+                trim->setValueNotifyingHost (trim->convertTo0to1 (-6.0f + 0.5f * (float) channel));
+            }
+
+            processor->setRateAndBufferSizeDetails (sampleRate, blockSize);
+            processor->prepareToPlay (sampleRate, blockSize);
+
+            juce::AudioBuffer<float> buffer (numChannels, blockSize);
+            juce::MidiBuffer midi;
+            std::vector<double> blockTimes;
+            blockTimes.reserve ((size_t) numBlocks);
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    juce::FloatVectorOperations::fill (buffer.getWritePointer (channel), 0.5f, blockSize);
+
+                const auto start = plugindsp::bench::Clock::now();
+                processor->processBlock (buffer, midi);
+                blockTimes.push_back (plugindsp::bench::nanosecondsBetween (start, plugindsp::bench::Clock::now()));
+            }
+
+            processor->releaseResources();
+
+            const auto timings = benchmarks::summariseBlockTimes (std::move (blockTimes));
+            channelCounts.push_back ((double) numChannels);
+            meanBlockTimes.push_back (timings.meanNs);
+
+            juce::DynamicObject::Ptr fields (new juce::DynamicObject());
+            benchmarks::addBlockTimingFields (*fields, timings, blockSize, numChannels, sampleRate);
+            fields->setProperty ("layout", layout.second.getDescription());
+            fields->setProperty ("ns_per_channel_sample", timings.meanNs / (numChannels * blockSize));
+            report.add (fullName, fields);
+        }
+
+        // Least-squares line through (channels, mean block time)
+        const auto numPoints = channelCounts.size();
+
+        if (numPoints < 2)
+            return;
+
+        double meanX = 0.0, meanY = 0.0;
+
+        for (size_t i = 0; i < numPoints; ++i)
+        {
+            meanX += channelCounts[i] / (double) numPoints;
+            meanY += meanBlockTimes[i] / (double) numPoints;
+        }
+
+        double sumXY = 0.0, sumXX = 0.0, sumYY = 0.0;
+
+        for (size_t i = 0; i < numPoints; ++i)
+        {
+            const auto dx = channelCounts[i] - meanX;
+            const auto dy = meanBlockTimes[i] - meanY;
+            sumXY += dx * dy;
+            sumXX += dx * dx;
+            sumYY += dy * dy;
+        }
+
+        const auto perChannel = sumXX > 0.0 ? sumXY / sumXX : 0.0;
+        const auto fixed = meanY - perChannel * meanX;
+        const auto rSquared = sumXX > 0.0 && sumYY > 0.0 ? (sumXY * sumXY) / (sumXX * sumYY) : 1.0;
+
+        const auto costPerChannelSample = [&] (size_t i) { return meanBlockTimes[i] / (channelCounts[i] * blockSize); };
+
+        juce::DynamicObject::Ptr fields (new juce::DynamicObject());
+        fields->setProperty ("fixed_ns_per_block", fixed);
+        fields->setProperty ("ns_per_channel_per_block", perChannel);
+        fields->setProperty ("r_squared", rSquared);
+        fields->setProperty ("widest_vs_narrowest_per_channel_cost",
+                             costPerChannelSample (numPoints - 1) / costPerChannelSample (0));
+        report.add ("VolumeControl/channels/scaling", fields);
+    }
+
+    //==============================================================================
+    /**
+     * Times processBlock() with MIDI Gain on, from no events up to a CC 7 and
+     * a CC 11 on every sample, to check dense controller streams stay well
+     * inside the real-time budget. The MIDI is built once, outside the timing.
+     */
+    void runMidiSuite (const benchmarks::Options& options, benchmarks::Report& report)
+    {
+        constexpr int blockSize = 512;
+        constexpr int numChannels = 2;
+        constexpr double sampleRate = 48000.0;
+
+        const auto numBlocks = juce::roundToInt (juce::jmax (1.0, options.secondsPerConfig) * sampleRate / blockSize);
+
+        const auto runConfig = [&] (const juce::String& name, bool enabled, int eventSpacing, bool withExpression)
+        {
+            const auto fullName = "VolumeControl/midi/" + name;
+
+            if (! options.matchesFilter (fullName))
+                return;
+
+            std::unique_ptr<juce::AudioProcessor> processor (createPluginFilter());
+            auto& state = static_cast<VolumeControlProcessor&> (*processor).getValueTreeState();
+            state.getParameter ("midiGain")->setValueNotifyingHost (enabled ? 1.0f : 0.0f);
+
+            benchmarks::setMainBusChannels (*processor, numChannels);
+            processor->setRateAndBufferSizeDetails (sampleRate, blockSize);
+            processor->prepareToPlay (sampleRate, blockSize);
+
+            // A controller sweep, one event every eventSpacing samples (0 for none)
+            juce::MidiBuffer midi;
+
+            for (int sample = 0; eventSpacing > 0 && sample < blockSize; sample += eventSpacing)
+            {
+                const auto value = 64 + (sample * 63) / blockSize;
+                midi.addEvent (juce::MidiMessage::controllerEvent (1, 7, value), sample);
+
+                if (withExpression)
+                    midi.addEvent (juce::MidiMessage::controllerEvent (1, 11, 127 - value / 2), sample);
+            }
+
+            juce::AudioBuffer<float> buffer (numChannels, blockSize);
+            std::vector<double> blockTimes;
+            blockTimes.reserve ((size_t) numBlocks);
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    juce::FloatVectorOperations::fill (buffer.getWritePointer (channel), 0.5f, blockSize);
+
+                const auto start = plugindsp::bench::Clock::now();
+                processor->processBlock (buffer, midi);
+                blockTimes.push_back (plugindsp::bench::nanosecondsBetween (start, plugindsp::bench::Clock::now()));
+            }
+
+            processor->releaseResources();
+
+            juce::DynamicObject::Ptr fields (new juce::DynamicObject());
+            benchmarks::addBlockTimingFields (*fields, benchmarks::summariseBlockTimes (std::move (blockTimes)),
+                                              blockSize, numChannels, sampleRate);
+            fields->setProperty ("events_per_block", midi.getNumEvents());
+            report.add (fullName, fields);
+        };
+
+        runConfig ("off/dense_cc", false, 1, false);
+        runConfig ("on/no_events", true, 0, false);
+        runConfig ("on/cc_per_block", true, blockSize, false);
+        runConfig ("on/cc_every_32", true, 32, false);
+        runConfig ("on/dense_cc", true, 1, false);
+        runConfig ("on/dense_cc7_cc11", true, 1, true);
+    }
+
+    //==============================================================================
+    /**
+     * Builds a library of generated presets in a temporary folder, then times
+     * the first scan, a rescan with nothing changed, opening the catalog,
+     * searching it, and loading a preset into a processor.
+     */
+    void runPresetSuite (const benchmarks::Options& options, benchmarks::Report& report)
+    {
+        const juce::String prefix ("VolumeControl/presets/");
+
+        if (! options.matchesFilter (prefix + "scan/first") && ! options.matchesFilter (prefix + "scan/unchanged")
+            && ! options.matchesFilter (prefix + "catalog/open") && ! options.matchesFilter (prefix + "search")
+            && ! options.matchesFilter (prefix + "load"))
+            return;
+
+        const auto numPresets = options.secondsPerConfig < 1.0 ? 1000 : 5000;
+        const auto root = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("VolumeControlPresetBenchmark");
+        root.deleteRecursively();
+
+        const auto presetDirectory = root.getChildFile ("Presets");
+        presetDirectory.createDirectory();
+
+        // Presets of real processor states, spread over a few folders and tags
+        std::unique_ptr<juce::AudioProcessor> processor (createPluginFilter());
+        auto& state = static_cast<VolumeControlProcessor&> (*processor).getValueTreeState();
+        const juce::StringArray tagSets { "Soft", "Loud", "Tremolo", "Soft,Tremolo", "Mastering", "" };
+        juce::Random random (1);
+
+        for (int i = 0; i < numPresets; ++i)
+        {
+            state.getParameter ("volume")->setValueNotifyingHost (random.nextFloat());
+            state.getParameter ("lfoDepth")->setValueNotifyingHost (random.nextFloat());
+
+            juce::MemoryBlock processorState;
+            processor->getStateInformation (processorState);
+
+            std::vector<plugindsp::ParameterStateEntry> summary;
+
+            for (auto* parameter : processor->getParameters())
+                if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter))
+                    summary.push_back ({ plugindsp::hashParameterID (withID->paramID.toRawUTF8()), withID->getValue() });
+
+            const auto name = "Preset " + juce::String (i);
+            std::vector<std::uint8_t> bytes;
+            plugindsp::writePresetFile (bytes, VolumeControlProcessor::stateMagic, name.toStdString(),
+                                        tagSets[i % tagSets.size()].toStdString(), summary.data(), summary.size(),
+                                        processorState.getData(), processorState.getSize());
+
+            const auto folder = presetDirectory.getChildFile ("Bank " + juce::String (i % 10));
+            folder.createDirectory();
+            folder.getChildFile (name + ".vcpreset").replaceWithData (bytes.data(), bytes.size());
+        }
+
+        plugindsp::PresetScanner::Options scannerOptions;
+        scannerOptions.presetDirectory = presetDirectory.getFullPathName().toStdString();
+        scannerOptions.catalogDirectory = root.getChildFile ("Catalog").getFullPathName().toStdString();
+        scannerOptions.extension = ".vcpreset";
+        scannerOptions.pluginMagic = VolumeControlProcessor::stateMagic;
+
+        const auto addScanResult = [&] (const juce::String& name, const plugindsp::PresetScanner::ScanStats& stats)
+        {
+            if (! options.matchesFilter (prefix + name))
+                return;
+
+            juce::DynamicObject::Ptr fields (new juce::DynamicObject());
+            fields->setProperty ("ms", stats.milliseconds);
+            fields->setProperty ("presets", stats.numPresets);
+            fields->setProperty ("files_read", stats.numFilesRead);
+            fields->setProperty ("files_reused", stats.numFilesReused);
+            fields->setProperty ("catalog_written", stats.catalogWritten);
+            report.add (prefix + name, fields);
+        };
+
+        const auto addTimingResult = [&] (const juce::String& name, const std::vector<double>& timings,
+                                          const std::function<void (juce::DynamicObject&)>& addFields)
+        {
+            const auto summary = plugindsp::bench::summarise (timings);
+
+            juce::DynamicObject::Ptr fields (new juce::DynamicObject());
+            fields->setProperty ("mean_us", summary.mean / 1000.0);
+            fields->setProperty ("p50_us", summary.p50 / 1000.0);
+            fields->setProperty ("p99_us", summary.p99 / 1000.0);
+            addFields (*fields);
+            report.add (prefix + name, fields);
+        };
+
+        {
+            plugindsp::PresetScanner scanner (scannerOptions);
+            scanner.waitUntilIdle();
+            addScanResult ("scan/first", scanner.getLastScanStats());
+
+            scanner.rescan();
+            scanner.waitUntilIdle();
+            addScanResult ("scan/unchanged", scanner.getLastScanStats());
+        }
+
+        // What a new instance pays: map the catalog the last scan left behind
+        std::string catalogPath;
+
+        for (const auto& file : root.getChildFile ("Catalog").findChildFiles (juce::File::findFiles, false, "*.catalog"))
+            catalogPath = file.getFullPathName().toStdString();
+
+        const auto catalog = std::shared_ptr<const plugindsp::PresetCatalog> (
+            plugindsp::PresetCatalog::open (catalogPath, VolumeControlProcessor::stateMagic));
+
+        if (catalog == nullptr)
+        {
+            std::cerr << "Couldn't open the preset catalog in " << root.getFullPathName() << std::endl;
+            root.deleteRecursively();
+            return;
+        }
+
+        if (options.matchesFilter (prefix + "catalog/open"))
+            addTimingResult ("catalog/open",
+                             plugindsp::bench::timeEachCall ([&] { plugindsp::PresetCatalog::open (catalogPath, VolumeControlProcessor::stateMagic); },
+                                                             5, 50),
+                             [&] (juce::DynamicObject& fields)
+                             {
+                                 fields.setProperty ("presets", catalog->getNumPresets());
+                                 fields.setProperty ("catalog_bytes", (juce::int64) juce::File (catalogPath).getSize());
+                             });
+
+        if (options.matchesFilter (prefix + "search"))
+        {
+            std::vector<int> results;
+            results.reserve ((size_t) catalog->getNumPresets());
+
+            addTimingResult ("search",
+                             plugindsp::bench::timeEachCall ([&] { catalog->search ("preset 12", "tremolo", results); }, 5, 100),
+                             [&] (juce::DynamicObject& fields) { fields.setProperty ("matches", (int) results.size()); });
+        }
+
+        // A program change: read the file, then hand its state to the processor
+        if (options.matchesFilter (prefix + "load"))
+        {
+            int index = 0;
+
+            addTimingResult ("load",
+                             plugindsp::bench::timeEachCall ([&]
+                             {
+                                 const auto path = std::string (catalog->getPath (index));
+                                 index = (index + 97) % catalog->getNumPresets();
+
+                                 const auto preset = plugindsp::PresetScanner::loadPresetFile (path, VolumeControlProcessor::stateMagic);
+
+                                 if (preset.loaded)
+                                     processor->setStateInformation (preset.state.data(), (int) preset.state.size());
+                             }, 20, 500),
+                             [] (juce::DynamicObject&) {});
+        }
+
+        root.deleteRecursively();
+    }
+
+    void runExtraSuites (const benchmarks::Options& options, benchmarks::Report& report)
+    {
+        runStateSuite (options, report);
+        runStateSwitchSuite (options, report);
+        runLfoSuite (options, report);
+        runChannelScalingSuite (options, report);
+        runMidiSuite (options, report);
+        runPresetSuite (options, report);
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    return benchmarks::runBenchmarkMain (argc, argv, "VolumeControl",
+                                         [] { return std::unique_ptr<juce::AudioProcessor> (createPluginFilter()); },
+                                         runExtraSuites);
+}
@@ -0,0 +1,25 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    StressHostMain - runs hundreds of instances as a DAW-style graph on a
+    work-stealing pool, with concurrent automation and state save/load
+
+    Run with --help for options, e.g.
+        VolumeControlStressHost --instances 200 --threads 1,2,4,8 --json stress.json
+
+  ==============================================================================
+*/
+
+#include "StressHost.h"
+#include "PluginProcessor.h"
+
+// Defined in PluginProcessor.cpp
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    return stress::runStressHostMain (argc, argv, "VolumeControl",
+                                      [] { return std::unique_ptr<juce::AudioProcessor> (createPluginFilter()); });
+}
@@ -0,0 +1,374 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    AudioThreadTelemetry - opt-in timing of processBlock() inside the host
+
+  ==============================================================================
+*/
+
+#include "AudioThreadTelemetry.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+ #include <xmmintrin.h>
+#endif
+
+namespace
+{
+    //==============================================================================
+    // Block time bins: quarter-octave steps from 0.25 us up to about 130 ms
+    constexpr double firstBlockTimeEdgeMicroseconds = 0.25;
+    constexpr int blockTimeBinsPerOctave = 4;
+    constexpr int numBlockTimeEdges = 19 * blockTimeBinsPerOctave;
+
+    // Load bins: 2% steps up to 200% of the block's duration
+    constexpr double loadBinWidthPercent = 2.0;
+    constexpr int numLoadEdges = 100;
+
+    constexpr int collectorIntervalMs = 20;
+    constexpr double minimumCalibrationSeconds = 0.05;
+
+    AudioThreadTelemetry::Histogram makeHistogram (const juce::String& name, const juce::String& unit,
+                                                   std::vector<double> edges)
+    {
+        AudioThreadTelemetry::Histogram histogram;
+        histogram.name = name;
+        histogram.unit = unit;
+        histogram.counts.assign (edges.size() + 1, 0);   // + overflow bin
+        histogram.binUpperEdges = std::move (edges);
+        return histogram;
+    }
+
+    void addToHistogram (AudioThreadTelemetry::Histogram& histogram, double value) noexcept
+    {
+        const auto& edges = histogram.binUpperEdges;
+        const auto bin = (size_t) (std::lower_bound (edges.begin(), edges.end(), value) - edges.begin());
+        ++histogram.counts[bin];
+    }
+}
+
+//==============================================================================
+juce::uint64 AudioThreadTelemetry::Histogram::getTotalCount() const noexcept
+{
+    juce::uint64 total = 0;
+
+    for (auto count : counts)
+        total += count;
+
+    return total;
+}
+
+double AudioThreadTelemetry::Histogram::getPercentile (double percentile) const noexcept
+{
+    const auto total = getTotalCount();
+
+    if (total == 0 || binUpperEdges.empty())
+        return 0.0;
+
+    const auto target = (juce::uint64) std::ceil (percentile / 100.0 * (double) total);
+    juce::uint64 runningTotal = 0;
+
+    for (size_t bin = 0; bin < binUpperEdges.size(); ++bin)
+    {
+        runningTotal += counts[bin];
+
+        if (runningTotal >= target)
+            return binUpperEdges[bin];
+    }
+
+    // In the overflow bin: the best we can say is "above the last edge"
+    return binUpperEdges.back();
+}
+
+//==============================================================================
+/** Polls the FIFO at low priority and keeps the cycle counter calibrated. */
+class AudioThreadTelemetry::Collector  : public juce::Thread
+{
+public:
+    explicit Collector (AudioThreadTelemetry& t)
+        : juce::Thread ("Telemetry collector"), owner (t)
+    {
+    }
+
+    void run() override
+    {
+        const auto startCycles = readCycleCounter();
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        auto cyclesPerSecond = 0.0;
+
+        while (! threadShouldExit())
+        {
+            wait (collectorIntervalMs);
+
+            // Re-measured every pass, over everything since the thread started,
+            // so the estimate only gets better the longer telemetry runs.
+            const auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+
+            if (elapsedSeconds >= minimumCalibrationSeconds)
+                cyclesPerSecond = (double) (readCycleCounter() - startCycles) / elapsedSeconds;
+
+            if (cyclesPerSecond > 0.0)
+                owner.collect (cyclesPerSecond);
+        }
+
+        if (cyclesPerSecond > 0.0)
+            owner.collect (cyclesPerSecond);
+    }
+
+private:
+    AudioThreadTelemetry& owner;
+
+    JUCE_DECLARE_NON_COPYABLE (Collector)
+};
+
+//==============================================================================
+AudioThreadTelemetry::AudioThreadTelemetry()
+{
+    reset();
+}
+
+AudioThreadTelemetry::~AudioThreadTelemetry()
+{
+    setEnabled (false);
+}
+
+void AudioThreadTelemetry::setEnabled (bool shouldBeEnabled)
+{
+    if (shouldBeEnabled == isEnabled())
+        return;
+
+    if (shouldBeEnabled)
+    {
+        // Allocated on first use only, so instances that never enable
+        // telemetry don't pay for the FIFO storage. Never freed while the
+        // processor lives, so a block that started just before disabling can
+        // still finish writing safely.
+        if (records.empty())
+            records.resize ((size_t) fifoCapacity);
+
+        fifo.reset();
+        collector = std::make_unique<Collector> (*this);
+        collector->startThread (juce::Thread::Priority::low);
+        enabled.store (true, std::memory_order_release);
+    }
+    else
+    {
+        enabled.store (false, std::memory_order_release);
+
+        if (collector != nullptr)
+        {
+            collector->stopThread (1000);
+            collector.reset();
+        }
+    }
+}
+
+void AudioThreadTelemetry::prepare (double sampleRate) noexcept
+{
+    currentSampleRate.store (sampleRate, std::memory_order_relaxed);
+}
+
+void AudioThreadTelemetry::reset()
+{
+    std::vector<double> blockTimeEdges, loadEdges;
+
+    for (int i = 1; i <= numBlockTimeEdges; ++i)
+        blockTimeEdges.push_back (firstBlockTimeEdgeMicroseconds * std::pow (2.0, (double) i / blockTimeBinsPerOctave));
+
+    for (int i = 1; i <= numLoadEdges; ++i)
+        loadEdges.push_back (loadBinWidthPercent * i);
+
+    const juce::ScopedLock sl (statsLock);
+
+    stats = {};
+    stats.blockTime = makeHistogram ("block_time", "us", std::move (blockTimeEdges));
+    stats.load = makeHistogram ("load", "percent", std::move (loadEdges));
+    totalBlockMicroseconds = 0.0;
+    droppedRecords.store (0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+juce::uint64 AudioThreadTelemetry::beginBlock() noexcept
+{
+    clearFloatingPointFlags();
+    return readCycleCounter();
+}
+
+void AudioThreadTelemetry::endBlock (juce::uint64 startCycles, int numSamples) noexcept
+{
+    const auto endCycles = readCycleCounter();
+    const auto flags = readDenormalFlag() ? (juce::uint32) denormalFlushed : 0u;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+    if (size1 + size2 == 0)
+    {
+        droppedRecords.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& record = records[(size_t) (size1 > 0 ? start1 : start2)];
+    record.startCycles = startCycles;
+    record.endCycles = endCycles;
+    record.numSamples = numSamples;
+    record.flags = flags;
+
+    fifo.finishedWrite (1);
+}
+
+juce::uint64 AudioThreadTelemetry::readCycleCounter() noexcept
+{
+   #if JUCE_INTEL
+    return (juce::uint64) __rdtsc();
+   #elif JUCE_ARM && JUCE_64BIT && ! JUCE_MSVC
+    juce::uint64 value;
+    asm volatile ("mrs %0, cntvct_el0" : "=r" (value));
+    return value;
+   #else
+    return (juce::uint64) juce::Time::getHighResolutionTicks();
+   #endif
+}
+
+// With ScopedNoDenormals active the FPU flushes denormals to zero instead of
+// slowing down. It still raises its sticky underflow/denormal flags when it
+// does, so clearing them at the start of a block and reading them at the end
+// tells us whether this block produced or consumed any.
+void AudioThreadTelemetry::clearFloatingPointFlags() noexcept
+{
+   #if JUCE_INTEL
+    _mm_setcsr (_mm_getcsr() & ~0x3fu);
+   #elif JUCE_ARM && JUCE_64BIT && ! JUCE_MSVC
+    juce::uint64 fpsr;
+    asm volatile ("mrs %0, fpsr" : "=r" (fpsr));
+    asm volatile ("msr fpsr, %0" : : "r" (fpsr & ~(juce::uint64) 0x9f));
+   #endif
+}
+
+bool AudioThreadTelemetry::readDenormalFlag() noexcept
+{
+   #if JUCE_INTEL
+    constexpr unsigned int denormalFlag = 1u << 1, underflowFlag = 1u << 4;
+    return (_mm_getcsr() & (denormalFlag | underflowFlag)) != 0;
+   #elif JUCE_ARM && JUCE_64BIT && ! JUCE_MSVC
+    constexpr juce::uint64 underflowFlag = 1u << 3, inputDenormalFlag = 1u << 7;
+    juce::uint64 fpsr;
+    asm volatile ("mrs %0, fpsr" : "=r" (fpsr));
+    return (fpsr & (underflowFlag | inputDenormalFlag)) != 0;
+   #else
+    return false;
+   #endif
+}
+
+//==============================================================================
+void AudioThreadTelemetry::collect (double cyclesPerSecond)
+{
+    const auto sampleRate = currentSampleRate.load (std::memory_order_relaxed);
+    const auto microsecondsPerCycle = 1.0e6 / cyclesPerSecond;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (fifo.getNumReady(), start1, size1, start2, size2);
+
+    const juce::ScopedLock sl (statsLock);
+
+    const auto addRecords = [&] (int start, int size)
+    {
+        for (int i = start; i < start + size; ++i)
+        {
+            const auto& record = records[(size_t) i];
+
+            const auto blockMicroseconds = (double) (record.endCycles - record.startCycles) * microsecondsPerCycle;
+            const auto durationMicroseconds = (double) record.numSamples / sampleRate * 1.0e6;
+            const auto loadPercent = durationMicroseconds > 0.0 ? 100.0 * blockMicroseconds / durationMicroseconds : 0.0;
+
+            addToHistogram (stats.blockTime, blockMicroseconds);
+            addToHistogram (stats.load, loadPercent);
+
+            ++stats.numBlocks;
+            totalBlockMicroseconds += blockMicroseconds;
+            stats.maxBlockMicroseconds = juce::jmax (stats.maxBlockMicroseconds, blockMicroseconds);
+            stats.maxLoadPercent = juce::jmax (stats.maxLoadPercent, loadPercent);
+
+            if (loadPercent > 100.0)
+                ++stats.numXruns;
+
+            if ((record.flags & denormalFlushed) != 0)
+                ++stats.numDenormalBlocks;
+        }
+    };
+
+    addRecords (start1, size1);
+    addRecords (start2, size2);
+    fifo.finishedRead (size1 + size2);
+
+    stats.sampleRate = sampleRate;
+    stats.numDroppedRecords = droppedRecords.load (std::memory_order_relaxed);
+    stats.meanBlockMicroseconds = stats.numBlocks > 0 ? totalBlockMicroseconds / (double) stats.numBlocks : 0.0;
+}
+
+AudioThreadTelemetry::Snapshot AudioThreadTelemetry::getSnapshot() const
+{
+    const juce::ScopedLock sl (statsLock);
+    return stats;
+}
+
+//==============================================================================
+juce::var AudioThreadTelemetry::histogramToVar (const Histogram& histogram)
+{
+    juce::Array<juce::var> edges, counts;
+
+    for (auto edge : histogram.binUpperEdges)
+        edges.add (edge);
+
+    for (auto count : histogram.counts)
+        counts.add ((juce::int64) count);
+
+    auto* object = new juce::DynamicObject();
+    object->setProperty ("unit", histogram.unit);
+    object->setProperty ("bin_upper_edges", edges);     // counts has one extra overflow bin
+    object->setProperty ("counts", counts);
+    object->setProperty ("p50", histogram.getPercentile (50.0));
+    object->setProperty ("p99", histogram.getPercentile (99.0));
+    object->setProperty ("p999", histogram.getPercentile (99.9));
+    return juce::var (object);
+}
+
+juce::Result AudioThreadTelemetry::dumpToFile (const juce::File& file) const
+{
+    const auto snapshot = getSnapshot();
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty ("time", juce::Time::getCurrentTime().toISO8601 (true));
+    root->setProperty ("sample_rate", snapshot.sampleRate);
+    root->setProperty ("blocks", (juce::int64) snapshot.numBlocks);
+    root->setProperty ("xruns", (juce::int64) snapshot.numXruns);
+    root->setProperty ("denormal_blocks", (juce::int64) snapshot.numDenormalBlocks);
+    root->setProperty ("dropped_records", (juce::int64) snapshot.numDroppedRecords);
+    root->setProperty ("block_mean_us", snapshot.meanBlockMicroseconds);
+    root->setProperty ("block_max_us", snapshot.maxBlockMicroseconds);
+    root->setProperty ("load_max_percent", snapshot.maxLoadPercent);
+    root->setProperty (snapshot.blockTime.name, histogramToVar (snapshot.blockTime));
+    root->setProperty (snapshot.load.name, histogramToVar (snapshot.load));
+
+    const juce::var json (root);
+
+    if (! file.getParentDirectory().createDirectory() || ! file.replaceWithText (juce::JSON::toString (json)))
+        return juce::Result::fail ("Couldn't write " + file.getFullPathName());
+
+    return juce::Result::ok();
+}
+
+juce::File AudioThreadTelemetry::getDefaultDumpFile()
+{
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+             .getChildFile ("VolumeControlPlugin")
+             .getChildFile ("telemetry-" + juce::Time::getCurrentTime().formatted ("%Y%m%d-%H%M%S") + ".json");
+}
@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    AudioThreadTelemetry - opt-in timing of processBlock() inside the host
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+/**
+ * AudioThreadTelemetry - Measures how long each processBlock() call takes
+ *
+ * The audio thread only reads a cycle counter and the FPU status flags, and
+ * pushes one small record per block into a wait-free single-producer/
+ * single-consumer FIFO. It never locks, allocates or makes a system call; if
+ * the FIFO is full the record is dropped and counted.
+ *
+ * A low-priority collector thread polls the FIFO, converts cycles to time and
+ * builds histograms of block time and of load (block time as a share of the
+ * block's duration). Blocks that took longer than their duration are counted
+ * as xruns, and blocks in which the FPU flushed a denormal to zero are counted
+ * too. The editor reads a Snapshot, and dumpToFile() writes one as JSON.
+ *
+ * Telemetry is off by default. When disabled, the per-block cost is a single
+ * relaxed atomic load.
+ */
+class AudioThreadTelemetry
+{
+public:
+    //==============================================================================
+    AudioThreadTelemetry();
+    ~AudioThreadTelemetry();
+
+    /** Starts or stops collection. Call from the message thread. */
+    void setEnabled (bool shouldBeEnabled);
+    bool isEnabled() const noexcept   { return enabled.load (std::memory_order_relaxed); }
+
+    /** Tells the collector the current sample rate. Call from prepareToPlay(). */
+    void prepare (double sampleRate) noexcept;
+
+    /** Clears all histograms and counters. */
+    void reset();
+
+    //==============================================================================
+    /** Times one processBlock() call. Create it first thing in processBlock(). */
+    class ScopedBlock
+    {
+    public:
+        ScopedBlock (AudioThreadTelemetry& t, int numSamplesInBlock) noexcept
+            : telemetry (t.isEnabled() ? &t : nullptr), numSamples (numSamplesInBlock)
+        {
+            if (telemetry != nullptr)
+                startCycles = telemetry->beginBlock();
+        }
+
+        ~ScopedBlock() noexcept
+        {
+            if (telemetry != nullptr)
+                telemetry->endBlock (startCycles, numSamples);
+        }
+
+    private:
+        AudioThreadTelemetry* telemetry;
+        juce::uint64 startCycles = 0;
+        int numSamples;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlock)
+    };
+
+    //==============================================================================
+    /** A histogram with fixed bins, filled on the collector thread. */
+    struct Histogram
+    {
+        juce::String name, unit;
+        std::vector<double> binUpperEdges;     // the last bin catches everything above
+        std::vector<juce::uint64> counts;
+
+        juce::uint64 getTotalCount() const noexcept;
+
+        /** Upper edge of the bin containing the given percentile (0-100). */
+        double getPercentile (double percentile) const noexcept;
+    };
+
+    /** Everything the collector has gathered so far. */
+    struct Snapshot
+    {
+        double sampleRate = 0.0;
+        juce::uint64 numBlocks = 0;
+        juce::uint64 numXruns = 0;              // blocks slower than real time
+        juce::uint64 numDenormalBlocks = 0;     // blocks where the FPU flushed a denormal
+        juce::uint64 numDroppedRecords = 0;     // FIFO was full
+        double meanBlockMicroseconds = 0.0;
+        double maxBlockMicroseconds = 0.0;
+        double maxLoadPercent = 0.0;
+        Histogram blockTime;                    // microseconds
+        Histogram load;                         // percent of block duration
+    };
+
+    Snapshot getSnapshot() const;
+
+    /** Writes the current snapshot as JSON. */
+    juce::Result dumpToFile (const juce::File& file) const;
+
+    /** A default location for dumps, in the user's app data folder. */
+    static juce::File getDefaultDumpFile();
+
+private:
+    //==============================================================================
+    struct BlockRecord
+    {
+        juce::uint64 startCycles;
+        juce::uint64 endCycles;
+        juce::int32 numSamples;
+        juce::uint32 flags;
+    };
+
+    enum RecordFlags : juce::uint32
+    {
+        denormalFlushed = 1u << 0
+    };
+
+    static constexpr int fifoCapacity = 4096;
+
+    juce::uint64 beginBlock() noexcept;
+    void endBlock (juce::uint64 startCycles, int numSamples) noexcept;
+
+    static juce::uint64 readCycleCounter() noexcept;
+    static void clearFloatingPointFlags() noexcept;
+    static bool readDenormalFlag() noexcept;
+
+    //==============================================================================
+    class Collector;
+    friend class Collector;
+
+    void collect (double cyclesPerSecond);
+    static juce::var histogramToVar (const Histogram&);
+
+    //==============================================================================
+    // Audio thread -> collector
+    std::atomic<bool> enabled { false };
+    std::atomic<double> currentSampleRate { 44100.0 };
+    std::atomic<juce::uint64> droppedRecords { 0 };
+    juce::AbstractFifo fifo { fifoCapacity };
+    std::vector<BlockRecord> records;
+
+    // Collector state, guarded by statsLock (never touched by the audio thread)
+    mutable juce::CriticalSection statsLock;
+    Snapshot stats;
+    double totalBlockMicroseconds = 0.0;
+
+    std::unique_ptr<Collector> collector;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioThreadTelemetry)
+};
@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    GainSmoother - per-sample gain ramping for the volume parameter
+
+  ==============================================================================
+*/
+
+#include "GainSmoother.h"
+
+#include <algorithm>
+
+//==============================================================================
+void GainSmoother::prepare (double sampleRate, int maximumBlockSize, double rampLengthSeconds)
+{
+    jassert (sampleRate > 0.0);
+    jassert (maximumBlockSize > 0);
+    juce::ignoreUnused (maximumBlockSize);
+
+    rampLengthSamples = juce::jmax (0, juce::roundToInt (sampleRate * rampLengthSeconds));
+
+    // Resolve the kernel dispatch now rather than on the first audio callback
+    plugindsp::getGainKernels();
+
+    // Jump to the current targets; there is nothing to ramp from yet
+    currentGains = targetGains;
+    gainSteps.fill (0.0f);
+    samplesRemaining = 0;
+}
+
+void GainSmoother::reset (float initialGain) noexcept
+{
+    currentGains.fill (initialGain);
+    targetGains.fill (initialGain);
+    gainSteps.fill (0.0f);
+    samplesRemaining = 0;
+}
+
+void GainSmoother::reset (const float* initialGains, int numChannels) noexcept
+{
+    numChannels = juce::jmin (numChannels, maxChannels);
+    std::copy (initialGains, initialGains + numChannels, targetGains.begin());
+    currentGains = targetGains;
+    gainSteps.fill (0.0f);
+    samplesRemaining = 0;
+}
+
+void GainSmoother::setTargetGain (float newTargetGain) noexcept
+{
+    std::array<float, maxChannels> gains;
+    gains.fill (newTargetGain);
+    setTargetGains (gains.data(), maxChannels);
+}
+
+void GainSmoother::setTargetGains (const float* newTargetGains, int numChannels) noexcept
+{
+    numChannels = juce::jmin (numChannels, maxChannels);
+
+    if (std::equal (newTargetGains, newTargetGains + numChannels, targetGains.begin()))
+        return;
+
+    std::copy (newTargetGains, newTargetGains + numChannels, targetGains.begin());
+    startRamp();
+}
+
+void GainSmoother::startRamp() noexcept
+{
+    if (rampLengthSamples <= 0)
+    {
+        currentGains = targetGains;
+        gainSteps.fill (0.0f);
+        samplesRemaining = 0;
+        return;
+    }
+
+    // Restart the ramp from wherever we currently are, so a new target that
+    // arrives mid-ramp never causes a jump.
+    samplesRemaining = rampLengthSamples;
+
+    for (size_t channel = 0; channel < (size_t) maxChannels; ++channel)
+        gainSteps[channel] = (targetGains[channel] - currentGains[channel]) / (float) rampLengthSamples;
+}
+
+template <typename SampleType>
+void GainSmoother::process (juce::AudioBuffer<SampleType>& buffer, int numSamples) noexcept
+{
+    auto* const* channels = buffer.getArrayOfWritePointers();
+    const auto numChannels = juce::jmin (buffer.getNumChannels(), maxChannels);
+    auto startSample = 0;
+
+    // Ramping section: the kernel computes each sample's gain as it goes.
+    // The gain for sample i is computed from the ramp start rather than
+    // accumulated, so rounding errors cannot build up across a long ramp.
+    if (samplesRemaining > 0 && numSamples > 0)
+    {
+        const auto rampSamples = juce::jmin (numSamples, samplesRemaining);
+
+        for (size_t channel = 0; channel < (size_t) numChannels; ++channel)
+            firstGains[channel] = currentGains[channel] + gainSteps[channel];
+
+        plugindsp::applyChannelGainRamps (channels, numChannels, rampSamples,
+                                          firstGains.data(), gainSteps.data());
+
+        samplesRemaining -= rampSamples;
+
+        if (samplesRemaining > 0)
+        {
+            for (size_t channel = 0; channel < (size_t) maxChannels; ++channel)
+                currentGains[channel] += gainSteps[channel] * (float) rampSamples;
+        }
+        else
+        {
+            currentGains = targetGains;
+            gainSteps.fill (0.0f);
+        }
+
+        startSample = rampSamples;
+    }
+
+    // Constant section: a flat multiply per channel, skipped at unity gain
+    if (startSample < numSamples)
+    {
+        SampleType* remaining[maxChannels];
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            remaining[channel] = channels[channel] + startSample;
+
+        plugindsp::applyChannelGains (remaining, numChannels, numSamples - startSample, currentGains.data());
+    }
+}
+
+template void GainSmoother::process (juce::AudioBuffer<float>&, int) noexcept;
+template void GainSmoother::process (juce::AudioBuffer<double>&, int) noexcept;
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    GainSmoother - per-sample gain ramping for the volume parameter
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "GainKernels.h"
+
+#include <array>
+
+//==============================================================================
+/**
+ * GainSmoother - Removes zipper noise from fast volume and trim automation
+ *
+ * Each channel has its own gain (the volume times that channel's trim).
+ * When any target changes, every channel ramps linearly from its current
+ * gain to its target over a fixed number of samples; channels whose target
+ * didn't change simply ramp by 0. While ramping, the shared plugindsp
+ * per-channel ramp kernel processes the whole channel set in one call.
+ * Once the targets are reached, processing falls back to a flat multiply
+ * per channel, skipping channels at unity gain.
+ * The gains are kept in single precision for either sample type.
+ *
+ * process() never allocates, so it is safe to call from the audio thread.
+ */
+class GainSmoother
+{
+public:
+    //==============================================================================
+    /** Channels beyond this are left untouched. */
+    static constexpr int maxChannels = 16;
+
+    GainSmoother() noexcept  { reset (1.0f); }
+
+    /** Sets the ramp length for the given sample rate. Call from prepareToPlay(). */
+    void prepare (double sampleRate, int maximumBlockSize,
+                  double rampLengthSeconds = defaultRampLengthSeconds);
+
+    /** Jumps every channel straight to the given gain, cancelling any ramp in progress. */
+    void reset (float initialGain) noexcept;
+
+    /** Jumps straight to per-channel gains. Channels from numChannels up keep theirs. */
+    void reset (const float* initialGains, int numChannels) noexcept;
+
+    /** Starts a ramp towards the same new gain on every channel. */
+    void setTargetGain (float newTargetGain) noexcept;
+
+    /**
+     * Starts a ramp towards new per-channel gains if any differs from its
+     * current target. Channels from numChannels up keep their targets.
+     */
+    void setTargetGains (const float* newTargetGains, int numChannels) noexcept;
+
+    /** Applies the (possibly ramping) gains to the first numSamples of every
+        channel. Instantiated for float and double buffers. */
+    template <typename SampleType>
+    void process (juce::AudioBuffer<SampleType>& buffer, int numSamples) noexcept;
+
+    //==============================================================================
+    bool isSmoothing() const noexcept                  { return samplesRemaining > 0; }
+    float getCurrentGain (int channel = 0) const noexcept { return currentGains[(size_t) channel]; }
+    float getTargetGain (int channel = 0) const noexcept  { return targetGains[(size_t) channel]; }
+    int getRampLengthSamples() const noexcept          { return rampLengthSamples; }
+
+    static constexpr double defaultRampLengthSeconds = 0.02;
+
+private:
+    //==============================================================================
+    void startRamp() noexcept;
+
+    std::array<float, maxChannels> currentGains;
+    std::array<float, maxChannels> targetGains;
+    std::array<float, maxChannels> gainSteps;
+    std::array<float, maxChannels> firstGains;     // scratch for process()
+    int rampLengthSamples = 0;
+    int samplesRemaining = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GainSmoother)
+};
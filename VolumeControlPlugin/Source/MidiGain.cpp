@@ -0,0 +1,227 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    MidiGain - sample-accurate gain from MIDI volume, expression and note
+    velocity
+
+  ==============================================================================
+*/
+
+#include "MidiGain.h"
+
+#include <algorithm>
+#include <limits>
+
+//==============================================================================
+void MidiGain::prepare (double sampleRate, int maximumBlockSize, double rampLengthSeconds)
+{
+    jassert (sampleRate > 0.0);
+    jassert (maximumBlockSize > 0);
+
+    // Room for two dense controllers (one event per sample each) plus notes
+    events.resize ((size_t) juce::jmax (1024, 4 * maximumBlockSize));
+    gains.resize ((size_t) maximumBlockSize);
+
+    rampLengthSamples = juce::jmax (0, juce::roundToInt (sampleRate * rampLengthSeconds));
+
+    reset();
+}
+
+void MidiGain::reset() noexcept
+{
+    numEvents = 0;
+    volumeGain = expressionGain = velocityGain = 1.0f;
+    currentGain = targetGain = 1.0f;
+    gainStep = 0.0f;
+    rampRemaining = 0;
+}
+
+//==============================================================================
+void MidiGain::addEvents (const juce::MidiBuffer& midiMessages) noexcept
+{
+    // Reads the raw bytes rather than building a MidiMessage, which would
+    // allocate for long SysEx messages
+    for (const auto metadata : midiMessages)
+    {
+        if (metadata.numBytes < 3)
+            continue;
+
+        const auto status = metadata.data[0] & 0xf0;
+        const auto data1 = (int) metadata.data[1];
+        const auto data2 = (int) metadata.data[2];
+
+        Source source;
+
+        if (status == 0xb0 && data1 == 7)
+            source = Source::volume;
+        else if (status == 0xb0 && data1 == 11)
+            source = Source::expression;
+        else if (status == 0x90 && data2 > 0)      // velocity 0 is a note-off
+            source = Source::velocity;
+        else
+            continue;
+
+        if (numEvents == (int) events.size())
+        {
+            ++numDroppedEvents;
+            continue;
+        }
+
+        events[(size_t) numEvents++] = { metadata.samplePosition, source, midiValueToGain (data2) };
+    }
+}
+
+void MidiGain::sortEvents() noexcept
+{
+    // Insertion sort: stable, in place, and one comparison per event when
+    // the events are already in order
+    for (int i = 1; i < numEvents; ++i)
+    {
+        const auto event = events[(size_t) i];
+        auto j = i;
+
+        for (; j > 0 && events[(size_t) (j - 1)].samplePosition > event.samplePosition; --j)
+            events[(size_t) j] = events[(size_t) (j - 1)];
+
+        events[(size_t) j] = event;
+    }
+}
+
+void MidiGain::startRamp (float newTarget, int rampSamples) noexcept
+{
+    targetGain = newTarget;
+
+    if (newTarget == currentGain || rampSamples <= 0)
+    {
+        currentGain = newTarget;
+        gainStep = 0.0f;
+        rampRemaining = 0;
+        return;
+    }
+
+    // Restart from wherever the last ramp got to, so nothing jumps
+    gainStep = (newTarget - currentGain) / (float) rampSamples;
+    rampRemaining = rampSamples;
+}
+
+//==============================================================================
+template <typename SampleType>
+void MidiGain::process (juce::AudioBuffer<SampleType>& buffer, int numSamples, bool enabled) noexcept
+{
+    sortEvents();
+
+    // Events still track the controllers while disabled, so enabling picks
+    // up where the MIDI is now
+    const auto applyEvent = [this] (const Event& event)
+    {
+        switch (event.source)
+        {
+            case Source::volume:      volumeGain = event.gain;      break;
+            case Source::expression:  expressionGain = event.gain;  break;
+            case Source::velocity:    velocityGain = event.gain;    break;
+        }
+    };
+
+    if (! enabled)
+    {
+        std::for_each (events.begin(), events.begin() + numEvents, applyEvent);
+        numEvents = 0;
+    }
+
+    // Enabling or disabling ramps like any other change
+    const auto blockStartGain = enabled ? getMidiGain() : 1.0f;
+
+    if (blockStartGain != targetGain)
+        startRamp (blockStartGain, rampLengthSamples);
+
+    // No events and no ramp: one flat multiply per channel, or nothing at unity
+    if (numEvents == 0 && rampRemaining == 0)
+    {
+        if (currentGain != 1.0f)
+            plugindsp::applyGain (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numSamples, currentGain);
+
+        return;
+    }
+
+    curveStart = 0;
+    curveSize = 0;
+    auto position = 0;
+
+    for (int i = 0; i < numEvents;)
+    {
+        const auto eventPosition = juce::jlimit (position, numSamples, events[(size_t) i].samplePosition);
+
+        render (buffer, eventPosition - position);
+        position = eventPosition;
+
+        // Every event at this sample is applied before the ramp starts
+        for (; i < numEvents && juce::jmin (events[(size_t) i].samplePosition, numSamples) <= position; ++i)
+            applyEvent (events[(size_t) i]);
+
+        const auto nextPosition = i < numEvents ? juce::jmin (events[(size_t) i].samplePosition, numSamples)
+                                                : std::numeric_limits<int>::max();
+
+        startRamp (getMidiGain(), juce::jmin (rampLengthSamples, nextPosition - position));
+    }
+
+    render (buffer, numSamples - position);
+    flushCurve (buffer);
+    numEvents = 0;
+}
+
+template <typename SampleType>
+void MidiGain::render (juce::AudioBuffer<SampleType>& buffer, int numSamples) noexcept
+{
+    const auto capacity = (int) gains.size();
+
+    while (numSamples > 0)
+    {
+        const auto count = juce::jmin (numSamples, capacity - curveSize);
+        auto* dest = gains.data() + curveSize;
+
+        // Ramping part, computed from the ramp's start for this piece
+        const auto rampSamples = juce::jmin (count, rampRemaining);
+
+        for (int i = 0; i < rampSamples; ++i)
+            dest[i] = currentGain + gainStep * (float) (i + 1);
+
+        if (rampSamples > 0)
+        {
+            rampRemaining -= rampSamples;
+            currentGain = rampRemaining > 0 ? currentGain + gainStep * (float) rampSamples : targetGain;
+        }
+
+        // Flat part
+        std::fill (dest + rampSamples, dest + count, currentGain);
+
+        curveSize += count;
+        numSamples -= count;
+
+        if (curveSize == capacity)
+            flushCurve (buffer);
+    }
+}
+
+template <typename SampleType>
+void MidiGain::flushCurve (juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    if (curveSize == 0)
+        return;
+
+    // One curve for every channel (the float or double kernel, picked at
+    // compile time)
+    auto* const* channels = buffer.getArrayOfWritePointers();
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    {
+        auto* data = channels[channel] + curveStart;
+        plugindsp::applyGainCurve (&data, 1, curveSize, gains.data());
+    }
+
+    curveStart += curveSize;
+    curveSize = 0;
+}
+
+template void MidiGain::process (juce::AudioBuffer<float>&, int, bool) noexcept;
+template void MidiGain::process (juce::AudioBuffer<double>&, int, bool) noexcept;
@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    MidiGain - sample-accurate gain from MIDI volume, expression and note
+    velocity
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "GainKernels.h"
+
+#include <vector>
+
+//==============================================================================
+/**
+ * MidiGain - Gain driven by incoming MIDI, applied at each event's sample
+ *
+ * The gain is the product of three MIDI values, on any MIDI channel:
+ *  - CC 7 (channel volume) and CC 11 (expression), both starting at 127
+ *  - the velocity of the last note-on, starting at 127
+ * Each is mapped to gain as (value / 127)^2, the General MIDI curve
+ * (40 log10 (value / 127) dB).
+ *
+ * The block is split at every event's samplePosition. From each event the
+ * gain ramps linearly to its new value, reaching it at the next event or
+ * after rampLengthSeconds, whichever comes first. Several events at the
+ * same sample are applied together, so a dense CC stream (one per sample)
+ * simply follows the controller, and an isolated jump doesn't click.
+ *
+ * The segments are written into one gain curve which is then applied to
+ * every channel with a single vectorised multiply, so the cost per channel
+ * doesn't depend on the number of events.
+ *
+ * Events are copied into storage allocated in prepare(), then sorted by
+ * position with an in-place insertion sort: stable (events at the same
+ * sample keep their order), allocation-free, and a single pass when the
+ * host has already sent them in order, as it normally does. Events beyond
+ * the storage are dropped and counted.
+ *
+ * addEvents() and process() never allocate, so they are safe to call from
+ * the audio thread.
+ */
+class MidiGain
+{
+public:
+    //==============================================================================
+    MidiGain() = default;
+
+    /** Allocates the event storage and gain curve. Call from prepareToPlay(). */
+    void prepare (double sampleRate, int maximumBlockSize,
+                  double rampLengthSeconds = defaultRampLengthSeconds);
+
+    /** Forgets the MIDI state and pending events; the gain goes back to 1. */
+    void reset() noexcept;
+
+    /** Copies the events that affect the gain (CC 7, CC 11, note-on) from this block's MIDI. */
+    void addEvents (const juce::MidiBuffer& midiMessages) noexcept;
+
+    /**
+     * Applies the gain to the first numSamples of every channel, splitting at
+     * the events added since the last call, then discards them. When enabled
+     * is false the events still update the MIDI state, but the gain ramps
+     * back to 1 and stays there.
+     * Instantiated for float and double buffers; the gain curve is float
+     * either way.
+     */
+    template <typename SampleType>
+    void process (juce::AudioBuffer<SampleType>& buffer, int numSamples, bool enabled) noexcept;
+
+    //==============================================================================
+    float getCurrentGain() const noexcept           { return currentGain; }
+    int getEventCapacity() const noexcept           { return (int) events.size(); }
+
+    /** Events dropped because more arrived in one block than the storage holds. */
+    int getNumDroppedEvents() const noexcept        { return numDroppedEvents; }
+
+    static constexpr double defaultRampLengthSeconds = 0.005;
+
+    /** General MIDI volume curve: 0 to 127 -> gain 0 to 1. */
+    static float midiValueToGain (int value) noexcept
+    {
+        const auto normalised = (float) juce::jlimit (0, 127, value) / 127.0f;
+        return normalised * normalised;
+    }
+
+private:
+    //==============================================================================
+    enum class Source : std::uint8_t
+    {
+        volume,
+        expression,
+        velocity
+    };
+
+    struct Event
+    {
+        int samplePosition;
+        Source source;
+        float gain;
+    };
+
+    void sortEvents() noexcept;
+    void startRamp (float newTarget, int rampSamples) noexcept;
+    float getMidiGain() const noexcept   { return volumeGain * expressionGain * velocityGain; }
+
+    /** Writes the gain for the next numSamples into the curve, applying it whenever it fills. */
+    template <typename SampleType>
+    void render (juce::AudioBuffer<SampleType>& buffer, int numSamples) noexcept;
+
+    template <typename SampleType>
+    void flushCurve (juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+    std::vector<Event> events;      // capacity fixed in prepare()
+    int numEvents = 0;
+    int numDroppedEvents = 0;
+
+    std::vector<float> gains;       // the gain curve
+    int curveStart = 0, curveSize = 0;
+
+    float volumeGain = 1.0f, expressionGain = 1.0f, velocityGain = 1.0f;
+
+    float currentGain = 1.0f, targetGain = 1.0f, gainStep = 0.0f;
+    int rampRemaining = 0;
+    int rampLengthSamples = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiGain)
+};
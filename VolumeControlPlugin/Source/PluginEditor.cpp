@@ -14,45 +14,118 @@
 VolumeControlProcessorEditor::VolumeControlProcessorEditor (VolumeControlProcessor& p)
     : AudioProcessorEditor (&p), processorRef (p)
 {
+    addAndMakeVisible (signalMonitor);
+    
     // Set up the volume slider
     volumeSlider.setSliderStyle (juce::Slider::LinearVertical);
     volumeSlider.setRange (0.0, 1.0, 0.01);
     volumeSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 90, 20);
-    volumeSlider.setValue (*p.getVolumeParameter(), juce::dontSendNotification);
     volumeSlider.setDoubleClickReturnValue (true, 0.7); // Double-click resets to 70%
     volumeSlider.setTextValueSuffix (" Volume");
-    volumeSlider.addListener (this);
     addAndMakeVisible (volumeSlider);
     
+    // Keeps the slider and the parameter in sync, with begin/end gestures
+    volumeAttachment = std::make_unique<params::BatchedSliderAttachment> (*p.getVolumeParameter(), volumeSlider);
+    
     // Set up the volume label
     volumeLabel.setText ("Volume", juce::dontSendNotification);
     volumeLabel.setFont (juce::Font (15.0f, juce::Font::bold));
     volumeLabel.setJustificationType (juce::Justification::centred);
     addAndMakeVisible (volumeLabel);
     
+    // Set up the tremolo controls
+    lfoLabel.setText ("Tempo LFO", juce::dontSendNotification);
+    lfoLabel.setJustificationType (juce::Justification::centred);
+    addAndMakeVisible (lfoLabel);
+    
+    lfoDepthSlider.setSliderStyle (juce::Slider::LinearHorizontal);
+    lfoDepthSlider.setRange (0.0, 1.0, 0.01);
+    lfoDepthSlider.setTextBoxStyle (juce::Slider::TextBoxRight, false, 40, 20);
+    lfoDepthSlider.setTooltip ("How far the LFO dips the volume");
+    addAndMakeVisible (lfoDepthSlider);
+    
+    auto& state = processorRef.getValueTreeState();
+    lfoDepthAttachment = std::make_unique<params::BatchedSliderAttachment> (*state.getParameter ("lfoDepth"), lfoDepthSlider);
+    
+    lfoRateBox.addItemList (TempoSyncedLFO::getRateNames(), 1);
+    lfoRateBox.setTooltip ("LFO cycle length, synced to the host tempo");
+    addAndMakeVisible (lfoRateBox);
+    lfoRateAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (state, "lfoRate", lfoRateBox);
+    
+    // The preset browser (loading a preset is a program change, which the processor hands to the library)
+    addAndMakeVisible (presetBrowser);
+    
+    // Set up the telemetry controls
+    auto& telemetry = processorRef.getTelemetry();
+    
+    telemetryButton.setToggleState (telemetry.isEnabled(), juce::dontSendNotification);
+    telemetryButton.onClick = [this]
+    {
+        processorRef.getTelemetry().setEnabled (telemetryButton.getToggleState());
+        updateTelemetryLabel();
+    };
+    addAndMakeVisible (telemetryButton);
+    
+    dumpButton.setTooltip ("Write the telemetry histograms to a JSON file");
+    dumpButton.onClick = [this]
+    {
+        const auto file = AudioThreadTelemetry::getDefaultDumpFile();
+        const auto result = processorRef.getTelemetry().dumpToFile (file);
+        
+        telemetryLabel.setText (result.wasOk() ? "Saved " + file.getFileName() : result.getErrorMessage(),
+                                juce::dontSendNotification);
+    };
+    addAndMakeVisible (dumpButton);
+    
+    telemetryLabel.setFont (juce::Font (11.0f));
+    telemetryLabel.setJustificationType (juce::Justification::topLeft);
+    addAndMakeVisible (telemetryLabel);
+    
+    updateTelemetryLabel();
+    telemetryUpdates.onFrame = [this]
+    {
+        if (processorRef.getTelemetry().isEnabled())
+            updateTelemetryLabel();
+    };
+    
+    // The cached background covers every pixel
+    setOpaque (true);
+    
     // Set the plugin window size
-    setSize (200, 300);
+    setSize (420, 526);
 }
 
 VolumeControlProcessorEditor::~VolumeControlProcessorEditor()
 {
-    volumeSlider.removeListener (this);
 }
 
 //==============================================================================
 void VolumeControlProcessorEditor::paint (juce::Graphics& g)
+{
+    frameTimes.beginFrame();
+    
+    // Nothing here changes between repaints, so it is one image blit
+    background.draw (g, getLocalBounds());
+}
+
+void VolumeControlProcessorEditor::paintOverChildren (juce::Graphics&)
+{
+    frameTimes.endFrame();
+}
+
+void VolumeControlProcessorEditor::paintBackground (juce::Graphics& g, juce::Rectangle<int> area)
 {
     // Fill the background
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
     
     // Add a border around the plugin
     g.setColour (juce::Colours::white);
-    g.drawRect (getLocalBounds(), 1);
+    g.drawRect (area, 1);
     
     // Add a title
     g.setColour (juce::Colours::white);
     g.setFont (15.0f);
-    g.drawFittedText ("Volume Control Plugin", getLocalBounds().removeFromTop(30), 
+    g.drawFittedText ("Volume Control Plugin", area.removeFromTop (30),
                       juce::Justification::centred, 1);
 }
 
@@ -64,6 +137,27 @@ void VolumeControlProcessorEditor::resized()
     // Position the title area
     area.removeFromTop (20);
     
+    // Presets down the right-hand side
+    presetBrowser.setBounds (area.removeFromRight (200));
+    area.removeFromRight (10);
+    
+    // Output meter and scope under the title
+    signalMonitor.setBounds (area.removeFromTop (80));
+    area.removeFromTop (6);
+    
+    // Position the telemetry controls along the bottom
+    auto telemetryArea = area.removeFromBottom (76);
+    auto buttonRow = telemetryArea.removeFromTop (24);
+    dumpButton.setBounds (buttonRow.removeFromRight (50));
+    telemetryButton.setBounds (buttonRow);
+    telemetryLabel.setBounds (telemetryArea);
+    
+    // Position the tremolo controls above them
+    auto lfoArea = area.removeFromBottom (70);
+    lfoLabel.setBounds (lfoArea.removeFromTop (20));
+    lfoRateBox.setBounds (lfoArea.removeFromTop (24).reduced (20, 0));
+    lfoDepthSlider.setBounds (lfoArea);
+    
     // Position the volume label
     volumeLabel.setBounds (area.removeFromTop (20));
     
@@ -71,11 +165,29 @@ void VolumeControlProcessorEditor::resized()
     volumeSlider.setBounds (area.reduced (area.getWidth() / 4, 10));
 }
 
-void VolumeControlProcessorEditor::sliderValueChanged (juce::Slider* slider)
+void VolumeControlProcessorEditor::updateTelemetryLabel()
 {
-    if (slider == &volumeSlider)
+    auto& telemetry = processorRef.getTelemetry();
+    
+    dumpButton.setEnabled (telemetry.isEnabled());
+    
+    if (! telemetry.isEnabled())
     {
-        // Update the processor's volume parameter
-        *processorRef.getVolumeParameter() = (float) volumeSlider.getValue();
+        telemetryLabel.setText ("Telemetry off", juce::dontSendNotification);
+        return;
     }
-}
\ No newline at end of file
+    
+    const auto snapshot = telemetry.getSnapshot();
+    const auto frames = frameTimes.getStats();
+    
+    // Label::setText() does nothing if the text hasn't changed, so an idle
+    // readout doesn't repaint
+    telemetryLabel.setText ("p50 " + juce::String (snapshot.blockTime.getPercentile (50.0), 1) + " us"
+                              + "  p99 " + juce::String (snapshot.blockTime.getPercentile (99.0), 1) + " us\n"
+                              + "max load " + juce::String (snapshot.maxLoadPercent, 1) + "%"
+                              + "  xruns " + juce::String ((juce::int64) snapshot.numXruns) + "\n"
+                              + "denormal blocks " + juce::String ((juce::int64) snapshot.numDenormalBlocks) + "\n"
+                              + "UI frame " + juce::String (frames.averageMilliseconds, 2) + " ms"
+                              + "  max " + juce::String (frames.maxMilliseconds, 2) + " ms",
+                            juce::dontSendNotification);
+}
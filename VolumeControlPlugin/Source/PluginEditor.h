@@ -11,13 +11,18 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "BatchedSliderAttachment.h"
+#include "CachedLayer.h"
+#include "FrameClock.h"
+#include "FrameTimeCounter.h"
+#include "SignalMonitor.h"
+#include "PresetBrowser.h"
 
 //==============================================================================
 /**
  * VolumeControlProcessorEditor - Custom editor for the volume control plugin
  */
-class VolumeControlProcessorEditor  : public juce::AudioProcessorEditor,
-                                      private juce::Slider::Listener
+class VolumeControlProcessorEditor  : public juce::AudioProcessorEditor
 {
 public:
     VolumeControlProcessorEditor (VolumeControlProcessor&);
@@ -25,19 +30,56 @@ public:
 
     //==============================================================================
     void paint (juce::Graphics&) override;
+    void paintOverChildren (juce::Graphics&) override;
     void resized() override;
+    
+    // Time taken by each paint of the editor and its children
+    const gfx::FrameTimeCounter& getFrameTimes() const noexcept { return frameTimes; }
 
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     VolumeControlProcessor& processorRef;
     
-    // Called when the slider value changes
-    void sliderValueChanged (juce::Slider* slider) override;
+    // Draws the background, border and title into the cached layer
+    void paintBackground (juce::Graphics&, juce::Rectangle<int> area);
+    
+    // Refreshes the telemetry readout
+    void updateTelemetryLabel();
+    
+    // Static drawing, rendered once rather than on every repaint
+    gfx::CachedLayer background { [this] (juce::Graphics& g, juce::Rectangle<int> area) { paintBackground (g, area); } };
+    gfx::FrameTimeCounter frameTimes;
+    
+    // Output level meter and scope (the processor only measures while this exists)
+    gfx::SignalMonitor signalMonitor { processorRef.getMeterFeed() };
     
     // UI Components
     juce::Slider volumeSlider;
     juce::Label volumeLabel;
     
+    // Sends slider drags to the host as gestures, at a bounded rate
+    // (declared after the slider so it is destroyed first)
+    std::unique_ptr<params::BatchedSliderAttachment> volumeAttachment;
+    
+    // Tempo-synced tremolo controls
+    juce::Label lfoLabel;
+    juce::Slider lfoDepthSlider;
+    juce::ComboBox lfoRateBox;
+    std::unique_ptr<params::BatchedSliderAttachment> lfoDepthAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> lfoRateAttachment;
+    
+    // Preset list, search and save, in a column on the right
+    presets::PresetBrowser presetBrowser { processorRef.getPresetLibrary() };
+    
+    // Telemetry controls and readout
+    juce::ToggleButton telemetryButton { "Telemetry" };
+    juce::TextButton dumpButton { "Dump" };
+    juce::Label telemetryLabel;
+    
+    // Updates the readout from the shared frame clock, a few times a second
+    // (declared last so it stops before the components go)
+    gfx::RepaintThrottle telemetryUpdates { *this, 4 };
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VolumeControlProcessorEditor)
 };
\ No newline at end of file
@@ -12,25 +12,102 @@
 
 //==============================================================================
 VolumeControlProcessor::VolumeControlProcessor()
+    : VolumeControlProcessor (presets::PresetLibrary::makeDefaultOptions ("VolumeControl", stateMagic, ".vcpreset"))
+{
+}
+
+VolumeControlProcessor::VolumeControlProcessor (const plugindsp::PresetScanner::Options& presetOptions)
     : AudioProcessor (BusesProperties()
                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                     )
-{
-    // Add volume parameter (0.0 to 1.0, default 0.7)
-    addParameter (volumeParameter = new juce::AudioParameterFloat (
-        "volume",                   // parameter ID
-        "Volume",                   // parameter name
-        0.0f,                       // minimum value
-        1.0f,                       // maximum value
-        0.7f                        // default value
-    ));
+                      .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
+                     ),
+      parameters (*this, nullptr, "VolumeControlParameters", createParameterLayout()),
+      volume (parameters, "volume"),
+      lfoDepth (parameters, "lfoDepth"),
+      lfoRate (parameters, "lfoRate"),
+      midiGainEnabled (parameters, "midiGain"),
+      duckDepth (parameters, "duck"),
+      volumeParameter (dynamic_cast<juce::AudioParameterFloat*> (&volume.getParameter())),
+      presetLibrary (*this, presetOptions)
+{
+    jassert (volumeParameter != nullptr);
+
+    for (int channel = 0; channel < maxChannels; ++channel)
+    {
+        const auto parameterID = getTrimParameterID (channel);
+        trims.add (new params::RawParameter (parameters, parameterID));
+        trimStateIDs[(size_t) channel] = plugindsp::hashParameterID (parameterID.toRawUTF8());
+    }
 }
 
 VolumeControlProcessor::~VolumeControlProcessor()
 {
 }
 
+juce::AudioProcessorValueTreeState::ParameterLayout VolumeControlProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+    // Volume parameter (0.0 to 1.0, default 0.7)
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID { "volume", 1 },  // parameter ID and version hint
+        "Volume",                           // parameter name
+        0.0f,                               // minimum value
+        1.0f,                               // maximum value
+        0.7f                                // default value
+    ));
+
+    // Tremolo depth: 0 leaves the volume alone, 1 dips to silence once per cycle
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID { "lfoDepth", 1 },
+        "LFO Depth",
+        0.0f,
+        1.0f,
+        0.0f
+    ));
+
+    // Tremolo cycle length, synced to the host tempo
+    layout.add (std::make_unique<juce::AudioParameterChoice> (
+        juce::ParameterID { "lfoRate", 1 },
+        "LFO Rate",
+        TempoSyncedLFO::getRateNames(),
+        TempoSyncedLFO::defaultRateIndex
+    ));
+
+    // MIDI CC 7 / CC 11 / note velocity control of the level (off by default)
+    layout.add (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID { "midiGain", 1 },
+        "MIDI Gain",
+        false
+    ));
+
+    // How far the sidechain's level turns the volume down: 0 ignores the
+    // sidechain, 1 silences the output while it's at full scale
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID { "duck", 1 },
+        "Duck",
+        0.0f,
+        1.0f,
+        0.0f
+    ));
+
+    // One trim per channel of the main bus, applied on top of the volume.
+    // Channels the current layout doesn't have ignore their trim.
+    for (int channel = 0; channel < maxChannels; ++channel)
+    {
+        layout.add (std::make_unique<juce::AudioParameterFloat> (
+            juce::ParameterID { getTrimParameterID (channel), 1 },
+            "Trim " + juce::String (channel + 1),
+            juce::NormalisableRange<float> (-24.0f, 12.0f, 0.1f),
+            0.0f,
+            juce::AudioParameterFloatAttributes().withLabel ("dB")
+        ));
+    }
+
+    return layout;
+}
+
 //==============================================================================
 const juce::String VolumeControlProcessor::getName() const
 {
@@ -39,7 +116,7 @@ const juce::String VolumeControlProcessor::getName() const
 
 bool VolumeControlProcessor::acceptsMidi() const
 {
-    return false;
+    return true;    // for MIDI Gain
 }
 
 bool VolumeControlProcessor::producesMidi() const
@@ -59,24 +136,22 @@ double VolumeControlProcessor::getTailLengthSeconds() const
 
 int VolumeControlProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return presetLibrary.getNumPrograms();
 }
 
 int VolumeControlProcessor::getCurrentProgram()
 {
-    return 0;
+    return presetLibrary.getCurrentProgram();
 }
 
 void VolumeControlProcessor::setCurrentProgram (int index)
 {
-    juce::ignoreUnused (index);
+    presetLibrary.setCurrentProgram (index);
 }
 
 const juce::String VolumeControlProcessor::getProgramName (int index)
 {
-    juce::ignoreUnused (index);
-    return {};
+    return presetLibrary.getProgramName (index);
 }
 
 void VolumeControlProcessor::changeProgramName (int index, const juce::String& newName)
@@ -87,9 +162,24 @@ void VolumeControlProcessor::changeProgramName (int index, const juce::String& n
 //==============================================================================
 void VolumeControlProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
-    juce::ignoreUnused (sampleRate, samplesPerBlock);
+    // Allocate the gain ramp up front so processBlock never has to, and start
+    // from the current parameter value so playback doesn't fade in.
+    gainSmoother.prepare (sampleRate, samplesPerBlock);
+    appliedSettings = getParameterSettings();
+    gainSmoother.reset (appliedSettings.channelGains.data(), maxChannels);
+
+    midiGain.prepare (sampleRate, samplesPerBlock);
+
+    lfo.prepare (sampleRate, samplesPerBlock);
+
+    ducker.prepare (sampleRate, samplesPerBlock);
+
+    // Buffers for crossfading to a loaded state, sized for the main bus
+    stateCrossfade.prepare (sampleRate, samplesPerBlock, getMainBusNumOutputChannels(), getProcessingPrecision());
+
+    telemetry.prepare (sampleRate);
+
+    meterFeed.setSampleRate (sampleRate);
 }
 
 void VolumeControlProcessor::releaseResources()
@@ -100,34 +190,142 @@ void VolumeControlProcessor::releaseResources()
 
 bool VolumeControlProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any main layout up to 16 channels (mono, stereo, 5.1, 7.1.4, ambisonics, ...).
+    // Every channel is processed the same way, so the type doesn't matter.
+    const auto mainOutput = layouts.getMainOutputChannelSet();
+
+    if (mainOutput.isDisabled() || mainOutput.size() > maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+    if (mainOutput != layouts.getMainInputChannelSet())
+        return false;
+
+    // The sidechain is optional and may have any layout the host offers;
+    // its channels are only measured, never written
+    if (layouts.inputBuses.size() > 1 && layouts.getChannelSet (true, 1).size() > maxChannels)
         return false;
 
     return true;
 }
 
+StateCrossfade::Settings VolumeControlProcessor::makeSettings (float volumeGain, float depth, float rate, float midiGain,
+                                                               float duck, const float* trimDecibels) noexcept
+{
+    StateCrossfade::Settings settings;
+
+    for (int channel = 0; channel < maxChannels; ++channel)
+        settings.channelGains[(size_t) channel] = volumeGain * juce::Decibels::decibelsToGain (trimDecibels[channel], -100.0f);
+
+    settings.lfoDepth = depth;
+    settings.lfoRate = (int) rate;
+    settings.midiGainEnabled = midiGain >= 0.5f;
+    settings.duckDepth = duck;
+    return settings;
+}
+
+StateCrossfade::Settings VolumeControlProcessor::getParameterSettings() const noexcept
+{
+    float trimDecibels[maxChannels];
+
+    for (int channel = 0; channel < maxChannels; ++channel)
+        trimDecibels[channel] = trims.getUnchecked (channel)->get();
+
+    return makeSettings (volume.get(), lfoDepth.get(), lfoRate.get(), midiGainEnabled.get(), duckDepth.get(), trimDecibels);
+}
+
 void VolumeControlProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    juce::ignoreUnused (midiMessages);
+    processSamples (buffer, midiMessages);
+}
+
+void VolumeControlProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    // Hosts running at 64 bits call this directly, so they don't pay for a
+    // conversion to float and back
+    processSamples (buffer, midiMessages);
+}
 
+template <typename SampleType>
+void VolumeControlProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midiMessages)
+{
+    // Every kernel below has a float and a double overload, chosen at
+    // compile time, so neither precision branches on the sample type
     juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
+
+    // Times this block if telemetry is enabled (wait-free, no allocation).
+    // Declared after noDenormals so it reads the FPU flags before they're restored.
+    const AudioThreadTelemetry::ScopedBlock telemetryBlock (telemetry, buffer.getNumSamples());
+
+    // Only the main bus is processed. The buffer may also hold sidechain
+    // channels after it, which only drive the ducking; getBusBuffer() just
+    // refers to each bus's channels, with no copy or allocation. A disabled
+    // sidechain has no channels.
+    auto mainBuffer = getBusBuffer (buffer, false, 0);
+    const auto sidechainBuffer = getBusBuffer (buffer, true, 1);
+    const auto numInputChannels  = getMainBusNumInputChannels();
+    const auto numOutputChannels = mainBuffer.getNumChannels();
 
     // In case we have more outputs than inputs, clear any output
     // channels that didn't contain input data
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
+    for (auto i = numInputChannels; i < numOutputChannels; ++i)
+        mainBuffer.clear (i, 0, mainBuffer.getNumSamples());
+
+    // A state loaded since the last block (a session, preset or program)
+    // arrives as one complete set of settings. Fade to it from what's
+    // playing now, holding it until the fade ends; the parameters only take
+    // over again after that, so a half-written state is never heard.
+    if (! stateCrossfade.isFading())
+    {
+        if (const auto* loaded = stateCrossfade.takePublished())
+        {
+            auto playing = appliedSettings;
+
+            for (int channel = 0; channel < maxChannels; ++channel)
+                playing.channelGains[(size_t) channel] = gainSmoother.getCurrentGain (channel);
+
+            // The fade covers the jump, so the new gains start straight away
+            if (stateCrossfade.startFade (playing, lfo))
+                gainSmoother.reset (loaded->channelGains.data(), maxChannels);
+
+            appliedSettings = *loaded;
+        }
+        else
+        {
+            // The parameters are plain atomic loads, with no virtual call per block
+            appliedSettings = getParameterSettings();
+        }
+    }
+
+    // The play head is read once per block; the LFO works out every sample's phase from it
+    const auto transport = TempoSyncedLFO::Transport::fromPlayHead (getPlayHead());
 
-    // Apply volume to the buffer
-    buffer.applyGain (*volumeParameter);
+    // While fading, the old settings render a copy of the input to fade out
+    stateCrossfade.renderOutgoing (mainBuffer, mainBuffer.getNumSamples(), transport);
+
+    // Apply volume and trim to every channel, ramping per sample whenever
+    // either has changed
+    gainSmoother.setTargetGains (appliedSettings.channelGains.data(), numOutputChannels);
+    gainSmoother.process (mainBuffer, mainBuffer.getNumSamples());
+
+    // Tremolo, in phase with the host
+    lfo.process (mainBuffer, mainBuffer.getNumSamples(), transport,
+                 appliedSettings.lfoRate, appliedSettings.lfoDepth);
+
+    stateCrossfade.mix (mainBuffer);
+
+    // MIDI-controlled gain, split at every event's sample position. The
+    // events are copied into preallocated storage; nothing allocates. It
+    // applies to both sides of a fade alike, so it comes after the mix.
+    midiGain.addEvents (midiMessages);
+    midiGain.process (mainBuffer, mainBuffer.getNumSamples(), appliedSettings.midiGainEnabled);
+
+    // Ducking by the sidechain's level, which also applies to both sides
+    ducker.process (mainBuffer, sidechainBuffer, mainBuffer.getNumSamples(), appliedSettings.duckDepth);
+
+    // Min/max/sum of squares per channel for the meter and scope. With no
+    // editor open this is a single atomic load.
+    meterFeed.push (mainBuffer.getArrayOfReadPointers(), numOutputChannels, mainBuffer.getNumSamples());
 }
 
 //==============================================================================
@@ -144,34 +342,103 @@ juce::AudioProcessorEditor* VolumeControlProcessor::createEditor()
 //==============================================================================
 void VolumeControlProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-    
-    // Create an XML element to store our state
-    auto state = std::make_unique<juce::XmlElement>("VolumeControlState");
-    
-    // Store the volume parameter
-    state->setAttribute("volume", (double) *volumeParameter);
-    
-    // Convert to binary and store in destData
-    copyXmlToBinary(*state, destData);
+    // State is a fixed header plus one { ID hash, value } row per parameter
+    // (see ParameterState.h), so hosts saving thousands of instances don't
+    // build and serialise an XML tree for each one.
+    constexpr int numFixedEntries = 5;
+
+    plugindsp::ParameterStateEntry entries[numFixedEntries + maxChannels] =
+    {
+        { volumeStateID,   volume.get() },
+        { lfoDepthStateID, lfoDepth.get() },
+        { lfoRateStateID,  lfoRate.get() },
+        { midiGainStateID, midiGainEnabled.get() },
+        { duckStateID,     duckDepth.get() }
+    };
+
+    // One row per channel trim after the fixed parameters
+    for (int channel = 0; channel < maxChannels; ++channel)
+        entries[numFixedEntries + channel] = { trimStateIDs[(size_t) channel], trims.getUnchecked (channel)->get() };
+
+    const auto numEntries = (size_t) juce::numElementsInArray (entries);
+
+    destData.setSize (plugindsp::getParameterStateSize (numEntries), false);
+    plugindsp::writeParameterState (destData.getData(), destData.getSize(), stateMagic, entries, numEntries);
 }
 
 void VolumeControlProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-    
-    // Create an XML element from the binary data
-    std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
+    // Reads the table in place: no parsing and no allocation
+    const plugindsp::ParameterStateReader state (data, (size_t) juce::jmax (0, sizeInBytes), stateMagic);
+
+    if (! state.isValid())
+    {
+        setLegacyXmlState (data, sizeInBytes);
+        return;
+    }
+
+    // Parameters missing from the state (e.g. the LFO, in states saved
+    // before it existed) keep their current value
+    constexpr int numFixedEntries = 5;
+    constexpr int numEntries = numFixedEntries + maxChannels;
+
+    std::pair<std::uint32_t, const params::RawParameter*> stateParameters[numEntries] =
+    {
+        { volumeStateID,   &volume },
+        { lfoDepthStateID, &lfoDepth },
+        { lfoRateStateID,  &lfoRate },
+        { midiGainStateID, &midiGainEnabled },
+        { duckStateID,     &duckDepth }
+    };
+
+    for (int channel = 0; channel < maxChannels; ++channel)
+        stateParameters[numFixedEntries + channel] = { trimStateIDs[(size_t) channel], trims.getUnchecked (channel) };
+
+    float values[numEntries];
+    bool found[numEntries];
+
+    for (int i = 0; i < numEntries; ++i)
+    {
+        const auto& parameter = stateParameters[i].second->getParameter();
+        found[i] = state.findValue (stateParameters[i].first, values[i]);
+
+        // Snapped and clamped the way the parameter will store it
+        values[i] = found[i] ? parameter.convertFrom0to1 (parameter.convertTo0to1 (values[i]))
+                             : stateParameters[i].second->get();
+    }
+
+    // The audio thread gets the whole state at once and crossfades to it;
+    // the parameters below then catch up and tell the host
+    stateCrossfade.publish (makeSettings (values[0], values[1], values[2], values[3], values[4], values + numFixedEntries));
+
+    for (int i = 0; i < numEntries; ++i)
+        if (found[i])
+            stateParameters[i].second->setValueNotifyingHost (values[i]);
+}
+
+void VolumeControlProcessor::setLegacyXmlState (const void* data, int sizeInBytes)
+{
+    // Sessions saved before the binary format store a VolumeControlState XML element
+    std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
     
     // Check if the XML is valid and has the correct tag name
-    if (xmlState.get() != nullptr && xmlState->hasTagName("VolumeControlState"))
+    if (xmlState.get() != nullptr && xmlState->hasTagName ("VolumeControlState"))
     {
-        // Restore the volume parameter
-        if (xmlState->hasAttribute("volume"))
-            *volumeParameter = (float) xmlState->getDoubleAttribute("volume", 0.7);
+        // Restore the volume parameter, crossfading like any other state
+        if (xmlState->hasAttribute ("volume"))
+        {
+            const auto& parameter = volume.getParameter();
+            const auto newVolume = parameter.convertFrom0to1 (parameter.convertTo0to1 ((float) xmlState->getDoubleAttribute ("volume", 0.7)));
+
+            float trimDecibels[maxChannels];
+
+            for (int channel = 0; channel < maxChannels; ++channel)
+                trimDecibels[channel] = trims.getUnchecked (channel)->get();
+
+            stateCrossfade.publish (makeSettings (newVolume, lfoDepth.get(), lfoRate.get(), midiGainEnabled.get(),
+                                                  duckDepth.get(), trimDecibels));
+            volume.setValueNotifyingHost (newVolume);
+        }
     }
 }
 
@@ -10,6 +10,16 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "GainSmoother.h"
+#include "MidiGain.h"
+#include "SidechainDucker.h"
+#include "TempoSyncedLFO.h"
+#include "StateCrossfade.h"
+#include "AudioThreadTelemetry.h"
+#include "MeterFeed.h"
+#include "ParameterState.h"
+#include "RawParameter.h"
+#include "PresetLibrary.h"
 
 //==============================================================================
 /**
@@ -20,6 +30,9 @@ class VolumeControlProcessor : public juce::AudioProcessor
 public:
     //==============================================================================
     VolumeControlProcessor();
+    // With the presets somewhere else, such as a test's temporary directory, or
+    // none at all (default-constructed options)
+    explicit VolumeControlProcessor (const plugindsp::PresetScanner::Options& presetOptions);
     ~VolumeControlProcessor() override;
 
     //==============================================================================
@@ -28,8 +41,10 @@ public:
 
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 
+    // Both precisions run the same templated code (see processSamples)
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-    using AudioProcessor::processBlock;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -55,13 +70,101 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
 
     //==============================================================================
+    // All parameters live in this value tree state
+    juce::AudioProcessorValueTreeState& getValueTreeState() { return parameters; }
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+
     // Expose the volume parameter for the editor to access
     juce::AudioParameterFloat* getVolumeParameter() { return volumeParameter; }
 
+    // Opt-in processBlock timing, shown and controlled by the editor
+    AudioThreadTelemetry& getTelemetry() { return telemetry; }
+
+    // Per-block level summaries of the output, read by the editor's meter and scope
+    plugindsp::MeterFeed& getMeterFeed() { return meterFeed; }
+
+    // Presets in the user's library; these are the host's programs
+    presets::PresetLibrary& getPresetLibrary() { return presetLibrary; }
+
+    // How long loading a state or switching program crossfades for, in samples
+    // (0 switches at the next block). Any thread.
+    void setStateCrossfadeLength (int numSamples) noexcept { stateCrossfade.setFadeLength (numSamples); }
+    int getStateCrossfadeLength() const noexcept { return stateCrossfade.getFadeLength(); }
+
+    //==============================================================================
+    // Binary state format: "Vcpl" magic followed by a flat parameter table
+    static constexpr auto stateMagic = plugindsp::makeStateMagic ('V', 'c', 'p', 'l');
+    static constexpr auto volumeStateID = plugindsp::hashParameterID ("volume");
+    static constexpr auto lfoDepthStateID = plugindsp::hashParameterID ("lfoDepth");
+    static constexpr auto lfoRateStateID = plugindsp::hashParameterID ("lfoRate");
+    static constexpr auto midiGainStateID = plugindsp::hashParameterID ("midiGain");
+    static constexpr auto duckStateID = plugindsp::hashParameterID ("duck");
+
+    //==============================================================================
+    // Channel layouts: any main bus up to 16 channels, e.g. 7.1.4 or 3rd order ambisonics
+    static constexpr int maxChannels = GainSmoother::maxChannels;
+
+    // Per-channel trim parameters, "trim1" to "trim16", in decibels
+    static juce::String getTrimParameterID (int channel) { return "trim" + juce::String (channel + 1); }
+
 private:
     //==============================================================================
-    // Volume parameter
+    // The DSP for both processBlock() overloads, compiled once per sample type
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midiMessages);
+
+    // Everything processBlock() uses, from raw parameter values (the volume,
+    // LFO depth and rate, MIDI gain switch, duck depth, and one trim in dB per
+    // channel)
+    static StateCrossfade::Settings makeSettings (float volumeGain, float depth, float rate, float midiGain,
+                                                  float duck, const float* trimDecibels) noexcept;
+
+    // The settings the parameters hold now
+    StateCrossfade::Settings getParameterSettings() const noexcept;
+
+    // Reads the XML state written by version 1.0.0
+    void setLegacyXmlState (const void* data, int sizeInBytes);
+
+    // Parameters, and cached lock-free access to them for processBlock
+    juce::AudioProcessorValueTreeState parameters;
+    params::RawParameter volume;
+    params::RawParameter lfoDepth;
+    params::RawParameter lfoRate;
+    params::RawParameter midiGainEnabled;
+    params::RawParameter duckDepth;
+    juce::OwnedArray<params::RawParameter> trims;
+    std::array<std::uint32_t, maxChannels> trimStateIDs;
+
+    // The settings processBlock() is using: the parameters' values, or a
+    // loaded state's while it fades in
+    StateCrossfade::Settings appliedSettings;
+
+    // Hands loaded states to the audio thread whole, and crossfades to them
+    StateCrossfade stateCrossfade;
+
+    // Volume parameter (for the message thread)
     juce::AudioParameterFloat* volumeParameter;
 
+    // Smooths volume changes to avoid zipper noise
+    GainSmoother gainSmoother;
+
+    // MIDI volume, expression and velocity, applied at each event's sample
+    MidiGain midiGain;
+
+    // Tempo-synced tremolo on top of the volume
+    TempoSyncedLFO lfo;
+
+    // Turns the main bus down by the sidechain's level
+    SidechainDucker ducker;
+
+    // Per-block timing (off unless enabled from the editor)
+    AudioThreadTelemetry telemetry;
+
+    // Output levels for the editor (skipped while no editor is open)
+    plugindsp::MeterFeed meterFeed;
+
+    // Last, so it's gone before anything a program change would touch
+    presets::PresetLibrary presetLibrary;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VolumeControlProcessor)
 };
\ No newline at end of file
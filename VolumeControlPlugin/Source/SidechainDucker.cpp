@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    SidechainDucker - turns the main bus down while the sidechain is loud
+
+  ==============================================================================
+*/
+
+#include "SidechainDucker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /** One-pole smoothing coefficient that covers about 63% of a step in this time. */
+    float getCoefficient (double sampleRate, double seconds) noexcept
+    {
+        return seconds > 0.0 ? (float) (1.0 - std::exp (-1.0 / (seconds * sampleRate))) : 1.0f;
+    }
+}
+
+//==============================================================================
+void SidechainDucker::prepare (double sampleRate, int maximumBlockSize, double attackSeconds, double releaseSeconds)
+{
+    jassert (sampleRate > 0.0);
+    jassert (maximumBlockSize > 0);
+
+    gains.resize ((size_t) juce::jmax (1, maximumBlockSize));
+    attackCoefficient = getCoefficient (sampleRate, attackSeconds);
+    releaseCoefficient = getCoefficient (sampleRate, releaseSeconds);
+
+    reset();
+}
+
+void SidechainDucker::reset() noexcept
+{
+    envelope = 0.0f;
+    currentDepth = 0.0f;
+}
+
+//==============================================================================
+template <typename SampleType>
+void SidechainDucker::process (juce::AudioBuffer<SampleType>& main, const juce::AudioBuffer<SampleType>& sidechain,
+                               int numSamples, float depth) noexcept
+{
+    depth = juce::jlimit (0.0f, 1.0f, depth);
+
+    // Off, and not ramping out: nothing to measure or apply
+    if (depth == 0.0f && currentDepth == 0.0f)
+    {
+        envelope = 0.0f;
+        return;
+    }
+
+    const auto capacity = (int) gains.size();
+    jassert (capacity > 0);     // prepare() hasn't been called
+
+    if (numSamples <= 0 || capacity == 0)
+        return;
+
+    const auto startDepth = currentDepth;
+    const auto depthStep = (depth - startDepth) / (float) numSamples;
+    auto* const* sidechainChannels = sidechain.getArrayOfReadPointers();
+    auto* const* mainChannels = main.getArrayOfWritePointers();
+
+    // Hosts may send more than the prepared block size, so the curve is
+    // filled and applied a piece at a time
+    for (int start = 0; start < numSamples; start += capacity)
+    {
+        const auto count = juce::jmin (capacity, numSamples - start);
+        auto* curve = gains.data();
+
+        // The peak of every sidechain channel, a channel at a time
+        std::fill (curve, curve + count, 0.0f);
+
+        for (int channel = 0; channel < sidechain.getNumChannels(); ++channel)
+        {
+            const auto* data = sidechainChannels[channel] + start;
+
+            for (int i = 0; i < count; ++i)
+                curve[i] = std::max (curve[i], (float) std::abs (data[i]));
+        }
+
+        // Then the envelope, turned into a gain in place
+        for (int i = 0; i < count; ++i)
+        {
+            const auto coefficient = curve[i] > envelope ? attackCoefficient : releaseCoefficient;
+            envelope += coefficient * (curve[i] - envelope);
+
+            const auto sampleDepth = startDepth + depthStep * (float) (start + i + 1);
+            curve[i] = 1.0f - sampleDepth * std::min (1.0f, envelope);
+        }
+
+        for (int channel = 0; channel < main.getNumChannels(); ++channel)
+        {
+            auto* data = mainChannels[channel] + start;
+            plugindsp::applyGainCurve (&data, 1, count, curve);
+        }
+    }
+
+    currentDepth = depth;
+}
+
+template void SidechainDucker::process (juce::AudioBuffer<float>&, const juce::AudioBuffer<float>&, int, float) noexcept;
+template void SidechainDucker::process (juce::AudioBuffer<double>&, const juce::AudioBuffer<double>&, int, float) noexcept;
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    SidechainDucker - turns the main bus down while the sidechain is loud
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "GainKernels.h"
+
+#include <vector>
+
+//==============================================================================
+/**
+ * SidechainDucker - Gain driven by the level of the sidechain input
+ *
+ * An envelope follower tracks the peak of the sidechain's channels, rising
+ * over attackSeconds and falling over releaseSeconds. The main bus is then
+ * multiplied by 1 - depth * envelope (the envelope is clamped to 1), so with
+ * depth 1 a full-scale sidechain silences it and a quiet one barely moves
+ * it. A sidechain with no channels (the bus is disabled) counts as silence.
+ *
+ * The depth ramps across each block from the last block's value, so moving
+ * it doesn't click. While the depth stays at 0 nothing is measured or
+ * applied, and the envelope starts from silence when ducking is turned on.
+ *
+ * The gain curve is allocated in prepare(); process() never allocates, so
+ * it's safe to call from the audio thread.
+ */
+class SidechainDucker
+{
+public:
+    //==============================================================================
+    SidechainDucker() = default;
+
+    /** Allocates the gain curve and works out the envelope coefficients. Call from prepareToPlay(). */
+    void prepare (double sampleRate, int maximumBlockSize,
+                  double attackSeconds = defaultAttackSeconds,
+                  double releaseSeconds = defaultReleaseSeconds);
+
+    /** Forgets the envelope; the gain goes back to 1. */
+    void reset() noexcept;
+
+    /**
+     * Applies the ducking gain to the first numSamples of every channel of
+     * main, following the level of the same samples in sidechain, with the
+     * depth ramping from the last call's value to this one (0 to 1).
+     * Instantiated for float and double buffers; the gain curve is float
+     * either way.
+     */
+    template <typename SampleType>
+    void process (juce::AudioBuffer<SampleType>& main, const juce::AudioBuffer<SampleType>& sidechain,
+                  int numSamples, float depth) noexcept;
+
+    //==============================================================================
+    float getEnvelope() const noexcept      { return envelope; }
+
+    static constexpr double defaultAttackSeconds = 0.005;
+    static constexpr double defaultReleaseSeconds = 0.150;
+
+private:
+    //==============================================================================
+    std::vector<float> gains;       // the gain curve, one block long
+    float attackCoefficient = 0.0f, releaseCoefficient = 0.0f;
+    float envelope = 0.0f;
+    float currentDepth = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SidechainDucker)
+};
@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    StateCrossfade - hands a loaded state to the audio thread in one piece
+    and crossfades from the old settings to it
+
+  ==============================================================================
+*/
+
+#include "StateCrossfade.h"
+
+//==============================================================================
+void StateCrossfade::publish (const Settings& settings)
+{
+    const std::lock_guard<std::mutex> lock (publishLock);
+
+    slots[(size_t) writeSlot] = settings;
+
+    // Swap the filled slot into the middle; whatever was there (taken or
+    // not, since only the latest set matters) becomes the next one to fill
+    writeSlot = middleSlot.exchange (writeSlot | newSettingsFlag, std::memory_order_acq_rel) & ~newSettingsFlag;
+}
+
+void StateCrossfade::setFadeLength (int numSamples) noexcept
+{
+    requestedFadeLength.store (juce::jmax (0, numSamples), std::memory_order_relaxed);
+}
+
+int StateCrossfade::getFadeLength() const noexcept
+{
+    const auto requested = requestedFadeLength.load (std::memory_order_relaxed);
+    return requested >= 0 ? requested : defaultFadeLength.load (std::memory_order_relaxed);
+}
+
+//==============================================================================
+void StateCrossfade::prepare (double sampleRate, int maximumBlockSize, int numChannels,
+                              juce::AudioProcessor::ProcessingPrecision precision)
+{
+    jassert (sampleRate > 0.0);
+    jassert (maximumBlockSize > 0);
+
+    defaultFadeLength.store (juce::roundToInt (sampleRate * defaultFadeLengthSeconds), std::memory_order_relaxed);
+
+    // Only the buffer for the precision in use takes any memory
+    numChannels = juce::jlimit (1, maxChannels, numChannels);
+    const auto isDouble = precision == juce::AudioProcessor::doublePrecision;
+    outgoingFloat.setSize (isDouble ? 0 : numChannels, isDouble ? 0 : maximumBlockSize);
+    outgoingDouble.setSize (isDouble ? numChannels : 0, isDouble ? maximumBlockSize : 0);
+
+    outgoingLfo.prepare (sampleRate, maximumBlockSize);
+
+    takePublished();
+    fadeRemaining = 0;
+    fadeSamplesThisBlock = 0;
+    fadePosition = 0.0f;
+}
+
+const StateCrossfade::Settings* StateCrossfade::takePublished() noexcept
+{
+    if ((middleSlot.load (std::memory_order_relaxed) & newSettingsFlag) == 0)
+        return nullptr;
+
+    // Give back the slot read last time and take the new one
+    readSlot = middleSlot.exchange (readSlot, std::memory_order_acq_rel) & ~newSettingsFlag;
+    return &slots[(size_t) readSlot];
+}
+
+bool StateCrossfade::startFade (const Settings& settings, const TempoSyncedLFO& lfo) noexcept
+{
+    const auto length = getFadeLength();
+
+    if (length <= 0)
+        return false;
+
+    outgoing = settings;
+    outgoingLfo.continueFrom (lfo);
+    fadeRemaining = length;
+    fadePosition = 0.0f;
+    return true;
+}
+
+//==============================================================================
+template <typename SampleType>
+void StateCrossfade::renderOutgoing (const juce::AudioBuffer<SampleType>& input, int numSamples,
+                                     const TempoSyncedLFO::Transport& transport) noexcept
+{
+    fadeSamplesThisBlock = 0;
+
+    if (fadeRemaining <= 0 || numSamples <= 0)
+        return;
+
+    auto& buffer = getOutgoingBuffer<SampleType>();
+    auto count = juce::jmin (numSamples, fadeRemaining);
+
+    // A block longer than the host promised: finish the fade early rather
+    // than cut it off part-way through the block
+    if (count > buffer.getNumSamples())
+    {
+        count = buffer.getNumSamples();
+        fadeRemaining = count;
+    }
+
+    channelsThisBlock = juce::jmin (input.getNumChannels(), buffer.getNumChannels());
+    fadeSamplesThisBlock = count;
+
+    if (count <= 0 || channelsThisBlock <= 0)
+        return;
+
+    for (int channel = 0; channel < channelsThisBlock; ++channel)
+        buffer.copyFrom (channel, 0, input, channel, 0, count);
+
+    // Refers to the prepared buffer, with just this block's channels; no allocation
+    juce::AudioBuffer<SampleType> block (buffer.getArrayOfWritePointers(), channelsThisBlock, count);
+
+    plugindsp::applyChannelGains (block.getArrayOfWritePointers(), channelsThisBlock, count, outgoing.channelGains.data());
+    outgoingLfo.process (block, count, transport, outgoing.lfoRate, outgoing.lfoDepth);
+}
+
+template <typename SampleType>
+void StateCrossfade::mix (juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    const auto count = fadeSamplesThisBlock;
+    fadeSamplesThisBlock = 0;
+
+    if (count <= 0)
+        return;
+
+    // The new settings come in from fadePosition towards 1, reaching it on
+    // the fade's last sample, and the old ones go out to match
+    const auto step = (1.0f - fadePosition) / (float) fadeRemaining;
+    const auto firstGain = fadePosition + step;
+
+    auto* const* incoming = buffer.getArrayOfWritePointers();
+    auto* const* old = getOutgoingBuffer<SampleType>().getArrayOfWritePointers();
+
+    plugindsp::applyGainRamp (incoming, channelsThisBlock, count, (SampleType) firstGain, (SampleType) step);
+    plugindsp::applyGainRamp (old, channelsThisBlock, count, (SampleType) (1.0f - firstGain), (SampleType) -step);
+
+    for (int channel = 0; channel < channelsThisBlock; ++channel)
+        juce::FloatVectorOperations::add (incoming[channel], old[channel], count);
+
+    fadeRemaining -= count;
+    fadePosition = fadeRemaining > 0 ? fadePosition + step * (float) count : 1.0f;
+}
+
+template void StateCrossfade::renderOutgoing (const juce::AudioBuffer<float>&, int, const TempoSyncedLFO::Transport&) noexcept;
+template void StateCrossfade::renderOutgoing (const juce::AudioBuffer<double>&, int, const TempoSyncedLFO::Transport&) noexcept;
+template void StateCrossfade::mix (juce::AudioBuffer<float>&) noexcept;
+template void StateCrossfade::mix (juce::AudioBuffer<double>&) noexcept;
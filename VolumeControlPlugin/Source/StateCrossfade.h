@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    StateCrossfade - hands a loaded state to the audio thread in one piece
+    and crossfades from the old settings to it
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "GainSmoother.h"
+#include "TempoSyncedLFO.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+//==============================================================================
+/**
+ * StateCrossfade - Glitch-free switching between complete sets of settings
+ *
+ * Loading a state (a session, a preset, a program change) changes every
+ * parameter at once. Written one parameter at a time, the audio thread could
+ * run a block with half of them changed, and the LFO rate in particular
+ * jumps the tremolo to a different phase, which clicks.
+ *
+ * Instead the loading thread works out the complete Settings and calls
+ * publish(). The settings are copied into one of three fixed slots, and the
+ * slots change hands with a single atomic exchange (a triple buffer), so
+ * the audio thread always takes a whole set, the latest one, without
+ * waiting, locking or allocating. A lock only orders loading threads among
+ * themselves; the audio thread never takes it.
+ *
+ * When the audio thread takes a new set it fades to it over
+ * getFadeLength() samples: the block is rendered with the new settings as
+ * usual, and renderOutgoing() renders it again, into a buffer allocated in
+ * prepare(), with the old settings held still (their gains, and an LFO
+ * carrying on from the main one's phase). mix() then crossfades the two
+ * linearly; both come from the same input, so a linear fade keeps the
+ * level steady. A set published during a fade waits for it to finish.
+ */
+class StateCrossfade
+{
+public:
+    //==============================================================================
+    static constexpr int maxChannels = GainSmoother::maxChannels;
+
+    /** Everything processBlock() takes from the parameters. */
+    struct Settings
+    {
+        std::array<float, maxChannels> channelGains {};     // volume x trim
+        float lfoDepth = 0.0f;
+        int lfoRate = TempoSyncedLFO::defaultRateIndex;
+        bool midiGainEnabled = false;
+        float duckDepth = 0.0f;
+    };
+
+    StateCrossfade() = default;
+
+    //==============================================================================
+    /** Hands a complete set of settings to the audio thread. Any thread but the audio thread. */
+    void publish (const Settings& settings);
+
+    /**
+     * Sets the fade length in samples, from the next fade on; 0 switches at
+     * the next block boundary. Any thread. Until this is called the length
+     * is defaultFadeLengthSeconds at the prepared sample rate.
+     */
+    void setFadeLength (int numSamples) noexcept;
+    int getFadeLength() const noexcept;
+
+    static constexpr double defaultFadeLengthSeconds = 0.03;
+
+    //==============================================================================
+    /**
+     * Allocates the outgoing buffer, for the precision the processor will
+     * run at, and cancels any fade. A set published before this is dropped:
+     * the parameters already hold it. Call from prepareToPlay().
+     */
+    void prepare (double sampleRate, int maximumBlockSize, int numChannels,
+                  juce::AudioProcessor::ProcessingPrecision precision);
+
+    /**
+     * The set published since the last call, or nullptr. Audio thread; the
+     * set stays valid until the next call.
+     */
+    const Settings* takePublished() noexcept;
+
+    /**
+     * Starts fading from outgoing, with an LFO continuing from lfo's last
+     * block. Returns false (and does nothing) if the fade length is 0.
+     * Audio thread.
+     */
+    bool startFade (const Settings& outgoing, const TempoSyncedLFO& lfo) noexcept;
+
+    bool isFading() const noexcept                  { return fadeRemaining > 0; }
+
+    /**
+     * Renders the part of this block that is still fading, from the block's
+     * input, with the outgoing settings. Call before the block is processed.
+     * Instantiated for float and double buffers.
+     */
+    template <typename SampleType>
+    void renderOutgoing (const juce::AudioBuffer<SampleType>& input, int numSamples,
+                         const TempoSyncedLFO::Transport& transport) noexcept;
+
+    /** Crossfades the processed block with what renderOutgoing() rendered. */
+    template <typename SampleType>
+    void mix (juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+private:
+    //==============================================================================
+    template <typename SampleType>
+    juce::AudioBuffer<SampleType>& getOutgoingBuffer() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return outgoingDouble;
+        else
+            return outgoingFloat;
+    }
+
+    // The triple buffer: the loading side writes slots[writeSlot], the audio
+    // thread reads slots[readSlot], and middleSlot holds the third, flagged
+    // when it holds a set the audio thread hasn't taken
+    static constexpr int newSettingsFlag = 4;
+    static_assert (std::atomic<int>::is_always_lock_free);
+
+    std::array<Settings, 3> slots;
+    int writeSlot = 0, readSlot = 1;
+    std::atomic<int> middleSlot { 2 };
+    std::mutex publishLock;
+
+    std::atomic<int> requestedFadeLength { -1 };    // -1 for the default
+    std::atomic<int> defaultFadeLength { 0 };       // set by prepare()
+
+    // Audio thread state for the fade in progress
+    Settings outgoing;
+    TempoSyncedLFO outgoingLfo;
+    juce::AudioBuffer<float> outgoingFloat;
+    juce::AudioBuffer<double> outgoingDouble;
+    int fadeRemaining = 0;
+    int fadeSamplesThisBlock = 0;
+    int channelsThisBlock = 0;
+    float fadePosition = 0.0f;      // 0 to 1, how far in the new settings are
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StateCrossfade)
+};
@@ -0,0 +1,242 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    TempoSyncedLFO - a sine LFO locked to the host's beat position, applied
+    to the output as tremolo
+
+  ==============================================================================
+*/
+
+#include "TempoSyncedLFO.h"
+
+namespace
+{
+    //==============================================================================
+    struct Rate
+    {
+        const char* name;
+        double bars;            // whole bars, which depend on the time signature
+        double quarterNotes;    // or a fixed note length
+    };
+
+    constexpr Rate rates[] =
+    {
+        { "4 bars", 4.0, 0.0 },
+        { "2 bars", 2.0, 0.0 },
+        { "1 bar",  1.0, 0.0 },
+        { "1/2",    0.0, 2.0 },
+        { "1/4",    0.0, 1.0 },
+        { "1/8",    0.0, 0.5 },
+        { "1/16",   0.0, 0.25 },
+        { "1/32",   0.0, 0.125 },
+        { "1/8 T",  0.0, 1.0 / 3.0 },
+        { "1/16 T", 0.0, 1.0 / 6.0 },
+        { "1/8 D",  0.0, 0.75 },
+        { "1/16 D", 0.0, 0.375 }
+    };
+
+    double wrapPhase (double phase) noexcept
+    {
+        return phase - std::floor (phase);
+    }
+}
+
+//==============================================================================
+TempoSyncedLFO::Transport TempoSyncedLFO::Transport::fromPlayHead (juce::AudioPlayHead* playHead)
+{
+    Transport transport;
+
+    if (playHead == nullptr)
+        return transport;
+
+    const auto position = playHead->getPosition();
+
+    if (! position.hasValue())
+        return transport;
+
+    transport.isPlaying = position->getIsPlaying();
+
+    if (const auto ppq = position->getPpqPosition())
+    {
+        transport.hasPosition = true;
+        transport.ppqPosition = *ppq;
+    }
+
+    if (const auto bpm = position->getBpm())
+        transport.bpm = juce::jmax (0.0, *bpm);
+
+    if (const auto signature = position->getTimeSignature())
+        if (signature->numerator > 0 && signature->denominator > 0)
+            transport.beatsPerBar = signature->numerator * 4.0 / signature->denominator;
+
+    if (const auto loop = position->getLoopPoints())
+    {
+        transport.isLooping = position->getIsLooping() && loop->ppqEnd > loop->ppqStart;
+        transport.loopStartPpq = loop->ppqStart;
+        transport.loopEndPpq = loop->ppqEnd;
+    }
+
+    return transport;
+}
+
+//==============================================================================
+juce::StringArray TempoSyncedLFO::getRateNames()
+{
+    juce::StringArray names;
+
+    for (const auto& rate : rates)
+        names.add (rate.name);
+
+    return names;
+}
+
+double TempoSyncedLFO::getBeatsPerCycle (int rateIndex, double beatsPerBar) noexcept
+{
+    const auto& rate = rates[juce::jlimit (0, (int) juce::numElementsInArray (rates) - 1, rateIndex)];
+    return rate.bars > 0.0 ? rate.bars * beatsPerBar : rate.quarterNotes;
+}
+
+//==============================================================================
+void TempoSyncedLFO::prepare (double newSampleRate, int maximumBlockSize)
+{
+    jassert (newSampleRate > 0.0);
+    jassert (maximumBlockSize > 0);
+
+    sampleRate = newSampleRate;
+    gains.assign ((size_t) juce::jmax (1, maximumBlockSize), 1.0f);
+
+    // Resolve the kernel dispatch now rather than on the first audio callback
+    plugindsp::getGainKernels();
+
+    reset();
+}
+
+void TempoSyncedLFO::reset() noexcept
+{
+    hasPrevious = false;
+    nextPpq = 0.0;
+    nextPhase = 0.0;
+}
+
+void TempoSyncedLFO::continueFrom (const TempoSyncedLFO& other) noexcept
+{
+    hasPrevious = other.hasPrevious;
+    nextPpq = other.nextPpq;
+    nextPhase = other.nextPhase;
+    lastBpm = other.lastBpm;
+    lastDepth = other.lastDepth;
+}
+
+template <typename SampleType>
+void TempoSyncedLFO::process (juce::AudioBuffer<SampleType>& buffer, int numSamples,
+                              const Transport& transport, int rateIndex, float depth) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    const auto bpm = transport.bpm > 0.0 ? transport.bpm : lastBpm;
+    const auto beatStep = bpm / (60.0 * sampleRate);
+    const auto beatsPerCycle = getBeatsPerCycle (rateIndex, transport.beatsPerBar);
+
+    if (! hasPrevious)
+        lastDepth = depth;
+
+    // Where this block starts, and how far each sample moves it. Both come
+    // from the host's position, not from adding up previous blocks.
+    auto startPpq = hasPrevious ? nextPpq : 0.0;
+    auto blockStep = beatStep;
+
+    if (transport.isPlaying && transport.hasPosition)
+    {
+        startPpq = transport.ppqPosition;
+
+        if (hasPrevious)
+        {
+            const auto correction = transport.ppqPosition - nextPpq;
+            const auto correctedStep = beatStep + correction / numSamples;
+
+            // Small mismatch: start where the last block ended, but aim for
+            // where the host says this block ends. Short blocks can't absorb
+            // much, so the LFO never runs backwards or at more than twice
+            // the tempo to catch up.
+            if (std::abs (correction) <= bpm / 60.0 * maxSmoothedCorrectionSeconds
+                 && correctedStep >= beatStep * 0.5 && correctedStep <= beatStep * 2.0)
+            {
+                startPpq = nextPpq;
+                blockStep = correctedStep;
+            }
+        }
+    }
+
+    const auto isActive = depth > 0.0f || lastDepth > 0.0f;
+    const auto depthStep = (depth - lastDepth) / (float) numSamples;
+    const auto looping = transport.isPlaying && transport.isLooping;
+
+    auto position = startPpq;
+    auto sample = 0;
+
+    while (sample < numSamples)
+    {
+        auto count = numSamples - sample;
+        auto wraps = false;
+
+        // Split where the host jumps back to the loop start
+        if (looping && position < transport.loopEndPpq
+             && position + count * blockStep >= transport.loopEndPpq)
+        {
+            count = juce::jlimit (1, count, (int) std::ceil ((transport.loopEndPpq - position) / blockStep));
+            wraps = true;
+        }
+
+        if (isActive)
+            applySegment (buffer, sample, count, position, blockStep, beatsPerCycle,
+                          lastDepth + depthStep * (float) sample, depthStep);
+
+        position += count * blockStep;
+        sample += count;
+
+        if (wraps && position >= transport.loopEndPpq)
+            position = transport.loopStartPpq + (position - transport.loopEndPpq);
+    }
+
+    nextPpq = position;
+    nextPhase = wrapPhase (position / beatsPerCycle);
+    lastBpm = bpm;
+    lastDepth = depth;
+    hasPrevious = true;
+}
+
+template <typename SampleType>
+void TempoSyncedLFO::applySegment (juce::AudioBuffer<SampleType>& buffer, int start, int count,
+                                   double startPpq, double beatStep, double beatsPerCycle,
+                                   float firstDepth, float depthStep) noexcept
+{
+    auto* const* channels = buffer.getArrayOfWritePointers();
+    const auto numChannels = buffer.getNumChannels();
+    const auto capacity = (int) gains.size();
+    const auto phaseStep = (float) (beatStep / beatsPerCycle);
+
+    for (int done = 0; done < count; done += capacity)
+    {
+        const auto pieceSize = juce::jmin (capacity, count - done);
+
+        // Each piece's first phase is worked out in double precision from
+        // the beat position; only the offsets within it are single precision
+        const auto firstPhase = (float) wrapPhase ((startPpq + done * beatStep) / beatsPerCycle);
+
+        plugindsp::generateTremoloGains (gains.data(), pieceSize, firstPhase, phaseStep,
+                                         firstDepth + depthStep * (float) done, depthStep);
+
+        // One curve for every channel (the float or double kernel, picked
+        // at compile time)
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = channels[channel] + start + done;
+            plugindsp::applyGainCurve (&data, 1, pieceSize, gains.data());
+        }
+    }
+}
+
+template void TempoSyncedLFO::process (juce::AudioBuffer<float>&, int, const Transport&, int, float) noexcept;
+template void TempoSyncedLFO::process (juce::AudioBuffer<double>&, int, const Transport&, int, float) noexcept;
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    TempoSyncedLFO - a sine LFO locked to the host's beat position, applied
+    to the output as tremolo
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "GainKernels.h"
+
+//==============================================================================
+/**
+ * TempoSyncedLFO - Gain modulation that stays in phase with the host
+ *
+ * The LFO's phase is never accumulated sample by sample. At the start of
+ * each block it is worked out from the host's PPQ position, and within the
+ * block each sample's phase is (start + step * i), so it cannot drift from
+ * the host however long the session runs.
+ *
+ * The play head is read once per block (see Transport). Within the block:
+ *  - a loop end that falls inside the block splits it, and the LFO restarts
+ *    from the loop start at the exact sample the host wraps round
+ *  - a small difference between where the last block predicted this one
+ *    would start and where the host says it starts (the host changed tempo
+ *    part-way through the last block, or ramps tempo) is spread over this
+ *    block instead of causing a jump
+ *  - a large difference (the user moved the play head) jumps straight there
+ *
+ * When the host isn't playing, or doesn't provide a position, the LFO keeps
+ * running at the last known tempo so the effect can still be heard.
+ *
+ * process() never allocates, so it is safe to call from the audio thread.
+ */
+class TempoSyncedLFO
+{
+public:
+    //==============================================================================
+    /** The parts of the host position the LFO needs, read once per block. */
+    struct Transport
+    {
+        bool isPlaying = false;
+        bool hasPosition = false;       // false if the host didn't give a PPQ position
+        double ppqPosition = 0.0;
+        double bpm = 0.0;               // 0 if the host didn't say
+        double beatsPerBar = 4.0;       // in quarter notes, from the time signature
+        bool isLooping = false;
+        double loopStartPpq = 0.0, loopEndPpq = 0.0;
+
+        /** Reads the play head, if there is one. Call from the audio thread. */
+        static Transport fromPlayHead (juce::AudioPlayHead* playHead);
+    };
+
+    //==============================================================================
+    /** Note lengths the LFO cycle can be synced to, as the rate parameter's choices. */
+    static juce::StringArray getRateNames();
+
+    /** Length of one cycle, in quarter notes, for a choice from getRateNames(). */
+    static double getBeatsPerCycle (int rateIndex, double beatsPerBar) noexcept;
+
+    static constexpr int defaultRateIndex = 4;   // 1/4
+
+    //==============================================================================
+    TempoSyncedLFO() = default;
+
+    /** Allocates the gain curve. Call from prepareToPlay(). */
+    void prepare (double sampleRate, int maximumBlockSize);
+
+    /** Forgets the previous block, so the next one starts exactly where the host says. */
+    void reset() noexcept;
+
+    /**
+     * Picks up where another LFO's last block left off (its position, tempo
+     * and depth), so this one carries on in phase with it. Used to keep
+     * rendering the old settings while a loaded state crossfades in.
+     */
+    void continueFrom (const TempoSyncedLFO& other) noexcept;
+
+    /**
+     * Applies the tremolo to the first numSamples of every channel. depth is
+     * 0 to 1 and is ramped from the previous block's value. With a depth of
+     * 0 on both ends nothing is touched, but the phase keeps following the
+     * host so that turning the depth up later starts in sync.
+     *
+     * Instantiated for float and double buffers; the gain curve is float
+     * either way.
+     */
+    template <typename SampleType>
+    void process (juce::AudioBuffer<SampleType>& buffer, int numSamples,
+                  const Transport& transport, int rateIndex, float depth) noexcept;
+
+    //==============================================================================
+    /** The phase (0 to 1) the next block will start at if the host plays on. */
+    double getNextPhase() const noexcept        { return nextPhase; }
+
+    /** Beat position the next block is expected to start at. */
+    double getNextPpq() const noexcept          { return nextPpq; }
+
+    /** Beat differences smaller than this many seconds are smoothed rather than jumped. */
+    static constexpr double maxSmoothedCorrectionSeconds = 0.02;
+
+private:
+    //==============================================================================
+    /**
+     * Applies samples [start, start + count) of the tremolo, from a beat
+     * position advancing by beatStep per sample. Blocks longer than the
+     * prepared size are done in pieces.
+     */
+    template <typename SampleType>
+    void applySegment (juce::AudioBuffer<SampleType>& buffer, int start, int count,
+                       double startPpq, double beatStep, double beatsPerCycle,
+                       float firstDepth, float depthStep) noexcept;
+
+    double sampleRate = 44100.0;
+    std::vector<float> gains;
+
+    bool hasPrevious = false;
+    double nextPpq = 0.0;           // where the last block predicted this one would start
+    double nextPhase = 0.0;
+    double lastBpm = 120.0;
+    float lastDepth = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TempoSyncedLFO)
+};
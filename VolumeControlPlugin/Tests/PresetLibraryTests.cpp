@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    PresetLibraryTests - the preset scanner only starts when presets are
+    asked for, and only in the directory the processor was given
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "ProcessorTests.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+    /** A fresh directory under the system's temporary folder, deleted with everything in it. */
+    struct ScopedTestDirectory
+    {
+        ScopedTestDirectory()   { root.createDirectory(); }
+        ~ScopedTestDirectory()  { root.deleteRecursively(); }
+
+        const juce::File root = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                                    .getNonexistentChildFile ("VolumeControlPresetTests", {}, false);
+    };
+
+    plugindsp::PresetScanner::Options makeOptions (const juce::File& root)
+    {
+        plugindsp::PresetScanner::Options options;
+        options.presetDirectory = root.getChildFile ("Presets").getFullPathName().toStdString();
+        options.catalogDirectory = root.getChildFile ("Catalogs").getFullPathName().toStdString();
+        options.extension = ".vcpreset";
+        options.pluginMagic = VolumeControlProcessor::stateMagic;
+        return options;
+    }
+}
+
+//==============================================================================
+TEST_CASE ("VolumeControl only scans for presets once they're asked for", "[presets]")
+{
+    const ScopedTestDirectory directory;
+    const auto catalogDirectory = directory.root.getChildFile ("Catalogs");
+    VolumeControlProcessor processor (makeOptions (directory.root));
+
+    // Created and played, as a render or a benchmark does: nothing on disk
+    processortests::BlockSettings settings;
+    settings.numBlocks = 10;
+    processortests::runBlocksUnderCheck (processor, settings);
+    CHECK_FALSE (catalogDirectory.exists());
+
+    // The host asks for its programs: the first scan writes an empty catalog
+    CHECK (processor.getNumPrograms() == 1);
+    auto* scanner = processor.getPresetLibrary().getScanner();
+    REQUIRE (scanner != nullptr);
+    scanner->waitUntilIdle();
+    CHECK (catalogDirectory.exists());
+
+    // A saved preset becomes a program
+    REQUIRE (processor.getPresetLibrary().savePreset ("Quiet", "test").wasOk());
+    scanner->waitUntilIdle();
+    CHECK (processor.getNumPrograms() == 1);
+    CHECK (processor.getProgramName (0) == "Quiet");
+}
+
+TEST_CASE ("VolumeControl tests and tools leave the user's preset library alone", "[presets]")
+{
+    // The test target is built with PLUGIN_SHARED_USER_PRESETS=0, like every console tool
+    VolumeControlProcessor processor;
+    auto& library = processor.getPresetLibrary();
+
+    CHECK (library.getOptions().presetDirectory.empty());
+    CHECK (processor.getNumPrograms() == 1);
+    CHECK (processor.getProgramName (0).isEmpty());
+    CHECK (library.getScanner() == nullptr);
+    CHECK (library.savePreset ("Anything", {}).failed());
+}
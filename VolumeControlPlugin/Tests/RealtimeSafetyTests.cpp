@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    RealtimeSafetyTests - every processBlock() call under the real-time
+    checker: no allocation, lock or blocking call, whatever the host does
+    between blocks
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "ProcessorTests.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+
+namespace
+{
+    void requireRealtimeSafe (const rtcheck::Report& report)
+    {
+        INFO (report.describe());
+        CHECK (report.numChecks > 0);
+        CHECK (report.isClean());
+    }
+
+    void setParameter (juce::AudioProcessor& processor, const juce::String& parameterID, float normalisedValue)
+    {
+        auto* parameter = processortests::findParameter (processor, parameterID);
+        REQUIRE (parameter != nullptr);
+        parameter->setValueNotifyingHost (normalisedValue);
+    }
+}
+
+//==============================================================================
+TEST_CASE ("VolumeControl processBlock() is real-time safe", "[realtime]")
+{
+    VolumeControlProcessor processor;
+    processortests::BlockSettings settings;
+
+    SECTION ("single precision")
+    {
+        requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+    }
+
+    SECTION ("double precision")
+    {
+        settings.precision = juce::AudioProcessor::doublePrecision;
+        requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+    }
+
+    SECTION ("small and odd block sizes")
+    {
+        for (const auto blockSize : { 1, 17, 64 })
+        {
+            settings.blockSize = blockSize;
+            requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+        }
+    }
+
+    SECTION ("program changes from the audio thread")
+    {
+        // Some hosts call setCurrentProgram() on the audio thread; it may only note the index
+        settings.onAudioThread = [&] (int block) { processor.setCurrentProgram (block % 3); };
+        requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+        CHECK (processor.getCurrentProgram() == (settings.numBlocks - 1) % 3);
+    }
+}
+
+TEST_CASE ("VolumeControl stays real-time safe while parameters change", "[realtime]")
+{
+    VolumeControlProcessor processor;
+    processortests::BlockSettings settings;
+
+    // Volume and trims ramp every block; the LFO is on at each rate in turn
+    settings.beforeBlock = [&] (int block, juce::MidiBuffer&)
+    {
+        setParameter (processor, "volume", (float) (block % 10) / 10.0f);
+        setParameter (processor, "lfoDepth", 0.5f);
+        setParameter (processor, "lfoRate", (float) (block % 5) / 4.0f);
+        setParameter (processor, "trim2", (float) (block % 7) / 7.0f);
+    };
+
+    requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+}
+
+TEST_CASE ("VolumeControl MIDI gain is real-time safe under a dense controller stream", "[realtime]")
+{
+    VolumeControlProcessor processor;
+    processortests::BlockSettings settings;
+    setParameter (processor, "midiGain", 1.0f);
+
+    // A CC 7 on every sample, plus expression and notes, as a busy host sends them
+    settings.beforeBlock = [&] (int block, juce::MidiBuffer& midi)
+    {
+        for (int i = 0; i < settings.blockSize; ++i)
+            midi.addEvent (juce::MidiMessage::controllerEvent (1, 7, (block + i) % 128), i);
+
+        midi.addEvent (juce::MidiMessage::controllerEvent (1, 11, block % 128), 0);
+        midi.addEvent (juce::MidiMessage::noteOn (1, 60, (juce::uint8) 100), settings.blockSize / 2);
+    };
+
+    requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+}
+
+TEST_CASE ("VolumeControl ducks by the sidechain level without allocating", "[realtime]")
+{
+    VolumeControlProcessor processor;
+
+    // The sidechain bus is off until a host routes something to it
+    auto layout = processor.getBusesLayout();
+    layout.inputBuses.getReference (1) = juce::AudioChannelSet::stereo();
+    REQUIRE (processor.setBusesLayout (layout));
+
+    SECTION ("with the depth automated")
+    {
+        // The test tone is on the sidechain channels too; the depth steps
+        // every block, including back to 0 and up again
+        processortests::BlockSettings settings;
+        settings.beforeBlock = [&] (int block, juce::MidiBuffer&)
+        {
+            setParameter (processor, "duck", (float) (block % 4) / 3.0f);
+        };
+
+        requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+
+        settings.precision = juce::AudioProcessor::doublePrecision;
+        requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+    }
+
+    SECTION ("a loud sidechain turns the output down")
+    {
+        setParameter (processor, "duck", 1.0f);
+
+        // Constant 0.5 on the main bus and the given level on the sidechain,
+        // for long enough that the envelope and depth have settled
+        const auto renderWithSidechainAt = [&] (float sidechainLevel)
+        {
+            constexpr int blockSize = 512;
+            processor.setRateAndBufferSizeDetails (48000.0, blockSize);
+            processor.prepareToPlay (48000.0, blockSize);
+
+            juce::AudioBuffer<float> buffer (4, blockSize);
+            juce::MidiBuffer midi;
+
+            for (int block = 0; block < 8; ++block)
+            {
+                buffer.clear();
+
+                for (int channel = 0; channel < 4; ++channel)
+                    juce::FloatVectorOperations::fill (buffer.getWritePointer (channel),
+                                                       channel < 2 ? 0.5f : sidechainLevel, blockSize);
+
+                processor.processBlock (buffer, midi);
+            }
+
+            processor.releaseResources();
+            return buffer.getSample (0, blockSize - 1);
+        };
+
+        const auto volumeGain = processor.getVolumeParameter()->get();
+
+        CHECK (renderWithSidechainAt (0.0f) == Approx (0.5f * volumeGain).margin (1.0e-4));
+        CHECK (std::abs (renderWithSidechainAt (1.0f)) < 0.01f * volumeGain);
+    }
+}
+
+TEST_CASE ("VolumeControl crossfades to a loaded state without allocating", "[realtime]")
+{
+    VolumeControlProcessor processor;
+    processor.setStateCrossfadeLength (1024);
+
+    juce::MemoryBlock quiet, loud;
+    setParameter (processor, "volume", 0.1f);
+    processor.getStateInformation (quiet);
+    setParameter (processor, "volume", 0.9f);
+    processor.getStateInformation (loud);
+
+    // A state load every few blocks, some of them while the last fade is running
+    processortests::BlockSettings settings;
+    settings.beforeBlock = [&] (int block, juce::MidiBuffer&)
+    {
+        if (block % 3 == 0)
+        {
+            const auto& state = (block / 3) % 2 == 0 ? quiet : loud;
+            processor.setStateInformation (state.getData(), (int) state.getSize());
+        }
+    };
+
+    requireRealtimeSafe (processortests::runBlocksUnderCheck (processor, settings));
+}
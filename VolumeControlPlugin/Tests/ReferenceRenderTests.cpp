@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    VolumeControlPlugin - A simple volume control plugin using JUCE
+    ReferenceRenderTests - null tests of offline renders against the
+    reference files in Tests/Golden
+
+    The inputs are 0.1 s of 16-bit stereo at 48 kHz; each reference is its
+    input times the gain the parameters should give, as 32-bit float. They
+    were written by JUCE_Plugin_Shared/Tools/ProcessorTests/make_reference_files.py:
+
+        make_reference_files.py inputs Golden
+        make_reference_files.py reference Golden/sine.wav Golden/sine_volume_0.5.wav 0.5
+        make_reference_files.py reference Golden/noise_burst.wav \
+            Golden/noise_burst_volume_0.25_trim2_-6dB.wav 0.25 0.12529680840681806
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "ProcessorTests.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+    /**
+     * The largest sample difference allowed, in dBFS. Float rounding of the
+     * gain stays below -130 dBFS at these levels; anything audible, such as
+     * a smoothing ramp at the start or a gain off by 0.01 dB, is far above it.
+     */
+    constexpr double toleranceDb = -100.0;
+
+    juce::File getGoldenFile (const char* name)
+    {
+        return juce::File (VOLUME_CONTROL_GOLDEN_DIR).getChildFile (name);
+    }
+
+    offline::ProcessorFactory createProcessor (std::vector<processortests::ParameterValue> values)
+    {
+        return processortests::withParameterValues ([] { return std::make_unique<VolumeControlProcessor>(); },
+                                                    std::move (values));
+    }
+
+    void requireNull (const offline::NullTestResult& test)
+    {
+        INFO (test.result.getErrorMessage());
+        REQUIRE (test.result.wasOk());
+        CHECK (test.peakDifferenceDb <= toleranceDb);
+    }
+}
+
+//==============================================================================
+TEST_CASE ("VolumeControl renders a sine at half volume", "[reference]")
+{
+    const auto factory = createProcessor ({ { "volume", 0.5f } });
+
+    for (const auto blockSize : { 512, 100 })
+    {
+        INFO ("block size " << blockSize);
+        requireNull (processortests::renderAndNullTest (factory, getGoldenFile ("sine.wav"),
+                                                        getGoldenFile ("sine_volume_0.5.wav"),
+                                                        toleranceDb, blockSize));
+    }
+}
+
+TEST_CASE ("VolumeControl renders a noise burst with a channel trim", "[reference]")
+{
+    // Trim runs from -24 to +12 dB, so 0.5 is -6 dB
+    const auto factory = createProcessor ({ { "volume", 0.25f }, { "trim2", 0.5f } });
+
+    requireNull (processortests::renderAndNullTest (factory, getGoldenFile ("noise_burst.wav"),
+                                                    getGoldenFile ("noise_burst_volume_0.25_trim2_-6dB.wav"),
+                                                    toleranceDb));
+}
+
+TEST_CASE ("VolumeControl null tests fail when the output is wrong", "[reference]")
+{
+    // The default volume (0.7) against the half-volume reference
+    const auto test = processortests::renderAndNullTest (createProcessor ({}), getGoldenFile ("sine.wav"),
+                                                         getGoldenFile ("sine_volume_0.5.wav"), toleranceDb);
+    CHECK (test.result.failed());
+}
@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    AudioSnapshot - an immutable object published from the message thread
+    and read by the audio thread without locks
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * Holds the current version of some immutable data (a compiled sequence, a
+ * routing table, ...) for one audio thread to read.
+ *
+ * The publishing thread builds a new object and calls publish(), which swaps
+ * it in with one atomic exchange. The audio thread opens a ReadScope per
+ * block, which loads the pointer once, so the whole block sees one version.
+ *
+ * Replaced objects are freed by the publishing thread, never the audio
+ * thread: the ReadScope bumps a counter as it opens and closes (odd while a
+ * block is running), and an object is freed once the block that might have
+ * loaded it has finished. If the audio thread isn't running, replaced
+ * objects are freed straight away.
+ *
+ * Only one thread may read and one thread may publish.
+ */
+template <typename Type>
+class AudioSnapshot
+{
+public:
+    AudioSnapshot() = default;
+
+    ~AudioSnapshot()
+    {
+        delete current.exchange (nullptr);
+
+        for (auto& r : retired)
+            delete r.object;
+    }
+
+    //==============================================================================
+    /** Swaps in a new object. Publishing thread only. */
+    void publish (std::unique_ptr<const Type> next)
+    {
+        const auto* old = current.exchange (next.release(), std::memory_order_seq_cst);
+
+        // Read after the exchange: any block that starts later loads the new object
+        if (old != nullptr)
+            retired.push_back ({ old, readEpoch.load (std::memory_order_seq_cst) });
+
+        collectGarbage();
+    }
+
+    /**
+     * Frees replaced objects the audio thread can no longer be using.
+     * publish() does this too; call it periodically (e.g. from a timer) to
+     * free the last replaced object when nothing new is being published.
+     */
+    void collectGarbage()
+    {
+        if (retired.empty())
+            return;
+
+        const auto epoch = readEpoch.load (std::memory_order_seq_cst);
+        size_t kept = 0;
+
+        for (auto& r : retired)
+        {
+            if ((r.epoch & 1) == 0 || epoch > r.epoch)
+                delete r.object;
+            else
+                retired[kept++] = r;
+        }
+
+        retired.resize (kept);
+    }
+
+    /** Objects replaced but not yet freed. */
+    size_t getNumRetired() const noexcept   { return retired.size(); }
+
+    /** The current object, for the publishing thread (which owns it). */
+    const Type* getLatest() const noexcept  { return current.load (std::memory_order_relaxed); }
+
+    //==============================================================================
+    /** Pins the current object for the duration of an audio block. */
+    class ReadScope
+    {
+    public:
+        explicit ReadScope (const AudioSnapshot& snapshotToRead) noexcept
+            : owner (snapshotToRead)
+        {
+            owner.readEpoch.fetch_add (1, std::memory_order_seq_cst);
+            object = owner.current.load (std::memory_order_seq_cst);
+        }
+
+        ~ReadScope()
+        {
+            owner.readEpoch.fetch_add (1, std::memory_order_seq_cst);
+        }
+
+        /** The object, or nullptr if nothing has been published. */
+        const Type* get() const noexcept          { return object; }
+        const Type* operator->() const noexcept   { return object; }
+
+    private:
+        const AudioSnapshot& owner;
+        const Type* object = nullptr;
+
+        ReadScope (const ReadScope&) = delete;
+        ReadScope& operator= (const ReadScope&) = delete;
+    };
+
+private:
+    struct Retired
+    {
+        const Type* object;
+        std::uint64_t epoch;
+    };
+
+    std::atomic<const Type*> current { nullptr };
+    mutable std::atomic<std::uint64_t> readEpoch { 0 };
+    std::vector<Retired> retired;
+
+    AudioSnapshot (const AudioSnapshot&) = delete;
+    AudioSnapshot& operator= (const AudioSnapshot&) = delete;
+};
+
+} // namespace wobbler
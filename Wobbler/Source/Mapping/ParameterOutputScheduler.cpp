@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    ParameterOutputScheduler - sends modulated parameter values to the host
+    at a bounded rate, and only when they have moved far enough to matter
+
+  ==============================================================================
+*/
+
+#include "ParameterOutputScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined (_MSC_VER)
+ #include <intrin.h>
+#endif
+
+namespace wobbler
+{
+
+namespace
+{
+    int countTrailingZeros (std::uint64_t bits) noexcept
+    {
+       #if defined (_MSC_VER)
+        unsigned long index;
+        _BitScanForward64 (&index, bits);
+        return (int) index;
+       #else
+        return __builtin_ctzll (bits);
+       #endif
+    }
+}
+
+ParameterOutputScheduler::ParameterOutputScheduler (int numTargets)
+    : maxTargets (std::max (1, numTargets)),
+      sentValues ((size_t) maxTargets),
+      differences ((size_t) maxTargets),
+      pendingValues (new std::atomic<float>[(size_t) maxTargets]),
+      pendingBits (new std::atomic<std::uint64_t>[(size_t) (maxTargets + 63) / 64]),
+      numPendingWords ((maxTargets + 63) / 64)
+{
+    for (int i = 0; i < maxTargets; ++i)
+        pendingValues[(size_t) i].store (0.0f, std::memory_order_relaxed);
+
+    for (int i = 0; i < numPendingWords; ++i)
+        pendingBits[(size_t) i].store (0, std::memory_order_relaxed);
+
+    prepare (44100.0);
+}
+
+void ParameterOutputScheduler::prepare (double sampleRate)
+{
+    samplesPerCheck = std::max (1.0, sampleRate / std::max (0.001, outputRateHz));
+    samplesUntilCheck = 0.0;
+
+    // NaN never compares within the tolerance, so every target goes out on the first check
+    std::fill (sentValues.begin(), sentValues.end(), std::nanf (""));
+}
+
+//==============================================================================
+void ParameterOutputScheduler::pushValues (const float* values, int numTargets, int numSamples) noexcept
+{
+    samplesUntilCheck -= numSamples;
+
+    if (samplesUntilCheck > 0.0)
+        return;
+
+    // Keep to the rate on average, but don't try to catch up after a long block
+    samplesUntilCheck = std::max (samplesUntilCheck + samplesPerCheck, 0.0);
+    check (values, std::min (numTargets, maxTargets));
+}
+
+void ParameterOutputScheduler::check (const float* values, int numTargets) noexcept
+{
+    checks.fetch_add (1, std::memory_order_relaxed);
+
+    // A flat pass the compiler can vectorise: mostly nothing has moved far enough
+    auto* difference = differences.data();
+    const auto* sent = sentValues.data();
+
+    for (int i = 0; i < numTargets; ++i)
+        difference[i] = std::abs (values[i] - sent[i]);
+
+    std::uint64_t queued = 0;
+
+    for (int word = 0; word * 64 < numTargets; ++word)
+    {
+        const auto first = word * 64;
+        const auto last = std::min (first + 64, numTargets);
+        std::uint64_t bits = 0;
+
+        for (int i = first; i < last; ++i)
+        {
+            // The negated test also catches NaN, i.e. targets never sent
+            if (! (difference[i] <= tolerance))
+            {
+                pendingValues[(size_t) i].store (values[i], std::memory_order_relaxed);
+                sentValues[(size_t) i] = values[i];
+                bits |= std::uint64_t (1) << (i - first);
+                ++queued;
+            }
+        }
+
+        if (bits != 0)
+            pendingBits[(size_t) word].fetch_or (bits, std::memory_order_release);
+    }
+
+    changesQueued.fetch_add (queued, std::memory_order_relaxed);
+}
+
+//==============================================================================
+int ParameterOutputScheduler::deliverChanges (HostParameterSink& sink)
+{
+    auto numDelivered = 0;
+
+    for (int word = 0; word < numPendingWords; ++word)
+    {
+        auto bits = pendingBits[(size_t) word].exchange (0, std::memory_order_acquire);
+
+        while (bits != 0)
+        {
+            const auto bit = countTrailingZeros (bits);
+            bits &= bits - 1;
+
+            if (numDelivered++ == 0)
+                sink.beginBatch();
+
+            const auto target = word * 64 + bit;
+            sink.setParameter (target, pendingValues[(size_t) target].load (std::memory_order_relaxed));
+        }
+    }
+
+    if (numDelivered > 0)
+    {
+        sink.endBatch();
+        ++batches;
+        notifications += (std::uint64_t) numDelivered;
+    }
+
+    return numDelivered;
+}
+
+ParameterOutputScheduler::Stats ParameterOutputScheduler::getStats() const noexcept
+{
+    Stats stats;
+    stats.checks = checks.load (std::memory_order_relaxed);
+    stats.changesQueued = changesQueued.load (std::memory_order_relaxed);
+    stats.notifications = notifications;
+    stats.batches = batches;
+    return stats;
+}
+
+} // namespace wobbler
@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    ParameterOutputScheduler - sends modulated parameter values to the host
+    at a bounded rate, and only when they have moved far enough to matter
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * Receives parameter changes on the message thread. In the plugin this calls
+ * setValueNotifyingHost() on the mapped parameter.
+ */
+class HostParameterSink
+{
+public:
+    virtual ~HostParameterSink() = default;
+
+    /** Called before a batch of changes, e.g. to start a single host update. */
+    virtual void beginBatch()   {}
+
+    /** A target's new value, normalised 0-1. */
+    virtual void setParameter (int targetID, float value) = 0;
+
+    virtual void endBatch()     {}
+};
+
+//==============================================================================
+/**
+ * Decides which modulated values are worth telling the host about.
+ *
+ * Pushing every target's value to the host every block floods the host and
+ * the message thread. Instead, the audio thread hands the latest values to
+ * pushValues() each block, and the scheduler:
+ *
+ * - decimates: values are only examined at the output rate (e.g. 30 Hz),
+ *   however small the blocks are
+ * - thins: a target is only sent when it differs from the value the host
+ *   last got by more than the tolerance, so a still or slow target costs
+ *   nothing, and the host's value is never further off than the tolerance
+ *   at the moment it's checked
+ * - coalesces: each target has one slot holding its latest value and one
+ *   dirty bit, so if the message thread falls behind, older values are
+ *   overwritten rather than queued
+ *
+ * The message thread calls deliverChanges() from a timer, which hands every
+ * dirty target to a HostParameterSink as one batch.
+ *
+ * pushValues() is wait-free and doesn't allocate. One audio thread and one
+ * message thread.
+ */
+class ParameterOutputScheduler
+{
+public:
+    explicit ParameterOutputScheduler (int maxTargets = 512);
+
+    //==============================================================================
+    /** How often values are checked, in Hz. Call before playback, not during it. */
+    void setOutputRate (double rateHz) noexcept     { outputRateHz = rateHz; }
+    double getOutputRate() const noexcept           { return outputRateHz; }
+
+    /** How far a target may drift from the host's value before it is sent. */
+    void setTolerance (float newTolerance) noexcept { tolerance = newTolerance; }
+    float getTolerance() const noexcept             { return tolerance; }
+
+    /** Sets the sample rate and forgets what the host has; the next check sends every target. */
+    void prepare (double sampleRate);
+
+    //==============================================================================
+    /**
+     * Audio thread: the targets' values at the end of a block of numSamples.
+     * Values past maxTargets are ignored.
+     */
+    void pushValues (const float* values, int numTargets, int numSamples) noexcept;
+
+    /**
+     * Message thread: sends every target that changed since the last call to
+     * the sink, as one batch (nothing is called if nothing changed). Returns
+     * the number of targets sent.
+     */
+    int deliverChanges (HostParameterSink& sink);
+
+    //==============================================================================
+    struct Stats
+    {
+        std::uint64_t checks = 0;           // times the values were examined
+        std::uint64_t changesQueued = 0;    // targets over the tolerance at a check
+        std::uint64_t notifications = 0;    // setParameter() calls
+        std::uint64_t batches = 0;
+    };
+
+    /** Message thread. checks and changesQueued are read while the audio thread may update them. */
+    Stats getStats() const noexcept;
+
+private:
+    //==============================================================================
+    void check (const float* values, int numTargets) noexcept;
+
+    const int maxTargets;
+    double outputRateHz = 30.0;
+    float tolerance = 1.0f / 256.0f;
+
+    // Audio thread
+    double samplesPerCheck = 1470.0;
+    double samplesUntilCheck = 0.0;
+    std::vector<float> sentValues;     // what the host has (or will have once delivered)
+    std::vector<float> differences;
+
+    // Shared: the latest value for each target, and which ones are waiting
+    std::unique_ptr<std::atomic<float>[]> pendingValues;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> pendingBits;
+    const int numPendingWords;
+
+    std::atomic<std::uint64_t> checks { 0 }, changesQueued { 0 };
+
+    // Message thread
+    std::uint64_t notifications = 0, batches = 0;
+
+    ParameterOutputScheduler (const ParameterOutputScheduler&) = delete;
+    ParameterOutputScheduler& operator= (const ParameterOutputScheduler&) = delete;
+};
+
+} // namespace wobbler
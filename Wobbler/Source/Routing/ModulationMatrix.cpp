@@ -0,0 +1,301 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    ModulationMatrix - routes modulation sources to parameter targets,
+    computing every route once per block
+
+  ==============================================================================
+*/
+
+#include "ModulationMatrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+
+namespace wobbler
+{
+
+ModulationMatrix::ModulationMatrix (int numSources, int numTargets, int routeCapacity)
+    : maxSources (std::max (1, numSources)),
+      maxTargets (std::max (1, numTargets)),
+      maxRoutes (std::max (1, routeCapacity)),
+      sources ((size_t) maxSources, nullptr),
+      tapValues ((size_t) maxRoutes),
+      routeInputs ((size_t) maxRoutes),
+      routeCoefficients ((size_t) maxRoutes),
+      routeStates ((size_t) maxRoutes),
+      targetValues ((size_t) maxTargets),
+      previousTargetValues ((size_t) maxTargets),
+      routeSlots ((size_t) maxRoutes),
+      slotStates ((size_t) maxRoutes),
+      slotGenerations ((size_t) maxRoutes)
+{
+    slots.reserve ((size_t) maxRoutes);
+    freeSlots.reserve ((size_t) maxRoutes);
+}
+
+//==============================================================================
+void ModulationMatrix::setSource (int sourceIndex, ModulationSource* source)
+{
+    if (sourceIndex >= 0 && sourceIndex < maxSources)
+        sources[(size_t) sourceIndex] = source;
+}
+
+bool ModulationMatrix::isValid (const RoutingEntry& entry) const noexcept
+{
+    return entry.sourceIndex >= 0 && entry.sourceIndex < maxSources
+        && entry.target.targetID >= 0 && entry.target.targetID < maxTargets;
+}
+
+int ModulationMatrix::addRoute (const RoutingEntry& entry)
+{
+    if (! isValid (entry))
+        return invalidRoute;
+
+    int routeID;
+
+    if (! freeSlots.empty())
+    {
+        routeID = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else if ((int) slots.size() < maxRoutes)
+    {
+        routeID = (int) slots.size();
+        slots.emplace_back();
+    }
+    else
+    {
+        return invalidRoute;
+    }
+
+    // A new generation tells the audio thread not to glide from whatever
+    // route used this slot before
+    auto& slot = slots[(size_t) routeID];
+    slot.entry = entry;
+    slot.used = true;
+    ++slot.generation;
+    ++numRoutes;
+    return routeID;
+}
+
+bool ModulationMatrix::setRoute (int routeID, const RoutingEntry& entry)
+{
+    if (getRoute (routeID) == nullptr || ! isValid (entry))
+        return false;
+
+    slots[(size_t) routeID].entry = entry;
+    return true;
+}
+
+void ModulationMatrix::removeRoute (int routeID)
+{
+    if (getRoute (routeID) == nullptr)
+        return;
+
+    slots[(size_t) routeID].used = false;
+    freeSlots.push_back (routeID);
+    --numRoutes;
+}
+
+void ModulationMatrix::clearRoutes()
+{
+    for (int i = 0; i < (int) slots.size(); ++i)
+        removeRoute (i);
+}
+
+const RoutingEntry* ModulationMatrix::getRoute (int routeID) const noexcept
+{
+    if (routeID < 0 || routeID >= (int) slots.size() || ! slots[(size_t) routeID].used)
+        return nullptr;
+
+    return &slots[(size_t) routeID].entry;
+}
+
+//==============================================================================
+void ModulationMatrix::commit()
+{
+    auto table = std::make_unique<RoutingTable>();
+    table->version = nextVersion++;
+    table->sources = sources;
+
+    // Number each route by how many routes to the same target come before
+    // it, then order by that rank and the target
+    std::vector<int> targetCounts ((size_t) maxTargets, 0);
+    std::vector<std::pair<int, int>> order;   // { rank, slot }
+    order.reserve ((size_t) numRoutes);
+
+    for (int i = 0; i < (int) slots.size(); ++i)
+        if (slots[(size_t) i].used)
+            order.emplace_back (targetCounts[(size_t) slots[(size_t) i].entry.target.targetID]++, i);
+
+    std::sort (order.begin(), order.end(), [this] (const auto& a, const auto& b)
+    {
+        if (a.first != b.first)
+            return a.first < b.first;
+
+        return slots[(size_t) a.second].entry.target.targetID < slots[(size_t) b.second].entry.target.targetID;
+    });
+
+    const auto size = order.size();
+    table->routeTaps.reserve (size);
+    table->routeTargets.reserve (size);
+    table->routeDepths.reserve (size);
+    table->routeSmoothingSeconds.reserve (size);
+    table->routeSlots.reserve (size);
+    table->routeGenerations.reserve (size);
+
+    std::map<std::pair<int, float>, int> taps;
+
+    for (const auto& item : order)
+    {
+        const auto& slot = slots[(size_t) item.second];
+        const auto& entry = slot.entry;
+        const auto phase = entry.target.phase - std::floor (entry.target.phase);
+        const auto key = std::make_pair (entry.sourceIndex, phase);
+        auto tap = taps.find (key);
+
+        if (tap == taps.end())
+        {
+            tap = taps.emplace (key, table->getNumTaps()).first;
+            table->tapSources.push_back (entry.sourceIndex);
+            table->tapPhases.push_back (phase);
+        }
+
+        table->routeTaps.push_back (tap->second);
+        table->routeTargets.push_back (entry.target.targetID);
+        table->routeDepths.push_back (entry.target.depth);
+        table->routeSmoothingSeconds.push_back (std::max (0.0f, entry.target.smoothingSeconds));
+        table->routeSlots.push_back (item.second);
+        table->routeGenerations.push_back (slot.generation);
+        table->numTargets = std::max (table->numTargets, entry.target.targetID + 1);
+    }
+
+    tables.publish (std::move (table));
+}
+
+//==============================================================================
+void ModulationMatrix::prepare (double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    for (auto* source : sources)
+        if (source != nullptr)
+            source->prepare (sampleRate);
+
+    // Generations start at 1, so every route starts fresh
+    coefficientsVersion = 0;
+    numRouteSlots = 0;
+    std::fill (slotGenerations.begin(), slotGenerations.end(), 0);
+    std::fill (targetValues.begin(), targetValues.end(), 0.0f);
+    std::fill (previousTargetValues.begin(), previousTargetValues.end(), 0.0f);
+}
+
+void ModulationMatrix::updateCoefficients (const RoutingTable& table, int numSamples) noexcept
+{
+    const auto blockSeconds = numSamples / sampleRate;
+
+    for (int i = 0; i < table.getNumRoutes(); ++i)
+    {
+        const auto smoothing = table.routeSmoothingSeconds[(size_t) i];
+        routeCoefficients[(size_t) i] = smoothing > 0.0f ? (float) (1.0 - std::exp (-blockSeconds / smoothing))
+                                                         : 1.0f;
+    }
+
+    coefficientsBlockSize = numSamples;
+}
+
+void ModulationMatrix::carryStatesOver (const RoutingTable& table) noexcept
+{
+    // Park the old table's states by slot, then pick them up in the new order.
+    // A route whose slot was reused since starts at its value rather than
+    // gliding from the old route's.
+    for (int i = 0; i < numRouteSlots; ++i)
+        slotStates[(size_t) routeSlots[(size_t) i]] = routeStates[(size_t) i];
+
+    numRouteSlots = table.getNumRoutes();
+
+    for (int i = 0; i < numRouteSlots; ++i)
+    {
+        const auto slot = (size_t) table.routeSlots[(size_t) i];
+        routeSlots[(size_t) i] = (int) slot;
+
+        if (slotGenerations[slot] == table.routeGenerations[(size_t) i])
+        {
+            routeStates[(size_t) i] = slotStates[slot];
+        }
+        else
+        {
+            slotGenerations[slot] = table.routeGenerations[(size_t) i];
+            routeStates[(size_t) i] = table.routeDepths[(size_t) i] * routeInputs[(size_t) i];
+        }
+    }
+}
+
+void ModulationMatrix::process (int numSamples) noexcept
+{
+    std::swap (targetValues, previousTargetValues);
+
+    const AudioSnapshot<RoutingTable>::ReadScope scope (tables);
+    const auto* table = scope.get();
+
+    if (table == nullptr || numSamples <= 0)
+    {
+        std::copy (previousTargetValues.begin(), previousTargetValues.end(), targetValues.begin());
+        return;
+    }
+
+    // One virtual call per source and per tap
+    for (auto* source : table->sources)
+        if (source != nullptr)
+            source->advance (numSamples);
+
+    const auto numTaps = table->getNumTaps();
+
+    for (int t = 0; t < numTaps; ++t)
+    {
+        const auto* source = table->sources[(size_t) table->tapSources[(size_t) t]];
+        tapValues[(size_t) t] = source != nullptr ? source->getValue (table->tapPhases[(size_t) t]) : 0.0f;
+    }
+
+    // Gather each route's input into a flat array, so the smoothing loop
+    // below is pure streaming arithmetic the compiler can vectorise
+    const auto numRoutesInTable = table->getNumRoutes();
+    const auto* taps = table->routeTaps.data();
+    auto* inputs = routeInputs.data();
+
+    for (int r = 0; r < numRoutesInTable; ++r)
+        inputs[r] = tapValues[(size_t) taps[r]];
+
+    if (table->version != coefficientsVersion)
+    {
+        carryStatesOver (*table);
+        updateCoefficients (*table, numSamples);
+        coefficientsVersion = table->version;
+    }
+    else if (numSamples != coefficientsBlockSize)
+    {
+        updateCoefficients (*table, numSamples);
+    }
+
+    const auto* depths = table->routeDepths.data();
+    const auto* coefficients = routeCoefficients.data();
+    auto* states = routeStates.data();
+
+    for (int r = 0; r < numRoutesInTable; ++r)
+        states[r] += coefficients[r] * (depths[r] * inputs[r] - states[r]);
+
+    // Sum into the targets. Consecutive routes go to different targets, so
+    // the adds don't wait on each other
+    const auto* targets = table->routeTargets.data();
+    auto* values = targetValues.data();
+    std::fill (values, values + maxTargets, 0.0f);
+
+    for (int r = 0; r < numRoutesInTable; ++r)
+        values[targets[r]] += states[r];
+}
+
+} // namespace wobbler
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    ModulationMatrix - routes modulation sources to parameter targets,
+    computing every route once per block
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "AudioSnapshot.h"
+#include "RoutingTable.h"
+
+#include <memory>
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * The modulation routing matrix.
+ *
+ * Message thread: register sources with setSource(), edit routes with
+ * addRoute() / setRoute() / removeRoute(), then commit(). The routes are
+ * compiled into a RoutingTable and published with one atomic exchange, so
+ * the audio thread always sees a complete table.
+ *
+ * Audio thread: call process() once per block. It reads each tap once
+ * (one virtual call), then runs the routes as flat loops over arrays:
+ * gather the tap values, scale by depth and smooth, and sum into the
+ * targets. getTargetValues() then holds one modulation amount per target,
+ * for the end of the block; getPreviousTargetValues() holds the amounts for
+ * the end of the previous block, so callers can ramp between the two.
+ *
+ * All audio-thread storage is sized in the constructor, so process() never
+ * allocates or locks.
+ */
+class ModulationMatrix
+{
+public:
+    static constexpr int invalidRoute = -1;
+
+    ModulationMatrix (int maxSources = 64, int maxTargets = 512, int maxRoutes = 64 * 512);
+
+    int getMaxSources() const noexcept  { return maxSources; }
+    int getMaxTargets() const noexcept  { return maxTargets; }
+    int getMaxRoutes() const noexcept   { return maxRoutes; }
+
+    //==============================================================================
+    /**
+     * Sets the source for an index. The source must outlive the matrix, and
+     * each source can only be set at one index (it's advanced once per index).
+     * Message thread only; takes effect at the next commit().
+     */
+    void setSource (int sourceIndex, ModulationSource* source);
+
+    /** Adds a route and returns its ID, or invalidRoute if the entry is invalid or the matrix is full. */
+    int addRoute (const RoutingEntry& entry);
+
+    /** Replaces a route, keeping its smoothing state. Returns false if the ID or entry is invalid. */
+    bool setRoute (int routeID, const RoutingEntry& entry);
+
+    void removeRoute (int routeID);
+    void clearRoutes();
+
+    /** Returns nullptr if the ID isn't in use. */
+    const RoutingEntry* getRoute (int routeID) const noexcept;
+    int getNumRoutes() const noexcept   { return numRoutes; }
+
+    /** Compiles the routes and publishes them to the audio thread. Message thread only. */
+    void commit();
+
+    /** Frees replaced tables once the audio thread is done with them; call from a timer. */
+    void collectGarbage()               { tables.collectGarbage(); }
+
+    //==============================================================================
+    /** Prepares every source and resets the smoothing. Call before playback, not during it. */
+    void prepare (double sampleRate);
+
+    /** Advances the sources by a block and recomputes every target. Audio thread only. */
+    void process (int numSamples) noexcept;
+
+    /** Modulation per target at the end of the last block (maxTargets values). */
+    const float* getTargetValues() const noexcept           { return targetValues.data(); }
+
+    /** Modulation per target at the end of the block before. */
+    const float* getPreviousTargetValues() const noexcept   { return previousTargetValues.data(); }
+
+private:
+    //==============================================================================
+    struct Slot
+    {
+        RoutingEntry entry;
+        bool used = false;
+        std::uint32_t generation = 0;
+    };
+
+    bool isValid (const RoutingEntry&) const noexcept;
+    void updateCoefficients (const RoutingTable&, int numSamples) noexcept;
+    void carryStatesOver (const RoutingTable&) noexcept;
+
+    const int maxSources, maxTargets, maxRoutes;
+
+    // Message thread
+    std::vector<ModulationSource*> sources;
+    std::vector<Slot> slots;
+    std::vector<int> freeSlots;
+    int numRoutes = 0;
+    std::uint64_t nextVersion = 1;
+
+    AudioSnapshot<RoutingTable> tables;
+
+    // Audio thread
+    double sampleRate = 44100.0;
+    std::uint64_t coefficientsVersion = 0;
+    int coefficientsBlockSize = 0;
+
+    std::vector<float> tapValues;
+    std::vector<float> routeInputs;
+    std::vector<float> routeCoefficients;
+    std::vector<float> routeStates;
+    std::vector<float> targetValues, previousTargetValues;
+
+    // Smoothing state by slot, for carrying it over to a new table
+    std::vector<int> routeSlots;
+    int numRouteSlots = 0;
+    std::vector<float> slotStates;
+    std::vector<std::uint32_t> slotGenerations;
+
+    ModulationMatrix (const ModulationMatrix&) = delete;
+    ModulationMatrix& operator= (const ModulationMatrix&) = delete;
+};
+
+} // namespace wobbler
@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    ModulationSource - base class for anything the routing matrix can route
+    (LFOs, envelopes, random generators, ...)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * A control-rate signal the ModulationMatrix reads once per block.
+ *
+ * The matrix calls advance() once per block, then getValue() once for every
+ * distinct phase offset routed from this source, so the cost is one virtual
+ * call per source per block rather than per route or per sample.
+ *
+ * Both are called on the audio thread and must not lock or allocate.
+ */
+class ModulationSource
+{
+public:
+    virtual ~ModulationSource() = default;
+
+    /** Called before playback starts. */
+    virtual void prepare (double sampleRate)    { (void) sampleRate; }
+
+    /** Moves the source on by a block. */
+    virtual void advance (int numSamples) noexcept = 0;
+
+    /**
+     * The current output, normally in 0-1. phaseOffset is in cycles: periodic
+     * sources read that far ahead in their cycle, others can ignore it.
+     */
+    virtual float getValue (float phaseOffset) const noexcept = 0;
+};
+
+} // namespace wobbler
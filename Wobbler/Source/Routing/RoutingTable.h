@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    RoutingTable - the routes from modulation sources to parameter targets,
+    compiled into flat arrays for the audio thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ModulationSource.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace wobbler
+{
+
+//==============================================================================
+/** Where a route goes and how it gets there. */
+struct ModulationTarget
+{
+    int targetID = 0;               // index of the parameter being modulated
+    float depth = 1.0f;             // the target moves by depth * source value
+    float smoothingSeconds = 0.0f;  // one-pole time constant; 0 follows the source exactly
+    float phase = 0.0f;             // read the source this many cycles ahead
+};
+
+/** One row of the routing table: a source and the target it drives. */
+struct RoutingEntry
+{
+    int sourceIndex = 0;
+    ModulationTarget target;
+};
+
+//==============================================================================
+/**
+ * An immutable routing table, built by ModulationMatrix::commit() and read by
+ * the audio thread.
+ *
+ * Routes are ordered so that the per-block sum into the targets never adds
+ * to the same target twice in a row: first every target's first route, then
+ * every target's second route, and so on. Each route carries its slot (its
+ * route ID in the matrix), so the audio thread can carry its smoothing
+ * state across tables that order the routes differently.
+ *
+ * Sources are read through taps: one per distinct (source, phase) pair, so a
+ * source feeding many targets is still read once per block.
+ */
+class RoutingTable
+{
+public:
+    std::uint64_t version = 0;
+
+    // Sources, by index; not owned, and must outlive every table that uses them
+    std::vector<ModulationSource*> sources;
+
+    // Taps
+    std::vector<int> tapSources;
+    std::vector<float> tapPhases;
+
+    // Routes
+    std::vector<int> routeTaps;
+    std::vector<int> routeTargets;
+    std::vector<float> routeDepths;
+    std::vector<float> routeSmoothingSeconds;
+    std::vector<int> routeSlots;
+    std::vector<std::uint32_t> routeGenerations;   // changes when a slot is reused
+
+    int numTargets = 0;
+
+    int getNumTaps() const noexcept     { return (int) tapSources.size(); }
+    int getNumRoutes() const noexcept   { return (int) routeTaps.size(); }
+};
+
+} // namespace wobbler
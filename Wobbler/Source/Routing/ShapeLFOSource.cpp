@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    ShapeLFOSource - a free-running LFO reading one LFOShapeEngine slot
+
+  ==============================================================================
+*/
+
+#include "ShapeLFOSource.h"
+
+#include <cmath>
+
+namespace wobbler
+{
+
+ShapeLFOSource::ShapeLFOSource (const LFOShapeEngine& engineToRead, int shapeSlot, float rate) noexcept
+    : engine (engineToRead), slot (shapeSlot), rateHz (rate)
+{
+}
+
+void ShapeLFOSource::prepare (double sampleRate)
+{
+    secondsPerSample = 1.0 / sampleRate;
+}
+
+void ShapeLFOSource::advance (int numSamples) noexcept
+{
+    const auto next = (double) phase + (double) rateHz * secondsPerSample * numSamples;
+    phase = (float) (next - std::floor (next));
+}
+
+float ShapeLFOSource::getValue (float phaseOffset) const noexcept
+{
+    if (const auto* table = engine.getTable (slot))
+        return table->getValue (phase + phaseOffset);
+
+    return 0.0f;
+}
+
+} // namespace wobbler
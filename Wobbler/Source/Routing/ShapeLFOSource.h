@@ -0,0 +1,45 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    ShapeLFOSource - a free-running LFO reading one LFOShapeEngine slot
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "LFOShapeEngine.h"
+#include "ModulationSource.h"
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * Loops one shape slot at a fixed rate in Hz. getValue() reads the slot's
+ * table, so the caller must hold an LFOShapeEngine::ReadScope while the
+ * matrix runs. An empty slot reads as 0.
+ */
+class ShapeLFOSource : public ModulationSource
+{
+public:
+    ShapeLFOSource (const LFOShapeEngine& engine, int shapeSlot, float rateHz) noexcept;
+
+    void setRate (float newRateHz) noexcept     { rateHz = newRateHz; }
+    float getPhase() const noexcept             { return phase; }
+
+    //==============================================================================
+    void prepare (double sampleRate) override;
+    void advance (int numSamples) noexcept override;
+    float getValue (float phaseOffset) const noexcept override;
+
+private:
+    const LFOShapeEngine& engine;
+    const int slot;
+    float rateHz;
+    double secondsPerSample = 1.0 / 44100.0;
+    float phase = 0.0f;
+};
+
+} // namespace wobbler
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    PatternSequence - the editable grid of LFO shape placements
+
+  ==============================================================================
+*/
+
+#include "PatternSequence.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace wobbler
+{
+
+PatternSequence::PatternSequence (int numLanes, double length)
+    : lanes ((size_t) std::max (1, numLanes)),
+      lengthBeats (std::max (1.0e-3, length))
+{
+}
+
+void PatternSequence::setNumLanes (int numLanes)
+{
+    lanes.resize ((size_t) std::max (1, numLanes));
+}
+
+void PatternSequence::setLengthBeats (double newLengthBeats)
+{
+    lengthBeats = std::max (1.0e-3, newLengthBeats);
+}
+
+int PatternSequence::addPlacement (int lane, const ShapePlacement& placement)
+{
+    assert (lane >= 0 && lane < getNumLanes());
+
+    auto& placements = lanes[(size_t) lane];
+    placements.push_back (placement);
+    return (int) placements.size() - 1;
+}
+
+void PatternSequence::setPlacement (int lane, int index, const ShapePlacement& placement)
+{
+    assert (lane >= 0 && lane < getNumLanes());
+    lanes[(size_t) lane][(size_t) index] = placement;
+}
+
+void PatternSequence::removePlacement (int lane, int index)
+{
+    assert (lane >= 0 && lane < getNumLanes());
+
+    auto& placements = lanes[(size_t) lane];
+    placements.erase (placements.begin() + index);
+}
+
+void PatternSequence::clearLane (int lane)
+{
+    assert (lane >= 0 && lane < getNumLanes());
+    lanes[(size_t) lane].clear();
+}
+
+int PatternSequence::getNumPlacements() const noexcept
+{
+    size_t total = 0;
+
+    for (const auto& lane : lanes)
+        total += lane.size();
+
+    return (int) total;
+}
+
+} // namespace wobbler
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    PatternSequence - the editable grid of LFO shape placements
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace wobbler
+{
+
+//==============================================================================
+/** One LFO shape placed on a lane of the sequencer grid. Times are in beats. */
+struct ShapePlacement
+{
+    double startBeat = 0.0;
+    double lengthBeats = 1.0;
+    int shapeSlot = 0;          // slot in the LFOShapeEngine
+
+    // Transform applied to the shape
+    float cycles = 1.0f;        // how many times the shape repeats over the placement
+    float phaseOffset = 0.0f;   // added to the shape's phase, in cycles
+    float scale = 1.0f;         // output = offset + scale * shape
+    float offset = 0.0f;
+
+    bool operator== (const ShapePlacement& other) const noexcept
+    {
+        return startBeat == other.startBeat && lengthBeats == other.lengthBeats
+            && shapeSlot == other.shapeSlot && cycles == other.cycles
+            && phaseOffset == other.phaseOffset && scale == other.scale && offset == other.offset;
+    }
+
+    bool operator!= (const ShapePlacement& other) const noexcept   { return ! operator== (other); }
+};
+
+//==============================================================================
+/**
+ * The sequencer as the editor sees it: lanes of placements, each lane
+ * driving one modulation output, looping every getLengthBeats().
+ *
+ * Placements within a lane are kept in the order they were added, may
+ * overlap and may be edited freely. This is a message-thread object; the
+ * audio thread plays a SequenceTimeline compiled from it.
+ */
+class PatternSequence
+{
+public:
+    explicit PatternSequence (int numLanes = 8, double lengthBeats = 16.0);
+
+    //==============================================================================
+    int getNumLanes() const noexcept                            { return (int) lanes.size(); }
+    void setNumLanes (int numLanes);
+
+    double getLengthBeats() const noexcept                      { return lengthBeats; }
+    void setLengthBeats (double newLengthBeats);
+
+    //==============================================================================
+    const std::vector<ShapePlacement>& getLane (int lane) const { return lanes[(std::size_t) lane]; }
+
+    /** Adds a placement and returns its index in the lane. */
+    int addPlacement (int lane, const ShapePlacement& placement);
+    void setPlacement (int lane, int index, const ShapePlacement& placement);
+    void removePlacement (int lane, int index);
+    void clearLane (int lane);
+
+    /** Total placements over all lanes. */
+    int getNumPlacements() const noexcept;
+
+private:
+    std::vector<std::vector<ShapePlacement>> lanes;
+    double lengthBeats;
+};
+
+} // namespace wobbler
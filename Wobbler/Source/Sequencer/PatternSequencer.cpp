@@ -0,0 +1,27 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    PatternSequencer - the editable pattern, and the compiled timeline the
+    audio thread plays
+
+  ==============================================================================
+*/
+
+#include "PatternSequencer.h"
+
+namespace wobbler
+{
+
+PatternSequencer::PatternSequencer (int numLanes, double lengthBeats)
+    : pattern (numLanes, lengthBeats)
+{
+    commit();
+}
+
+void PatternSequencer::commit()
+{
+    timelines.publish (SequenceTimeline::compile (pattern, nextVersion++));
+}
+
+} // namespace wobbler
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    PatternSequencer - the editable pattern, and the compiled timeline the
+    audio thread plays
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "AudioSnapshot.h"
+#include "PatternSequence.h"
+#include "SequencePlayer.h"
+#include "SequenceTimeline.h"
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * Connects the message-thread model to the audio thread.
+ *
+ * Edit the pattern through getPattern(), then call commit(): the pattern is
+ * compiled into a new SequenceTimeline and swapped in atomically, so the
+ * audio thread always plays a complete version, old or new. A burst of
+ * edits can be committed once.
+ *
+ * On the audio thread, open a ReadScope per block and hand its timeline to a
+ * SequencePlayer.
+ */
+class PatternSequencer
+{
+public:
+    explicit PatternSequencer (int numLanes = 8, double lengthBeats = 16.0);
+
+    //==============================================================================
+    /** The editable pattern. Message thread only. */
+    PatternSequence& getPattern() noexcept               { return pattern; }
+    const PatternSequence& getPattern() const noexcept   { return pattern; }
+
+    /** Compiles the pattern and publishes it to the audio thread. Message thread only. */
+    void commit();
+
+    /** Frees replaced timelines once the audio thread is done with them; call from a timer. */
+    void collectGarbage()                                 { timelines.collectGarbage(); }
+
+    //==============================================================================
+    /** Pins the current timeline for one audio block. */
+    class ReadScope
+    {
+    public:
+        explicit ReadScope (const PatternSequencer& sequencer) noexcept
+            : scope (sequencer.timelines)
+        {
+        }
+
+        /** The timeline to play, or nullptr before the first commit(). */
+        const SequenceTimeline* getTimeline() const noexcept   { return scope.get(); }
+
+    private:
+        AudioSnapshot<SequenceTimeline>::ReadScope scope;
+    };
+
+private:
+    PatternSequence pattern;
+    AudioSnapshot<SequenceTimeline> timelines;
+    std::uint64_t nextVersion = 1;
+};
+
+} // namespace wobbler
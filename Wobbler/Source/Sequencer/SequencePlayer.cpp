@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    SequencePlayer - plays a SequenceTimeline block by block on the audio
+    thread
+
+  ==============================================================================
+*/
+
+#include "SequencePlayer.h"
+#include "LFOShapeEngine.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace wobbler
+{
+
+namespace
+{
+    // How far a cursor may step forwards before a binary search is cheaper
+    constexpr int maxLinearSteps = 8;
+
+    float wrapPhase (double phase) noexcept
+    {
+        return (float) (phase - std::floor (phase));
+    }
+}
+
+//==============================================================================
+SequencePlayer::SequencePlayer (int maxLanes)
+    : cursors ((size_t) std::max (1, maxLanes), -1)
+{
+}
+
+void SequencePlayer::reset() noexcept
+{
+    hasTimeline = false;
+}
+
+int SequencePlayer::locate (const SequenceTimeline& timeline, int lane, double beat) noexcept
+{
+    const auto begin = timeline.getLaneBegin (lane);
+    const auto end = timeline.getLaneEnd (lane);
+    auto& cursor = cursors[(size_t) lane];
+
+    // The cursor is usable if it isn't past the beat; then step forwards
+    if (cursor >= begin - 1 && cursor < end && (cursor < begin || timeline.getStart (cursor) <= beat))
+    {
+        for (int steps = 0; steps <= maxLinearSteps; ++steps)
+        {
+            if (cursor + 1 >= end || timeline.getStart (cursor + 1) > beat)
+            {
+                ++stats.linearSteps;
+                return cursor;
+            }
+
+            ++cursor;
+        }
+    }
+
+    ++stats.binarySearches;
+    cursor = timeline.findPlacement (lane, beat);
+    return cursor;
+}
+
+int SequencePlayer::getSegments (const SequenceTimeline& timeline, int lane, double startBeat, double beatsPerSample,
+                                 int numSamples, Segment* dest, int maxSegments) noexcept
+{
+    if (numSamples <= 0 || maxSegments <= 0 || lane < 0 || lane >= timeline.getNumLanes()
+         || lane >= (int) cursors.size() || beatsPerSample <= 0.0)
+        return 0;
+
+    // A new timeline invalidates every cursor
+    if (! hasTimeline || timeline.getVersion() != timelineVersion)
+    {
+        std::fill (cursors.begin(), cursors.end(), -1);
+        timelineVersion = timeline.getVersion();
+        hasTimeline = true;
+    }
+
+    const auto length = timeline.getLengthBeats();
+    const auto laneEnd = timeline.getLaneEnd (lane);
+
+    // Positions are computed from the block start, never accumulated
+    const auto loopsBefore = std::floor (startBeat / length);
+    const auto firstBeat = startBeat - loopsBefore * length;
+
+    auto index = locate (timeline, lane, firstBeat);
+    auto& cursor = cursors[(size_t) lane];
+    auto loopStart = 0.0;     // beats of the block (from its start) at which the current loop began
+    auto sample = 0;
+    auto numSegments = 0;
+
+    while (sample < numSamples)
+    {
+        const auto beat = firstBeat + sample * beatsPerSample - loopStart;
+        const auto isPlaying = index >= timeline.getLaneBegin (lane) && beat < timeline.getEnd (index);
+
+        // Where this segment stops: the placement's end, the next start, or the loop end
+        auto boundary = isPlaying ? timeline.getEnd (index)
+                                  : (index + 1 < laneEnd ? timeline.getStart (index + 1) : length);
+        boundary = std::min (boundary, length);
+
+        auto count = (int) std::ceil ((boundary - beat) / beatsPerSample);
+        count = std::max (1, std::min (count, numSamples - sample));
+
+        if (numSegments == maxSegments - 1)
+            count = numSamples - sample;
+
+        auto& segment = dest[numSegments++];
+        segment.startSample = sample;
+        segment.numSamples = count;
+
+        if (isPlaying)
+        {
+            const auto cyclesPerBeat = (double) timeline.getCyclesPerBeat (index);
+
+            segment.shapeSlot = timeline.getShapeSlot (index);
+            segment.firstPhase = wrapPhase (timeline.getPhaseOffset (index) + (beat - timeline.getStart (index)) * cyclesPerBeat);
+            segment.phaseStep = (float) (beatsPerSample * cyclesPerBeat);
+            segment.scale = timeline.getScale (index);
+            segment.offset = timeline.getOffset (index);
+        }
+        else
+        {
+            segment = { sample, count, -1, 0.0f, 0.0f, 0.0f, 0.0f };
+        }
+
+        sample += count;
+
+        if (sample >= numSamples)
+            break;
+
+        // Move on to whatever plays next
+        const auto nextBeat = firstBeat + sample * beatsPerSample - loopStart;
+
+        if (nextBeat >= length)
+        {
+            loopStart += length;
+            cursor = timeline.getLaneBegin (lane) - 1;
+            index = locate (timeline, lane, nextBeat - length);
+        }
+        else
+        {
+            index = locate (timeline, lane, nextBeat);
+        }
+    }
+
+    return numSegments;
+}
+
+void SequencePlayer::renderLane (const SequenceTimeline& timeline, int lane, double startBeat, double beatsPerSample,
+                                 const LFOShapeEngine& shapes, float* dest, int numSamples) noexcept
+{
+    const auto numSegments = getSegments (timeline, lane, startBeat, beatsPerSample,
+                                          numSamples, scratch, maxSegmentsPerBlock);
+
+    if (numSegments == 0)
+    {
+        std::fill (dest, dest + std::max (0, numSamples), 0.0f);
+        return;
+    }
+
+    for (int s = 0; s < numSegments; ++s)
+    {
+        const auto& segment = scratch[s];
+        auto* out = dest + segment.startSample;
+
+        if (segment.shapeSlot < 0)
+        {
+            std::fill (out, out + segment.numSamples, 0.0f);
+            continue;
+        }
+
+        shapes.render (segment.shapeSlot, segment.firstPhase, segment.phaseStep, out, segment.numSamples);
+
+        // Simple enough for the compiler to vectorise
+        const auto scale = segment.scale, offset = segment.offset;
+
+        for (int i = 0; i < segment.numSamples; ++i)
+            out[i] = offset + scale * out[i];
+    }
+}
+
+} // namespace wobbler
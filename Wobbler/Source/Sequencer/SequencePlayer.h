@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    SequencePlayer - plays a SequenceTimeline block by block on the audio
+    thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SequenceTimeline.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace wobbler
+{
+
+class LFOShapeEngine;
+
+//==============================================================================
+/**
+ * Turns a timeline and a block's beat position into what each lane plays.
+ *
+ * Each lane keeps a cursor: the placement it was playing at the end of the
+ * last block. During normal playback the next block starts at or just after
+ * the cursor, so it is found by stepping forwards; only after a jump (the
+ * host relocated, the pattern looped, a new timeline was swapped in) does
+ * the player binary-search. Either way the cost of a block depends on how
+ * many placements it touches, not on how many the pattern holds.
+ *
+ * Owned and used by one audio thread. Nothing here allocates after
+ * construction.
+ */
+class SequencePlayer
+{
+public:
+    /** A run of samples in one lane that plays one placement, or nothing. */
+    struct Segment
+    {
+        int startSample = 0;
+        int numSamples = 0;
+        int shapeSlot = -1;         // -1 for a gap between placements
+        float firstPhase = 0.0f;    // shape phase of the first sample, wrapped into 0-1
+        float phaseStep = 0.0f;     // shape cycles per sample
+        float scale = 0.0f;
+        float offset = 0.0f;
+    };
+
+    /** maxLanes bounds the lanes a timeline may have to be played in full. */
+    explicit SequencePlayer (int maxLanes = 64);
+
+    /** Forgets the cursors, e.g. after the host relocates. Not required: jumps are detected. */
+    void reset() noexcept;
+
+    //==============================================================================
+    /**
+     * Works out the segments of one lane for a block starting at startBeat
+     * (host position; the pattern loops) and advancing beatsPerSample per
+     * sample. Writes at most maxSegments; if a block touches more placements
+     * than that, the last segment is stretched to the end of the block.
+     * Returns the number written.
+     */
+    int getSegments (const SequenceTimeline& timeline, int lane, double startBeat, double beatsPerSample,
+                     int numSamples, Segment* dest, int maxSegments) noexcept;
+
+    /**
+     * Renders one lane into dest using the shapes in the engine: each sample
+     * is offset + scale * shape (phase), and 0 in gaps. Call inside an
+     * LFOShapeEngine::ReadScope.
+     */
+    void renderLane (const SequenceTimeline& timeline, int lane, double startBeat, double beatsPerSample,
+                     const LFOShapeEngine& shapes, float* dest, int numSamples) noexcept;
+
+    //==============================================================================
+    /** How placements were found: by stepping from a cursor, or by searching. */
+    struct Stats
+    {
+        std::uint64_t linearSteps = 0;
+        std::uint64_t binarySearches = 0;
+    };
+
+    const Stats& getStats() const noexcept   { return stats; }
+
+    static constexpr int maxSegmentsPerBlock = 64;
+
+private:
+    int locate (const SequenceTimeline& timeline, int lane, double beat) noexcept;
+
+    std::vector<int> cursors;
+    std::uint64_t timelineVersion = 0;
+    bool hasTimeline = false;
+    Segment scratch[maxSegmentsPerBlock];
+    Stats stats;
+};
+
+} // namespace wobbler
@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    SequenceTimeline - a PatternSequence compiled into flat, sorted arrays
+    for the audio thread
+
+  ==============================================================================
+*/
+
+#include "SequenceTimeline.h"
+
+#include <algorithm>
+
+namespace wobbler
+{
+
+std::unique_ptr<SequenceTimeline> SequenceTimeline::compile (const PatternSequence& sequence, std::uint64_t version)
+{
+    std::unique_ptr<SequenceTimeline> timeline (new SequenceTimeline());
+    auto& t = *timeline;
+
+    t.lengthBeats = sequence.getLengthBeats();
+    t.version = version;
+
+    const auto total = (size_t) sequence.getNumPlacements();
+    t.laneBegin.reserve ((size_t) sequence.getNumLanes() + 1);
+    t.starts.reserve (total);
+    t.ends.reserve (total);
+    t.shapeSlots.reserve (total);
+    t.cyclesPerBeat.reserve (total);
+    t.phaseOffsets.reserve (total);
+    t.scales.reserve (total);
+    t.offsets.reserve (total);
+
+    std::vector<int> order;
+
+    for (int lane = 0; lane < sequence.getNumLanes(); ++lane)
+    {
+        t.laneBegin.push_back ((int) t.starts.size());
+
+        const auto& placements = sequence.getLane (lane);
+
+        // Sort indices rather than placements; ties keep the order they were
+        // added. Empty placements are left out first, so they can't cut off
+        // the placement before them.
+        order.clear();
+
+        for (size_t i = 0; i < placements.size(); ++i)
+            if (placements[i].lengthBeats > 0.0)
+                order.push_back ((int) i);
+
+        std::stable_sort (order.begin(), order.end(), [&] (int a, int b)
+        {
+            return placements[(size_t) a].startBeat < placements[(size_t) b].startBeat;
+        });
+
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            const auto& p = placements[(size_t) order[i]];
+
+            const auto start = std::max (0.0, p.startBeat);
+            auto end = std::min (t.lengthBeats, p.startBeat + p.lengthBeats);
+
+            // A later placement cuts off an earlier one it overlaps
+            if (i + 1 < order.size())
+                end = std::min (end, placements[(size_t) order[i + 1]].startBeat);
+
+            if (end <= start)
+                continue;
+
+            t.starts.push_back (start);
+            t.ends.push_back (end);
+            t.shapeSlots.push_back (p.shapeSlot);
+            t.cyclesPerBeat.push_back ((float) (p.cycles / p.lengthBeats));
+            t.phaseOffsets.push_back (p.phaseOffset + (float) ((start - p.startBeat) * p.cycles / p.lengthBeats));
+            t.scales.push_back (p.scale);
+            t.offsets.push_back (p.offset);
+        }
+    }
+
+    t.laneBegin.push_back ((int) t.starts.size());
+    return timeline;
+}
+
+int SequenceTimeline::findPlacement (int lane, double beat) const noexcept
+{
+    const auto first = starts.begin() + getLaneBegin (lane);
+    const auto last  = starts.begin() + getLaneEnd (lane);
+
+    return (int) (std::upper_bound (first, last, beat) - starts.begin()) - 1;
+}
+
+} // namespace wobbler
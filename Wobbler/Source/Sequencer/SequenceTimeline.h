@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    SequenceTimeline - a PatternSequence compiled into flat, sorted arrays
+    for the audio thread
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "PatternSequence.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * An immutable, playable form of a PatternSequence.
+ *
+ * All lanes' placements live in one set of parallel arrays (structure of
+ * arrays), sorted by lane and then by start. Lane l owns the index range
+ * [getLaneBegin (l), getLaneEnd (l)). Overlaps are resolved when compiling
+ * (a placement ends where the next one in its lane starts), so at any beat
+ * a lane plays at most one placement, and finding it is a binary search
+ * over one contiguous array of start times. Playback then steps forwards
+ * through the same arrays.
+ *
+ * Placements are also clipped to the pattern length, and empty ones dropped.
+ */
+class SequenceTimeline
+{
+public:
+    /** Compiles a sequence. Message thread; allocates. */
+    static std::unique_ptr<SequenceTimeline> compile (const PatternSequence& sequence, std::uint64_t version);
+
+    //==============================================================================
+    int getNumLanes() const noexcept                    { return (int) laneBegin.size() - 1; }
+    double getLengthBeats() const noexcept              { return lengthBeats; }
+    int getNumPlacements() const noexcept               { return (int) starts.size(); }
+
+    /** Increases with every compile, so players can tell timelines apart. */
+    std::uint64_t getVersion() const noexcept           { return version; }
+
+    int getLaneBegin (int lane) const noexcept          { return laneBegin[(size_t) lane]; }
+    int getLaneEnd (int lane) const noexcept            { return laneBegin[(size_t) lane + 1]; }
+
+    /**
+     * Index of the last placement in the lane starting at or before beat,
+     * or getLaneBegin (lane) - 1 if there is none. The placement may already
+     * have ended; check against getEnd().
+     */
+    int findPlacement (int lane, double beat) const noexcept;
+
+    //==============================================================================
+    // Placement data, by index
+    double getStart (int index) const noexcept          { return starts[(size_t) index]; }
+    double getEnd (int index) const noexcept            { return ends[(size_t) index]; }
+    int getShapeSlot (int index) const noexcept         { return shapeSlots[(size_t) index]; }
+    float getCyclesPerBeat (int index) const noexcept   { return cyclesPerBeat[(size_t) index]; }
+    float getPhaseOffset (int index) const noexcept     { return phaseOffsets[(size_t) index]; }
+    float getScale (int index) const noexcept           { return scales[(size_t) index]; }
+    float getOffset (int index) const noexcept          { return offsets[(size_t) index]; }
+
+private:
+    SequenceTimeline() = default;
+
+    double lengthBeats = 0.0;
+    std::uint64_t version = 0;
+
+    std::vector<int> laneBegin;     // numLanes + 1 entries
+    std::vector<double> starts, ends;
+    std::vector<int> shapeSlots;
+    std::vector<float> cyclesPerBeat, phaseOffsets, scales, offsets;
+};
+
+} // namespace wobbler
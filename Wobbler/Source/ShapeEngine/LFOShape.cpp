@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    LFOShape - point-based LFO shapes with linear, exponential, spline and
+    stepped segments
+
+  ==============================================================================
+*/
+
+#include "LFOShape.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace wobbler
+{
+
+namespace
+{
+    //==============================================================================
+    // curvature 1 bends the curve as far as exp (8 t) does
+    constexpr double maxExponent = 8.0;
+
+    template <typename Type>
+    Type clamp01 (Type value) noexcept
+    {
+        return std::min ((Type) 1, std::max ((Type) 0, value));
+    }
+
+    double wrapPhase (double phase) noexcept
+    {
+        return phase - std::floor (phase);
+    }
+}
+
+//==============================================================================
+LFOShape::LFOShape (std::vector<LFOPoint> newPoints)
+{
+    setPoints (std::move (newPoints));
+}
+
+void LFOShape::setPoints (std::vector<LFOPoint> newPoints)
+{
+    for (auto& point : newPoints)
+    {
+        point.phase = clamp01 (point.phase);
+        point.value = clamp01 (point.value);
+        point.curvature = std::min (1.0f, std::max (-1.0f, point.curvature));
+    }
+
+    std::stable_sort (newPoints.begin(), newPoints.end(),
+                      [] (const LFOPoint& a, const LFOPoint& b) { return a.phase < b.phase; });
+
+    points = std::move (newPoints);
+}
+
+int LFOShape::findSegment (double phase) const noexcept
+{
+    if (points.empty())
+        return -1;
+
+    phase = wrapPhase (phase);
+
+    // The last point at or before this phase; before the first point we are
+    // still in the last point's segment, which wraps round
+    const auto next = std::upper_bound (points.begin(), points.end(), phase,
+                                        [] (double p, const LFOPoint& point) { return p < (double) point.phase; });
+
+    if (next == points.begin())
+        return (int) points.size() - 1;
+
+    return (int) (next - points.begin()) - 1;
+}
+
+float LFOShape::evaluate (double phase) const noexcept
+{
+    const auto segment = findSegment (phase);
+
+    if (segment < 0)
+        return 0.0f;
+
+    return evaluateSegment (segment, wrapPhase (phase));
+}
+
+float LFOShape::evaluateSegment (int index, double phase) const noexcept
+{
+    const auto numPoints = (int) points.size();
+    const auto& start = points[(size_t) index];
+
+    if (numPoints == 1 || start.curve == CurveType::step)
+        return start.value;
+
+    const auto wraps = index == numPoints - 1;
+    const auto& end = points[(size_t) ((index + 1) % numPoints)];
+
+    // Unwrap so that the segment runs forwards from start.phase
+    const auto startPhase = (double) start.phase;
+    const auto endPhase = (double) end.phase + (wraps ? 1.0 : 0.0);
+    const auto length = endPhase - startPhase;
+
+    if (phase < startPhase)
+        phase += 1.0;
+
+    if (length <= 0.0)
+        return end.value;
+
+    const auto t = clamp01 ((phase - startPhase) / length);
+    const auto v0 = (double) start.value;
+    const auto v1 = (double) end.value;
+
+    switch (start.curve)
+    {
+        case CurveType::linear:
+            return (float) (v0 + (v1 - v0) * t);
+
+        case CurveType::exponential:
+        {
+            const auto k = (double) start.curvature * maxExponent;
+
+            if (std::abs (k) < 1.0e-4)
+                return (float) (v0 + (v1 - v0) * t);
+
+            const auto shaped = std::expm1 (k * t) / std::expm1 (k);
+            return (float) (v0 + (v1 - v0) * shaped);
+        }
+
+        case CurveType::spline:
+        {
+            // Cubic Hermite with Catmull-Rom tangents taken from the neighbours,
+            // scaled for uneven point spacing
+            const auto& before = points[(size_t) ((index + numPoints - 1) % numPoints)];
+            const auto& after  = points[(size_t) ((index + 2) % numPoints)];
+
+            auto beforePhase = (double) before.phase;
+            auto afterPhase  = (double) after.phase;
+
+            if (beforePhase >= startPhase)   beforePhase -= 1.0;
+            while (afterPhase <= endPhase)   afterPhase += 1.0;
+
+            const auto slope0 = ((double) end.value - before.value) / std::max (1.0e-9, endPhase - beforePhase);
+            const auto slope1 = ((double) after.value - start.value) / std::max (1.0e-9, afterPhase - startPhase);
+            const auto m0 = slope0 * length;
+            const auto m1 = slope1 * length;
+
+            const auto t2 = t * t;
+            const auto t3 = t2 * t;
+
+            return (float) ((2.0 * t3 - 3.0 * t2 + 1.0) * v0
+                          + (t3 - 2.0 * t2 + t) * m0
+                          + (-2.0 * t3 + 3.0 * t2) * v1
+                          + (t3 - t2) * m1);
+        }
+
+        case CurveType::step:
+            break;
+    }
+
+    return start.value;
+}
+
+//==============================================================================
+LFOShape LFOShape::sine()
+{
+    // Spline through the peaks, troughs and zero crossings
+    return LFOShape ({ { 0.0f,  0.5f, CurveType::spline },
+                       { 0.25f, 1.0f, CurveType::spline },
+                       { 0.5f,  0.5f, CurveType::spline },
+                       { 0.75f, 0.0f, CurveType::spline } });
+}
+
+LFOShape LFOShape::triangle()
+{
+    return LFOShape ({ { 0.0f, 0.0f }, { 0.5f, 1.0f } });
+}
+
+LFOShape LFOShape::square()
+{
+    return LFOShape ({ { 0.0f, 1.0f, CurveType::step }, { 0.5f, 0.0f, CurveType::step } });
+}
+
+LFOShape LFOShape::sawUp()
+{
+    return LFOShape ({ { 0.0f, 0.0f }, { 1.0f, 1.0f, CurveType::step } });
+}
+
+LFOShape LFOShape::sawDown()
+{
+    return LFOShape ({ { 0.0f, 1.0f }, { 1.0f, 0.0f, CurveType::step } });
+}
+
+} // namespace wobbler
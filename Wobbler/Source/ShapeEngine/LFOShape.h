@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    LFOShape - point-based LFO shapes with linear, exponential, spline and
+    stepped segments
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+
+namespace wobbler
+{
+
+//==============================================================================
+/** How the curve travels from one point to the next. */
+enum class CurveType
+{
+    linear,         // straight line
+    exponential,    // bends towards the start or end, set by LFOPoint::curvature
+    spline,         // Catmull-Rom style cubic through the neighbouring points
+    step            // holds the point's value until the next point
+};
+
+/**
+ * One editable point of an LFO shape. The curve type describes the segment
+ * that starts at this point; the last point's segment wraps round to the
+ * first point.
+ */
+struct LFOPoint
+{
+    float phase = 0.0f;         // position in the cycle, 0 to 1
+    float value = 0.0f;         // unipolar, 0 to 1
+    CurveType curve = CurveType::linear;
+    float curvature = 0.5f;     // exponential only: -1 to 1, 0 is a straight line
+
+    bool operator== (const LFOPoint& other) const noexcept
+    {
+        return phase == other.phase && value == other.value
+            && curve == other.curve && curvature == other.curvature;
+    }
+
+    bool operator!= (const LFOPoint& other) const noexcept   { return ! operator== (other); }
+};
+
+//==============================================================================
+/**
+ * A single cycle of an LFO, defined by points.
+ *
+ * evaluate() computes the exact curve and is meant for baking wavetables and
+ * for drawing, not for the audio thread: playback reads the baked tables
+ * held by LFOShapeEngine.
+ */
+class LFOShape
+{
+public:
+    LFOShape() = default;
+    explicit LFOShape (std::vector<LFOPoint> points);
+
+    /** Replaces the points. They are clamped to 0-1 and sorted by phase. */
+    void setPoints (std::vector<LFOPoint> newPoints);
+    const std::vector<LFOPoint>& getPoints() const noexcept   { return points; }
+
+    /** The shape's value at a phase (wrapped into 0-1). An empty shape is 0. */
+    float evaluate (double phase) const noexcept;
+
+    /** Index of the point whose segment contains this phase, or -1 if empty. */
+    int findSegment (double phase) const noexcept;
+
+    bool operator== (const LFOShape& other) const noexcept    { return points == other.points; }
+    bool operator!= (const LFOShape& other) const noexcept    { return points != other.points; }
+
+    //==============================================================================
+    /** Standard shapes for the editor's quick-start buttons. */
+    static LFOShape sine();
+    static LFOShape triangle();
+    static LFOShape square();
+    static LFOShape sawUp();
+    static LFOShape sawDown();
+
+private:
+    float evaluateSegment (int index, double phase) const noexcept;
+
+    std::vector<LFOPoint> points;
+};
+
+} // namespace wobbler
@@ -0,0 +1,259 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    LFOShapeEngine - keeps a baked wavetable for every LFO shape, rebuilding
+    edited shapes on a background thread and swapping them in lock-free
+
+  ==============================================================================
+*/
+
+#include "LFOShapeEngine.h"
+#include "WavetableBuilder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace wobbler
+{
+
+//==============================================================================
+LFOShapeEngine::LFOShapeEngine (int maxShapes, int tableSizeToUse)
+    : tableSize (tableSizeToUse),
+      slots ((size_t) std::max (1, maxShapes)),
+      builders (slots.size()),
+      versions (slots.size(), 0)
+{
+    for (auto& slot : slots)
+        slot.store (nullptr, std::memory_order_relaxed);
+
+    builderThread = std::thread ([this] { builderLoop(); });
+}
+
+LFOShapeEngine::~LFOShapeEngine()
+{
+    {
+        const std::lock_guard<std::mutex> guard (lock);
+        shouldExit = true;
+    }
+
+    workAvailable.notify_all();
+    builderThread.join();
+
+    // The audio thread must have stopped reading by now
+    for (auto& slot : slots)
+        delete slot.exchange (nullptr);
+
+    for (auto& r : retired)
+        delete r.table;
+}
+
+//==============================================================================
+void LFOShapeEngine::setShape (int slot, const LFOShape& shape)
+{
+    if (slot < 0 || slot >= getMaxShapes())
+        return;
+
+    // Copied outside the lock, so the builder never waits on an allocation
+    auto copy = std::make_shared<const LFOShape> (shape);
+
+    {
+        const std::lock_guard<std::mutex> guard (lock);
+        pending[slot] = std::move (copy);
+    }
+
+    workAvailable.notify_one();
+}
+
+void LFOShapeEngine::clearShape (int slot)
+{
+    if (slot < 0 || slot >= getMaxShapes())
+        return;
+
+    {
+        const std::lock_guard<std::mutex> guard (lock);
+        pending[slot] = nullptr;
+    }
+
+    workAvailable.notify_one();
+}
+
+bool LFOShapeEngine::waitUntilIdle (int timeoutMilliseconds)
+{
+    std::unique_lock<std::mutex> guard (lock);
+    const auto isIdle = [this] { return pending.empty() && ! building; };
+
+    if (timeoutMilliseconds < 0)
+    {
+        idle.wait (guard, isIdle);
+        return true;
+    }
+
+    return idle.wait_for (guard, std::chrono::milliseconds (timeoutMilliseconds), isIdle);
+}
+
+LFOShapeEngine::Stats LFOShapeEngine::getStats() const
+{
+    const std::lock_guard<std::mutex> guard (lock);
+    return stats;
+}
+
+//==============================================================================
+LFOShapeEngine::ReadScope::ReadScope (const LFOShapeEngine& engine) noexcept
+    : owner (engine)
+{
+    // Odd while a block is running. seq_cst, so that this is ordered before
+    // the table loads that follow (see publish())
+    owner.readEpoch.fetch_add (1, std::memory_order_seq_cst);
+}
+
+LFOShapeEngine::ReadScope::~ReadScope()
+{
+    owner.readEpoch.fetch_add (1, std::memory_order_seq_cst);
+}
+
+const Wavetable* LFOShapeEngine::getTable (int slot) const noexcept
+{
+    if (slot < 0 || slot >= getMaxShapes())
+        return nullptr;
+
+    return slots[(size_t) slot].load (std::memory_order_seq_cst);
+}
+
+float LFOShapeEngine::render (int slot, float startPhase, float phaseIncrement, float* dest, int numSamples) const noexcept
+{
+    if (const auto* table = getTable (slot))
+        return table->render (startPhase, phaseIncrement, dest, numSamples);
+
+    std::memset (dest, 0, sizeof (float) * (size_t) std::max (0, numSamples));
+
+    const auto end = (double) startPhase + (double) phaseIncrement * numSamples;
+    return (float) (end - std::floor (end));
+}
+
+//==============================================================================
+void LFOShapeEngine::builderLoop()
+{
+    using Clock = std::chrono::steady_clock;
+
+    for (;;)
+    {
+        std::map<int, std::shared_ptr<const LFOShape>> work;
+
+        {
+            std::unique_lock<std::mutex> guard (lock);
+
+            // Poll while old tables are waiting for the audio thread to
+            // finish a block; otherwise sleep until there's something to do
+            const auto hasWork = [this] { return shouldExit || ! pending.empty(); };
+
+            if (retired.empty())
+                workAvailable.wait (guard, hasWork);
+            else
+                workAvailable.wait_for (guard, std::chrono::milliseconds (5), hasWork);
+
+            if (shouldExit)
+                return;
+
+            work.swap (pending);
+            building = ! work.empty();
+        }
+
+        Stats batch;
+
+        for (auto& item : work)
+        {
+            const auto slot = item.first;
+
+            if (item.second == nullptr)
+            {
+                if (builders[(size_t) slot] != nullptr)
+                    builders[(size_t) slot]->reset();
+
+                publish (slot, nullptr);
+                continue;
+            }
+
+            auto& builder = builders[(size_t) slot];
+
+            if (builder == nullptr)
+                builder = std::make_unique<WavetableBuilder> (tableSize);
+
+            const auto start = Clock::now();
+            auto table = builder->build (*item.second, ++versions[(size_t) slot]);
+            const auto micros = std::chrono::duration<double, std::micro> (Clock::now() - start).count();
+
+            publish (slot, std::move (table));
+
+            ++batch.tablesBuilt;
+            batch.samplesEvaluated += (std::uint64_t) builder->getLastNumSamplesEvaluated();
+            batch.incrementalBuilds += builder->getLastNumSamplesEvaluated() < tableSize ? 1 : 0;
+            batch.lastBuildMicroseconds = micros;
+            batch.maxBuildMicroseconds = std::max (batch.maxBuildMicroseconds, micros);
+        }
+
+        const auto numBefore = retired.size();
+        freeRetiredTables();
+        batch.tablesFreed = numBefore - retired.size();
+
+        {
+            const std::lock_guard<std::mutex> guard (lock);
+
+            stats.tablesBuilt += batch.tablesBuilt;
+            stats.samplesEvaluated += batch.samplesEvaluated;
+            stats.incrementalBuilds += batch.incrementalBuilds;
+            stats.tablesFreed += batch.tablesFreed;
+            stats.maxBuildMicroseconds = std::max (stats.maxBuildMicroseconds, batch.maxBuildMicroseconds);
+
+            if (batch.tablesBuilt > 0)
+                stats.lastBuildMicroseconds = batch.lastBuildMicroseconds;
+
+            building = false;
+
+            if (pending.empty())
+                idle.notify_all();
+        }
+    }
+}
+
+void LFOShapeEngine::publish (int slot, std::unique_ptr<Wavetable> table)
+{
+    const auto* old = slots[(size_t) slot].exchange (table.release(), std::memory_order_seq_cst);
+
+    // Read after the exchange: any block that starts later loads the new table
+    if (old != nullptr)
+        retired.push_back ({ old, readEpoch.load (std::memory_order_seq_cst) });
+}
+
+void LFOShapeEngine::freeRetiredTables()
+{
+    if (retired.empty())
+        return;
+
+    const auto current = readEpoch.load (std::memory_order_seq_cst);
+
+    // A table is safe to free if no block was running when it was replaced
+    // (even epoch), or the block that was running has since finished
+    const auto canFree = [current] (const Retired& r)
+    {
+        return (r.readEpoch & 1) == 0 || current > r.readEpoch;
+    };
+
+    for (auto& r : retired)
+    {
+        if (canFree (r))
+        {
+            delete r.table;
+            r.table = nullptr;
+        }
+    }
+
+    retired.erase (std::remove_if (retired.begin(), retired.end(),
+                                   [] (const Retired& r) { return r.table == nullptr; }),
+                   retired.end());
+}
+
+} // namespace wobbler
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    LFOShapeEngine - keeps a baked wavetable for every LFO shape, rebuilding
+    edited shapes on a background thread and swapping them in lock-free
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "LFOShape.h"
+#include "Wavetable.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wobbler
+{
+
+class WavetableBuilder;
+
+//==============================================================================
+/**
+ * A fixed number of shape slots, each holding the current Wavetable for one
+ * LFO shape.
+ *
+ * Editing side (message thread): setShape() queues a shape and returns at
+ * once. A background thread bakes it and publishes the new table with a
+ * single atomic exchange. If a slot is edited again before its previous edit
+ * was baked, only the latest shape is built, so dragging a point costs at
+ * most one bake per slot per pass of the builder.
+ *
+ * Audio side (one audio thread): open a ReadScope for the block, then read
+ * tables with getTable() or render(). Nothing on this side locks, allocates
+ * or frees. The ReadScope tells the builder when the audio thread might
+ * still hold a replaced table, so old tables are freed only once the block
+ * that could have seen them has finished.
+ */
+class LFOShapeEngine
+{
+public:
+    LFOShapeEngine (int maxShapes = 256, int tableSize = 2048);
+    ~LFOShapeEngine();
+
+    int getMaxShapes() const noexcept   { return (int) slots.size(); }
+    int getTableSize() const noexcept   { return tableSize; }
+
+    //==============================================================================
+    /** Queues a shape to be baked into a slot. */
+    void setShape (int slot, const LFOShape& shape);
+
+    /** Queues removal of a slot's table; render() outputs silence for it afterwards. */
+    void clearShape (int slot);
+
+    /**
+     * Blocks until every queued shape has been baked and published, or until
+     * the timeout (-1 waits forever). Returns false on timeout.
+     */
+    bool waitUntilIdle (int timeoutMilliseconds = -1);
+
+    /** Counters kept by the builder thread. */
+    struct Stats
+    {
+        std::uint64_t tablesBuilt = 0;
+        std::uint64_t samplesEvaluated = 0;     // exact curve evaluations, all builds
+        std::uint64_t incrementalBuilds = 0;    // builds that re-used part of the last table
+        std::uint64_t tablesFreed = 0;
+        double lastBuildMicroseconds = 0.0;
+        double maxBuildMicroseconds = 0.0;
+    };
+
+    Stats getStats() const;
+
+    //==============================================================================
+    /** Marks the audio thread as reading tables for as long as it exists. */
+    class ReadScope
+    {
+    public:
+        explicit ReadScope (const LFOShapeEngine& engine) noexcept;
+        ~ReadScope();
+
+    private:
+        const LFOShapeEngine& owner;
+
+        ReadScope (const ReadScope&) = delete;
+        ReadScope& operator= (const ReadScope&) = delete;
+    };
+
+    /**
+     * The table for a slot, or nullptr if it has none. Only valid inside a
+     * ReadScope, and only until that scope ends.
+     */
+    const Wavetable* getTable (int slot) const noexcept;
+
+    /**
+     * Renders a slot into dest (see Wavetable::render()). If the slot is empty
+     * dest is cleared. Returns the phase after the last sample. Only call
+     * inside a ReadScope.
+     */
+    float render (int slot, float startPhase, float phaseIncrement, float* dest, int numSamples) const noexcept;
+
+private:
+    //==============================================================================
+    struct Retired
+    {
+        const Wavetable* table;
+        std::uint64_t readEpoch;
+    };
+
+    void builderLoop();
+    void publish (int slot, std::unique_ptr<Wavetable> table);
+    void freeRetiredTables();
+
+    const int tableSize;
+
+    // Audio thread reads: one pointer per slot, and the block counter
+    std::vector<std::atomic<const Wavetable*>> slots;
+    mutable std::atomic<std::uint64_t> readEpoch { 0 };
+
+    // Shared between the message thread and the builder
+    mutable std::mutex lock;
+    std::condition_variable workAvailable, idle;
+    std::map<int, std::shared_ptr<const LFOShape>> pending;   // nullptr clears the slot
+    bool building = false, shouldExit = false;
+    Stats stats;
+
+    // Builder thread only
+    std::vector<std::unique_ptr<WavetableBuilder>> builders;
+    std::vector<std::uint64_t> versions;
+    std::vector<Retired> retired;
+
+    std::thread builderThread;
+};
+
+} // namespace wobbler
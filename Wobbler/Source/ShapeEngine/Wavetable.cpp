@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    Wavetable - an immutable, baked LFO cycle with band-limited mip levels
+
+  ==============================================================================
+*/
+
+#include "Wavetable.h"
+#include "WavetableKernels.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace wobbler
+{
+
+Wavetable::Wavetable (std::vector<float> samplesToUse, const Level* levelsToUse, int numLevelsToUse, std::uint64_t versionToUse)
+    : samples (std::move (samplesToUse)),
+      numLevels (std::min (numLevelsToUse, maxLevels)),
+      version (versionToUse)
+{
+    assert (numLevels > 0);
+
+    for (int i = 0; i < numLevels; ++i)
+    {
+        assert (levelsToUse[i].size > 0 && (levelsToUse[i].size & (levelsToUse[i].size - 1)) == 0);
+        assert ((size_t) (levelsToUse[i].offset + levelsToUse[i].size) < samples.size());
+        levels[(size_t) i] = levelsToUse[i];
+    }
+}
+
+int Wavetable::selectLevel (float phaseIncrement) const noexcept
+{
+    const auto increment = std::abs (phaseIncrement);
+
+    // Level 0 is exact, so it's fine as long as we don't skip table samples
+    if (increment * (float) levels[0].size <= 1.0f)
+        return 0;
+
+    // Otherwise the first level whose top harmonic is below Nyquist
+    for (int i = 1; i < numLevels; ++i)
+        if ((float) levels[(size_t) i].maxHarmonic * increment <= 0.5f)
+            return i;
+
+    return numLevels - 1;
+}
+
+float Wavetable::render (float startPhase, float phaseIncrement, float* dest, int numSamples) const noexcept
+{
+    const auto level = selectLevel (phaseIncrement);
+
+    getWavetableKernels().render (getLevelData (level), levels[(size_t) level].size,
+                                  startPhase, phaseIncrement, dest, numSamples);
+
+    // Wrapped in double so long blocks at high rates don't lose precision
+    const auto end = (double) startPhase + (double) phaseIncrement * numSamples;
+    return (float) (end - std::floor (end));
+}
+
+void Wavetable::lookup (const float* phases, float* dest, int numSamples, float phaseIncrement) const noexcept
+{
+    const auto level = selectLevel (phaseIncrement);
+
+    getWavetableKernels().lookup (getLevelData (level), levels[(size_t) level].size,
+                                  phases, dest, numSamples);
+}
+
+float Wavetable::getValue (float phase) const noexcept
+{
+    float value;
+    getWavetableKernels().lookup (getLevelData (0), levels[0].size, &phase, &value, 1);
+    return value;
+}
+
+} // namespace wobbler
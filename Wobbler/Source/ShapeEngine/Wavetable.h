@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    Wavetable - an immutable, baked LFO cycle with band-limited mip levels
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * One LFO shape baked into power-of-two tables.
+ *
+ * Level 0 is the exact curve, sampled at the full table size, and is used
+ * while the LFO is slow enough that one table step lasts at least a sample.
+ * Each level above it keeps half as many harmonics as the one before, so a
+ * fast LFO can pick a level whose highest harmonic stays below Nyquist
+ * instead of aliasing on sharp edges.
+ *
+ * A Wavetable never changes once built. LFOShapeEngine builds new ones on a
+ * background thread and swaps them in, so the audio thread can read one
+ * without locks.
+ */
+class Wavetable
+{
+public:
+    static constexpr int maxLevels = 16;
+
+    /** Where one level's samples live, and what it can reproduce. */
+    struct Level
+    {
+        int offset = 0;         // into the sample storage
+        int size = 0;           // samples per cycle, a power of two
+        int maxHarmonic = 0;    // 0 for level 0, which isn't band-limited
+    };
+
+    /**
+     * Takes ownership of the samples. Each level's data must be followed by
+     * one guard sample equal to its first sample.
+     */
+    Wavetable (std::vector<float> samples, const Level* levels, int numLevels, std::uint64_t version);
+
+    int getNumLevels() const noexcept                       { return numLevels; }
+    const Level& getLevel (int index) const noexcept        { return levels[(std::size_t) index]; }
+    const float* getLevelData (int index) const noexcept    { return samples.data() + levels[(std::size_t) index].offset; }
+
+    /** Increases every time the shape engine rebuilds the same slot. */
+    std::uint64_t getVersion() const noexcept               { return version; }
+
+    /** The level to play when the phase moves this far (in cycles) per sample. */
+    int selectLevel (float phaseIncrement) const noexcept;
+
+    //==============================================================================
+    /**
+     * Fills dest with numSamples values starting at startPhase and advancing
+     * by phaseIncrement each sample, using the band-limited level that suits
+     * the increment. Returns the phase after the last sample, wrapped into 0-1.
+     */
+    float render (float startPhase, float phaseIncrement, float* dest, int numSamples) const noexcept;
+
+    /** Reads arbitrary phases, e.g. a swinging or modulated LFO, at the level for phaseIncrement. */
+    void lookup (const float* phases, float* dest, int numSamples, float phaseIncrement) const noexcept;
+
+    /** A single interpolated value from level 0. */
+    float getValue (float phase) const noexcept;
+
+private:
+    std::vector<float> samples;
+    std::array<Level, maxLevels> levels {};
+    int numLevels = 0;
+    std::uint64_t version = 0;
+};
+
+} // namespace wobbler
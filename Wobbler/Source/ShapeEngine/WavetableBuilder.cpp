@@ -0,0 +1,220 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    WavetableBuilder - bakes LFO shapes into wavetables, re-evaluating only
+    the part of the cycle an edit touched
+
+  ==============================================================================
+*/
+
+#include "WavetableBuilder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace wobbler
+{
+
+namespace
+{
+    //==============================================================================
+    // The smallest band-limited level; below this linear interpolation between
+    // samples starts to add more error than the band-limiting removes
+    constexpr int minLevelSize = 256;
+
+    constexpr double pi = 3.14159265358979323846;
+
+    /** In-place radix-2 FFT. inverse uses e^+i and does not scale. */
+    void fft (std::complex<double>* data, int size, bool inverse) noexcept
+    {
+        for (int i = 1, j = 0; i < size; ++i)
+        {
+            auto bit = size >> 1;
+
+            for (; (j & bit) != 0; bit >>= 1)
+                j ^= bit;
+
+            j ^= bit;
+
+            if (i < j)
+                std::swap (data[i], data[j]);
+        }
+
+        for (int length = 2; length <= size; length <<= 1)
+        {
+            const auto angle = (inverse ? 2.0 : -2.0) * pi / length;
+            const std::complex<double> step (std::cos (angle), std::sin (angle));
+
+            for (int start = 0; start < size; start += length)
+            {
+                std::complex<double> twiddle (1.0, 0.0);
+
+                for (int k = 0; k < length / 2; ++k)
+                {
+                    const auto a = data[start + k];
+                    const auto b = data[start + k + length / 2] * twiddle;
+                    data[start + k] = a + b;
+                    data[start + k + length / 2] = a - b;
+                    twiddle *= step;
+                }
+            }
+        }
+    }
+}
+
+//==============================================================================
+WavetableBuilder::WavetableBuilder (int size)
+    : tableSize (size)
+{
+    assert (tableSize >= minLevelSize && (tableSize & (tableSize - 1)) == 0);
+
+    exact.resize ((size_t) tableSize);
+    dirty.resize ((size_t) tableSize);
+    spectrum.resize ((size_t) tableSize);
+    scratch.resize ((size_t) tableSize);
+}
+
+void WavetableBuilder::reset()
+{
+    hasShape = false;
+}
+
+std::unique_ptr<Wavetable> WavetableBuilder::build (const LFOShape& shape, std::uint64_t version)
+{
+    if (hasShape)
+    {
+        std::fill (dirty.begin(), dirty.end(), (unsigned char) 0);
+        markChangedRegions (lastShape.getPoints(), shape.getPoints());
+    }
+    else
+    {
+        std::fill (dirty.begin(), dirty.end(), (unsigned char) 1);
+    }
+
+    lastNumSamplesEvaluated = 0;
+
+    for (int i = 0; i < tableSize; ++i)
+    {
+        if (dirty[(size_t) i] != 0)
+        {
+            exact[(size_t) i] = shape.evaluate ((double) i / tableSize);
+            ++lastNumSamplesEvaluated;
+        }
+    }
+
+    lastShape = shape;
+    hasShape = true;
+
+    std::vector<float> samples;
+    Wavetable::Level levels[Wavetable::maxLevels];
+    int numLevels = 0;
+    buildLevels (samples, levels, numLevels);
+
+    return std::make_unique<Wavetable> (std::move (samples), levels, numLevels, version);
+}
+
+//==============================================================================
+void WavetableBuilder::markChangedRegions (const std::vector<LFOPoint>& oldPoints, const std::vector<LFOPoint>& newPoints)
+{
+    const auto numPoints = (int) newPoints.size();
+
+    // Adding or removing a point changes which points are neighbours, and
+    // with so few points almost every segment depends on every point anyway
+    if ((int) oldPoints.size() != numPoints || numPoints <= 4)
+    {
+        std::fill (dirty.begin(), dirty.end(), (unsigned char) 1);
+        return;
+    }
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        if (oldPoints[(size_t) i] == newPoints[(size_t) i])
+            continue;
+
+        // Point i is used by segments i - 2 to i + 1 (splines look at the
+        // point before a segment and the one after it). Mark that stretch of
+        // the cycle as it was and as it is now, in case the point moved.
+        const auto first = (size_t) ((i + numPoints - 2) % numPoints);
+        const auto last  = (size_t) ((i + 2) % numPoints);
+
+        markPhaseRange (oldPoints[first].phase, oldPoints[last].phase);
+        markPhaseRange (newPoints[first].phase, newPoints[last].phase);
+    }
+}
+
+void WavetableBuilder::markPhaseRange (float startPhase, float endPhase)
+{
+    // Inclusive at both ends, rounding outwards, so a sample that lands on a
+    // segment boundary is always re-evaluated
+    const auto first = (int) std::floor (startPhase * (float) tableSize);
+    auto last = (int) std::ceil (endPhase * (float) tableSize);
+
+    if (last < first)
+        last += tableSize;
+
+    for (int i = first; i <= last; ++i)
+        dirty[(size_t) (i & (tableSize - 1))] = 1;
+}
+
+void WavetableBuilder::buildLevels (std::vector<float>& samples, Wavetable::Level* levels, int& numLevels)
+{
+    // Level 0 is the exact curve. Level 1 keeps harmonics up to tableSize / 8,
+    // and each level after that keeps half as many, down to the fundamental
+    numLevels = 1;
+    levels[0] = { 0, tableSize, 0 };
+    auto total = tableSize + 1;
+
+    for (auto harmonics = tableSize / 8; harmonics >= 1 && numLevels < Wavetable::maxLevels; harmonics /= 2)
+    {
+        // Four samples per period of the top harmonic keeps linear
+        // interpolation error small
+        const auto size = std::max (minLevelSize, harmonics * 4);
+        levels[numLevels++] = { total, size, harmonics };
+        total += size + 1;
+    }
+
+    samples.resize ((size_t) total);
+    std::copy (exact.begin(), exact.end(), samples.begin());
+    samples[(size_t) tableSize] = exact[0];
+
+    for (int i = 0; i < tableSize; ++i)
+        spectrum[(size_t) i] = exact[(size_t) i];
+
+    fft (spectrum.data(), tableSize, false);
+
+    for (int l = 1; l < numLevels; ++l)
+    {
+        const auto& level = levels[l];
+        const auto scale = 1.0 / tableSize;
+
+        std::fill (scratch.begin(), scratch.begin() + level.size, std::complex<double>());
+        scratch[0] = spectrum[0] * scale;
+
+        for (int k = 1; k <= level.maxHarmonic; ++k)
+        {
+            // Lanczos sigma factors taper the top harmonics, which keeps the
+            // ringing around steps (Gibbs overshoot) to around 1%
+            const auto x = pi * k / (level.maxHarmonic + 1);
+            const auto sigma = std::sin (x) / x;
+            const auto coefficient = spectrum[(size_t) k] * (sigma * scale);
+
+            scratch[(size_t) k] = coefficient;
+            scratch[(size_t) (level.size - k)] = std::conj (coefficient);
+        }
+
+        fft (scratch.data(), level.size, true);
+
+        auto* dest = samples.data() + level.offset;
+
+        // Clamped so what's left of the overshoot can't push modulation out
+        // of range
+        for (int i = 0; i < level.size; ++i)
+            dest[i] = (float) std::min (1.0, std::max (0.0, scratch[(size_t) i].real()));
+
+        dest[level.size] = dest[0];
+    }
+}
+
+} // namespace wobbler
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    WavetableBuilder - bakes LFO shapes into wavetables, re-evaluating only
+    the part of the cycle an edit touched
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "LFOShape.h"
+#include "Wavetable.h"
+
+#include <complex>
+#include <memory>
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * Turns successive versions of one shape into Wavetables.
+ *
+ * The builder remembers the last shape and its exact (level 0) samples.
+ * When only some points move, only the segments that depend on them are
+ * evaluated again; a spline segment depends on four points, so that is at
+ * most the four segments around each changed point. The band-limited levels
+ * are then made from the new spectrum with one FFT, which costs far less
+ * than evaluating the curve.
+ *
+ * Not thread-safe: each builder belongs to whichever thread does the baking.
+ */
+class WavetableBuilder
+{
+public:
+    /** tableSize must be a power of two, at least 256. */
+    explicit WavetableBuilder (int tableSize = 2048);
+
+    int getTableSize() const noexcept   { return tableSize; }
+
+    /** Bakes a shape into a new table, reusing what it can from the last build. */
+    std::unique_ptr<Wavetable> build (const LFOShape& shape, std::uint64_t version);
+
+    /** Forgets the last shape, so the next build evaluates the whole cycle. */
+    void reset();
+
+    /** How many samples the last build had to evaluate (tableSize for a full bake). */
+    int getLastNumSamplesEvaluated() const noexcept   { return lastNumSamplesEvaluated; }
+
+private:
+    void markChangedRegions (const std::vector<LFOPoint>& oldPoints, const std::vector<LFOPoint>& newPoints);
+    void markPhaseRange (float startPhase, float endPhase);
+    void buildLevels (std::vector<float>& samples, Wavetable::Level* levels, int& numLevels);
+
+    int tableSize;
+    bool hasShape = false;
+    LFOShape lastShape;
+    std::vector<float> exact;
+    std::vector<unsigned char> dirty;
+    std::vector<std::complex<double>> spectrum, scratch;
+    int lastNumSamplesEvaluated = 0;
+};
+
+} // namespace wobbler
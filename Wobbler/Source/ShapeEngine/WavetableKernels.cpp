@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    WavetableKernels - dispatch to the best kernels for this CPU
+
+  ==============================================================================
+*/
+
+#include "WavetableKernels.h"
+
+#include "GainKernels.h"
+
+namespace wobbler
+{
+
+namespace
+{
+    struct KernelRegistry
+    {
+        KernelRegistry() noexcept
+            : scalar (detail::makeScalarWavetableKernels()),
+             #if WOBBLER_X86_KERNELS
+              avx2 (plugindsp::isSimdLevelAvailable (plugindsp::SimdLevel::avx2)
+                        ? detail::makeAvx2WavetableKernels() : scalar)
+             #else
+              avx2 (scalar)
+             #endif
+        {
+        }
+
+        WavetableKernelTable scalar, avx2;
+    };
+
+    const KernelRegistry& getRegistry() noexcept
+    {
+        static const KernelRegistry registry;
+        return registry;
+    }
+}
+
+const WavetableKernelTable& getWavetableKernels() noexcept
+{
+    const auto& registry = getRegistry();
+
+    // Only an AVX2 version is worth having: gathers are what make table
+    // reads vectorise, and SSE2 has none
+    if (plugindsp::getActiveSimdLevel() >= plugindsp::SimdLevel::avx2)
+        return registry.avx2;
+
+    return registry.scalar;
+}
+
+} // namespace wobbler
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    WavetableKernels - vectorised, interpolated wavetable reads with runtime
+    CPU dispatch
+
+  ==============================================================================
+*/
+
+#pragma once
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * Table reads shared by every LFO.
+ *
+ * A table holds tableSize samples of one cycle plus one guard sample equal to
+ * the first, so linear interpolation never needs to wrap an index. tableSize
+ * must be a power of two. Phases are in cycles and are wrapped into 0-1.
+ *
+ * The instruction set follows plugindsp::getActiveSimdLevel(), so forcing a
+ * level for the gain kernels (e.g. in a benchmark) also applies here.
+ */
+struct WavetableKernelTable
+{
+    /** dest[i] = table (phases[i]) */
+    void (*lookup) (const float* table, int tableSize, const float* phases,
+                    float* dest, int numSamples) noexcept;
+
+    /** dest[i] = table (startPhase + phaseIncrement * i) */
+    void (*render) (const float* table, int tableSize, float startPhase, float phaseIncrement,
+                    float* dest, int numSamples) noexcept;
+};
+
+/** Returns the kernels for the active instruction set. */
+const WavetableKernelTable& getWavetableKernels() noexcept;
+
+namespace detail
+{
+    WavetableKernelTable makeScalarWavetableKernels() noexcept;
+    WavetableKernelTable makeAvx2WavetableKernels() noexcept;
+}
+
+} // namespace wobbler
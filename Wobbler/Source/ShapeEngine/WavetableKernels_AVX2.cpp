@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    WavetableKernels_AVX2 - 8-wide kernels using gathers, compiled with AVX2
+    and FMA enabled
+
+  ==============================================================================
+*/
+
+#include "WavetableKernels.h"
+
+#if WOBBLER_X86_KERNELS
+
+#include <cmath>
+#include <immintrin.h>
+
+namespace wobbler
+{
+namespace detail
+{
+
+namespace
+{
+    /** Reads 8 interpolated values for 8 phases. */
+    inline __m256 readLinear (const float* table, __m256 tableSize, __m256i indexMask, __m256 phases) noexcept
+    {
+        const auto wrapped  = _mm256_sub_ps (phases, _mm256_floor_ps (phases));
+        const auto position = _mm256_mul_ps (wrapped, tableSize);
+        const auto whole    = _mm256_floor_ps (position);
+        const auto fraction = _mm256_sub_ps (position, whole);
+        const auto index    = _mm256_and_si256 (_mm256_cvttps_epi32 (whole), indexMask);
+
+        const auto a = _mm256_i32gather_ps (table, index, 4);
+        const auto b = _mm256_i32gather_ps (table + 1, index, 4);
+        return _mm256_fmadd_ps (fraction, _mm256_sub_ps (b, a), a);
+    }
+
+    inline float readLinearScalar (const float* table, int tableSize, float phase) noexcept
+    {
+        const auto position = (phase - std::floor (phase)) * (float) tableSize;
+        const auto index = (int) position;
+        const auto fraction = position - (float) index;
+        const auto i = index & (tableSize - 1);
+        return table[i] + fraction * (table[i + 1] - table[i]);
+    }
+
+    void lookup (const float* table, int tableSize, const float* phases,
+                 float* dest, int numSamples) noexcept
+    {
+        const auto size = _mm256_set1_ps ((float) tableSize);
+        const auto mask = _mm256_set1_epi32 (tableSize - 1);
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+            _mm256_storeu_ps (dest + i, readLinear (table, size, mask, _mm256_loadu_ps (phases + i)));
+
+        for (; i < numSamples; ++i)
+            dest[i] = readLinearScalar (table, tableSize, phases[i]);
+    }
+
+    void render (const float* table, int tableSize, float startPhase, float phaseIncrement,
+                 float* dest, int numSamples) noexcept
+    {
+        const auto size = _mm256_set1_ps ((float) tableSize);
+        const auto mask = _mm256_set1_epi32 (tableSize - 1);
+        const auto increment = _mm256_set1_ps (phaseIncrement);
+        const auto start = _mm256_set1_ps (startPhase);
+        auto steps = _mm256_setr_ps (0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+        const auto eight = _mm256_set1_ps (8.0f);
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            const auto phases = _mm256_fmadd_ps (steps, increment, start);
+            _mm256_storeu_ps (dest + i, readLinear (table, size, mask, phases));
+            steps = _mm256_add_ps (steps, eight);
+        }
+
+        for (; i < numSamples; ++i)
+            dest[i] = readLinearScalar (table, tableSize, startPhase + phaseIncrement * (float) i);
+    }
+}
+
+WavetableKernelTable makeAvx2WavetableKernels() noexcept
+{
+    return { lookup, render };
+}
+
+} // namespace detail
+} // namespace wobbler
+
+#endif
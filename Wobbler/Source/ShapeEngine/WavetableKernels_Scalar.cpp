@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    WavetableKernels_Scalar - portable kernels (auto-vectorised where the
+    compiler can)
+
+  ==============================================================================
+*/
+
+#include "WavetableKernels.h"
+
+#include <cmath>
+
+namespace wobbler
+{
+namespace detail
+{
+
+namespace
+{
+    inline float readLinear (const float* table, int tableSize, float phase) noexcept
+    {
+        const auto position = (phase - std::floor (phase)) * (float) tableSize;
+        const auto index = (int) position;
+        const auto fraction = position - (float) index;
+
+        // A phase just below 1 can round up to tableSize; the mask wraps it to 0
+        const auto i = index & (tableSize - 1);
+        return table[i] + fraction * (table[i + 1] - table[i]);
+    }
+
+    void lookup (const float* table, int tableSize, const float* phases,
+                 float* dest, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = readLinear (table, tableSize, phases[i]);
+    }
+
+    void render (const float* table, int tableSize, float startPhase, float phaseIncrement,
+                 float* dest, int numSamples) noexcept
+    {
+        // Phases are computed from the start rather than accumulated, so
+        // rounding errors don't build up over a block
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = readLinear (table, tableSize, startPhase + phaseIncrement * (float) i);
+    }
+}
+
+WavetableKernelTable makeScalarWavetableKernels() noexcept
+{
+    return { lookup, render };
+}
+
+} // namespace detail
+} // namespace wobbler
@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    LZCompressor - a small LZ77-style byte compressor for data kept in memory
+
+  ==============================================================================
+*/
+
+#include "LZCompressor.h"
+
+#include <cstring>
+
+namespace wobbler
+{
+namespace lzcompressor
+{
+
+namespace
+{
+    constexpr std::size_t minMatch = 4;
+    constexpr int hashBits = 14;
+
+    std::uint32_t read32 (const std::uint8_t* source) noexcept
+    {
+        std::uint32_t value;
+        std::memcpy (&value, source, sizeof (value));
+        return value;
+    }
+
+    std::uint32_t hash (std::uint32_t value) noexcept
+    {
+        return (value * 2654435761u) >> (32 - hashBits);
+    }
+
+    void writeVarint (std::vector<std::uint8_t>& dest, std::size_t value)
+    {
+        while (value >= 0x80)
+        {
+            dest.push_back ((std::uint8_t) (value | 0x80));
+            value >>= 7;
+        }
+
+        dest.push_back ((std::uint8_t) value);
+    }
+
+    bool readVarint (const std::uint8_t* data, std::size_t size, std::size_t& position, std::size_t& value) noexcept
+    {
+        value = 0;
+
+        // 32 bits is plenty: nothing this compresses is anywhere near 4 GB
+        for (int shift = 0; shift < 35; shift += 7)
+        {
+            if (position >= size)
+                return false;
+
+            const auto byte = data[position++];
+            value |= (std::size_t) (byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    void writeLiterals (std::vector<std::uint8_t>& dest, const std::uint8_t* literals, std::size_t count)
+    {
+        writeVarint (dest, count);
+        dest.insert (dest.end(), literals, literals + count);
+    }
+}
+
+//==============================================================================
+void compress (const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& dest)
+{
+    dest.clear();
+    dest.reserve (size / 2 + 16);
+
+    for (size_t i = 0; i < 4; ++i)
+        dest.push_back ((std::uint8_t) ((std::uint32_t) size >> (8 * i)));
+
+    // Each slot holds the last position + 1 with that hash, or 0
+    std::vector<std::uint32_t> table ((size_t) 1 << hashBits, 0);
+    std::size_t literalStart = 0;
+    std::size_t position = 0;
+
+    while (position + minMatch <= size)
+    {
+        const auto current = read32 (data + position);
+        auto& slot = table[hash (current)];
+        const auto candidate = (std::size_t) slot;
+        slot = (std::uint32_t) (position + 1);
+
+        if (candidate == 0 || read32 (data + candidate - 1) != current)
+        {
+            ++position;
+            continue;
+        }
+
+        const auto matchStart = candidate - 1;
+        auto length = minMatch;
+
+        while (position + length < size && data[matchStart + length] == data[position + length])
+            ++length;
+
+        writeLiterals (dest, data + literalStart, position - literalStart);
+        writeVarint (dest, length);
+        writeVarint (dest, position - matchStart);
+
+        position += length;
+        literalStart = position;
+    }
+
+    writeLiterals (dest, data + literalStart, size - literalStart);
+    writeVarint (dest, 0);
+}
+
+bool decompress (const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& dest)
+{
+    dest.clear();
+
+    if (size < 4)
+        return false;
+
+    std::size_t expectedSize = 0;
+
+    for (size_t i = 0; i < 4; ++i)
+        expectedSize |= (std::size_t) data[i] << (8 * i);
+
+    dest.reserve (expectedSize);
+    std::size_t position = 4;
+
+    for (;;)
+    {
+        std::size_t numLiterals, length, distance;
+
+        if (! readVarint (data, size, position, numLiterals)
+             || numLiterals > size - position || numLiterals > expectedSize - dest.size())
+            return false;
+
+        dest.insert (dest.end(), data + position, data + position + numLiterals);
+        position += numLiterals;
+
+        if (! readVarint (data, size, position, length))
+            return false;
+
+        if (length == 0)
+            break;
+
+        if (! readVarint (data, size, position, distance)
+             || distance == 0 || distance > dest.size() || length > expectedSize - dest.size())
+            return false;
+
+        // Byte by byte: a match may overlap the bytes it is producing
+        auto from = dest.size() - distance;
+
+        for (std::size_t i = 0; i < length; ++i)
+            dest.push_back (dest[from + i]);
+    }
+
+    return position == size && dest.size() == expectedSize;
+}
+
+} // namespace lzcompressor
+} // namespace wobbler
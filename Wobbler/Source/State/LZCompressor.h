@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    LZCompressor - a small LZ77-style byte compressor for data kept in memory
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * Byte-oriented LZ77 with a single-entry hash table, in the spirit of LZ4:
+ * fast rather than tight. It is meant for the plugin's own in-memory data
+ * (old undo steps), which is full of repeated property names and node
+ * headers, not as a file format.
+ *
+ * Output: a u32 uncompressed size, then sequences of
+ *   varint literal count, the literals,
+ *   varint match length (0 ends the data), varint match distance.
+ */
+namespace lzcompressor
+{
+    /** Replaces dest with the compressed form of size bytes at data. */
+    void compress (const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& dest);
+
+    /**
+     * Replaces dest with the decompressed bytes. Returns false, leaving dest
+     * in an unspecified state, if the input is malformed or truncated.
+     */
+    bool decompress (const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& dest);
+}
+
+} // namespace wobbler
@@ -0,0 +1,387 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    PluginState - the versioned state tree (shapes, patterns, mappings and
+    settings), with incremental saving and load-time migration
+
+  ==============================================================================
+*/
+
+#include "PluginState.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace wobbler
+{
+
+namespace
+{
+    //==============================================================================
+    namespace ids
+    {
+        const std::string pluginState       { "PluginState" };
+        const std::string lfoShapes         { "LFOShapes" };
+        const std::string patternSequences  { "PatternSequences" };
+        const std::string mappings          { "Mappings" };
+        const std::string settings          { "Settings" };
+
+        const std::string shape             { "Shape" };
+        const std::string point             { "Point" };
+        const std::string pattern           { "Pattern" };
+        const std::string lane              { "Lane" };
+        const std::string placement         { "Placement" };
+        const std::string route             { "Route" };
+
+        const std::string version           { "version" };
+        const std::string points            { "points" };
+        const std::string phase             { "phase" };
+        const std::string value             { "value" };
+        const std::string curve             { "curve" };
+        const std::string curvature         { "curvature" };
+        const std::string lengthBeats       { "lengthBeats" };
+        const std::string start             { "start" };
+        const std::string length            { "length" };
+        const std::string slot              { "slot" };
+        const std::string cycles            { "cycles" };
+        const std::string phaseOffset       { "phaseOffset" };
+        const std::string scale             { "scale" };
+        const std::string offset            { "offset" };
+        const std::string source            { "source" };
+        const std::string target            { "target" };
+        const std::string depth             { "depth" };
+        const std::string smoothing         { "smoothing" };
+    }
+
+    constexpr std::uint8_t stateMagic[] = { 'W', 'b', 'S', 't' };
+    constexpr int floatsPerPoint = 4;
+
+    /** Makes node have exactly numChildren children, adding nodes of childType or removing from the end. */
+    void resizeChildren (StateTree& node, int numChildren, const std::string& childType)
+    {
+        while (node.getNumChildren() > numChildren)
+            node.removeChild (node.getNumChildren() - 1);
+
+        while (node.getNumChildren() < numChildren)
+            node.addChild (childType);
+    }
+
+    //==============================================================================
+    void writePlacement (StateTree& node, const ShapePlacement& placement)
+    {
+        node.setProperty (ids::start, placement.startBeat);
+        node.setProperty (ids::length, placement.lengthBeats);
+        node.setProperty (ids::slot, (std::int64_t) placement.shapeSlot);
+        node.setProperty (ids::cycles, (double) placement.cycles);
+        node.setProperty (ids::phaseOffset, (double) placement.phaseOffset);
+        node.setProperty (ids::scale, (double) placement.scale);
+        node.setProperty (ids::offset, (double) placement.offset);
+    }
+
+    ShapePlacement readPlacement (const StateTree& node)
+    {
+        ShapePlacement placement;
+        placement.startBeat = node.getDouble (ids::start);
+        placement.lengthBeats = node.getDouble (ids::length, 1.0);
+        placement.shapeSlot = (int) node.getInt (ids::slot);
+        placement.cycles = (float) node.getDouble (ids::cycles, 1.0);
+        placement.phaseOffset = (float) node.getDouble (ids::phaseOffset);
+        placement.scale = (float) node.getDouble (ids::scale, 1.0);
+        placement.offset = (float) node.getDouble (ids::offset);
+        return placement;
+    }
+
+    //==============================================================================
+    // Migrations. Each one takes a state from fromVersion to fromVersion + 1;
+    // load() runs them in order from the state's version.
+
+    /** 1 -> 2: Point child nodes become one packed float array per shape. */
+    void packShapePoints (StateTree& root)
+    {
+        auto* shapes = root.getChildWithType (ids::lfoShapes);
+
+        if (shapes == nullptr)
+            return;
+
+        for (int i = 0; i < shapes->getNumChildren(); ++i)
+        {
+            auto& shape = shapes->getChild (i);
+            std::vector<float> packed;
+            packed.reserve ((size_t) (shape.getNumChildren() * floatsPerPoint));
+
+            for (int p = 0; p < shape.getNumChildren(); ++p)
+            {
+                const auto& point = shape.getChild (p);
+
+                if (point.getType() != ids::point)
+                    continue;
+
+                packed.push_back ((float) point.getDouble (ids::phase));
+                packed.push_back ((float) point.getDouble (ids::value));
+                packed.push_back ((float) point.getInt (ids::curve));
+                packed.push_back ((float) point.getDouble (ids::curvature, 0.5));
+            }
+
+            shape.removeAllChildren();
+            shape.setProperty (ids::points, std::move (packed));
+        }
+    }
+
+    struct Migration
+    {
+        int fromVersion;
+        void (*apply) (StateTree& root);
+    };
+
+    const Migration migrations[] =
+    {
+        { 1, packShapePoints }
+    };
+
+    void writeMagic (std::vector<std::uint8_t>& dest)
+    {
+        dest.assign (std::begin (stateMagic), std::end (stateMagic));
+    }
+}
+
+//==============================================================================
+PluginState::PluginState()
+    : root (std::make_unique<StateTree> (ids::pluginState))
+{
+    root->setProperty (ids::version, (std::int64_t) currentVersion);
+    addMissingSections (*root);
+    undoHistory.attachTo (root.get());
+}
+
+void PluginState::addMissingSections (StateTree& tree)
+{
+    tree.getOrCreateChildWithType (ids::lfoShapes);
+    tree.getOrCreateChildWithType (ids::patternSequences);
+    tree.getOrCreateChildWithType (ids::mappings);
+    tree.getOrCreateChildWithType (ids::settings);
+}
+
+//==============================================================================
+void PluginState::setShape (int slot, const LFOShape& shape)
+{
+    assert (slot >= 0);
+
+    auto& shapes = getShapes();
+
+    if (slot >= shapes.getNumChildren())
+        resizeChildren (shapes, slot + 1, ids::shape);
+
+    std::vector<float> packed;
+    packed.reserve (shape.getPoints().size() * floatsPerPoint);
+
+    for (const auto& point : shape.getPoints())
+    {
+        packed.push_back (point.phase);
+        packed.push_back (point.value);
+        packed.push_back ((float) point.curve);
+        packed.push_back (point.curvature);
+    }
+
+    shapes.getChild (slot).setProperty (ids::points, std::move (packed));
+}
+
+LFOShape PluginState::getShape (int slot) const
+{
+    const auto& shapes = *root->getChildWithType (ids::lfoShapes);
+
+    if (slot < 0 || slot >= shapes.getNumChildren())
+        return {};
+
+    const auto& packed = shapes.getChild (slot).getFloats (ids::points);
+    std::vector<LFOPoint> points (packed.size() / floatsPerPoint);
+
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        const auto* values = packed.data() + i * floatsPerPoint;
+        points[i].phase = values[0];
+        points[i].value = values[1];
+        points[i].curve = (CurveType) std::min (3, std::max (0, (int) values[2]));
+        points[i].curvature = values[3];
+    }
+
+    return LFOShape (std::move (points));
+}
+
+int PluginState::getNumShapes() const noexcept
+{
+    return root->getChildWithType (ids::lfoShapes)->getNumChildren();
+}
+
+//==============================================================================
+void PluginState::setPattern (int index, const PatternSequence& pattern)
+{
+    assert (index >= 0);
+
+    auto& patterns = getPatterns();
+
+    if (index >= patterns.getNumChildren())
+        resizeChildren (patterns, index + 1, ids::pattern);
+
+    auto& node = patterns.getChild (index);
+    node.setProperty (ids::lengthBeats, pattern.getLengthBeats());
+    resizeChildren (node, pattern.getNumLanes(), ids::lane);
+
+    for (int lane = 0; lane < pattern.getNumLanes(); ++lane)
+    {
+        const auto& placements = pattern.getLane (lane);
+        auto& laneNode = node.getChild (lane);
+        resizeChildren (laneNode, (int) placements.size(), ids::placement);
+
+        // Unchanged placements keep their values, so stay clean
+        for (size_t i = 0; i < placements.size(); ++i)
+            writePlacement (laneNode.getChild ((int) i), placements[i]);
+    }
+}
+
+PatternSequence PluginState::getPattern (int index) const
+{
+    const auto& patterns = *root->getChildWithType (ids::patternSequences);
+
+    if (index < 0 || index >= patterns.getNumChildren())
+        return PatternSequence();
+
+    const auto& node = patterns.getChild (index);
+    PatternSequence pattern (node.getNumChildren(), node.getDouble (ids::lengthBeats, 16.0));
+
+    for (int lane = 0; lane < node.getNumChildren(); ++lane)
+    {
+        const auto& laneNode = node.getChild (lane);
+
+        for (int i = 0; i < laneNode.getNumChildren(); ++i)
+            pattern.addPlacement (lane, readPlacement (laneNode.getChild (i)));
+    }
+
+    return pattern;
+}
+
+int PluginState::getNumPatterns() const noexcept
+{
+    return root->getChildWithType (ids::patternSequences)->getNumChildren();
+}
+
+void PluginState::setPlacement (int patternIndex, int lane, int index, const ShapePlacement& placement)
+{
+    writePlacement (getPatterns().getChild (patternIndex).getChild (lane).getChild (index), placement);
+}
+
+//==============================================================================
+void PluginState::setRoutes (const std::vector<RoutingEntry>& routes)
+{
+    auto& mappings = getMappings();
+    resizeChildren (mappings, (int) routes.size(), ids::route);
+
+    for (size_t i = 0; i < routes.size(); ++i)
+    {
+        auto& node = mappings.getChild ((int) i);
+        node.setProperty (ids::source, (std::int64_t) routes[i].sourceIndex);
+        node.setProperty (ids::target, (std::int64_t) routes[i].target.targetID);
+        node.setProperty (ids::depth, (double) routes[i].target.depth);
+        node.setProperty (ids::smoothing, (double) routes[i].target.smoothingSeconds);
+        node.setProperty (ids::phase, (double) routes[i].target.phase);
+    }
+}
+
+std::vector<RoutingEntry> PluginState::getRoutes() const
+{
+    const auto& mappings = *root->getChildWithType (ids::mappings);
+    std::vector<RoutingEntry> routes ((size_t) mappings.getNumChildren());
+
+    for (size_t i = 0; i < routes.size(); ++i)
+    {
+        const auto& node = mappings.getChild ((int) i);
+        routes[i].sourceIndex = (int) node.getInt (ids::source);
+        routes[i].target.targetID = (int) node.getInt (ids::target);
+        routes[i].target.depth = (float) node.getDouble (ids::depth, 1.0);
+        routes[i].target.smoothingSeconds = (float) node.getDouble (ids::smoothing);
+        routes[i].target.phase = (float) node.getDouble (ids::phase);
+    }
+
+    return routes;
+}
+
+//==============================================================================
+int PluginState::save (std::vector<std::uint8_t>& dest)
+{
+    writeMagic (dest);
+    return root->encode (dest);
+}
+
+PluginState::LoadResult PluginState::load (const void* data, std::size_t size)
+{
+    const auto* bytes = static_cast<const std::uint8_t*> (data);
+
+    if (size < sizeof (stateMagic) || std::memcmp (bytes, stateMagic, sizeof (stateMagic)) != 0)
+        return LoadResult::invalid;
+
+    auto tree = StateTree::decode (bytes + sizeof (stateMagic), size - sizeof (stateMagic));
+
+    if (tree == nullptr || tree->getType() != ids::pluginState)
+        return LoadResult::invalid;
+
+    const auto version = (int) tree->getInt (ids::version, 1);
+
+    if (version > currentVersion)
+        return LoadResult::tooNew;
+
+    if (version < 1)
+        return LoadResult::invalid;
+
+    // Migrate once, here, so nothing else deals with old layouts
+    auto numRun = 0;
+
+    for (const auto& migration : migrations)
+    {
+        if (migration.fromVersion >= version)
+        {
+            migration.apply (*tree);
+            ++numRun;
+        }
+    }
+
+    tree->setProperty (ids::version, (std::int64_t) currentVersion);
+    addMissingSections (*tree);
+
+    // Detaches from the old root while it still exists
+    undoHistory.attachTo (tree.get());
+    root = std::move (tree);
+    loadedVersion = version;
+    numMigrationsRun = numRun;
+    return LoadResult::loaded;
+}
+
+void PluginState::writeVersion1State (const std::vector<LFOShape>& shapes, std::vector<std::uint8_t>& dest)
+{
+    StateTree tree (ids::pluginState);
+    tree.setProperty (ids::version, (std::int64_t) 1);
+
+    auto& shapesNode = tree.addChild (ids::lfoShapes);
+    tree.addChild (ids::patternSequences);
+    tree.addChild (ids::mappings);
+    tree.addChild (ids::settings);
+
+    for (const auto& shape : shapes)
+    {
+        auto& shapeNode = shapesNode.addChild (ids::shape);
+
+        for (const auto& point : shape.getPoints())
+        {
+            auto& pointNode = shapeNode.addChild (ids::point);
+            pointNode.setProperty (ids::phase, (double) point.phase);
+            pointNode.setProperty (ids::value, (double) point.value);
+            pointNode.setProperty (ids::curve, (std::int64_t) point.curve);
+            pointNode.setProperty (ids::curvature, (double) point.curvature);
+        }
+    }
+
+    writeMagic (dest);
+    tree.encode (dest);
+}
+
+} // namespace wobbler
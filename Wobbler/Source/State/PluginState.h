@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    PluginState - the versioned state tree (shapes, patterns, mappings and
+    settings), with incremental saving and load-time migration
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "LFOShape.h"
+#include "PatternSequence.h"
+#include "RoutingTable.h"
+#include "StateTree.h"
+#include "UndoHistory.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * The plugin's saved state, laid out as the Technical Requirements describe:
+ *
+ *   PluginState (version)
+ *     LFOShapes         Shape per slot: points packed as floats
+ *                       (phase, value, curve, curvature per point)
+ *     PatternSequences  Pattern (lengthBeats) > Lane > Placement
+ *     Mappings          Route (source, target, depth, smoothing, phase)
+ *     Settings          free-form properties
+ *
+ * The set...() methods copy engine objects into the tree by updating the
+ * existing nodes in place. A property that already holds the value isn't
+ * touched, so after editing one placement of a 10,000-placement pattern
+ * only that placement and its ancestors are dirty, and save() re-encodes
+ * just those (see StateTree). Host autosaves and undo snapshots then cost
+ * little more than copying the cached bytes.
+ *
+ * load() decodes a saved state and runs any migrations from its version
+ * to currentVersion once, there; the rest of the plugin only ever sees the
+ * current layout. States from a newer version are rejected.
+ *
+ * Every edit to the tree is recorded in the undo history; callers only
+ * mark where each undo step begins. load() starts a fresh history.
+ *
+ * Message thread only.
+ */
+class PluginState
+{
+public:
+    //==============================================================================
+    /**
+     * Version history:
+     *  1  each shape point was a Point child node
+     *  2  a shape's points are one packed float array (far fewer nodes for
+     *     large shape libraries)
+     */
+    static constexpr int currentVersion = 2;
+
+    enum class LoadResult
+    {
+        loaded,
+        invalid,    // not a Wobbler state, or corrupt
+        tooNew      // saved by a newer version of the plugin
+    };
+
+    PluginState();
+
+    //==============================================================================
+    StateTree& getRoot() noexcept                   { return *root; }
+    StateTree& getShapes() noexcept                 { return *root->getChildWithType ("LFOShapes"); }
+    StateTree& getPatterns() noexcept               { return *root->getChildWithType ("PatternSequences"); }
+    StateTree& getMappings() noexcept               { return *root->getChildWithType ("Mappings"); }
+    StateTree& getSettings() noexcept               { return *root->getChildWithType ("Settings"); }
+
+    UndoHistory& getUndoHistory() noexcept          { return undoHistory; }
+
+    //==============================================================================
+    /** Shape slots are the children of LFOShapes, in order; setting a slot past the end adds empty ones. */
+    void setShape (int slot, const LFOShape& shape);
+    LFOShape getShape (int slot) const;
+    int getNumShapes() const noexcept;
+
+    /** Patterns are the children of PatternSequences, in order. */
+    void setPattern (int index, const PatternSequence& pattern);
+    PatternSequence getPattern (int index) const;
+    int getNumPatterns() const noexcept;
+
+    /** Changes one placement without visiting the rest of the pattern. */
+    void setPlacement (int patternIndex, int lane, int index, const ShapePlacement& placement);
+
+    void setRoutes (const std::vector<RoutingEntry>& routes);
+    std::vector<RoutingEntry> getRoutes() const;
+
+    //==============================================================================
+    /**
+     * Replaces dest with the encoded state: a 4-byte magic, then the tree.
+     * Returns how many nodes had to be re-encoded.
+     */
+    int save (std::vector<std::uint8_t>& dest);
+
+    /** Replaces the state with a saved one, migrating it to currentVersion. On failure nothing changes. */
+    LoadResult load (const void* data, std::size_t size);
+
+    /** The version the last successful load() read, before migration. */
+    int getLoadedVersion() const noexcept           { return loadedVersion; }
+
+    /** Migration steps the last successful load() ran. */
+    int getNumMigrationsRun() const noexcept        { return numMigrationsRun; }
+
+    /** Writes a version 1 state with these shapes, for testing migration. */
+    static void writeVersion1State (const std::vector<LFOShape>& shapes, std::vector<std::uint8_t>& dest);
+
+private:
+    //==============================================================================
+    static void addMissingSections (StateTree& tree);
+
+    std::unique_ptr<StateTree> root;
+    UndoHistory undoHistory;
+    int loadedVersion = currentVersion;
+    int numMigrationsRun = 0;
+};
+
+} // namespace wobbler
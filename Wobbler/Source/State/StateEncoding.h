@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    StateEncoding - little-endian byte writing and bounds-checked reading
+    for the state tree and the undo history
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "StateTree.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace wobbler
+{
+namespace stateencoding
+{
+
+//==============================================================================
+/** Type tag written before each property value. */
+enum ValueTag : std::uint8_t
+{
+    intTag    = 0,
+    doubleTag = 1,
+    stringTag = 2,
+    floatsTag = 3
+};
+
+template <typename IntType>
+void writeInt (std::vector<std::uint8_t>& dest, IntType value)
+{
+    for (size_t i = 0; i < sizeof (IntType); ++i)
+        dest.push_back ((std::uint8_t) ((std::uint64_t) value >> (8 * i)));
+}
+
+/** A u16 length followed by the bytes (longer strings are cut). */
+inline void writeString (std::vector<std::uint8_t>& dest, const std::string& text)
+{
+    const auto length = std::min (text.size(), (size_t) 0xffff);
+    writeInt (dest, (std::uint16_t) length);
+    dest.insert (dest.end(), text.begin(), text.begin() + (std::ptrdiff_t) length);
+}
+
+/**
+ * A tag and payload: int64 / double are 8 bytes; a string is a u32 length
+ * and the bytes; floats are a u32 count and 4 bytes each.
+ */
+inline void writeValue (std::vector<std::uint8_t>& dest, const StateTree::Value& value)
+{
+    if (const auto* intValue = std::get_if<std::int64_t> (&value))
+    {
+        writeInt (dest, intTag);
+        writeInt (dest, *intValue);
+    }
+    else if (const auto* doubleValue = std::get_if<double> (&value))
+    {
+        std::uint64_t bits;
+        std::memcpy (&bits, doubleValue, sizeof (bits));
+        writeInt (dest, doubleTag);
+        writeInt (dest, bits);
+    }
+    else if (const auto* text = std::get_if<std::string> (&value))
+    {
+        writeInt (dest, stringTag);
+        writeInt (dest, (std::uint32_t) text->size());
+        dest.insert (dest.end(), text->begin(), text->end());
+    }
+    else if (const auto* floats = std::get_if<std::vector<float>> (&value))
+    {
+        writeInt (dest, floatsTag);
+        writeInt (dest, (std::uint32_t) floats->size());
+
+        for (auto sample : *floats)
+        {
+            std::uint32_t bits;
+            std::memcpy (&bits, &sample, sizeof (bits));
+            writeInt (dest, bits);
+        }
+    }
+}
+
+//==============================================================================
+/** Bounds-checked reads; any overrun sets failed and returns zeros from then on. */
+struct Reader
+{
+    const std::uint8_t* data;
+    size_t size;                // end of the readable range, from data
+    size_t position = 0;
+    bool failed = false;
+
+    bool canRead (size_t numBytes) noexcept
+    {
+        if (failed || size - position < numBytes)
+            failed = true;
+
+        return ! failed;
+    }
+
+    bool isAtEnd() const noexcept       { return position == size; }
+
+    template <typename IntType>
+    IntType readInt() noexcept
+    {
+        if (! canRead (sizeof (IntType)))
+            return 0;
+
+        std::uint64_t value = 0;
+
+        for (size_t i = 0; i < sizeof (IntType); ++i)
+            value |= (std::uint64_t) data[position + i] << (8 * i);
+
+        position += sizeof (IntType);
+        return (IntType) value;
+    }
+
+    std::string readString()
+    {
+        const auto length = readInt<std::uint16_t>();
+
+        if (! canRead (length))
+            return {};
+
+        std::string text (reinterpret_cast<const char*> (data + position), length);
+        position += length;
+        return text;
+    }
+
+    /** Reads what writeValue() wrote. Returns false (and sets failed) on a bad tag or overrun. */
+    bool readValue (StateTree::Value& value)
+    {
+        switch (readInt<std::uint8_t>())
+        {
+            case intTag:
+                value = (std::int64_t) readInt<std::uint64_t>();
+                break;
+
+            case doubleTag:
+            {
+                const auto bits = readInt<std::uint64_t>();
+                double number;
+                std::memcpy (&number, &bits, sizeof (number));
+                value = number;
+                break;
+            }
+
+            case stringTag:
+            {
+                const auto length = readInt<std::uint32_t>();
+
+                if (! canRead (length))
+                    return false;
+
+                value = std::string (reinterpret_cast<const char*> (data + position), length);
+                position += length;
+                break;
+            }
+
+            case floatsTag:
+            {
+                const auto count = readInt<std::uint32_t>();
+
+                if (! canRead ((size_t) count * 4))
+                    return false;
+
+                std::vector<float> floats (count);
+
+                for (auto& sample : floats)
+                {
+                    const auto bits = readInt<std::uint32_t>();
+                    std::memcpy (&sample, &bits, sizeof (sample));
+                }
+
+                value = std::move (floats);
+                break;
+            }
+
+            default:
+                failed = true;
+        }
+
+        return ! failed;
+    }
+};
+
+} // namespace stateencoding
+} // namespace wobbler
@@ -0,0 +1,381 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    StateTree - a ValueTree-like tree of typed nodes that caches the binary
+    encoding of every subtree and re-encodes only what changed
+
+  ==============================================================================
+*/
+
+#include "StateTree.h"
+#include "StateEncoding.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace wobbler
+{
+
+namespace
+{
+    //==============================================================================
+    // Encoding of one node, all integers little-endian:
+    //
+    //   u32 total size of the node in bytes, including this field
+    //   str type
+    //   u16 number of properties, then for each: str name, u8 tag, payload
+    //       int64 / double: 8 bytes; string: u32 length + bytes;
+    //       floats: u32 count + 4 bytes each
+    //   u32 number of children, then each child node
+    //
+    // str is a u16 length followed by the bytes (see StateEncoding.h). The
+    // leading size lets a clean subtree be copied, or skipped, as one block.
+    using namespace stateencoding;
+
+    const std::string emptyString;
+    const std::vector<float> emptyFloats;
+}
+
+//==============================================================================
+StateTree::StateTree (std::string nodeType)
+    : type (std::move (nodeType))
+{
+}
+
+int StateTree::findProperty (const std::string& name) const noexcept
+{
+    for (size_t i = 0; i < properties.size(); ++i)
+        if (properties[i].first == name)
+            return (int) i;
+
+    return -1;
+}
+
+const StateTree::Value* StateTree::getProperty (const std::string& name) const noexcept
+{
+    const auto index = findProperty (name);
+    return index >= 0 ? &properties[(size_t) index].second : nullptr;
+}
+
+std::int64_t StateTree::getInt (const std::string& name, std::int64_t fallback) const noexcept
+{
+    if (const auto* value = getProperty (name))
+        if (const auto* intValue = std::get_if<std::int64_t> (value))
+            return *intValue;
+
+    return fallback;
+}
+
+double StateTree::getDouble (const std::string& name, double fallback) const noexcept
+{
+    if (const auto* value = getProperty (name))
+    {
+        if (const auto* doubleValue = std::get_if<double> (value))
+            return *doubleValue;
+
+        if (const auto* intValue = std::get_if<std::int64_t> (value))
+            return (double) *intValue;
+    }
+
+    return fallback;
+}
+
+const std::string& StateTree::getString (const std::string& name) const noexcept
+{
+    if (const auto* value = getProperty (name))
+        if (const auto* text = std::get_if<std::string> (value))
+            return *text;
+
+    return emptyString;
+}
+
+const std::vector<float>& StateTree::getFloats (const std::string& name) const noexcept
+{
+    if (const auto* value = getProperty (name))
+        if (const auto* floats = std::get_if<std::vector<float>> (value))
+            return *floats;
+
+    return emptyFloats;
+}
+
+void StateTree::setProperty (const std::string& name, Value newValue, int indexIfNew)
+{
+    auto* changeObserver = findObserver();
+    auto index = findProperty (name);
+
+    if (index < 0)
+    {
+        if (indexIfNew < 0 || indexIfNew > (int) properties.size())
+            indexIfNew = (int) properties.size();
+
+        index = indexIfNew;
+        properties.emplace (properties.begin() + index, name, std::move (newValue));
+        markDirty();
+
+        if (changeObserver != nullptr)
+            changeObserver->propertyChanged (*this, name, index, nullptr, &properties[(size_t) index].second);
+
+        return;
+    }
+
+    auto& value = properties[(size_t) index].second;
+
+    if (value == newValue)
+        return;
+
+    if (changeObserver != nullptr)
+    {
+        // The observer needs the old value, so only pay for keeping it when there is one
+        auto oldValue = std::exchange (value, std::move (newValue));
+        markDirty();
+        changeObserver->propertyChanged (*this, name, index, &oldValue, &value);
+        return;
+    }
+
+    value = std::move (newValue);
+    markDirty();
+}
+
+void StateTree::removeProperty (const std::string& name)
+{
+    const auto index = findProperty (name);
+
+    if (index < 0)
+        return;
+
+    auto removed = std::move (properties[(size_t) index]);
+    properties.erase (properties.begin() + index);
+    markDirty();
+
+    if (auto* changeObserver = findObserver())
+        changeObserver->propertyChanged (*this, name, index, &removed.second, nullptr);
+}
+
+//==============================================================================
+StateTree* StateTree::getChildWithType (const std::string& childType) const noexcept
+{
+    for (const auto& child : children)
+        if (child->type == childType)
+            return child.get();
+
+    return nullptr;
+}
+
+StateTree& StateTree::getOrCreateChildWithType (const std::string& childType)
+{
+    if (auto* child = getChildWithType (childType))
+        return *child;
+
+    return addChild (childType);
+}
+
+StateTree& StateTree::addChild (std::unique_ptr<StateTree> child, int index)
+{
+    assert (child != nullptr && child->parent == nullptr);
+
+    child->parent = this;
+
+    if (index < 0 || index > (int) children.size())
+        index = (int) children.size();
+
+    auto& added = **children.insert (children.begin() + index, std::move (child));
+    markDirty();
+
+    if (auto* changeObserver = findObserver())
+        changeObserver->childAdded (*this, index);
+
+    return added;
+}
+
+StateTree& StateTree::addChild (std::string childType, int index)
+{
+    return addChild (std::make_unique<StateTree> (std::move (childType)), index);
+}
+
+std::unique_ptr<StateTree> StateTree::removeChild (int index)
+{
+    assert (index >= 0 && index < (int) children.size());
+
+    auto child = std::move (children[(size_t) index]);
+    children.erase (children.begin() + index);
+    child->parent = nullptr;
+    markDirty();
+
+    if (auto* changeObserver = findObserver())
+        changeObserver->childRemoved (*this, index, *child);
+
+    return child;
+}
+
+void StateTree::removeAllChildren()
+{
+    if (children.empty())
+        return;
+
+    // One at a time from the end, so an observer sees each removal at a valid index
+    if (findObserver() != nullptr)
+    {
+        while (! children.empty())
+            removeChild ((int) children.size() - 1);
+
+        return;
+    }
+
+    children.clear();
+    markDirty();
+}
+
+int StateTree::indexOf (const StateTree& child) const noexcept
+{
+    for (size_t i = 0; i < children.size(); ++i)
+        if (children[i].get() == &child)
+            return (int) i;
+
+    return -1;
+}
+
+void StateTree::setType (std::string newType)
+{
+    if (newType != type)
+    {
+        type = std::move (newType);
+        markDirty();
+    }
+}
+
+StateTree::ChangeObserver* StateTree::findObserver() const noexcept
+{
+    auto* node = this;
+
+    while (node->parent != nullptr)
+        node = node->parent;
+
+    return node->observer;
+}
+
+void StateTree::markDirty() noexcept
+{
+    // A dirty node's ancestors are always dirty too, so stop at the first one
+    for (auto* node = this; node != nullptr && ! node->dirty; node = node->parent)
+        node->dirty = true;
+}
+
+void StateTree::invalidateEncoding() noexcept
+{
+    for (auto& child : children)
+        child->invalidateEncoding();
+
+    cachedEncoding = {};
+    markDirty();
+}
+
+//==============================================================================
+int StateTree::encode (std::vector<std::uint8_t>& dest)
+{
+    auto numEncoded = 0;
+
+    if (dirty)
+    {
+        auto& bytes = cachedEncoding;
+        bytes.clear();
+
+        writeInt (bytes, (std::uint32_t) 0);     // size, filled in below
+        writeString (bytes, type);
+        writeInt (bytes, (std::uint16_t) properties.size());
+
+        for (const auto& [name, value] : properties)
+        {
+            writeString (bytes, name);
+            writeValue (bytes, value);
+        }
+
+        writeInt (bytes, (std::uint32_t) children.size());
+
+        // Clean children just append their cached bytes
+        for (const auto& child : children)
+            numEncoded += child->encode (bytes);
+
+        const auto size = (std::uint32_t) bytes.size();
+
+        for (size_t i = 0; i < 4; ++i)
+            bytes[i] = (std::uint8_t) (size >> (8 * i));
+
+        dirty = false;
+        ++numEncoded;
+    }
+
+    dest.insert (dest.end(), cachedEncoding.begin(), cachedEncoding.end());
+    return numEncoded;
+}
+
+/** Private access for decoding, which builds nodes and seeds their caches. */
+struct StateTree::Decoder
+{
+    static std::unique_ptr<StateTree> decodeNode (Reader& reader, int depth)
+    {
+        // Deep enough for any real state; stops a malicious file exhausting the stack
+        constexpr int maxDepth = 64;
+
+        const auto start = reader.position;
+        const auto nodeSize = reader.readInt<std::uint32_t>();
+
+        if (depth > maxDepth || reader.failed || nodeSize < 4 || nodeSize > reader.size - start)
+            return {};
+
+        // Read only within this node's bytes
+        Reader nodeReader { reader.data, start + nodeSize, reader.position };
+
+        auto node = std::make_unique<StateTree> (nodeReader.readString());
+        const auto numProperties = nodeReader.readInt<std::uint16_t>();
+        node->properties.reserve (numProperties);
+
+        for (std::uint16_t i = 0; i < numProperties && ! nodeReader.failed; ++i)
+        {
+            auto name = nodeReader.readString();
+            Value value;
+
+            if (! nodeReader.readValue (value))
+                return {};
+
+            node->properties.emplace_back (std::move (name), std::move (value));
+        }
+
+        const auto numChildren = nodeReader.readInt<std::uint32_t>();
+
+        for (std::uint32_t i = 0; i < numChildren && ! nodeReader.failed; ++i)
+        {
+            auto child = decodeNode (nodeReader, depth + 1);
+
+            if (child == nullptr)
+                return {};
+
+            child->parent = node.get();
+            node->children.push_back (std::move (child));
+        }
+
+        if (nodeReader.failed || nodeReader.position != start + nodeSize)
+            return {};
+
+        reader.position = nodeReader.position;
+
+        // The input is exactly this node's encoding, so it starts clean
+        node->cachedEncoding.assign (reader.data + start, reader.data + reader.position);
+        node->dirty = false;
+        return node;
+    }
+};
+
+std::unique_ptr<StateTree> StateTree::decode (const std::uint8_t* data, std::size_t size)
+{
+    Reader reader { data, size };
+    auto tree = Decoder::decodeNode (reader, 0);
+
+    if (tree == nullptr || reader.position != size)
+        return {};
+
+    return tree;
+}
+
+} // namespace wobbler
@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    StateTree - a ValueTree-like tree of typed nodes that caches the binary
+    encoding of every subtree and re-encodes only what changed
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * A node with a type, named properties and ordered children, in the style
+ * of juce::ValueTree but with no JUCE dependency, so the engine can save
+ * and load state on its own.
+ *
+ * Property values are 64-bit integers, doubles, strings or packed float
+ * arrays (for bulk data such as a shape's points).
+ *
+ * Every node keeps the encoded bytes of its subtree from the last encode()
+ * (or from decode()). Changing a property or the children marks the node
+ * and its ancestors dirty; encode() then rebuilds only the dirty nodes and
+ * copies the cached bytes of every clean child. Saving a large tree after
+ * a small edit costs the size of the edited path plus one copy of the
+ * result, rather than re-encoding everything. The price is memory: each
+ * level of the tree holds its own copy of its subtree's bytes.
+ *
+ * An observer set on the root hears about every property and child change
+ * made anywhere in the tree (UndoHistory records edits this way). Nodes
+ * that aren't attached to an observed root report nothing, so a subtree
+ * can be built up on its own and added as one change.
+ *
+ * Not thread safe; owned and edited by the message thread.
+ */
+class StateTree
+{
+public:
+    using Value = std::variant<std::int64_t, double, std::string, std::vector<float>>;
+
+    //==============================================================================
+    /** Receives every change to an observed tree, after it has been made. */
+    class ChangeObserver
+    {
+    public:
+        virtual ~ChangeObserver() = default;
+
+        /**
+         * A property was set, added or removed. before is nullptr if it was
+         * added and after is nullptr if it was removed; index is where the
+         * property is (or was, for a removal) in the node's list.
+         */
+        virtual void propertyChanged (StateTree& node, const std::string& name, int index,
+                                      const Value* before, const Value* after) = 0;
+
+        /** parent.getChild (index) was just added. */
+        virtual void childAdded (StateTree& parent, int index) = 0;
+
+        /** child was just detached from index of parent; it is destroyed after this returns if nobody kept it. */
+        virtual void childRemoved (StateTree& parent, int index, StateTree& child) = 0;
+    };
+
+    explicit StateTree (std::string type);
+
+    const std::string& getType() const noexcept                 { return type; }
+
+    //==============================================================================
+    int getNumProperties() const noexcept                       { return (int) properties.size(); }
+    const std::string& getPropertyName (int index) const        { return properties[(size_t) index].first; }
+
+    /** The value, or nullptr if there is no such property. */
+    const Value* getProperty (const std::string& name) const noexcept;
+
+    /** Typed reads; the fallback is returned if the property is missing or has another type. */
+    std::int64_t getInt (const std::string& name, std::int64_t fallback = 0) const noexcept;
+    double getDouble (const std::string& name, double fallback = 0.0) const noexcept;
+    const std::string& getString (const std::string& name) const noexcept;
+    const std::vector<float>& getFloats (const std::string& name) const noexcept;
+
+    /**
+     * Sets or adds a property. A new property goes at indexIfNew (at the end
+     * if that is out of range). Setting the value it already has doesn't
+     * mark anything dirty.
+     */
+    void setProperty (const std::string& name, Value newValue, int indexIfNew = -1);
+    void removeProperty (const std::string& name);
+
+    //==============================================================================
+    int getNumChildren() const noexcept                         { return (int) children.size(); }
+    StateTree& getChild (int index) const                       { return *children[(size_t) index]; }
+
+    /** The first child of this type, or nullptr. */
+    StateTree* getChildWithType (const std::string& childType) const noexcept;
+
+    /** Finds or appends a child of this type. */
+    StateTree& getOrCreateChildWithType (const std::string& childType);
+
+    /** Inserts a child (at the end if index is out of range) and returns it. */
+    StateTree& addChild (std::unique_ptr<StateTree> child, int index = -1);
+    StateTree& addChild (std::string childType, int index = -1);
+
+    /** Detaches and returns a child. */
+    std::unique_ptr<StateTree> removeChild (int index);
+    void removeAllChildren();
+
+    /** The index of a child of this node, or -1. */
+    int indexOf (const StateTree& child) const noexcept;
+
+    /** Changes the node type, e.g. for a migration. Observers aren't told about this. */
+    void setType (std::string newType);
+
+    StateTree* getParent() const noexcept                       { return parent; }
+
+    /** Sets the observer of this tree; only meaningful on the root, as changes are reported to the root's observer. */
+    void setChangeObserver (ChangeObserver* newObserver) noexcept   { observer = newObserver; }
+
+    //==============================================================================
+    /**
+     * Appends the binary encoding of this subtree to dest, rebuilding only
+     * dirty nodes. Returns how many nodes were rebuilt (0 if nothing changed).
+     */
+    int encode (std::vector<std::uint8_t>& dest);
+
+    /** True if this subtree has changed since it was last encoded or decoded. */
+    bool isDirty() const noexcept                               { return dirty; }
+
+    /** Frees the cached bytes of the whole subtree; the next encode() rebuilds all of it. */
+    void invalidateEncoding() noexcept;
+
+    /**
+     * Rebuilds a tree from encode()'s output. Returns nullptr if the data is
+     * malformed or truncated. Every node of the result starts clean, with
+     * its cached bytes taken straight from the input.
+     */
+    static std::unique_ptr<StateTree> decode (const std::uint8_t* data, std::size_t size);
+
+private:
+    //==============================================================================
+    struct Decoder;
+
+    void markDirty() noexcept;
+    int findProperty (const std::string& name) const noexcept;
+    ChangeObserver* findObserver() const noexcept;
+
+    std::string type;
+    std::vector<std::pair<std::string, Value>> properties;
+    std::vector<std::unique_ptr<StateTree>> children;
+    StateTree* parent = nullptr;
+    ChangeObserver* observer = nullptr;
+
+    std::vector<std::uint8_t> cachedEncoding;
+    bool dirty = true;
+
+    StateTree (const StateTree&) = delete;
+    StateTree& operator= (const StateTree&) = delete;
+};
+
+} // namespace wobbler
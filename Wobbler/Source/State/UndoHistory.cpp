@@ -0,0 +1,610 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    UndoHistory - undo and redo of state tree edits, recorded as compact
+    changes, with drag merging and a memory cap
+
+  ==============================================================================
+*/
+
+#include "UndoHistory.h"
+#include "LZCompressor.h"
+#include "StateEncoding.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace wobbler
+{
+
+namespace
+{
+    using namespace stateencoding;
+    using Value = StateTree::Value;
+
+    const std::string emptyString;
+
+    /**
+     * How far back a property change looks for an earlier change to the same
+     * property to merge with. A drag changes one or two properties per step,
+     * and a bound keeps a transaction that sets thousands of properties
+     * (syncing a whole pattern) linear.
+     */
+    constexpr int maxChangesToSearch = 16;
+
+    std::size_t getValueMemory (const Value& value) noexcept
+    {
+        if (const auto* text = std::get_if<std::string> (&value))
+            return text->size();
+
+        if (const auto* floats = std::get_if<std::vector<float>> (&value))
+            return floats->size() * sizeof (float);
+
+        return 0;
+    }
+
+    bool sameBits (float a, float b) noexcept
+    {
+        return std::memcmp (&a, &b, sizeof (float)) == 0;
+    }
+
+    /** The range [first, last) where two equal-sized arrays differ, compared bit for bit. */
+    std::pair<std::size_t, std::size_t> getChangedRange (const std::vector<float>& a, const std::vector<float>& b) noexcept
+    {
+        assert (a.size() == b.size());
+
+        std::size_t first = 0, last = a.size();
+
+        while (first < last && sameBits (a[first], b[first]))
+            ++first;
+
+        while (last > first && sameBits (a[last - 1], b[last - 1]))
+            --last;
+
+        return { first, last };
+    }
+
+    std::vector<float> getSlice (const std::vector<float>& floats, std::size_t first, std::size_t last)
+    {
+        return { floats.begin() + (std::ptrdiff_t) first, floats.begin() + (std::ptrdiff_t) last };
+    }
+}
+
+//==============================================================================
+UndoHistory::UndoHistory (std::size_t memoryLimitBytes)
+    : memoryLimit (memoryLimitBytes)
+{
+}
+
+UndoHistory::~UndoHistory()
+{
+    attachTo (nullptr);
+}
+
+void UndoHistory::attachTo (StateTree* newRoot)
+{
+    assert (newRoot == nullptr || newRoot->getParent() == nullptr);
+
+    if (root != nullptr)
+        root->setChangeObserver (nullptr);
+
+    root = newRoot;
+
+    if (root != nullptr)
+        root->setChangeObserver (this);
+
+    clear();
+}
+
+void UndoHistory::clear()
+{
+    transactions.clear();
+    numUndoable = 0;
+    numCompressed = 0;
+    needsNewTransaction = true;
+    canMerge = false;
+    memoryUsage = 0;
+    numDropped = 0;
+    compressedInputBytes = 0;
+    compressedOutputBytes = 0;
+}
+
+//==============================================================================
+void UndoHistory::beginTransaction (std::string name, std::int64_t mergeKey)
+{
+    pendingName = std::move (name);
+    pendingMergeKey = mergeKey;
+    needsNewTransaction = true;
+}
+
+UndoHistory::Transaction& UndoHistory::getTransactionForChange()
+{
+    if (! needsNewTransaction)
+        return transactions.back();
+
+    needsNewTransaction = false;
+
+    // Anything undone can't be redone once something new happens
+    removeTransactionsFrom (numUndoable);
+
+    if (canMerge && pendingMergeKey != 0 && ! transactions.empty()
+         && transactions.back().mergeKey == pendingMergeKey)
+    {
+        assert (transactions.back().compressed.empty());
+        return transactions.back();
+    }
+
+    auto& transaction = transactions.emplace_back();
+    transaction.name = pendingName;
+    transaction.mergeKey = pendingMergeKey;
+    transaction.memory = getMemory (transaction);
+    memoryUsage += transaction.memory;
+    numUndoable = transactions.size();
+    canMerge = true;
+    return transaction;
+}
+
+void UndoHistory::addChange (Transaction& transaction, Change&& change)
+{
+    const auto memory = getMemory (change);
+    transaction.changes.push_back (std::move (change));
+    transaction.memory += memory;
+    memoryUsage += memory;
+    enforceMemoryLimit();
+}
+
+//==============================================================================
+void UndoHistory::propertyChanged (StateTree& node, const std::string& name, int index,
+                                   const Value* before, const Value* after)
+{
+    if (applying)
+        return;
+
+    auto& transaction = getTransactionForChange();
+    auto path = getPath (node);
+
+    const auto* beforeFloats = before != nullptr ? std::get_if<std::vector<float>> (before) : nullptr;
+    const auto* afterFloats = after != nullptr ? std::get_if<std::vector<float>> (after) : nullptr;
+    const auto isFloatPatch = beforeFloats != nullptr && afterFloats != nullptr
+                               && beforeFloats->size() == afterFloats->size();
+
+    // A value updated in place merges into an earlier change to the same
+    // property, which keeps its own before value. Structural changes may
+    // have moved nodes around, so the search stops at the first one.
+    if (before != nullptr && after != nullptr)
+    {
+        auto searched = 0;
+
+        for (auto it = transaction.changes.rbegin(); it != transaction.changes.rend() && searched < maxChangesToSearch; ++it, ++searched)
+        {
+            if (it->kind != Change::Kind::property)
+                break;
+
+            if (it->name != name || it->path != path)
+                continue;
+
+            auto& previous = *it;
+            const auto oldMemory = getMemory (previous);
+
+            if (previous.floatOffset >= 0)
+            {
+                // beforeFloats is what the previous change left; with its own
+                // slice put back, that is the array before the previous change
+                assert (beforeFloats != nullptr);
+                const auto& previousBefore = std::get<std::vector<float>> (previous.before);
+                const auto previousFirst = (std::size_t) previous.floatOffset;
+                const auto previousLast = previousFirst + previousBefore.size();
+
+                if (isFloatPatch)
+                {
+                    auto [first, last] = getChangedRange (*beforeFloats, *afterFloats);
+
+                    if (first == last)
+                        first = last = previousFirst;
+
+                    first = std::min (first, previousFirst);
+                    last = std::max (last, previousLast);
+
+                    auto beforeSlice = getSlice (*beforeFloats, first, last);
+                    std::copy (previousBefore.begin(), previousBefore.end(), beforeSlice.begin() + (std::ptrdiff_t) (previousFirst - first));
+
+                    previous.before = std::move (beforeSlice);
+                    previous.after = getSlice (*afterFloats, first, last);
+                    previous.floatOffset = (int) first;
+                }
+                else
+                {
+                    // The size changed, so keep whole arrays from here on
+                    auto original = *beforeFloats;
+                    std::copy (previousBefore.begin(), previousBefore.end(), original.begin() + (std::ptrdiff_t) previousFirst);
+
+                    previous.before = std::move (original);
+                    previous.after = *after;
+                    previous.floatOffset = -1;
+                }
+            }
+            else
+            {
+                previous.after = *after;
+            }
+
+            const auto newMemory = getMemory (previous);
+            transaction.memory = transaction.memory - oldMemory + newMemory;
+            memoryUsage = memoryUsage - oldMemory + newMemory;
+            enforceMemoryLimit();
+            return;
+        }
+    }
+
+    Change change;
+    change.kind = Change::Kind::property;
+    change.path = std::move (path);
+    change.index = index;
+    change.name = name;
+    change.hadBefore = before != nullptr;
+    change.hasAfter = after != nullptr;
+
+    if (isFloatPatch)
+    {
+        const auto [first, last] = getChangedRange (*beforeFloats, *afterFloats);
+        change.floatOffset = (int) first;
+        change.before = getSlice (*beforeFloats, first, last);
+        change.after = getSlice (*afterFloats, first, last);
+    }
+    else
+    {
+        if (before != nullptr)
+            change.before = *before;
+
+        if (after != nullptr)
+            change.after = *after;
+    }
+
+    addChange (transaction, std::move (change));
+}
+
+void UndoHistory::childAdded (StateTree& parent, int index)
+{
+    if (applying)
+        return;
+
+    auto& transaction = getTransactionForChange();
+
+    Change change;
+    change.kind = Change::Kind::addChild;
+    change.path = getPath (parent);
+    change.index = index;
+    parent.getChild (index).encode (change.subtree);
+
+    addChange (transaction, std::move (change));
+}
+
+void UndoHistory::childRemoved (StateTree& parent, int index, StateTree& child)
+{
+    if (applying)
+        return;
+
+    auto& transaction = getTransactionForChange();
+
+    Change change;
+    change.kind = Change::Kind::removeChild;
+    change.path = getPath (parent);
+    change.index = index;
+    child.encode (change.subtree);
+
+    addChange (transaction, std::move (change));
+}
+
+std::vector<int> UndoHistory::getPath (const StateTree& node) const
+{
+    std::vector<int> path;
+    auto* current = &node;
+
+    for (auto* parent = current->getParent(); parent != nullptr; parent = current->getParent())
+    {
+        path.push_back (parent->indexOf (*current));
+        current = parent;
+    }
+
+    assert (current == root);
+    std::reverse (path.begin(), path.end());
+    return path;
+}
+
+StateTree& UndoHistory::getNode (const std::vector<int>& path) const
+{
+    auto* node = root;
+
+    for (auto index : path)
+    {
+        assert (index >= 0 && index < node->getNumChildren());
+        node = &node->getChild (index);
+    }
+
+    return *node;
+}
+
+//==============================================================================
+bool UndoHistory::undo()
+{
+    if (! canUndo())
+        return false;
+
+    apply (transactions[numUndoable - 1], false);
+    --numUndoable;
+    needsNewTransaction = true;
+    canMerge = false;
+    return true;
+}
+
+bool UndoHistory::redo()
+{
+    if (! canRedo())
+        return false;
+
+    apply (transactions[numUndoable], true);
+    ++numUndoable;
+    needsNewTransaction = true;
+    canMerge = false;
+    return true;
+}
+
+const std::string& UndoHistory::getUndoName() const noexcept
+{
+    return canUndo() ? transactions[numUndoable - 1].name : emptyString;
+}
+
+const std::string& UndoHistory::getRedoName() const noexcept
+{
+    return canRedo() ? transactions[numUndoable].name : emptyString;
+}
+
+void UndoHistory::apply (const Transaction& transaction, bool forwards)
+{
+    assert (root != nullptr);
+
+    // Compressed steps are unpacked for the duration and stay compressed
+    std::vector<Change> unpacked;
+    const auto* changes = &transaction.changes;
+
+    if (! transaction.compressed.empty())
+    {
+        std::vector<std::uint8_t> bytes;
+
+        if (! lzcompressor::decompress (transaction.compressed.data(), transaction.compressed.size(), bytes)
+             || ! readChanges (bytes.data(), bytes.size(), unpacked))
+        {
+            assert (false);
+            return;
+        }
+
+        changes = &unpacked;
+    }
+
+    // The tree reports our own edits back to us; they aren't new changes
+    applying = true;
+
+    for (size_t i = 0; i < changes->size(); ++i)
+    {
+        const auto& change = (*changes)[forwards ? i : changes->size() - 1 - i];
+        auto& node = getNode (change.path);
+
+        switch (change.kind)
+        {
+            case Change::Kind::property:
+                applyProperty (node, change, forwards);
+                break;
+
+            case Change::Kind::addChild:
+            case Change::Kind::removeChild:
+                if (forwards == (change.kind == Change::Kind::addChild))
+                {
+                    auto child = StateTree::decode (change.subtree.data(), change.subtree.size());
+                    assert (child != nullptr);
+                    node.addChild (std::move (child), change.index);
+                }
+                else
+                {
+                    node.removeChild (change.index);
+                }
+                break;
+        }
+    }
+
+    applying = false;
+}
+
+void UndoHistory::applyProperty (StateTree& node, const Change& change, bool forwards)
+{
+    const auto& value = forwards ? change.after : change.before;
+
+    if (! (forwards ? change.hasAfter : change.hadBefore))
+    {
+        node.removeProperty (change.name);
+        return;
+    }
+
+    if (change.floatOffset >= 0)
+    {
+        auto floats = node.getFloats (change.name);
+        const auto& slice = std::get<std::vector<float>> (value);
+        assert ((std::size_t) change.floatOffset + slice.size() <= floats.size());
+
+        std::copy (slice.begin(), slice.end(), floats.begin() + change.floatOffset);
+        node.setProperty (change.name, std::move (floats));
+        return;
+    }
+
+    // Put back at its old index, so the tree encodes exactly as it did
+    node.setProperty (change.name, value, change.index);
+}
+
+//==============================================================================
+void UndoHistory::setMemoryLimit (std::size_t newLimit)
+{
+    memoryLimit = newLimit;
+    enforceMemoryLimit();
+}
+
+void UndoHistory::enforceMemoryLimit()
+{
+    // First squeeze the oldest steps, never the newest, which may still be growing
+    while (memoryUsage > memoryLimit && numCompressed + 1 < transactions.size())
+        compress (transactions[numCompressed++]);
+
+    // Then forget the oldest. Only undoable steps go: the oldest redo step is
+    // needed to redo every step after it.
+    while (memoryUsage > memoryLimit && transactions.size() > 1 && numUndoable > 0)
+    {
+        auto& oldest = transactions.front();
+        memoryUsage -= oldest.memory;
+
+        if (! oldest.compressed.empty())
+        {
+            compressedInputBytes -= oldest.uncompressedSize;
+            compressedOutputBytes -= oldest.compressed.size();
+        }
+
+        transactions.pop_front();
+        numCompressed -= std::min (numCompressed, (std::size_t) 1);
+        --numUndoable;
+        ++numDropped;
+    }
+}
+
+void UndoHistory::compress (Transaction& transaction)
+{
+    if (! transaction.compressed.empty())
+        return;
+
+    std::vector<std::uint8_t> bytes;
+    writeChanges (transaction.changes, bytes);
+    lzcompressor::compress (bytes.data(), bytes.size(), transaction.compressed);
+    transaction.compressed.shrink_to_fit();
+    transaction.uncompressedSize = bytes.size();
+    std::vector<Change>().swap (transaction.changes);
+
+    memoryUsage -= transaction.memory;
+    transaction.memory = getMemory (transaction);
+    memoryUsage += transaction.memory;
+
+    compressedInputBytes += bytes.size();
+    compressedOutputBytes += transaction.compressed.size();
+}
+
+void UndoHistory::removeTransactionsFrom (std::size_t index)
+{
+    while (transactions.size() > index)
+    {
+        auto& newest = transactions.back();
+        memoryUsage -= newest.memory;
+
+        if (! newest.compressed.empty())
+        {
+            compressedInputBytes -= newest.uncompressedSize;
+            compressedOutputBytes -= newest.compressed.size();
+        }
+
+        transactions.pop_back();
+    }
+
+    numCompressed = std::min (numCompressed, transactions.size());
+    numUndoable = std::min (numUndoable, transactions.size());
+}
+
+//==============================================================================
+std::size_t UndoHistory::getMemory (const Change& change) noexcept
+{
+    return sizeof (Change) + change.path.size() * sizeof (int) + change.name.size()
+            + getValueMemory (change.before) + getValueMemory (change.after) + change.subtree.size();
+}
+
+std::size_t UndoHistory::getMemory (const Transaction& transaction) noexcept
+{
+    auto memory = sizeof (Transaction) + transaction.name.size() + transaction.compressed.size();
+
+    for (const auto& change : transaction.changes)
+        memory += getMemory (change);
+
+    return memory;
+}
+
+//==============================================================================
+// Serialised changes, for compression. Per change:
+//
+//   u8 kind, u16 path length, i32 per path index, i32 index, str name,
+//   u8 flags (1 = had before, 2 = has after), i32 float offset,
+//   the before and after values that exist (see writeValue()),
+//   u32 subtree size + bytes
+void UndoHistory::writeChanges (const std::vector<Change>& changes, std::vector<std::uint8_t>& dest)
+{
+    writeInt (dest, (std::uint32_t) changes.size());
+
+    for (const auto& change : changes)
+    {
+        writeInt (dest, (std::uint8_t) change.kind);
+        writeInt (dest, (std::uint16_t) change.path.size());
+
+        for (auto index : change.path)
+            writeInt (dest, (std::int32_t) index);
+
+        writeInt (dest, (std::int32_t) change.index);
+        writeString (dest, change.name);
+        writeInt (dest, (std::uint8_t) ((change.hadBefore ? 1 : 0) | (change.hasAfter ? 2 : 0)));
+        writeInt (dest, (std::int32_t) change.floatOffset);
+
+        if (change.hadBefore)
+            writeValue (dest, change.before);
+
+        if (change.hasAfter)
+            writeValue (dest, change.after);
+
+        writeInt (dest, (std::uint32_t) change.subtree.size());
+        dest.insert (dest.end(), change.subtree.begin(), change.subtree.end());
+    }
+}
+
+bool UndoHistory::readChanges (const std::uint8_t* data, std::size_t size, std::vector<Change>& changes)
+{
+    Reader reader { data, size };
+    const auto numChanges = reader.readInt<std::uint32_t>();
+    changes.clear();
+
+    for (std::uint32_t i = 0; i < numChanges && ! reader.failed; ++i)
+    {
+        auto& change = changes.emplace_back();
+        change.kind = (Change::Kind) reader.readInt<std::uint8_t>();
+        change.path.resize (reader.readInt<std::uint16_t>());
+
+        for (auto& index : change.path)
+            index = reader.readInt<std::int32_t>();
+
+        change.index = reader.readInt<std::int32_t>();
+        change.name = reader.readString();
+
+        const auto flags = reader.readInt<std::uint8_t>();
+        change.hadBefore = (flags & 1) != 0;
+        change.hasAfter = (flags & 2) != 0;
+        change.floatOffset = reader.readInt<std::int32_t>();
+
+        if (change.hadBefore)
+            reader.readValue (change.before);
+
+        if (change.hasAfter)
+            reader.readValue (change.after);
+
+        const auto subtreeSize = reader.readInt<std::uint32_t>();
+
+        if (reader.canRead (subtreeSize))
+        {
+            change.subtree.assign (data + reader.position, data + reader.position + subtreeSize);
+            reader.position += subtreeSize;
+        }
+    }
+
+    return ! reader.failed && reader.isAtEnd();
+}
+
+} // namespace wobbler
@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    UndoHistory - undo and redo of state tree edits, recorded as compact
+    changes, with drag merging and a memory cap
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "StateTree.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace wobbler
+{
+
+//==============================================================================
+/**
+ * Undo history for a StateTree, in the spirit of juce::UndoManager but
+ * recording changes instead of snapshots.
+ *
+ * It observes the tree's root, so every edit made anywhere in the tree is
+ * recorded with no help from the code making it:
+ *
+ *  - a property change keeps the value before and after. For a packed float
+ *    array that keeps its size (a shape's points being dragged), only the
+ *    changed range is kept, so moving one point of a 100-point shape costs
+ *    a few floats, not two copies of the shape
+ *  - adding or removing a child keeps the child's encoded subtree (taken
+ *    from the tree's cache when it is clean)
+ *
+ * Changes are grouped into transactions. beginTransaction() starts one;
+ * the changes that follow belong to it until the next call. Within a
+ * transaction, repeated changes to the same property collapse into one
+ * (the first value before and the latest after). A transaction begun with
+ * the same non-zero merge key as the previous one continues it instead, so
+ * a whole drag - one beginTransaction() per mouse move - is a single undo
+ * step. Undo or redo ends merging. A transaction that records nothing
+ * leaves no step behind.
+ *
+ * The history has a memory limit. When it is exceeded, the oldest steps
+ * (all but the newest) are compressed (see LZCompressor); if that isn't
+ * enough, the oldest steps are dropped. The newest step is always kept,
+ * even if it alone is over the limit.
+ *
+ * Message thread only, like the tree.
+ */
+class UndoHistory : private StateTree::ChangeObserver
+{
+public:
+    //==============================================================================
+    explicit UndoHistory (std::size_t memoryLimitBytes = 32 * 1024 * 1024);
+    ~UndoHistory() override;
+
+    /** Starts observing a tree's root (stopping observing the previous one) and clears the history. */
+    void attachTo (StateTree* root);
+
+    /** Forgets every step. */
+    void clear();
+
+    //==============================================================================
+    /**
+     * Ends the current transaction; the following changes go into a new one
+     * named name. If mergeKey isn't 0 and matches the previous transaction's,
+     * and there has been no undo or redo since, they are added to that one.
+     */
+    void beginTransaction (std::string name, std::int64_t mergeKey = 0);
+
+    bool canUndo() const noexcept                   { return numUndoable > 0; }
+    bool canRedo() const noexcept                   { return numUndoable < transactions.size(); }
+
+    /** Reverts the newest undoable step. Returns false if there was none. */
+    bool undo();
+
+    /** Reapplies the oldest undone step. Returns false if there was none. */
+    bool redo();
+
+    /** The name of the step undo() / redo() would apply, or an empty string. */
+    const std::string& getUndoName() const noexcept;
+    const std::string& getRedoName() const noexcept;
+
+    /** Steps that can be undone and redone, in total, and how many of them can be undone. */
+    int getNumSteps() const noexcept                { return (int) transactions.size(); }
+    int getNumUndoable() const noexcept             { return (int) numUndoable; }
+
+    //==============================================================================
+    /** An estimate of the memory the recorded steps use, in bytes. */
+    std::size_t getMemoryUsage() const noexcept     { return memoryUsage; }
+
+    std::size_t getMemoryLimit() const noexcept     { return memoryLimit; }
+    void setMemoryLimit (std::size_t newLimit);
+
+    /** Steps currently held compressed, and steps dropped since the last clear(). */
+    int getNumCompressed() const noexcept           { return (int) numCompressed; }
+    int getNumDropped() const noexcept              { return numDropped; }
+
+    /** Total bytes the compressed steps would take uncompressed, and compressed. */
+    std::size_t getCompressedInputBytes() const noexcept    { return compressedInputBytes; }
+    std::size_t getCompressedOutputBytes() const noexcept   { return compressedOutputBytes; }
+
+private:
+    //==============================================================================
+    struct Change
+    {
+        enum class Kind : std::uint8_t
+        {
+            property,
+            addChild,
+            removeChild
+        };
+
+        Kind kind = Kind::property;
+        std::vector<int> path;              // child indices from the root to the node changed
+        int index = 0;                      // the property's or child's index
+        std::string name;                   // property name
+
+        bool hadBefore = false;             // the property existed before / after the change
+        bool hasAfter = false;
+        int floatOffset = -1;               // >= 0: before and after are this slice of a float array
+        StateTree::Value before, after;
+
+        std::vector<std::uint8_t> subtree;  // the child's encoding, for addChild and removeChild
+    };
+
+    struct Transaction
+    {
+        std::string name;
+        std::int64_t mergeKey = 0;
+        std::vector<Change> changes;
+        std::vector<std::uint8_t> compressed;   // non-empty: changes is empty and lives here
+        std::size_t uncompressedSize = 0;
+        std::size_t memory = 0;
+    };
+
+    //==============================================================================
+    void propertyChanged (StateTree& node, const std::string& name, int index,
+                          const StateTree::Value* before, const StateTree::Value* after) override;
+    void childAdded (StateTree& parent, int index) override;
+    void childRemoved (StateTree& parent, int index, StateTree& child) override;
+
+    Transaction& getTransactionForChange();
+    void addChange (Transaction& transaction, Change&& change);
+    std::vector<int> getPath (const StateTree& node) const;
+    StateTree& getNode (const std::vector<int>& path) const;
+
+    void apply (const Transaction& transaction, bool forwards);
+    static void applyProperty (StateTree& node, const Change& change, bool forwards);
+
+    void compress (Transaction& transaction);
+    void removeTransactionsFrom (std::size_t index);
+    void enforceMemoryLimit();
+
+    static std::size_t getMemory (const Change& change) noexcept;
+    static std::size_t getMemory (const Transaction& transaction) noexcept;
+    static void writeChanges (const std::vector<Change>& changes, std::vector<std::uint8_t>& dest);
+    static bool readChanges (const std::uint8_t* data, std::size_t size, std::vector<Change>& changes);
+
+    //==============================================================================
+    StateTree* root = nullptr;
+
+    std::deque<Transaction> transactions;
+    std::size_t numUndoable = 0;            // transactions before this index can be undone
+    std::size_t numCompressed = 0;          // the oldest transactions are the compressed ones
+
+    std::string pendingName;
+    std::int64_t pendingMergeKey = 0;
+    bool needsNewTransaction = true;
+    bool canMerge = false;
+    bool applying = false;
+
+    std::size_t memoryUsage = 0;
+    std::size_t memoryLimit;
+    int numDropped = 0;
+    std::size_t compressedInputBytes = 0, compressedOutputBytes = 0;
+
+    UndoHistory (const UndoHistory&) = delete;
+    UndoHistory& operator= (const UndoHistory&) = delete;
+};
+
+} // namespace wobbler
@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    OutputSchedulerScenario - LFOs through the matrix into the parameter
+    output scheduler and on to a mock host, for OutputSchedulerTests and
+    WobblerBench's output run
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "LFOShapeEngine.h"
+#include "ModulationMatrix.h"
+#include "ParameterOutputScheduler.h"
+#include "ShapeLFOSource.h"
+
+#include <memory>
+#include <vector>
+
+namespace wobblertests
+{
+
+//==============================================================================
+/** Stands in for the host: counts what it's told and remembers each parameter's value. */
+class MockHost : public wobbler::HostParameterSink
+{
+public:
+    explicit MockHost (int numTargets)
+        : values ((size_t) numTargets, 0.0f), notificationsPerTarget ((size_t) numTargets, 0)
+    {
+    }
+
+    void beginBatch() override                          { ++batches; }
+    void setParameter (int target, float value) override
+    {
+        values[(size_t) target] = value;
+        ++notificationsPerTarget[(size_t) target];
+        ++notifications;
+    }
+
+    std::vector<float> values;
+    std::vector<int> notificationsPerTarget;
+    std::uint64_t notifications = 0, batches = 0;
+};
+
+/** An output rate and tolerance for the scheduler. */
+struct OutputConfig
+{
+    const char* name;
+    double rateHz;      // 0 = every block
+    float tolerance;
+};
+
+/** The rates and tolerances both the test and the benchmark run. */
+inline std::vector<OutputConfig> getOutputConfigs()
+{
+    return { { "every block, exact",      0.0,  0.0f },
+             { "30 Hz, exact",            30.0, 0.0f },
+             { "30 Hz, tolerance 1/256",  30.0, 1.0f / 256.0f },
+             { "60 Hz, tolerance 1/1024", 60.0, 1.0f / 1024.0f },
+             { "15 Hz, tolerance 1/64",   15.0, 1.0f / 64.0f } };
+}
+
+//==============================================================================
+/**
+ * Half the targets follow LFOs at 0.1-8 Hz, a quarter at 0.02 Hz and the
+ * last quarter have no route and stay at 0. The scheduler is delivered to
+ * the host at timerHz, as the plugin's message thread timer would.
+ *
+ * Each block, call processMatrix(), then pushValues(), then deliverIfDue().
+ */
+class OutputSchedulerScenario
+{
+public:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int numSources = 64;
+
+    /** Sines and triangles for the LFOs to play; waits until the tables are ready. */
+    static void setUpShapes (wobbler::LFOShapeEngine& shapes)
+    {
+        for (int i = 0; i < numSources; ++i)
+            shapes.setShape (i, i % 2 == 0 ? wobbler::LFOShape::sine() : wobbler::LFOShape::triangle());
+
+        shapes.waitUntilIdle();
+    }
+
+    OutputSchedulerScenario (wobbler::LFOShapeEngine& shapesToPlay, int targets, int samplesPerBlock,
+                             double timerHz, const OutputConfig& config)
+        : shapes (shapesToPlay), numTargets (targets), blockSize (samplesPerBlock),
+          matrix (numSources, targets, targets), scheduler (targets),
+          samplesPerDelivery (sampleRate / timerHz), samplesUntilDelivery (samplesPerDelivery)
+    {
+        for (int i = 0; i < numSources; ++i)
+        {
+            const auto rate = i < numSources / 2 ? 0.1f + 0.25f * (float) i : 0.02f;
+            lfos.push_back (std::make_unique<wobbler::ShapeLFOSource> (shapes, i, rate));
+            matrix.setSource (i, lfos.back().get());
+        }
+
+        // Targets in the last quarter get no route and stay at 0
+        for (int target = 0; target < numTargets * 3 / 4; ++target)
+        {
+            wobbler::RoutingEntry entry;
+            entry.sourceIndex = target < numTargets / 2 ? target % (numSources / 2)
+                                                        : numSources / 2 + target % (numSources / 2);
+            entry.target.targetID = target;
+            matrix.addRoute (entry);
+        }
+
+        matrix.commit();
+        matrix.prepare (sampleRate);
+
+        scheduler.setOutputRate (config.rateHz > 0.0 ? config.rateHz : sampleRate / blockSize);
+        scheduler.setTolerance (config.tolerance);
+        scheduler.prepare (sampleRate);
+    }
+
+    //==============================================================================
+    /** Runs the matrix for one block. */
+    void processMatrix()
+    {
+        const wobbler::LFOShapeEngine::ReadScope scope (shapes);
+        matrix.process (blockSize);
+    }
+
+    /** Hands the block's values to the scheduler, as the audio thread does. */
+    void pushValues()
+    {
+        scheduler.pushValues (matrix.getTargetValues(), numTargets, blockSize);
+    }
+
+    /**
+     * Advances the message thread's timer by a block and delivers the
+     * scheduler's changes to the host when it fires. Returns true if it did
+     * and the host's values are worth comparing: the first delivery is
+     * skipped, as before it the host has nothing.
+     */
+    bool deliverIfDue (wobbler::HostParameterSink& host)
+    {
+        samplesUntilDelivery -= blockSize;
+
+        if (samplesUntilDelivery > 0.0)
+            return false;
+
+        samplesUntilDelivery += samplesPerDelivery;
+        scheduler.deliverChanges (host);
+        return ++numDeliveries > 1;
+    }
+
+    const float* getTargetValues() const noexcept                           { return matrix.getTargetValues(); }
+    wobbler::ParameterOutputScheduler& getScheduler() noexcept              { return scheduler; }
+
+private:
+    //==============================================================================
+    wobbler::LFOShapeEngine& shapes;
+    const int numTargets, blockSize;
+
+    std::vector<std::unique_ptr<wobbler::ShapeLFOSource>> lfos;
+    wobbler::ModulationMatrix matrix;
+    wobbler::ParameterOutputScheduler scheduler;
+
+    const double samplesPerDelivery;
+    double samplesUntilDelivery;
+    int numDeliveries = 0;
+};
+
+} // namespace wobblertests
@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    OutputSchedulerTests - what the parameter output scheduler tells a mock
+    host: within the tolerance of the values it checked, and counted the same
+    on both sides
+
+  ==============================================================================
+*/
+
+#include "OutputSchedulerScenario.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace wobbler;
+using namespace wobblertests;
+
+namespace
+{
+    constexpr int numTargets = 512;
+    constexpr int blockSize = 128;
+    constexpr int seconds = 10;
+    constexpr double timerHz = 60.0;
+    constexpr double sampleRate = OutputSchedulerScenario::sampleRate;
+
+    struct Result
+    {
+        double maxCheckedError = 0.0;       // host value against the value at the scheduler's last check
+        ParameterOutputScheduler::Stats stats;
+    };
+
+    Result run (const OutputConfig& config, LFOShapeEngine& shapes, MockHost& host)
+    {
+        OutputSchedulerScenario scenario (shapes, numTargets, blockSize, timerHz, config);
+        auto& scheduler = scenario.getScheduler();
+        const auto numBlocks = (int) (seconds * sampleRate / blockSize);
+
+        // The values at the scheduler's last check; the host should be within the tolerance of these
+        std::vector<float> checkedValues ((size_t) numTargets);
+        std::uint64_t lastCheck = 0;
+        Result result;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            scenario.processMatrix();
+            scenario.pushValues();
+
+            if (scheduler.getStats().checks != lastCheck)
+            {
+                lastCheck = scheduler.getStats().checks;
+                std::copy (scenario.getTargetValues(), scenario.getTargetValues() + numTargets, checkedValues.begin());
+            }
+
+            if (scenario.deliverIfDue (host))
+                for (int t = 0; t < numTargets; ++t)
+                    result.maxCheckedError = std::max (result.maxCheckedError,
+                                                       (double) std::abs (host.values[(size_t) t] - checkedValues[(size_t) t]));
+        }
+
+        // Whatever the last check queued
+        scheduler.deliverChanges (host);
+
+        result.stats = scheduler.getStats();
+        return result;
+    }
+}
+
+//==============================================================================
+TEST_CASE ("The host gets what the output scheduler checked, within the tolerance", "[output]")
+{
+    const auto config = GENERATE (from_range (getOutputConfigs()));
+    INFO (config.name);
+
+    LFOShapeEngine shapes (OutputSchedulerScenario::numSources);
+    OutputSchedulerScenario::setUpShapes (shapes);
+
+    MockHost host (numTargets);
+    const auto result = run (config, shapes, host);
+
+    CHECK (result.maxCheckedError <= config.tolerance + 1.0e-6);
+
+    // Both sides count the same calls
+    CHECK (result.stats.notifications == host.notifications);
+    CHECK (result.stats.batches == host.batches);
+    CHECK (result.stats.changesQueued >= host.notifications);
+
+    // Checks keep to the output rate
+    const auto rateHz = config.rateHz > 0.0 ? config.rateHz : sampleRate / blockSize;
+    CHECK (std::abs ((double) result.stats.checks - rateHz * seconds) <= rateHz * seconds * 0.01 + 1.0);
+
+    // Targets that never move are sent once, on the first check, and never again
+    for (int target = numTargets * 3 / 4; target < numTargets; ++target)
+        CHECK (host.notificationsPerTarget[(size_t) target] == 1);
+
+    // Far fewer calls than one per target per block
+    CHECK ((double) host.notifications < 0.5 * numTargets * (seconds * sampleRate / blockSize));
+}
@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    RandomStateEdits - a random preset and random edits to it of every kind
+    the editor makes, for UndoHistoryTests and WobblerBench's undo run
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "PluginState.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace wobblertests
+{
+
+//==============================================================================
+/**
+ * Fills a PluginState with random shapes and one pattern of random
+ * placements, then makes random edits to it through the tree, each begun as
+ * an undo step: point drags (several moves merged into one step), placement
+ * changes, adds and deletes, shape replacements and settings changes.
+ * Undos and redos are mixed in with chooseAction().
+ *
+ * The same seed gives the same preset and the same edits.
+ */
+class RandomStateEdits
+{
+public:
+    struct PresetSize
+    {
+        int numShapes = 64;
+        int numPlacements = 1000;
+        int numLanes = 16;
+    };
+
+    /** Builds the preset; the undo history is cleared, so it's the starting point rather than a step. */
+    RandomStateEdits (wobbler::PluginState& stateToEdit, const PresetSize& presetSize, unsigned seed)
+        : state (stateToEdit), size (presetSize), random (seed)
+    {
+        for (int i = 0; i < size.numShapes; ++i)
+            state.setShape (i, makeRandomShape());
+
+        wobbler::PatternSequence pattern (size.numLanes, 64.0);
+
+        for (int i = 0; i < size.numPlacements; ++i)
+            pattern.addPlacement (i % size.numLanes, makeRandomPlacement());
+
+        state.setPattern (0, pattern);
+        state.getUndoHistory().clear();
+    }
+
+    //==============================================================================
+    enum class Action { edit, undo, redo };
+
+    /** An undo a quarter of the time and a redo 15% of the time, where the history has one; otherwise an edit. */
+    Action chooseAction()
+    {
+        const auto& history = state.getUndoHistory();
+        const auto choice = random() % 100;
+
+        if (choice < 25 && history.canUndo())
+            return Action::undo;
+
+        if (choice < 40 && history.canRedo())
+            return Action::redo;
+
+        return Action::edit;
+    }
+
+    /** One random edit. Some (a delete from an empty lane) change nothing and record no step. */
+    void makeEdit()
+    {
+        auto& history = state.getUndoHistory();
+        std::uniform_real_distribution<float> unit (0.0f, 1.0f);
+        auto& lane = state.getPatterns().getChild (0).getChild ((int) (random() % (unsigned) size.numLanes));
+        const auto choice = random() % 100;
+
+        if (choice < 35)
+        {
+            // A drag: several small moves of one point, merged into one step
+            const auto slot = (int) (random() % (unsigned) size.numShapes);
+            const auto mergeKey = ++nextMergeKey;
+            auto points = state.getShape (slot).getPoints();
+            auto& point = points[random() % points.size()];
+
+            for (auto moves = 1 + random() % 8; moves > 0; --moves)
+            {
+                history.beginTransaction ("Move point", mergeKey);
+                point.value = unit (random);
+                point.phase = unit (random);
+                state.setShape (slot, wobbler::LFOShape (points));
+            }
+        }
+        else if (choice < 55 && lane.getNumChildren() > 0)
+        {
+            history.beginTransaction ("Change placement");
+            const auto index = (int) (random() % (unsigned) lane.getNumChildren());
+            state.setPlacement (0, state.getPatterns().getChild (0).indexOf (lane), index, makeRandomPlacement());
+        }
+        else if (choice < 65)
+        {
+            // Straight through the tree: the add and its properties are one step
+            history.beginTransaction ("Add placement");
+            const auto placement = makeRandomPlacement();
+            auto& node = lane.addChild ("Placement", (int) (random() % (unsigned) (lane.getNumChildren() + 1)));
+            node.setProperty ("start", placement.startBeat);
+            node.setProperty ("length", placement.lengthBeats);
+            node.setProperty ("slot", (std::int64_t) placement.shapeSlot);
+            node.setProperty ("scale", (double) placement.scale);
+        }
+        else if (choice < 75 && lane.getNumChildren() > 0)
+        {
+            history.beginTransaction ("Delete placement");
+            lane.removeChild ((int) (random() % (unsigned) lane.getNumChildren()));
+        }
+        else if (choice < 85)
+        {
+            // A new shape with a different number of points: whole arrays are kept
+            history.beginTransaction ("Replace shape");
+            state.setShape ((int) (random() % (unsigned) size.numShapes), makeRandomShape());
+        }
+        else
+        {
+            history.beginTransaction ("Change setting");
+            auto& settings = state.getSettings();
+            const auto name = "option" + std::to_string (random() % 8);
+
+            if (random() % 3 == 0)
+                settings.removeProperty (name);
+            else
+                settings.setProperty (name, (std::int64_t) (random() % 1000));
+        }
+    }
+
+private:
+    //==============================================================================
+    wobbler::LFOShape makeRandomShape()
+    {
+        std::uniform_real_distribution<float> unit (0.0f, 1.0f);
+        std::vector<wobbler::LFOPoint> points ((size_t) (4 + random() % 61));
+
+        for (auto& point : points)
+        {
+            point.phase = unit (random);
+            point.value = unit (random);
+            point.curve = (wobbler::CurveType) (random() % 4);
+            point.curvature = unit (random) * 2.0f - 1.0f;
+        }
+
+        return wobbler::LFOShape (std::move (points));
+    }
+
+    wobbler::ShapePlacement makeRandomPlacement()
+    {
+        std::uniform_real_distribution<float> unit (0.0f, 1.0f);
+
+        wobbler::ShapePlacement placement;
+        placement.startBeat = (double) (random() % 128) * 0.25;
+        placement.lengthBeats = 0.25 + 0.25 * (double) (random() % 4);
+        placement.shapeSlot = (int) (random() % (unsigned) size.numShapes);
+        placement.cycles = 1.0f + (float) (random() % 4);
+        placement.phaseOffset = unit (random);
+        placement.scale = unit (random);
+        return placement;
+    }
+
+    wobbler::PluginState& state;
+    const PresetSize size;
+    std::mt19937 random;
+    std::int64_t nextMergeKey = 0;
+};
+
+} // namespace wobblertests
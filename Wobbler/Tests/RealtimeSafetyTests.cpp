@@ -0,0 +1,326 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    RealtimeSafetyTests - runs every audio-thread path of the engine under the
+    real-time checker while a message thread keeps editing, and fails on any
+    allocation, lock or blocking call
+
+  ==============================================================================
+*/
+
+#include "LFOShapeEngine.h"
+#include "ModulationMatrix.h"
+#include "ParameterOutputScheduler.h"
+#include "PatternSequencer.h"
+#include "RealtimeChecks.h"
+#include "ShapeLFOSource.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace wobbler;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int numShapes = 32;
+    constexpr int numLanes = 16;
+    constexpr int numTargets = 256;
+    constexpr int blockSize = 256;
+    constexpr int numBlocks = 2000;
+    constexpr double beatsPerSample = 120.0 / (60.0 * sampleRate);
+
+    /** Takes the scheduler's notifications on the message thread. */
+    class CountingSink : public HostParameterSink
+    {
+    public:
+        void beginBatch() override                  {}
+        void setParameter (int, float) override     { ++notifications; }
+
+        std::uint64_t notifications = 0;
+    };
+
+    /** A lane of back-to-back placements, different each time so every commit changes the timeline. */
+    void fillLane (PatternSequence& pattern, int lane, std::mt19937& random)
+    {
+        pattern.clearLane (lane);
+        auto beat = 0.0;
+
+        for (int i = 0; i < 64; ++i)
+        {
+            ShapePlacement placement;
+            placement.startBeat = beat;
+            placement.lengthBeats = 0.25 + (double) (random() % 8) * 0.25;
+            placement.shapeSlot = (int) (random() % numShapes);
+            pattern.addPlacement (lane, placement);
+            beat += placement.lengthBeats;
+        }
+    }
+
+    LFOShape makeShape (int variant)
+    {
+        switch (variant % 3)
+        {
+            case 0:  return LFOShape::sine();
+            case 1:  return LFOShape::triangle();
+            default: return LFOShape::sawUp();
+        }
+    }
+
+    //==============================================================================
+    /** The whole engine, set up and committed once as prepareToPlay() would leave it. */
+    struct Engine
+    {
+        Engine()
+        {
+            for (int i = 0; i < numShapes; ++i)
+                shapes.setShape (i, makeShape (i));
+
+            shapes.waitUntilIdle();
+
+            std::mt19937 random (7);
+
+            for (int lane = 0; lane < numLanes; ++lane)
+                fillLane (sequencer.getPattern(), lane, random);
+
+            sequencer.getPattern().setLengthBeats (64.0);
+            sequencer.commit();
+
+            for (int i = 0; i < numShapes; ++i)
+            {
+                lfos.push_back (std::make_unique<ShapeLFOSource> (shapes, i, 0.1f + 0.3f * (float) i));
+                matrix.setSource (i, lfos.back().get());
+            }
+
+            routeEverything (0);
+            matrix.prepare (sampleRate);
+
+            for (auto& lfo : lfos)
+                lfo->prepare (sampleRate);
+
+            scheduler.setOutputRate (30.0);
+            scheduler.prepare (sampleRate);
+        }
+
+        void routeEverything (int offset)
+        {
+            matrix.clearRoutes();
+
+            for (int target = 0; target < numTargets; ++target)
+            {
+                RoutingEntry entry;
+                entry.sourceIndex = (target + offset) % numShapes;
+                entry.target.targetID = target;
+                entry.target.depth = 0.5f;
+                entry.target.smoothingSeconds = target % 2 == 0 ? 0.0f : 0.05f;
+                matrix.addRoute (entry);
+            }
+
+            matrix.commit();
+        }
+
+        /** One message-thread edit of everything the audio side reads. */
+        void edit (int index, std::mt19937& random, HostParameterSink& sink)
+        {
+            shapes.setShape (index % numShapes, makeShape (index + 1));
+            fillLane (sequencer.getPattern(), index % numLanes, random);
+            sequencer.commit();
+            routeEverything (index);
+            matrix.collectGarbage();
+            scheduler.deliverChanges (sink);
+        }
+
+        LFOShapeEngine shapes { numShapes };
+        PatternSequencer sequencer { numLanes };
+        std::vector<std::unique_ptr<ShapeLFOSource>> lfos;
+        ModulationMatrix matrix { numShapes, numTargets, numTargets * 2 };
+        ParameterOutputScheduler scheduler { numTargets };
+    };
+
+    /** What each audio-thread path did, over every block. */
+    struct Reports
+    {
+        rtcheck::Report shapes, sequencer, routing, output, wholeBlock;
+    };
+
+    /**
+     * Runs the audio callback numBlocks times, each path in a check of its
+     * own and the whole callback in another, to catch the ReadScopes too.
+     */
+    Reports runAudioThread (Engine& engine)
+    {
+        Reports reports;
+        std::vector<float> laneOutput ((size_t) blockSize);
+        SequencePlayer player (numLanes);
+        auto beat = 0.0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const rtcheck::ScopedRealtimeCheck blockCheck;
+
+            {
+                const LFOShapeEngine::ReadScope shapeScope (engine.shapes);
+
+                {
+                    const rtcheck::ScopedRealtimeCheck check;
+
+                    for (int slot = 0; slot < numShapes; ++slot)
+                        engine.shapes.render (slot, 0.0f, 1.0f / 480.0f, laneOutput.data(), blockSize);
+
+                    reports.shapes.add (check.getReport());
+                }
+
+                {
+                    const rtcheck::ScopedRealtimeCheck check;
+                    const PatternSequencer::ReadScope scope (engine.sequencer);
+
+                    if (auto* timeline = scope.getTimeline())
+                        for (int lane = 0; lane < numLanes; ++lane)
+                            player.renderLane (*timeline, lane, beat, beatsPerSample, engine.shapes, laneOutput.data(), blockSize);
+
+                    reports.sequencer.add (check.getReport());
+                }
+
+                {
+                    const rtcheck::ScopedRealtimeCheck check;
+                    engine.matrix.process (blockSize);
+                    reports.routing.add (check.getReport());
+                }
+
+                {
+                    const rtcheck::ScopedRealtimeCheck check;
+                    engine.scheduler.pushValues (engine.matrix.getTargetValues(), numTargets, blockSize);
+                    reports.output.add (check.getReport());
+                }
+            }
+
+            reports.wholeBlock.add (blockCheck.getReport());
+            beat += blockSize * beatsPerSample;
+        }
+
+        return reports;
+    }
+
+    void requireClean (const rtcheck::Report& report)
+    {
+        INFO (report.describe());
+        CHECK (report.numChecks > 0);
+        CHECK (report.isClean());
+    }
+}
+
+//==============================================================================
+TEST_CASE ("The real-time checker catches what it is meant to", "[realtime]")
+{
+    SECTION ("an allocation")
+    {
+        rtcheck::Report report;
+
+        {
+            const rtcheck::ScopedRealtimeCheck check;
+            auto block = std::make_unique<std::vector<float>> (1024);
+            report = check.getReport();
+        }
+
+        CHECK (report.getCount (rtcheck::ViolationKind::allocation) >= 1);
+    }
+
+    SECTION ("a lock")
+    {
+        if (! rtcheck::canDetectSystemCalls())
+            SUCCEED ("Locks can't be detected in this build");
+        else
+        {
+            std::mutex mutex;
+            rtcheck::Report report;
+
+            {
+                const rtcheck::ScopedRealtimeCheck check;
+                const std::lock_guard<std::mutex> lock (mutex);
+                report = check.getReport();
+            }
+
+            CHECK (report.getCount (rtcheck::ViolationKind::lock) == 1);
+        }
+    }
+
+    SECTION ("nothing on other threads")
+    {
+        std::atomic<int> stage { 0 };
+
+        std::thread other ([&]
+        {
+            while (stage.load() == 0) {}
+            std::vector<float> elsewhere (1024);
+            stage = 2;
+        });
+
+        rtcheck::Report report;
+
+        {
+            const rtcheck::ScopedRealtimeCheck check;
+            stage = 1;
+
+            while (stage.load() != 2) {}
+
+            report = check.getReport();
+        }
+
+        other.join();
+        CHECK (report.isClean());
+    }
+}
+
+TEST_CASE ("Every audio-thread path is real-time safe", "[realtime]")
+{
+    Engine engine;
+    const auto reports = runAudioThread (engine);
+
+    SECTION ("shapes")       { requireClean (reports.shapes); }
+    SECTION ("sequencer")    { requireClean (reports.sequencer); }
+    SECTION ("routing")      { requireClean (reports.routing); }
+    SECTION ("output")       { requireClean (reports.output); }
+    SECTION ("whole block")  { requireClean (reports.wholeBlock); }
+}
+
+TEST_CASE ("Audio-thread paths stay real-time safe while the message thread edits", "[realtime]")
+{
+    Engine engine;
+
+    // The audio side keeps swapping in new tables, timelines and routes while it runs
+    std::atomic<bool> finished { false };
+    std::atomic<int> numEdits { 0 };
+
+    std::thread messageThread ([&]
+    {
+        std::mt19937 random (11);
+        CountingSink sink;
+
+        for (int index = 0; ! finished.load(); ++index)
+        {
+            engine.edit (index, random, sink);
+            numEdits.fetch_add (1);
+            std::this_thread::sleep_for (std::chrono::milliseconds (2));
+        }
+    });
+
+    const auto reports = runAudioThread (engine);
+
+    finished = true;
+    messageThread.join();
+
+    INFO (numEdits.load() << " edits from the message thread");
+    requireClean (reports.shapes);
+    requireClean (reports.sequencer);
+    requireClean (reports.routing);
+    requireClean (reports.output);
+    requireClean (reports.wholeBlock);
+}
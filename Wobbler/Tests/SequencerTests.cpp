@@ -0,0 +1,423 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    SequencerTests - the placements SequencePlayer finds against a brute-force
+    scan of the pattern, and how its lookups grow with the pattern
+
+  ==============================================================================
+*/
+
+#include "BenchmarkUtilities.h"
+#include "PatternSequence.h"
+#include "SequencePlayer.h"
+#include "SequenceTimeline.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+
+using namespace wobbler;
+
+namespace
+{
+    namespace bench = plugindsp::bench;
+
+    constexpr int numLanes = 16;
+    constexpr double sampleRate = 48000.0;
+    constexpr double beatsPerSampleAt120 = 120.0 / (60.0 * sampleRate);
+
+    /**
+     * Fills every lane with placements of random length: mostly back to back,
+     * with some gaps, some overlapping the one before (which cuts that one
+     * off), and some starting on the same beat as the one before (which
+     * replaces it). The pattern ends inside the longest lane, so placements
+     * are clipped by the loop too.
+     */
+    void fillPattern (PatternSequence& pattern, int numPlacements, std::mt19937& random)
+    {
+        std::uniform_real_distribution<double> length (0.25, 2.0);
+        std::uniform_real_distribution<float> unit (0.0f, 1.0f);
+
+        const auto perLane = std::max (1, numPlacements / numLanes);
+        auto longest = 0.0;
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            pattern.clearLane (lane);
+            auto beat = 0.0;
+
+            for (int i = 0; i < perLane; ++i)
+            {
+                ShapePlacement placement;
+                placement.startBeat = beat;
+                placement.lengthBeats = length (random);
+                placement.shapeSlot = (int) (random() % 16);
+                placement.cycles = 1.0f + (float) (random() % 4);
+                placement.phaseOffset = unit (random);
+                placement.scale = 0.5f + 0.5f * unit (random);
+                placement.offset = unit (random) - 0.5f;
+                pattern.addPlacement (lane, placement);
+
+                switch (random() % 8)
+                {
+                    case 0:  beat += placement.lengthBeats + 0.5; break;   // a gap
+                    case 1:  beat += placement.lengthBeats * 0.5; break;   // overlaps the next
+                    case 2:  break;                                        // same start as the next
+                    default: beat += placement.lengthBeats; break;
+                }
+            }
+
+            longest = std::max (longest, beat);
+        }
+
+        pattern.setLengthBeats (longest * 0.9);
+    }
+
+    //==============================================================================
+    /** What should play at a beat, worked out from the nested vectors alone. */
+    struct Expected
+    {
+        int shapeSlot = -1;
+        double phase = 0.0;
+        float scale = 0.0f, offset = 0.0f;
+        bool nearBoundary = false;      // too close to a start or end to say which side a sample falls
+    };
+
+    Expected scanPattern (const PatternSequence& pattern, int lane, double beat)
+    {
+        constexpr double boundaryTolerance = 1.0e-6;
+
+        const auto length = pattern.getLengthBeats();
+        const ShapePlacement* playing = nullptr;
+
+        Expected expected;
+        expected.nearBoundary = std::abs (beat - length) < boundaryTolerance || beat < boundaryTolerance;
+
+        // The latest placement starting at or before the beat; of several on
+        // the same beat, the last one added
+        for (const auto& placement : pattern.getLane (lane))
+        {
+            if (placement.lengthBeats <= 0.0)
+                continue;
+
+            const auto end = placement.startBeat + placement.lengthBeats;
+
+            if (std::abs (beat - placement.startBeat) < boundaryTolerance || std::abs (beat - end) < boundaryTolerance)
+                expected.nearBoundary = true;
+
+            if (placement.startBeat <= beat && (playing == nullptr || placement.startBeat >= playing->startBeat))
+                playing = &placement;
+        }
+
+        if (playing == nullptr || beat >= playing->startBeat + playing->lengthBeats || beat >= length)
+            return expected;
+
+        const auto phase = playing->phaseOffset + (beat - playing->startBeat) * playing->cycles / playing->lengthBeats;
+
+        expected.shapeSlot = playing->shapeSlot;
+        expected.phase = phase - std::floor (phase);
+        expected.scale = playing->scale;
+        expected.offset = playing->offset;
+        return expected;
+    }
+
+    double phaseDistance (double a, double b)
+    {
+        const auto difference = std::abs (a - b);
+        return std::min (difference, 1.0 - difference);
+    }
+
+    /**
+     * Gets one block's segments for every lane and checks samples against
+     * the brute-force scan: the first and last of every segment, and every
+     * 64th in between (the scan is slow). Returns the number checked.
+     */
+    int checkBlock (SequencePlayer& player, const SequenceTimeline& timeline, const PatternSequence& pattern,
+                    double startBeat, double beatsPerSample, int blockSize)
+    {
+        SequencePlayer::Segment segments[SequencePlayer::maxSegmentsPerBlock];
+        const auto length = pattern.getLengthBeats();
+        auto numChecked = 0;
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const auto numSegments = player.getSegments (timeline, lane, startBeat, beatsPerSample, blockSize,
+                                                         segments, SequencePlayer::maxSegmentsPerBlock);
+            REQUIRE (numSegments > 0);
+            REQUIRE (segments[0].startSample == 0);
+            REQUIRE (segments[numSegments - 1].startSample + segments[numSegments - 1].numSamples == blockSize);
+
+            for (int s = 0; s < numSegments; ++s)
+            {
+                const auto& segment = segments[s];
+
+                if (s > 0 && segment.startSample != segments[s - 1].startSample + segments[s - 1].numSamples)
+                    FAIL ("lane " << lane << ": segment " << s << " doesn't follow on from the one before");
+
+                for (int i = 0; i < segment.numSamples; ++i)
+                {
+                    if (i % 64 != 0 && i != segment.numSamples - 1)
+                        continue;
+
+                    const auto sample = segment.startSample + i;
+                    auto beat = startBeat + sample * beatsPerSample;
+                    beat -= std::floor (beat / length) * length;
+
+                    const auto expected = scanPattern (pattern, lane, beat);
+
+                    if (expected.nearBoundary)
+                        continue;
+
+                    // Only reported on a mismatch: asserting every sample would dominate the run time
+                    const auto phase = segment.firstPhase + i * (double) segment.phaseStep;
+
+                    if (segment.shapeSlot != expected.shapeSlot
+                         || (expected.shapeSlot >= 0 && (phaseDistance (phase, expected.phase) > 1.0e-4
+                                                          || segment.scale != expected.scale
+                                                          || segment.offset != expected.offset)))
+                    {
+                        FAIL ("lane " << lane << ", beat " << beat << ", sample " << sample << ": found slot "
+                              << segment.shapeSlot << " at phase " << phase << ", expected slot "
+                              << expected.shapeSlot << " at phase " << expected.phase);
+                    }
+
+                    ++numChecked;
+                }
+            }
+        }
+
+        return numChecked;
+    }
+
+    //==============================================================================
+    /** The most lookups SequencePlayer made for one block, over every lane. */
+    struct LookupCounts
+    {
+        std::uint64_t maxLinearStepsPerBlock = 0;
+        std::uint64_t maxBinarySearchesPerBlock = 0;
+        std::uint64_t binarySearchesAfterFirstBlock = 0;
+    };
+
+    /**
+     * Counts how SequencePlayer found the placements for numBlocks blocks in
+     * every lane, playing continuously or seeking first. The counters don't
+     * depend on timing, so they can be compared exactly.
+     */
+    LookupCounts countLookups (const SequenceTimeline& timeline, bool seekEveryBlock, int numBlocks)
+    {
+        constexpr int blockSize = 512;
+
+        SequencePlayer player (numLanes);
+        SequencePlayer::Segment segments[SequencePlayer::maxSegmentsPerBlock];
+        std::mt19937 random (99);
+        std::uniform_real_distribution<double> anywhere (0.0, timeline.getLengthBeats());
+        auto beat = anywhere (random);
+        LookupCounts counts;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            if (seekEveryBlock)
+                beat = anywhere (random);
+
+            const auto before = player.getStats();
+
+            for (int lane = 0; lane < numLanes; ++lane)
+                player.getSegments (timeline, lane, beat, beatsPerSampleAt120, blockSize,
+                                    segments, SequencePlayer::maxSegmentsPerBlock);
+
+            const auto linearSteps = player.getStats().linearSteps - before.linearSteps;
+            const auto binarySearches = player.getStats().binarySearches - before.binarySearches;
+
+            counts.maxLinearStepsPerBlock = std::max (counts.maxLinearStepsPerBlock, linearSteps);
+            counts.maxBinarySearchesPerBlock = std::max (counts.maxBinarySearchesPerBlock, binarySearches);
+
+            if (block > 0)
+                counts.binarySearchesAfterFirstBlock += binarySearches;
+
+            beat += blockSize * beatsPerSampleAt120;
+        }
+
+        return counts;
+    }
+
+    /** Median time in ns to look up one block in every lane, playing continuously or seeking first. */
+    double medianLookupNanoseconds (const SequenceTimeline& timeline, bool seekEveryBlock)
+    {
+        constexpr int blockSize = 512;
+
+        SequencePlayer player (numLanes);
+        SequencePlayer::Segment segments[SequencePlayer::maxSegmentsPerBlock];
+        std::mt19937 random (99);
+        std::uniform_real_distribution<double> anywhere (0.0, timeline.getLengthBeats());
+        auto beat = anywhere (random);
+
+        const auto timings = bench::timeEachCall ([&]
+        {
+            if (seekEveryBlock)
+                beat = anywhere (random);
+
+            for (int lane = 0; lane < numLanes; ++lane)
+                bench::doNotOptimise (player.getSegments (timeline, lane, beat, beatsPerSampleAt120, blockSize,
+                                                          segments, SequencePlayer::maxSegmentsPerBlock));
+
+            beat += blockSize * beatsPerSampleAt120;
+        }, 100, 2000);
+
+        return bench::summarise (timings).p50;
+    }
+
+    /** The best of a few runs, so one interrupted run doesn't decide the result. */
+    double bestMedianLookupNanoseconds (const SequenceTimeline& timeline, bool seekEveryBlock)
+    {
+        auto best = medianLookupNanoseconds (timeline, seekEveryBlock);
+
+        for (int run = 1; run < 5; ++run)
+            best = std::min (best, medianLookupNanoseconds (timeline, seekEveryBlock));
+
+        return best;
+    }
+}
+
+//==============================================================================
+TEST_CASE ("SequencePlayer finds the placements a brute-force scan finds", "[sequencer]")
+{
+    const auto numPlacements = GENERATE (100, 10000);
+    INFO (numPlacements << " placements");
+
+    std::mt19937 random (1234);
+    PatternSequence pattern (numLanes);
+    fillPattern (pattern, numPlacements, random);
+
+    const auto timeline = SequenceTimeline::compile (pattern, 1);
+    const auto length = pattern.getLengthBeats();
+    std::uniform_real_distribution<double> anywhere (0.0, length);
+    SequencePlayer player (numLanes);
+
+    SECTION ("playing continuously through the loop point")
+    {
+        constexpr int blockSize = 512;
+        const auto blockBeats = blockSize * beatsPerSampleAt120;
+
+        // From just before the loop end, and from somewhere in the middle
+        for (auto beat : { length - 3.0 * blockBeats, anywhere (random) })
+        {
+            auto numChecked = 0;
+
+            for (int block = 0; block < 500; ++block, beat += blockBeats)
+                numChecked += checkBlock (player, *timeline, pattern, beat, beatsPerSampleAt120, blockSize);
+
+            CHECK (numChecked > 0);
+        }
+
+        CHECK (player.getStats().linearSteps > player.getStats().binarySearches);
+    }
+
+    SECTION ("seeking before every block")
+    {
+        for (int block = 0; block < 200; ++block)
+            checkBlock (player, *timeline, pattern, anywhere (random), beatsPerSampleAt120, 256);
+    }
+
+    SECTION ("with the tempo and block size changing every block")
+    {
+        std::uniform_real_distribution<double> bpm (40.0, 300.0);
+        auto beat = anywhere (random);
+
+        for (int block = 0; block < 300; ++block)
+        {
+            const auto beatsPerSample = bpm (random) / (60.0 * sampleRate);
+            const auto blockSize = 1 + (int) (random() % 1024);
+
+            checkBlock (player, *timeline, pattern, beat, beatsPerSample, blockSize);
+            beat += blockSize * beatsPerSample;
+        }
+    }
+
+    SECTION ("at a host position many loops in")
+    {
+        const auto beat = 1000.0 * length + anywhere (random);
+        checkBlock (player, *timeline, pattern, beat, beatsPerSampleAt120, 512);
+    }
+}
+
+TEST_CASE ("SequencePlayer lookups don't grow with the pattern", "[sequencer]")
+{
+    std::mt19937 random (1234);
+
+    PatternSequence small (numLanes), large (numLanes);
+    fillPattern (small, 100, random);
+    fillPattern (large, 10000, random);
+
+    const auto smallTimeline = SequenceTimeline::compile (small, 1);
+    const auto largeTimeline = SequenceTimeline::compile (large, 2);
+
+    // Each cursor step is bounded, so a block's cost is bounded by its lookups.
+    // At 120 bpm a 512-sample block touches at most a few placements per lane,
+    // whatever the lane length, and the loop point is stepped through too.
+    constexpr std::uint64_t maxLookupsPerLane = 4;
+
+    SECTION ("playing continuously only steps cursors")
+    {
+        for (const auto* timeline : { smallTimeline.get(), largeTimeline.get() })
+        {
+            INFO (timeline->getNumPlacements() << " placements");
+            const auto counts = countLookups (*timeline, false, 4000);
+
+            CHECK (counts.binarySearchesAfterFirstBlock == 0);
+            CHECK (counts.maxBinarySearchesPerBlock <= (std::uint64_t) numLanes);
+            CHECK (counts.maxLinearStepsPerBlock <= maxLookupsPerLane * numLanes);
+        }
+    }
+
+    SECTION ("seeking searches at most once per lane per block")
+    {
+        for (const auto* timeline : { smallTimeline.get(), largeTimeline.get() })
+        {
+            INFO (timeline->getNumPlacements() << " placements");
+            const auto counts = countLookups (*timeline, true, 2000);
+
+            CHECK (counts.binarySearchesAfterFirstBlock > 0);
+            CHECK (counts.maxBinarySearchesPerBlock <= (std::uint64_t) numLanes);
+            CHECK (counts.maxLinearStepsPerBlock <= maxLookupsPerLane * numLanes);
+        }
+    }
+}
+
+// Wall-clock ratios depend on the machine and its load, so this is hidden from
+// ctest; run it with WobblerTests "[performance]".
+TEST_CASE ("SequencePlayer lookup time doesn't grow with the pattern", "[.performance][sequencer]")
+{
+    std::mt19937 random (1234);
+
+    PatternSequence small (numLanes), large (numLanes);
+    fillPattern (small, 100, random);
+    fillPattern (large, 10000, random);
+
+    const auto smallTimeline = SequenceTimeline::compile (small, 1);
+    const auto largeTimeline = SequenceTimeline::compile (large, 2);
+
+    // Playing steps a cursor, so the cost should be flat. A seek is a binary
+    // search per lane, so it grows with the log of the lane length (6 to 625
+    // placements, about 3x the steps). Both bounds leave room for timing noise.
+    SECTION ("playing continuously")
+    {
+        const auto smallNs = bestMedianLookupNanoseconds (*smallTimeline, false);
+        const auto largeNs = bestMedianLookupNanoseconds (*largeTimeline, false);
+
+        INFO ("100 placements: " << smallNs << " ns per block, 10,000 placements: " << largeNs << " ns per block");
+        CHECK (largeNs <= 3.0 * smallNs);
+    }
+
+    SECTION ("seeking before every block")
+    {
+        const auto smallNs = bestMedianLookupNanoseconds (*smallTimeline, true);
+        const auto largeNs = bestMedianLookupNanoseconds (*largeTimeline, true);
+
+        INFO ("100 placements: " << smallNs << " ns per block, 10,000 placements: " << largeNs << " ns per block");
+        CHECK (largeNs <= 6.0 * smallNs);
+    }
+}
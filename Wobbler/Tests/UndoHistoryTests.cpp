@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    UndoHistoryTests - random edits, drags, undos and redos on a full preset,
+    with the saved state checked byte for byte after every step and the
+    history kept within its memory limit
+
+  ==============================================================================
+*/
+
+#include "RandomStateEdits.h"
+
+#include <catch2/catch.hpp>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+using namespace wobbler;
+
+namespace
+{
+    constexpr wobblertests::RandomStateEdits::PresetSize presetSize { 64, 400, 16 };
+    constexpr int numOperations = 2500;
+
+    /** FNV-1a over the saved bytes: equal states save to identical bytes. */
+    std::uint64_t hashBytes (const std::vector<std::uint8_t>& bytes) noexcept
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+
+        for (auto byte : bytes)
+            hash = (hash ^ byte) * 1099511628211ull;
+
+        return hash;
+    }
+
+    //==============================================================================
+    /**
+     * Keeps the hash of the state after each step the history holds. Every
+     * undo and redo must bring back exactly the state saved when that step
+     * was current; the first one that doesn't fails the test.
+     */
+    class RoundTripChecker
+    {
+    public:
+        RoundTripChecker (std::size_t memoryLimit, unsigned seed)
+            : edits (state, presetSize, seed)
+        {
+            history.setMemoryLimit (memoryLimit);
+            hashes.push_back (hashState());
+        }
+
+        //==============================================================================
+        void run (int operations)
+        {
+            for (int i = 0; i < operations; ++i)
+            {
+                switch (edits.chooseAction())
+                {
+                    case wobblertests::RandomStateEdits::Action::undo:  step (true);  break;
+                    case wobblertests::RandomStateEdits::Action::redo:  step (false); break;
+                    case wobblertests::RandomStateEdits::Action::edit:  edit();       break;
+                }
+            }
+        }
+
+        /** Undoes everything the history holds, then redoes it all. */
+        void unwindAndReplay()
+        {
+            while (history.canUndo())
+                step (true);
+
+            while (history.canRedo())
+                step (false);
+        }
+
+        const UndoHistory& getHistory() const noexcept  { return history; }
+        int getNumUndos() const noexcept                { return numUndos; }
+        int getNumRedos() const noexcept                { return numRedos; }
+
+    private:
+        //==============================================================================
+        std::uint64_t hashState()
+        {
+            state.save (saved);
+            return hashBytes (saved);
+        }
+
+        std::string describePosition() const
+        {
+            return "edit " + std::to_string (numEdits) + ", step " + std::to_string (history.getNumUndoable())
+                     + " of " + std::to_string (history.getNumSteps());
+        }
+
+        void step (bool isUndo)
+        {
+            if (! (isUndo ? history.undo() : history.redo()))
+                FAIL ((isUndo ? "undo refused at " : "redo refused at ") << describePosition());
+
+            ++(isUndo ? numUndos : numRedos);
+
+            if (hashState() != hashes[(size_t) history.getNumUndoable()])
+                FAIL ((isUndo ? "undo didn't restore the state at " : "redo didn't restore the state at ")
+                        << describePosition());
+        }
+
+        //==============================================================================
+        void edit()
+        {
+            const auto droppedBefore = history.getNumDropped();
+            edits.makeEdit();
+            ++numEdits;
+
+            // Steps dropped for memory take their states with them
+            for (auto i = droppedBefore; i < history.getNumDropped(); ++i)
+                hashes.pop_front();
+
+            const auto current = (size_t) history.getNumUndoable();
+            const auto hash = hashState();
+
+            if (history.canRedo())
+            {
+                // Nothing was recorded, so the redo steps survive
+                if (hash != hashes[current])
+                    FAIL ("an unrecorded edit changed the state at " << describePosition());
+            }
+            else
+            {
+                // A new step, or more of a merged drag
+                hashes.resize (current);
+                hashes.push_back (hash);
+            }
+
+            if (hashes.size() != (size_t) history.getNumSteps() + 1)
+                FAIL ("step count out of sync at " << describePosition());
+
+            // A single step bigger than the limit is kept: it's the only way to undo it
+            if (history.getMemoryUsage() > history.getMemoryLimit() && history.getNumSteps() > 1)
+                FAIL ("over the memory limit (" << history.getMemoryUsage() << " of "
+                        << history.getMemoryLimit() << " bytes) at " << describePosition());
+        }
+
+        //==============================================================================
+        PluginState state;
+        UndoHistory& history = state.getUndoHistory();
+        wobblertests::RandomStateEdits edits;
+
+        std::vector<std::uint8_t> saved;
+        std::deque<std::uint64_t> hashes;     // the state after each step the history holds
+
+        int numEdits = 0, numUndos = 0, numRedos = 0;
+    };
+
+    struct Config
+    {
+        std::size_t memoryLimitKB;
+        unsigned seed;
+    };
+}
+
+//==============================================================================
+TEST_CASE ("Every undo and redo restores the saved state exactly", "[undo]")
+{
+    // 8 MB holds everything; 256 KB compresses old steps; 32 KB drops them too
+    const auto config = GENERATE (Config { 8192, 1 }, Config { 256, 2 }, Config { 32, 3 });
+    INFO ("memory limit " << config.memoryLimitKB << " KB, seed " << config.seed);
+
+    RoundTripChecker checker (config.memoryLimitKB * 1024, config.seed);
+    checker.run (numOperations);
+    checker.unwindAndReplay();
+
+    const auto& history = checker.getHistory();
+    CHECK (checker.getNumUndos() > 0);
+    CHECK (checker.getNumRedos() > 0);
+    CHECK (history.getMemoryUsage() <= history.getMemoryLimit());
+
+    // Make sure the runs reach the paths they're meant to
+    if (config.memoryLimitKB <= 256)
+        CHECK (history.getNumCompressed() > 0);
+
+    if (config.memoryLimitKB <= 32)
+        CHECK (history.getNumDropped() > 0);
+}
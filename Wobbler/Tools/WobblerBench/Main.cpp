@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    WobblerBench - benchmarks for the modulation engine, one subcommand each
+
+    Usage: WobblerBench <subcommand> [--quick] [options]
+
+  ==============================================================================
+*/
+
+#include "WobblerBench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace wobblerbench
+{
+
+int getIntOption (const std::vector<std::string>& args, const char* flag, int fallback)
+{
+    for (size_t i = 0; i + 1 < args.size(); ++i)
+        if (args[i] == flag)
+            return std::atoi (args[i + 1].c_str());
+
+    return fallback;
+}
+
+bool hasFlag (const std::vector<std::string>& args, const char* flag)
+{
+    for (const auto& arg : args)
+        if (arg == flag)
+            return true;
+
+    return false;
+}
+
+} // namespace wobblerbench
+
+namespace
+{
+    struct Subcommand
+    {
+        const char* name;
+        const char* description;
+        int (*run) (const std::vector<std::string>&, const wobblerbench::CommonOptions&);
+    };
+
+    const Subcommand subcommands[] =
+    {
+        { "shapes", "LFO wavetable render cost, rebuild latency and accuracy "
+                    "[--shapes N] [--block-size N]", wobblerbench::runShapeBenchmark },
+        { "sequencer", "pattern lookup cost per block from 1k placements up "
+                       "[--max-placements N] [--blocks N]", wobblerbench::runSequencerBenchmark },
+        { "routing", "modulation matrix cost per block, up to every source on every target "
+                     "[--sources N] [--targets N] [--block-size N]", wobblerbench::runRoutingBenchmark },
+        { "output", "host notifications from modulated parameters, counted by a mock host "
+                    "[--targets N] [--block-size N] [--seconds N] [--timer-hz N]", wobblerbench::runOutputBenchmark },
+        { "state", "preset save/load latency, incremental saves and migration "
+                   "[--shapes N] [--placements N] [--patterns N]", wobblerbench::runStateBenchmark },
+        { "undo", "undo/redo timings and history memory over randomised edits "
+                  "[--edits N] [--memory-kb N] [--seed N]", wobblerbench::runUndoBenchmark },
+    };
+
+    void printUsage()
+    {
+        std::printf ("Usage: WobblerBench <subcommand> [--quick] [options]\n\nSubcommands:\n");
+
+        for (const auto& subcommand : subcommands)
+            std::printf ("  %-11s %s\n", subcommand.name, subcommand.description);
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    if (argc < 2 || std::strcmp (argv[1], "--help") == 0)
+    {
+        printUsage();
+        return argc < 2 ? 1 : 0;
+    }
+
+    const std::vector<std::string> args (argv + 2, argv + argc);
+
+    wobblerbench::CommonOptions options;
+    options.quick = wobblerbench::hasFlag (args, "--quick");
+
+    for (const auto& subcommand : subcommands)
+        if (std::strcmp (argv[1], subcommand.name) == 0)
+            return subcommand.run (args, options);
+
+    std::fprintf (stderr, "Unknown subcommand: %s\n\n", argv[1]);
+    printUsage();
+    return 1;
+}
@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    OutputBenchmark - how many host notifications the parameter output
+    scheduler sends, counted by a mock host, how far the host's values are
+    from the modulation, and what pushing values costs per block
+
+  ==============================================================================
+*/
+
+#include "WobblerBench.h"
+
+#include "BenchmarkUtilities.h"
+#include "OutputSchedulerScenario.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace wobblerbench
+{
+
+namespace
+{
+    using namespace wobbler;
+    using namespace wobblertests;
+    namespace bench = plugindsp::bench;
+
+    constexpr double sampleRate = OutputSchedulerScenario::sampleRate;
+}
+
+//==============================================================================
+int runOutputBenchmark (const std::vector<std::string>& args, const CommonOptions& options)
+{
+    const auto numTargets = std::max (1, getIntOption (args, "--targets", 512));
+    const auto blockSize = std::max (1, getIntOption (args, "--block-size", 128));
+    const auto seconds = std::max (1, getIntOption (args, "--seconds", options.quick ? 10 : 60));
+    const auto timerHz = std::max (1, getIntOption (args, "--timer-hz", 60));
+
+    const auto numBlocks = (int) (seconds * sampleRate / blockSize);
+
+    LFOShapeEngine shapes (OutputSchedulerScenario::numSources);
+    OutputSchedulerScenario::setUpShapes (shapes);
+
+    std::printf ("%d targets (half modulated at 0.1-8 Hz, a quarter at 0.02 Hz, a quarter still), "
+                 "%d-sample blocks, delivered at %d Hz, %d s of audio\n\n", numTargets, blockSize, timerHz, seconds);
+    std::printf ("Without a scheduler, calling the host for every target every block: %.0f notifications/s\n\n",
+                 numTargets * sampleRate / blockSize);
+    std::printf ("%-24s %15s %10s %12s %12s %9s\n",
+                 "", "notifications/s", "batches/s", "max drift", "mean drift", "ns/block");
+
+    for (const auto& config : getOutputConfigs())
+    {
+        OutputSchedulerScenario scenario (shapes, numTargets, blockSize, timerHz, config);
+        MockHost host (numTargets);
+        std::vector<double> pushTimes;
+        pushTimes.reserve ((size_t) numBlocks);
+
+        auto maxDrift = 0.0, totalDrift = 0.0;
+        std::uint64_t numDriftSamples = 0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            scenario.processMatrix();
+
+            const auto start = bench::Clock::now();
+            scenario.pushValues();
+            pushTimes.push_back (bench::nanosecondsBetween (start, bench::Clock::now()));
+
+            if (scenario.deliverIfDue (host))
+            {
+                for (int t = 0; t < numTargets; ++t)
+                {
+                    const auto drift = std::abs ((double) host.values[(size_t) t] - scenario.getTargetValues()[t]);
+                    maxDrift = std::max (maxDrift, drift);
+                    totalDrift += drift;
+                    ++numDriftSamples;
+                }
+            }
+        }
+
+        const auto summary = bench::summarise (pushTimes);
+        std::printf ("%-24s %15.0f %10.1f %12.4f %12.4f %9.0f\n", config.name,
+                     (double) host.notifications / seconds, (double) host.batches / seconds,
+                     maxDrift, totalDrift / (double) std::max<std::uint64_t> (1, numDriftSamples), summary.mean);
+    }
+
+    std::printf ("\n'drift' compares the host's values with the current modulation when each batch is delivered,\n"
+                 "so it includes the movement since the scheduler's last check as well as the tolerance.\n"
+                 "WobblerTests checks the host stays within the tolerance of the checked values.\n");
+    return 0;
+}
+
+} // namespace wobblerbench
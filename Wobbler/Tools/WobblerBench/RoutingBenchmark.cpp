@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    RoutingBenchmark - cost of the modulation matrix per block, up to every
+    source routed to every target, against a loop over RoutingEntry objects
+
+  ==============================================================================
+*/
+
+#include "WobblerBench.h"
+
+#include "BenchmarkUtilities.h"
+#include "LFOShapeEngine.h"
+#include "ModulationMatrix.h"
+#include "ShapeLFOSource.h"
+
+#include <cstdio>
+#include <memory>
+#include <random>
+
+namespace wobblerbench
+{
+
+namespace
+{
+    using namespace wobbler;
+    namespace bench = plugindsp::bench;
+
+    constexpr double sampleRate = 48000.0;
+
+    /**
+     * The layout from the design document, run as written: a vector of
+     * entries, each reading its source through the base class.
+     */
+    void processEntries (const std::vector<RoutingEntry>& entries, const std::vector<ModulationSource*>& sources,
+                         std::vector<float>& targets, int numSamples)
+    {
+        for (auto* source : sources)
+            source->advance (numSamples);
+
+        std::fill (targets.begin(), targets.end(), 0.0f);
+
+        for (const auto& entry : entries)
+            targets[(size_t) entry.target.targetID] += entry.target.depth
+                                                     * sources[(size_t) entry.sourceIndex]->getValue (entry.target.phase);
+    }
+}
+
+//==============================================================================
+int runRoutingBenchmark (const std::vector<std::string>& args, const CommonOptions& options)
+{
+    const auto numSources = std::max (1, getIntOption (args, "--sources", 64));
+    const auto numTargets = std::max (1, getIntOption (args, "--targets", 512));
+    const auto blockSize = std::max (1, getIntOption (args, "--block-size", 512));
+    const auto numBlocks = options.quick ? 500 : 5000;
+    const auto deadlineNs = blockSize / sampleRate * 1.0e9;
+
+    LFOShapeEngine shapes (numSources);
+
+    for (int i = 0; i < numSources; ++i)
+        shapes.setShape (i, i % 3 == 0 ? LFOShape::sine() : (i % 3 == 1 ? LFOShape::triangle() : LFOShape::sawUp()));
+
+    shapes.waitUntilIdle();
+
+    std::vector<std::unique_ptr<ShapeLFOSource>> lfos;
+    std::vector<ModulationSource*> sources;
+
+    for (int i = 0; i < numSources; ++i)
+    {
+        lfos.push_back (std::make_unique<ShapeLFOSource> (shapes, i, 0.1f + 0.37f * (float) i));
+        sources.push_back (lfos.back().get());
+    }
+
+    std::printf ("%d sources, %d targets, %d-sample blocks at 48 kHz; times in ns per block\n\n",
+                 numSources, numTargets, blockSize);
+    std::printf ("%-22s %8s %10s %10s %10s %10s %12s\n", "", "routes", "p50", "p99", "max", "commit", "p99 budget");
+
+    std::mt19937 random (99);
+    std::uniform_real_distribution<float> unit (0.0f, 1.0f);
+
+    for (const auto routesPerTarget : { 1, 8, numSources })
+    {
+        ModulationMatrix matrix (numSources, numTargets, numSources * numTargets);
+        std::vector<RoutingEntry> entries;
+
+        for (int i = 0; i < numSources; ++i)
+            matrix.setSource (i, sources[(size_t) i]);
+
+        for (int target = 0; target < numTargets; ++target)
+        {
+            for (int k = 0; k < routesPerTarget; ++k)
+            {
+                RoutingEntry entry;
+                entry.sourceIndex = (target + k * 7) % numSources;
+                entry.target.targetID = target;
+                entry.target.depth = unit (random) / (float) routesPerTarget;
+                entry.target.smoothingSeconds = k % 2 == 0 ? 0.0f : 0.05f;
+                entry.target.phase = (float) (k % 4) * 0.25f;
+                matrix.addRoute (entry);
+                entries.push_back (entry);
+            }
+        }
+
+        const auto commitStart = bench::Clock::now();
+        matrix.commit();
+        const auto commitNs = bench::nanosecondsBetween (commitStart, bench::Clock::now());
+
+        matrix.prepare (sampleRate);
+
+        for (auto* source : sources)
+            source->prepare (sampleRate);
+
+        const auto numRoutes = matrix.getNumRoutes();
+
+        const auto matrixTimes = bench::timeEachCall ([&]
+        {
+            const LFOShapeEngine::ReadScope scope (shapes);
+            matrix.process (blockSize);
+            bench::doNotOptimise (matrix.getTargetValues()[0]);
+        }, 20, numBlocks);
+
+        std::vector<float> targets ((size_t) numTargets);
+
+        const auto entryTimes = bench::timeEachCall ([&]
+        {
+            const LFOShapeEngine::ReadScope scope (shapes);
+            processEntries (entries, sources, targets, blockSize);
+            bench::doNotOptimise (targets[0]);
+        }, 20, numBlocks);
+
+        const auto printRow = [&] (const char* name, const std::vector<double>& timings, double commit)
+        {
+            const auto summary = bench::summarise (timings);
+            std::printf ("%-22s %8d %10.0f %10.0f %10.0f ", name, numRoutes, summary.p50, summary.p99, summary.max);
+
+            if (commit >= 0.0)
+                std::printf ("%8.2f ms", commit / 1.0e6);
+            else
+                std::printf ("%11s", "");
+
+            std::printf (" %11.2f%%\n", 100.0 * summary.p99 / deadlineNs);
+        };
+
+        printRow ("matrix", matrixTimes, commitNs);
+        printRow ("RoutingEntry loop", entryTimes, -1.0);
+        std::printf ("\n");
+    }
+
+    return 0;
+}
+
+} // namespace wobblerbench
@@ -0,0 +1,202 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    SequencerBenchmark - per-block cost of finding and rendering placements
+    as the pattern grows, against scanning the nested placement vectors
+
+  ==============================================================================
+*/
+
+#include "WobblerBench.h"
+
+#include "BenchmarkUtilities.h"
+#include "LFOShapeEngine.h"
+#include "PatternSequencer.h"
+
+#include <cstdio>
+#include <random>
+
+namespace wobblerbench
+{
+
+namespace
+{
+    using namespace wobbler;
+    namespace bench = plugindsp::bench;
+
+    constexpr int numLanes = 16;
+    constexpr int blockSize = 512;
+    constexpr double sampleRate = 48000.0;
+    constexpr double beatsPerSample = 120.0 / (60.0 * sampleRate);
+
+    //==============================================================================
+    /** Fills every lane with back-to-back placements of random length, with occasional gaps. */
+    void fillPattern (PatternSequence& pattern, int numPlacements, std::mt19937& random)
+    {
+        std::uniform_real_distribution<double> length (0.25, 2.0);
+        std::uniform_real_distribution<float> unit (0.0f, 1.0f);
+
+        const auto perLane = std::max (1, numPlacements / numLanes);
+        auto longest = 0.0;
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            pattern.clearLane (lane);
+            auto beat = 0.0;
+
+            for (int i = 0; i < perLane; ++i)
+            {
+                ShapePlacement placement;
+                placement.startBeat = beat;
+                placement.lengthBeats = length (random);
+                placement.shapeSlot = (int) (random() % 16);
+                placement.cycles = 1.0f + (float) (random() % 4);
+                placement.phaseOffset = unit (random);
+                placement.scale = 0.5f + 0.5f * unit (random);
+                pattern.addPlacement (lane, placement);
+
+                beat += placement.lengthBeats + (random() % 8 == 0 ? 0.5 : 0.0);
+            }
+
+            longest = std::max (longest, beat);
+        }
+
+        pattern.setLengthBeats (longest);
+    }
+
+    /**
+     * The straightforward way to play the design's nested vectors: scan each
+     * lane for placements overlapping the block. Kept as the baseline.
+     */
+    int scanNestedVectors (const PatternSequence& pattern, double startBeat, double endBeat)
+    {
+        auto found = 0;
+
+        for (int lane = 0; lane < pattern.getNumLanes(); ++lane)
+            for (const auto& placement : pattern.getLane (lane))
+                if (placement.startBeat < endBeat && placement.startBeat + placement.lengthBeats > startBeat)
+                    ++found;
+
+        return found;
+    }
+
+    void printRow (const char* name, int numPlacements, const std::vector<double>& timings)
+    {
+        const auto summary = bench::summarise (timings);
+        std::printf ("%-26s %10d %12.0f %12.0f %12.0f\n", name, numPlacements, summary.p50, summary.p99, summary.max);
+    }
+}
+
+//==============================================================================
+int runSequencerBenchmark (const std::vector<std::string>& args, const CommonOptions& options)
+{
+    const auto numBlocks = std::max (1, getIntOption (args, "--blocks", options.quick ? 500 : 5000));
+    const auto largest = std::max (1000, getIntOption (args, "--max-placements", options.quick ? 10000 : 100000));
+
+    std::mt19937 random (1234);
+
+    LFOShapeEngine shapes (16);
+
+    for (int i = 0; i < 16; ++i)
+        shapes.setShape (i, i % 2 == 0 ? LFOShape::sine() : LFOShape::triangle());
+
+    shapes.waitUntilIdle();
+
+    std::printf ("%d lanes, %d-sample blocks at 120 bpm / 48 kHz; times in ns per block (all lanes)\n\n",
+                 numLanes, blockSize);
+    std::printf ("%-26s %10s %12s %12s %12s\n", "", "placements", "p50", "p99", "max");
+
+    std::vector<float> output ((size_t) blockSize);
+    SequencePlayer::Segment segments[SequencePlayer::maxSegmentsPerBlock];
+
+    for (int numPlacements = 1000; numPlacements <= largest; numPlacements *= 10)
+    {
+        PatternSequencer sequencer (numLanes);
+        fillPattern (sequencer.getPattern(), numPlacements, random);
+
+        const auto compileStart = bench::Clock::now();
+        sequencer.commit();
+        const auto compileNs = bench::nanosecondsBetween (compileStart, bench::Clock::now());
+
+        const auto length = sequencer.getPattern().getLengthBeats();
+        std::uniform_real_distribution<double> anywhere (0.0, length);
+
+        SequencePlayer player (numLanes);
+
+        // Continuous playback: every block carries on from the last
+        {
+            auto beat = anywhere (random);
+
+            const auto timings = bench::timeEachCall ([&]
+            {
+                const PatternSequencer::ReadScope scope (sequencer);
+
+                for (int lane = 0; lane < numLanes; ++lane)
+                    bench::doNotOptimise (player.getSegments (*scope.getTimeline(), lane, beat, beatsPerSample,
+                                                              blockSize, segments, SequencePlayer::maxSegmentsPerBlock));
+
+                beat += blockSize * beatsPerSample;
+            }, 10, numBlocks);
+
+            printRow ("lookup, playing", numPlacements, timings);
+        }
+
+        // A relocation before every block: always a binary search
+        {
+            const auto timings = bench::timeEachCall ([&]
+            {
+                const auto beat = anywhere (random);
+                const PatternSequencer::ReadScope scope (sequencer);
+
+                for (int lane = 0; lane < numLanes; ++lane)
+                    bench::doNotOptimise (player.getSegments (*scope.getTimeline(), lane, beat, beatsPerSample,
+                                                              blockSize, segments, SequencePlayer::maxSegmentsPerBlock));
+            }, 10, numBlocks);
+
+            printRow ("lookup, seek every block", numPlacements, timings);
+        }
+
+        // Lookup plus rendering every lane's shapes
+        {
+            auto beat = anywhere (random);
+
+            const auto timings = bench::timeEachCall ([&]
+            {
+                const PatternSequencer::ReadScope scope (sequencer);
+                const LFOShapeEngine::ReadScope shapeScope (shapes);
+
+                for (int lane = 0; lane < numLanes; ++lane)
+                {
+                    player.renderLane (*scope.getTimeline(), lane, beat, beatsPerSample, shapes, output.data(), blockSize);
+                    bench::doNotOptimise (output[0]);
+                }
+
+                beat += blockSize * beatsPerSample;
+            }, 10, numBlocks);
+
+            printRow ("lookup + render", numPlacements, timings);
+        }
+
+        // Baseline: scanning the nested vectors
+        {
+            auto beat = anywhere (random);
+
+            const auto timings = bench::timeEachCall ([&]
+            {
+                bench::doNotOptimise (scanNestedVectors (sequencer.getPattern(), beat, beat + blockSize * beatsPerSample));
+                beat += blockSize * beatsPerSample;
+            }, 2, std::max (10, numBlocks / 10));
+
+            printRow ("scan nested vectors", numPlacements, timings);
+        }
+
+        const auto& stats = player.getStats();
+        std::printf ("%-26s %10d %12.2f ms  (stepped %llu, searched %llu)\n\n", "compile + swap", numPlacements,
+                     compileNs / 1.0e6, (unsigned long long) stats.linearSteps, (unsigned long long) stats.binarySearches);
+    }
+
+    return 0;
+}
+
+} // namespace wobblerbench
@@ -0,0 +1,251 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    ShapeBenchmark - cost of rendering hundreds of LFOs from their baked
+    wavetables, how long an edit takes to reach the audio thread, and how far
+    the tables are from the exact curves
+
+  ==============================================================================
+*/
+
+#include "WobblerBench.h"
+
+#include "BenchmarkUtilities.h"
+#include "GainKernels.h"
+#include "LFOShapeEngine.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace wobblerbench
+{
+
+namespace
+{
+    using namespace wobbler;
+    namespace bench = plugindsp::bench;
+
+    //==============================================================================
+    LFOShape makeRandomShape (std::mt19937& random, int numPoints)
+    {
+        std::uniform_real_distribution<float> unit (0.0f, 1.0f);
+        std::vector<LFOPoint> points;
+
+        for (int i = 0; i < numPoints; ++i)
+        {
+            LFOPoint point;
+            point.phase = (float) i / (float) numPoints;
+            point.value = unit (random);
+            point.curve = (CurveType) (random() % 4);
+            point.curvature = unit (random) * 2.0f - 1.0f;
+            points.push_back (point);
+        }
+
+        return LFOShape (std::move (points));
+    }
+
+    //==============================================================================
+    void benchmarkRendering (LFOShapeEngine& engine, const std::vector<LFOShape>& shapes,
+                             int blockSize, const CommonOptions& options)
+    {
+        const auto numShapes = (int) shapes.size();
+        const auto measuredBlocks = options.quick ? 50 : 500;
+        const auto sampleRate = 48000.0;
+
+        std::vector<float> output ((size_t) blockSize);
+        std::vector<float> phases ((size_t) numShapes, 0.0f);
+
+        std::printf ("Rendering %d LFOs, %d-sample blocks, 48 kHz\n", numShapes, blockSize);
+        std::printf ("%-12s %-8s %12s %12s %10s\n", "rate", "impl", "ns/sample", "us/block", "% budget");
+
+        const auto blockBudget = 1.0e9 * blockSize / sampleRate;
+
+        for (auto rateHz : { 1.0, 40.0, 400.0 })
+        {
+            const auto increment = (float) (rateHz / sampleRate);
+
+            // Baseline: evaluating the exact curve for every sample
+            {
+                const auto timings = bench::timeEachCall ([&]
+                {
+                    for (int s = 0; s < numShapes; ++s)
+                    {
+                        auto phase = (double) phases[(size_t) s];
+
+                        for (int i = 0; i < blockSize; ++i)
+                            output[(size_t) i] = shapes[(size_t) s].evaluate (phase + increment * i);
+
+                        phases[(size_t) s] = (float) std::fmod (phase + (double) increment * blockSize, 1.0);
+                        bench::doNotOptimise (output[0]);
+                    }
+                }, 2, std::max (5, measuredBlocks / 20));
+
+                const auto p50 = bench::summarise (timings).p50;
+                std::printf ("%7.0f Hz   %-8s %12.3f %12.2f %9.1f%%\n", rateHz, "exact",
+                             p50 / (numShapes * blockSize), p50 / 1000.0, 100.0 * p50 / blockBudget);
+            }
+
+            const auto bestLevel = plugindsp::getBestAvailableSimdLevel();
+
+            for (auto level : { plugindsp::SimdLevel::scalar, plugindsp::SimdLevel::avx2 })
+            {
+                if (! plugindsp::setActiveSimdLevel (level))
+                    continue;
+
+                const auto timings = bench::timeEachCall ([&]
+                {
+                    const LFOShapeEngine::ReadScope scope (engine);
+
+                    for (int s = 0; s < numShapes; ++s)
+                    {
+                        phases[(size_t) s] = engine.render (s, phases[(size_t) s], increment, output.data(), blockSize);
+                        bench::doNotOptimise (output[0]);
+                    }
+                }, 10, measuredBlocks);
+
+                const auto p50 = bench::summarise (timings).p50;
+                std::printf ("%7.0f Hz   %-8s %12.3f %12.2f %9.1f%%\n", rateHz, plugindsp::getSimdLevelName (level),
+                             p50 / (numShapes * blockSize), p50 / 1000.0, 100.0 * p50 / blockBudget);
+            }
+
+            plugindsp::setActiveSimdLevel (bestLevel);
+        }
+
+        std::printf ("\n");
+    }
+
+    //==============================================================================
+    void benchmarkRebuilds (LFOShapeEngine& engine, std::mt19937& random, const CommonOptions& options)
+    {
+        const auto numEdits = options.quick ? 50 : 500;
+
+        std::printf ("Edit-to-audio latency (setShape() until the new table is published)\n");
+        std::printf ("%-28s %10s %10s %10s %14s\n", "edit", "p50 us", "p99 us", "max us", "evaluated/edit");
+
+        auto shape = makeRandomShape (random, 32);
+        std::uniform_real_distribution<float> unit (0.0f, 1.0f);
+
+        const auto measure = [&] (const char* name, auto&& edit)
+        {
+            engine.setShape (0, shape);
+            engine.waitUntilIdle();
+
+            const auto before = engine.getStats();
+            std::vector<double> timings;
+
+            for (int i = 0; i < numEdits; ++i)
+            {
+                edit();
+
+                const auto start = bench::Clock::now();
+                engine.setShape (0, shape);
+                engine.waitUntilIdle();
+                timings.push_back (bench::nanosecondsBetween (start, bench::Clock::now()));
+            }
+
+            const auto after = engine.getStats();
+            const auto summary = bench::summarise (timings);
+            std::printf ("%-28s %10.1f %10.1f %10.1f %14.0f\n", name,
+                         summary.p50 / 1000.0, summary.p99 / 1000.0, summary.max / 1000.0,
+                         (double) (after.samplesEvaluated - before.samplesEvaluated) / numEdits);
+        };
+
+        measure ("move one point (32 points)", [&]
+        {
+            auto points = shape.getPoints();
+            points[(size_t) (random() % points.size())].value = unit (random);
+            shape.setPoints (std::move (points));
+        });
+
+        measure ("add a point (full rebake)", [&]
+        {
+            auto points = shape.getPoints();
+
+            if (points.size() > 48)
+                points.resize (32);
+
+            points.push_back ({ unit (random), unit (random), CurveType::spline });
+            shape.setPoints (std::move (points));
+        });
+
+        const auto stats = engine.getStats();
+        std::printf ("builds: %llu (%llu incremental), tables freed: %llu, slowest build: %.1f us\n\n",
+                     (unsigned long long) stats.tablesBuilt, (unsigned long long) stats.incrementalBuilds,
+                     (unsigned long long) stats.tablesFreed, stats.maxBuildMicroseconds);
+    }
+
+    //==============================================================================
+    void measureAccuracy (LFOShapeEngine& engine, const std::vector<LFOShape>& shapes)
+    {
+        std::printf ("Level 0 accuracy against the exact curve (values are 0-1)\n");
+
+        std::mt19937 random (99);
+        std::uniform_real_distribution<double> unit (0.0, 1.0);
+
+        double sumError = 0.0, maxSmoothError = 0.0;
+        long long count = 0;
+
+        const LFOShapeEngine::ReadScope scope (engine);
+
+        for (int s = 0; s < (int) shapes.size(); ++s)
+        {
+            const auto* table = engine.getTable (s);
+            const auto& shape = shapes[(size_t) s];
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                const auto phase = unit (random);
+                const auto error = (double) std::abs (table->getValue ((float) phase) - shape.evaluate (phase));
+
+                sumError += error;
+                ++count;
+
+                // Steps and jumps can't be interpolated, so only segments
+                // that are continuous count towards the worst case
+                const auto& point = shape.getPoints()[(size_t) shape.findSegment (phase)];
+                const auto sampleWidth = 1.0 / engine.getTableSize();
+
+                if (point.curve != CurveType::step
+                     && shape.findSegment (phase - sampleWidth) == shape.findSegment (phase + sampleWidth))
+                    maxSmoothError = std::max (maxSmoothError, error);
+            }
+        }
+
+        std::printf ("mean error: %.6f, worst error on continuous segments: %.6f\n\n",
+                     sumError / (double) std::max (1LL, count), maxSmoothError);
+    }
+}
+
+//==============================================================================
+int runShapeBenchmark (const std::vector<std::string>& args, const CommonOptions& options)
+{
+    const auto numShapes = std::max (1, getIntOption (args, "--shapes", 256));
+    const auto blockSize = std::max (1, getIntOption (args, "--block-size", 512));
+
+    std::printf ("Best available SIMD level: %s\n\n",
+                 plugindsp::getSimdLevelName (plugindsp::getBestAvailableSimdLevel()));
+
+    std::mt19937 random (1234);
+    LFOShapeEngine engine (numShapes);
+    std::vector<LFOShape> shapes;
+
+    for (int i = 0; i < numShapes; ++i)
+    {
+        shapes.push_back (makeRandomShape (random, 4 + (int) (random() % 29)));
+        engine.setShape (i, shapes.back());
+    }
+
+    const auto start = bench::Clock::now();
+    engine.waitUntilIdle();
+    std::printf ("Baked %d shapes in %.2f ms\n\n", numShapes,
+                 bench::nanosecondsBetween (start, bench::Clock::now()) / 1.0e6);
+
+    benchmarkRendering (engine, shapes, blockSize, options);
+    measureAccuracy (engine, shapes);
+    benchmarkRebuilds (engine, random, options);
+    return 0;
+}
+
+} // namespace wobblerbench
@@ -0,0 +1,228 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    StateBenchmark - save and load latency of a large preset, with and
+    without the state tree's cached encodings, and the cost of migrating a
+    version 1 preset
+
+  ==============================================================================
+*/
+
+#include "WobblerBench.h"
+
+#include "BenchmarkUtilities.h"
+#include "PluginState.h"
+
+#include <cstdio>
+#include <random>
+
+namespace wobblerbench
+{
+
+namespace
+{
+    using namespace wobbler;
+    namespace bench = plugindsp::bench;
+
+    constexpr int numLanes = 16;
+
+    //==============================================================================
+    LFOShape makeRandomShape (std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> unit (0.0f, 1.0f);
+        std::vector<LFOPoint> points ((size_t) (4 + random() % 29));
+
+        for (auto& point : points)
+        {
+            point.phase = unit (random);
+            point.value = unit (random);
+            point.curve = (CurveType) (random() % 4);
+            point.curvature = unit (random) * 2.0f - 1.0f;
+        }
+
+        return LFOShape (std::move (points));
+    }
+
+    PatternSequence makeRandomPattern (int numPlacements, int numShapes, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> unit (0.0f, 1.0f);
+        PatternSequence pattern (numLanes, 16.0);
+
+        for (int i = 0; i < numPlacements; ++i)
+        {
+            ShapePlacement placement;
+            placement.startBeat = (double) (i / numLanes) * 0.5;
+            placement.lengthBeats = 0.25 + 0.25 * (double) (random() % 4);
+            placement.shapeSlot = (int) (random() % (unsigned) numShapes);
+            placement.cycles = 1.0f + (float) (random() % 4);
+            placement.phaseOffset = unit (random);
+            placement.scale = unit (random);
+            pattern.addPlacement (i % numLanes, placement);
+        }
+
+        pattern.setLengthBeats ((double) (numPlacements / numLanes + 1) * 0.5);
+        return pattern;
+    }
+
+    void printRow (const char* name, const std::vector<double>& timings, int nodesEncoded, size_t bytes)
+    {
+        const auto summary = bench::summarise (timings);
+        std::printf ("%-34s %10.3f %10.3f %10d %10.2f\n", name, summary.p50 / 1.0e6, summary.p99 / 1.0e6,
+                     nodesEncoded, (double) bytes / (1024.0 * 1024.0));
+    }
+}
+
+//==============================================================================
+int runStateBenchmark (const std::vector<std::string>& args, const CommonOptions& options)
+{
+    const auto numShapes = std::max (1, getIntOption (args, "--shapes", 1000));
+    const auto numPlacements = std::max (numLanes, getIntOption (args, "--placements", 10000));
+    const auto numPatterns = std::max (1, getIntOption (args, "--patterns", 4));
+    const auto runs = options.quick ? 10 : 50;
+
+    std::mt19937 random (7);
+
+    // The preset, as the engine objects and as the state tree
+    std::vector<LFOShape> shapes;
+    std::vector<PatternSequence> patterns;
+    PluginState state;
+
+    for (int i = 0; i < numShapes; ++i)
+    {
+        shapes.push_back (makeRandomShape (random));
+        state.setShape (i, shapes.back());
+    }
+
+    for (int i = 0; i < numPatterns; ++i)
+    {
+        patterns.push_back (makeRandomPattern (numPlacements / numPatterns, numShapes, random));
+        state.setPattern (i, patterns.back());
+    }
+
+    std::vector<RoutingEntry> routes (256);
+
+    for (size_t i = 0; i < routes.size(); ++i)
+    {
+        routes[i].sourceIndex = (int) i % 64;
+        routes[i].target.targetID = (int) i;
+    }
+
+    state.setRoutes (routes);
+    state.getSettings().setProperty ("tempoSync", (std::int64_t) 1);
+
+    std::printf ("%d shapes, %d placements in %d patterns, %d routes\n\n",
+                 numShapes, numPlacements, numPatterns, (int) routes.size());
+    std::printf ("%-34s %10s %10s %10s %10s\n", "operation", "p50 ms", "p99 ms", "re-encoded", "MB");
+
+    std::vector<std::uint8_t> saved;
+    auto nodesEncoded = 0;
+
+    // Baseline: every node encoded from scratch, as a save without caching would
+    const auto fullTimes = bench::timeEachCall ([&]
+    {
+        state.getRoot().invalidateEncoding();
+        nodesEncoded = state.save (saved);
+    }, 2, runs);
+
+    printRow ("save, full encode", fullTimes, nodesEncoded, saved.size());
+
+    const auto unchangedTimes = bench::timeEachCall ([&] { nodesEncoded = state.save (saved); }, 2, runs);
+    printRow ("save, nothing changed", unchangedTimes, nodesEncoded, saved.size());
+
+    // One edit between saves, as an autosave or undo snapshot after a drag would see
+    auto edit = 0;
+
+    const auto placementTimes = bench::timeEachCall ([&]
+    {
+        auto placement = patterns[0].getLane (3)[5];
+        placement.scale = (float) (++edit % 100) / 100.0f;
+        patterns[0].setPlacement (3, 5, placement);
+        state.setPlacement (0, 3, 5, placement);
+        nodesEncoded = state.save (saved);
+    }, 2, runs);
+
+    printRow ("save after 1 placement edit", placementTimes, nodesEncoded, saved.size());
+
+    const auto shapeTimes = bench::timeEachCall ([&]
+    {
+        auto points = shapes[17].getPoints();
+        points[0].value = (float) (++edit % 100) / 100.0f;
+        state.setShape (17, LFOShape (points));
+        nodesEncoded = state.save (saved);
+    }, 2, runs);
+
+    printRow ("save after 1 shape edit", shapeTimes, nodesEncoded, saved.size());
+
+    // Syncing a whole pattern back from the engine objects only dirties what differs
+    const auto syncTimes = bench::timeEachCall ([&]
+    {
+        auto placement = patterns[1].getLane (0)[0];
+        placement.offset = (float) (++edit % 100) / 100.0f;
+        patterns[1].setPlacement (0, 0, placement);
+        state.setPattern (1, patterns[1]);
+        nodesEncoded = state.save (saved);
+    }, 2, runs);
+
+    printRow ("setPattern (1 change) + save", syncTimes, nodesEncoded, saved.size());
+
+    //==============================================================================
+    const auto savedState = saved;
+    PluginState loaded;
+    auto result = PluginState::LoadResult::invalid;
+
+    const auto loadTimes = bench::timeEachCall ([&] { result = loaded.load (savedState.data(), savedState.size()); }, 2, runs);
+    printRow ("load", loadTimes, 0, savedState.size());
+
+    const auto extractTimes = bench::timeEachCall ([&]
+    {
+        result = loaded.load (savedState.data(), savedState.size());
+
+        for (int i = 0; i < loaded.getNumShapes(); ++i)
+            bench::doNotOptimise (loaded.getShape (i));
+
+        for (int i = 0; i < loaded.getNumPatterns(); ++i)
+            bench::doNotOptimise (loaded.getPattern (i));
+    }, 2, runs);
+
+    printRow ("load + rebuild engine objects", extractTimes, 0, savedState.size());
+
+    const auto resaveTimes = bench::timeEachCall ([&] { nodesEncoded = loaded.save (saved); }, 2, runs);
+    printRow ("save straight after load", resaveTimes, nodesEncoded, saved.size());
+
+    // A version 1 preset of the same shapes: migrated once, in load()
+    std::vector<std::uint8_t> version1;
+    PluginState::writeVersion1State (shapes, version1);
+
+    const auto migrateTimes = bench::timeEachCall ([&] { result = loaded.load (version1.data(), version1.size()); }, 2, runs);
+    printRow ("load version 1 (migrates)", migrateTimes, 0, version1.size());
+
+    const auto migrationsRun = loaded.getNumMigrationsRun();
+
+    //==============================================================================
+    // Everything must survive the round trip
+    auto roundTripOk = result == PluginState::LoadResult::loaded && loaded.getLoadedVersion() == 1
+                        && migrationsRun == PluginState::currentVersion - 1;
+
+    for (int i = 0; i < numShapes && roundTripOk; ++i)
+        roundTripOk = loaded.getShape (i) == shapes[(size_t) i];
+
+    roundTripOk = roundTripOk && loaded.load (savedState.data(), savedState.size()) == PluginState::LoadResult::loaded;
+
+    for (int i = 0; i < numShapes && roundTripOk; ++i)
+        roundTripOk = loaded.getShape (i) == state.getShape (i);
+
+    for (int i = 0; i < numPatterns && roundTripOk; ++i)
+    {
+        const auto pattern = loaded.getPattern (i);
+
+        for (int lane = 0; lane < numLanes && roundTripOk; ++lane)
+            roundTripOk = pattern.getLane (lane) == patterns[(size_t) i].getLane (lane);
+    }
+
+    std::printf ("\nmigrations run for a version 1 preset: %d\n", migrationsRun);
+    std::printf ("round trip (current and version 1): %s\n", roundTripOk ? "ok" : "FAILED");
+    return roundTripOk ? 0 : 1;
+}
+
+} // namespace wobblerbench
@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    UndoBenchmark - times undo and redo over a randomised run of edits,
+    drags, undos and redos, and reports what the history keeps in memory
+
+  ==============================================================================
+*/
+
+#include "WobblerBench.h"
+
+#include "BenchmarkUtilities.h"
+#include "RandomStateEdits.h"
+
+#include <cstdio>
+
+namespace wobblerbench
+{
+
+namespace
+{
+    using namespace wobbler;
+    namespace bench = plugindsp::bench;
+
+    constexpr wobblertests::RandomStateEdits::PresetSize presetSize { 64, 1000, 16 };
+
+    //==============================================================================
+    /** Edits a preset at random, timing each undo and redo in between. */
+    class UndoRun
+    {
+    public:
+        UndoRun (std::size_t memoryLimit, unsigned seed)
+            : edits (state, presetSize, seed)
+        {
+            history.setMemoryLimit (memoryLimit);
+        }
+
+        //==============================================================================
+        void run (int numOperations)
+        {
+            for (int i = 0; i < numOperations; ++i)
+            {
+                switch (edits.chooseAction())
+                {
+                    case wobblertests::RandomStateEdits::Action::undo:  timedStep (true);  break;
+                    case wobblertests::RandomStateEdits::Action::redo:  timedStep (false); break;
+                    case wobblertests::RandomStateEdits::Action::edit:  edit();            break;
+                }
+            }
+        }
+
+        /** Undoes everything the history holds, then redoes it all. */
+        void unwindAndReplay()
+        {
+            while (history.canUndo())
+                timedStep (true);
+
+            while (history.canRedo())
+                timedStep (false);
+        }
+
+        //==============================================================================
+        void printReport()
+        {
+            state.save (saved);
+
+            const auto undo = bench::summarise (undoTimes);
+            const auto redo = bench::summarise (redoTimes);
+            const auto compressedIn = history.getCompressedInputBytes();
+            const auto compressedOut = history.getCompressedOutputBytes();
+
+            std::printf ("%-34s %12d\n", "edits", numEdits);
+            std::printf ("%-34s %12d\n", "undos", (int) undoTimes.size());
+            std::printf ("%-34s %12d\n", "redos", (int) redoTimes.size());
+            std::printf ("%-34s %12d\n", "steps held", history.getNumSteps());
+            std::printf ("%-34s %12d\n", "steps compressed", history.getNumCompressed());
+            std::printf ("%-34s %12d\n", "steps dropped", history.getNumDropped());
+            std::printf ("%-34s %12.2f\n", "compression ratio",
+                         compressedOut > 0 ? (double) compressedIn / (double) compressedOut : 0.0);
+            std::printf ("%-34s %12.1f\n", "memory limit KB", (double) history.getMemoryLimit() / 1024.0);
+            std::printf ("%-34s %12.1f\n", "peak memory KB", (double) peakMemory / 1024.0);
+            std::printf ("%-34s %12.1f\n", "saved state KB (one snapshot)", (double) saved.size() / 1024.0);
+            std::printf ("%-34s %12.1f\n", "memory per step, bytes",
+                         (double) history.getMemoryUsage() / (double) std::max (1, history.getNumSteps()));
+            std::printf ("%-34s %12.2f %12.2f\n", "undo p50 / p99 us", undo.p50 / 1.0e3, undo.p99 / 1.0e3);
+            std::printf ("%-34s %12.2f %12.2f\n", "redo p50 / p99 us", redo.p50 / 1.0e3, redo.p99 / 1.0e3);
+        }
+
+    private:
+        //==============================================================================
+        void timedStep (bool isUndo)
+        {
+            const auto start = bench::Clock::now();
+            isUndo ? history.undo() : history.redo();
+            const auto end = bench::Clock::now();
+
+            (isUndo ? undoTimes : redoTimes).push_back (bench::nanosecondsBetween (start, end));
+        }
+
+        //==============================================================================
+        void edit()
+        {
+            edits.makeEdit();
+            ++numEdits;
+            peakMemory = std::max (peakMemory, history.getMemoryUsage());
+        }
+
+        //==============================================================================
+        PluginState state;
+        UndoHistory& history = state.getUndoHistory();
+        wobblertests::RandomStateEdits edits;
+
+        std::vector<std::uint8_t> saved;
+
+        int numEdits = 0;
+        std::size_t peakMemory = 0;
+        std::vector<double> undoTimes, redoTimes;
+    };
+}
+
+//==============================================================================
+int runUndoBenchmark (const std::vector<std::string>& args, const CommonOptions& options)
+{
+    const auto numOperations = std::max (1, getIntOption (args, "--edits", options.quick ? 3000 : 30000));
+    const auto memoryLimit = (std::size_t) std::max (1, getIntOption (args, "--memory-kb", 1024)) * 1024;
+    const auto seed = (unsigned) getIntOption (args, "--seed", 1);
+
+    std::printf ("%d shapes, %d placements, %d random operations, seed %u\n\n",
+                 presetSize.numShapes, presetSize.numPlacements, numOperations, seed);
+
+    UndoRun undoRun (memoryLimit, seed);
+    undoRun.run (numOperations);
+    undoRun.unwindAndReplay();
+    undoRun.printReport();
+
+    std::printf ("\nWobblerTests checks that every undo and redo restores the saved state exactly,\n"
+                 "and that the history stays within its memory limit.\n");
+    return 0;
+}
+
+} // namespace wobblerbench
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    Wobbler - pattern-based LFO modulation plugin
+    WobblerBench - benchmarks for the modulation engine, one subcommand each
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace wobblerbench
+{
+
+/** Options shared by every subcommand. */
+struct CommonOptions
+{
+    bool quick = false;     // fewer repetitions, for a fast sanity check
+};
+
+/** Returns the value following a flag, e.g. "--shapes 64", or fallback if absent. */
+int getIntOption (const std::vector<std::string>& args, const char* flag, int fallback);
+bool hasFlag (const std::vector<std::string>& args, const char* flag);
+
+//==============================================================================
+/** shapes: wavetable rendering cost, rebuild latency and accuracy. */
+int runShapeBenchmark (const std::vector<std::string>& args, const CommonOptions& options);
+
+/** sequencer: per-block placement lookup cost as the pattern grows. */
+int runSequencerBenchmark (const std::vector<std::string>& args, const CommonOptions& options);
+
+/** routing: modulation matrix cost per block, up to every source on every target. */
+int runRoutingBenchmark (const std::vector<std::string>& args, const CommonOptions& options);
+
+/** output: host notifications sent by the parameter output scheduler, counted by a mock host. */
+int runOutputBenchmark (const std::vector<std::string>& args, const CommonOptions& options);
+
+/** state: preset save/load latency with cached subtree encodings, and migration cost. */
+int runStateBenchmark (const std::vector<std::string>& args, const CommonOptions& options);
+
+/** undo: randomised edits, undos and redos, checking every step restores the state exactly. */
+int runUndoBenchmark (const std::vector<std::string>& args, const CommonOptions& options);
+
+} // namespace wobblerbench